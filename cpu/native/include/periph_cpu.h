@@ -113,11 +113,13 @@ typedef enum {
 /** @} */
 
 /* Configuration for the wrapper around the Linux SPI API (periph_spidev_linux)
+ * and for the mock SPI bus (periph_spi_mock)
  *
  * Needs to go here, otherwise the SPI_NEEDS_ are defined after inclusion of
  * spi.h.
  */
-#if defined(MODULE_PERIPH_SPIDEV_LINUX) || defined(DOXYGEN)
+#if defined(MODULE_PERIPH_SPIDEV_LINUX) || defined(MODULE_PERIPH_SPI_MOCK) || \
+    defined(DOXYGEN)
 
 /**
  * @name SPI Configuration
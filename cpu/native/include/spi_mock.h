@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2023 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    drivers_spi_mock Mock SPI Driver
+ * @ingroup     cpu_native
+ * @brief       SPI bus connected to emulated devices
+ *
+ * This module provides the SPI API on native without any hardware. Instead of
+ * a physical bus, every SPI bus is connected to a device model that is attached
+ * by the application with @ref spi_mock_attach. This allows to test drivers of
+ * SPI devices on native against a model of the device.
+ *
+ * The module replaces `periph_spidev_linux` when it is added to the
+ * application's Makefile:
+ * ```
+ * USEMODULE += periph_spi_mock
+ * ```
+ *
+ * A device is selected when a transfer with a chip select line other than
+ * `SPI_CS_UNDEF` starts, and unselected after the last transfer that does not
+ * continue. Drivers that handle the chip select line themselves (`SPI_CS_UNDEF`)
+ * select the device for the whole time they acquired the bus.
+ *
+ * @{
+ *
+ * @file
+ * @brief       Mock SPI bus connected to emulated devices
+ */
+
+#ifndef SPI_MOCK_H
+#define SPI_MOCK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "periph/spi.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Model of a device on a mock SPI bus
+ */
+typedef struct {
+    /**
+     * @brief   Called when the device is selected or unselected
+     *
+     * @param[in]   arg         argument given to @ref spi_mock_attach
+     * @param[in]   selected    true if the device was selected
+     */
+    void (*select)(void *arg, bool selected);
+    /**
+     * @brief   Called for every byte transferred to the selected device
+     *
+     * @param[in]   arg     argument given to @ref spi_mock_attach
+     * @param[in]   out     byte sent by the host
+     *
+     * @return  byte sent by the device in the same clock cycles
+     */
+    uint8_t (*transfer)(void *arg, uint8_t out);
+} spi_mock_dev_t;
+
+/**
+ * @brief   Connect a device model to a mock SPI bus
+ *
+ * Transfers on a bus without a device read all bits as set.
+ *
+ * @param[in]   bus     SPI bus the device is connected to
+ * @param[in]   dev     model of the device, NULL to disconnect the device
+ * @param[in]   arg     argument passed to the callbacks of @p dev
+ */
+void spi_mock_attach(spi_t bus, const spi_mock_dev_t *dev, void *arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SPI_MOCK_H */
+/** @} */
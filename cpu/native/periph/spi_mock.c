@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2023 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     cpu_native
+ * @ingroup     drivers_spi_mock
+ * @{
+ *
+ * @file
+ * @brief       Mock SPI bus connected to emulated devices
+ * @}
+ */
+
+#include <assert.h>
+
+#include "mutex.h"
+#include "periph/spi.h"
+#include "spi_mock.h"
+
+#define ENABLE_DEBUG 0
+#include "debug.h"
+
+/**
+ * @brief   State of a mock SPI bus
+ */
+typedef struct {
+    mutex_t lock;                   /**< lock of the bus */
+    const spi_mock_dev_t *dev;      /**< device connected to the bus */
+    void *arg;                      /**< argument of the device callbacks */
+    bool selected;                  /**< device is selected */
+} _spi_mock_t;
+
+static _spi_mock_t _buses[SPI_NUMOF];
+
+static void _select(_spi_mock_t *bus, bool selected)
+{
+    if (bus->selected == selected) {
+        return;
+    }
+    bus->selected = selected;
+    if (bus->dev && bus->dev->select) {
+        bus->dev->select(bus->arg, selected);
+    }
+}
+
+void spi_mock_attach(spi_t bus, const spi_mock_dev_t *dev, void *arg)
+{
+    assert(bus < SPI_NUMOF);
+
+    mutex_lock(&_buses[bus].lock);
+    _buses[bus].dev = dev;
+    _buses[bus].arg = arg;
+    _buses[bus].selected = false;
+    mutex_unlock(&_buses[bus].lock);
+}
+
+void spi_init(spi_t bus)
+{
+    assert(bus < SPI_NUMOF);
+    DEBUG("spi_init(%u)\n", bus);
+}
+
+void spi_init_pins(spi_t bus)
+{
+    (void)bus;
+}
+
+int spi_init_cs(spi_t bus, spi_cs_t cs)
+{
+    (void)cs;
+
+    if (bus >= SPI_NUMOF) {
+        return SPI_NODEV;
+    }
+    return SPI_OK;
+}
+
+void spi_acquire(spi_t bus, spi_cs_t cs, spi_mode_t mode, spi_clk_t clk)
+{
+    (void)mode;
+    (void)clk;
+    assert(bus < SPI_NUMOF);
+
+    mutex_lock(&_buses[bus].lock);
+    /* the driver handles the chip select line, so the device is selected
+       while the bus is acquired */
+    if (cs == SPI_CS_UNDEF) {
+        _select(&_buses[bus], true);
+    }
+}
+
+void spi_release(spi_t bus)
+{
+    assert(bus < SPI_NUMOF);
+
+    _select(&_buses[bus], false);
+    mutex_unlock(&_buses[bus].lock);
+}
+
+void spi_transfer_bytes(spi_t bus, spi_cs_t cs, bool cont,
+                        const void *out, void *in, size_t len)
+{
+    assert(bus < SPI_NUMOF);
+    /* as the real peripherals, at least one direction has to be given */
+    assert(out || in);
+
+    _spi_mock_t *mock = &_buses[bus];
+    const uint8_t *out_buf = out;
+    uint8_t *in_buf = in;
+
+    _select(mock, true);
+    for (size_t i = 0; i < len; i++) {
+        uint8_t tx = out_buf ? out_buf[i] : 0;
+        uint8_t rx = 0xff;
+
+        if (mock->dev && mock->dev->transfer) {
+            rx = mock->dev->transfer(mock->arg, tx);
+        }
+        if (in_buf) {
+            in_buf[i] = rx;
+        }
+    }
+    DEBUG("spi_transfer_bytes: transferred %u bytes\n", (unsigned)len);
+
+    if (cs != SPI_CS_UNDEF && !cont) {
+        _select(mock, false);
+    }
+}
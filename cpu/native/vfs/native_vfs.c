@@ -19,11 +19,18 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <stdarg.h>
+#include <stdbool.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
+#include "container.h"
+#include "macros/utils.h"
 #include "vfs.h"
 
+/* number of iovec entries passed to the VFS at once */
+#define NATIVE_VFS_IOLIST_NUMOF     (8)
+
 int open(const char *name, int flags, ...)
 {
     unsigned mode = 0;
@@ -110,6 +117,84 @@ off_t lseek(int fd, off_t off, int whence)
     return res;
 }
 
+ssize_t pread(int fd, void *dest, size_t count, off_t off)
+{
+    int res = vfs_pread(fd, dest, count, off);
+
+    if (res < 0) {
+        /* vfs returns negative error codes */
+        errno = -res;
+        return -1;
+    }
+    return res;
+}
+
+ssize_t pwrite(int fd, const void *src, size_t count, off_t off)
+{
+    int res = vfs_pwrite(fd, src, count, off);
+
+    if (res < 0) {
+        /* vfs returns negative error codes */
+        errno = -res;
+        return -1;
+    }
+    return res;
+}
+
+static ssize_t _prwv(int fd, const struct iovec *iov, int iovcnt, off_t off,
+                     bool write)
+{
+    iolist_t iolist[NATIVE_VFS_IOLIST_NUMOF];
+    ssize_t sum = 0;
+
+    if (iovcnt < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    /* the iovec array is passed on in chunks as linked iolists */
+    while (iovcnt > 0) {
+        unsigned numof = MIN((unsigned)iovcnt, ARRAY_SIZE(iolist));
+        size_t len = 0;
+
+        for (unsigned i = 0; i < numof; i++) {
+            iolist[i].iol_next = (i + 1 < numof) ? &iolist[i + 1] : NULL;
+            iolist[i].iol_base = iov[i].iov_base;
+            iolist[i].iol_len = iov[i].iov_len;
+            len += iov[i].iov_len;
+        }
+
+        ssize_t res = write ? vfs_pwritev(fd, iolist, off + sum)
+                            : vfs_preadv(fd, iolist, off + sum);
+        if (res < 0) {
+            if (sum) {
+                /* report what was transferred before the error */
+                break;
+            }
+            /* vfs returns negative error codes */
+            errno = -res;
+            return -1;
+        }
+        sum += res;
+        if ((size_t)res < len) {
+            break;
+        }
+        iov += numof;
+        iovcnt -= numof;
+    }
+    return sum;
+}
+
+ssize_t preadv(int fd, const struct iovec *iov, int iovcnt, off_t off)
+{
+    return _prwv(fd, iov, iovcnt, off, false);
+}
+
+ssize_t pwritev(int fd, const struct iovec *iov, int iovcnt, off_t off)
+{
+    return _prwv(fd, iov, iovcnt, off, true);
+}
+
 int fstat(int fd, struct stat *buf)
 {
     int res = vfs_fstat(fd, buf);
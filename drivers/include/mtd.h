@@ -99,6 +99,11 @@ enum mtd_power_state {
  */
 typedef struct mtd_desc mtd_desc_t;
 
+/**
+ * @brief   Asynchronous MTD request, see @ref drivers_mtd_async
+ */
+struct mtd_async_req;
+
 /**
  * @brief   MTD device descriptor
  *
@@ -278,6 +283,38 @@ struct mtd_desc {
      */
     int (*power)(mtd_dev_t *dev, enum mtd_power_state power);
 
+#if defined(MODULE_MTD_ASYNC) || DOXYGEN
+    /**
+     * @brief   Starts the next step of an asynchronous request
+     *
+     * Issues the next command of @p req to the device without waiting for
+     * it to complete and updates @p req to the remaining work. Optional,
+     * requests without this are run in the @ref drivers_mtd_async worker
+     * thread.
+     *
+     * @param[in] dev       Pointer to the selected driver
+     * @param[in,out] req   The request
+     *
+     * @return  expected duration of the step in us
+     * @return  0 if @p req is complete
+     * @return  -ENOTSUP if @p req is to be run synchronously instead
+     * @return  < 0 value on error
+     */
+    int (*async_step)(mtd_dev_t *dev, struct mtd_async_req *req);
+
+    /**
+     * @brief   Checks whether the step started by mtd_desc::async_step
+     *          is still in progress
+     *
+     * @param[in] dev       Pointer to the selected driver
+     *
+     * @return  1 if busy
+     * @return  0 if the step completed
+     * @return  < 0 value on error
+     */
+    int (*async_busy)(mtd_dev_t *dev);
+#endif
+
     /**
      * @brief   Properties of the MTD driver
      */
@@ -0,0 +1,187 @@
+/*
+ * Copyright (C) 2023 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    drivers_mtd_async  Asynchronous MTD requests
+ * @ingroup     drivers_mtd
+ * @brief       Read, write and erase MTD devices without blocking the caller
+ *
+ * The functions of @ref drivers_mtd return when the operation completed,
+ * which for erasing flash can take hundreds of milliseconds. With this
+ * module, requests are submitted and an event is posted to an
+ * @ref sys_event "event queue" of the caller's choice when they complete.
+ *
+ * Requests are run by one of two means:
+ *
+ * - Drivers implementing mtd_desc::async_step and mtd_desc::async_busy
+ *   start the operation right away and return. The device is polled from
+ *   the event queue of the request, timed by ZTIMER_MSEC, until the
+ *   operation completed. @ref drivers_mtd_spi_nor does so for erasing.
+ * - All other requests are run by the synchronous driver functions in a
+ *   worker thread, one after the other.
+ *
+ * ```c
+ * static void _erased(event_t *event)
+ * {
+ *     mtd_async_req_t *req = container_of(event, mtd_async_req_t, event);
+ *
+ *     printf("erase done: %d\n", req->res);
+ * }
+ *
+ * static mtd_async_req_t req;
+ *
+ * mtd_async_req_init(&req, EVENT_PRIO_MEDIUM, _erased);
+ * mtd_async_erase_sector(&req, MTD_0, 0, 16);
+ * ```
+ *
+ * @{
+ *
+ * @file
+ * @brief       Interface definitions for asynchronous MTD requests
+ */
+
+#ifndef MTD_ASYNC_H
+#define MTD_ASYNC_H
+
+#include <stdint.h>
+
+#include "event.h"
+#include "mtd.h"
+#include "ztimer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Stack size of the worker thread
+ */
+#ifndef MTD_ASYNC_STACK_SIZE
+#define MTD_ASYNC_STACK_SIZE    (THREAD_STACKSIZE_DEFAULT)
+#endif
+
+/**
+ * @brief   Priority of the worker thread
+ */
+#ifndef MTD_ASYNC_PRIO
+#define MTD_ASYNC_PRIO          (THREAD_PRIORITY_MAIN + 1)
+#endif
+
+/**
+ * @brief   Operation of an asynchronous request
+ */
+typedef enum {
+    MTD_ASYNC_READ,         /**< mtd_read_page() */
+    MTD_ASYNC_WRITE_RAW,    /**< mtd_write_page_raw() */
+    MTD_ASYNC_WRITE,        /**< mtd_write_page() */
+    MTD_ASYNC_ERASE,        /**< mtd_erase_sector() */
+} mtd_async_op_t;
+
+/**
+ * @brief   Asynchronous MTD request
+ *
+ * Set up with mtd_async_req_init(). The other members are set on submission
+ * and are, except for @p res, private while the request is in progress.
+ */
+typedef struct mtd_async_req {
+    event_t event;          /**< posted to @p queue on completion */
+    event_t work;           /**< work in the worker thread or poll */
+    ztimer_t timer;         /**< times polls of the device */
+    event_queue_t *queue;   /**< queue to post @p event to */
+    mtd_dev_t *mtd;         /**< device */
+    void *buf;              /**< data to read or write */
+    uint32_t page;          /**< first page, or first sector for erasing */
+    uint32_t offset;        /**< byte offset in @p page */
+    uint32_t size;          /**< bytes, or sectors for erasing */
+    uint32_t wait;          /**< time in us until the next poll */
+    int res;                /**< result of the operation, see @ref drivers_mtd */
+    uint8_t op;             /**< operation, see @ref mtd_async_op_t */
+} mtd_async_req_t;
+
+/**
+ * @brief   Initializes a request
+ *
+ * @param[out] req      The request.
+ * @param[in] queue     Queue to post the completion event to.
+ * @param[in] handler   Handler of the completion event.
+ */
+void mtd_async_req_init(mtd_async_req_t *req, event_queue_t *queue,
+                        event_handler_t handler);
+
+/**
+ * @brief   Submits a request to read with pagewise addressing
+ *
+ * Asynchronous version of mtd_read_page(). @p dest must stay valid until
+ * the request completed.
+ *
+ * @param[in] req       Initialized request, not in progress.
+ * @param[in] mtd       The device.
+ * @param[out] dest     Buffer for the data.
+ * @param[in] page      Page to start reading from.
+ * @param[in] offset    Offset from the start of @p page.
+ * @param[in] size      Number of bytes to read.
+ */
+void mtd_async_read_page(mtd_async_req_t *req, mtd_dev_t *mtd, void *dest,
+                         uint32_t page, uint32_t offset, uint32_t size);
+
+/**
+ * @brief   Submits a request to write with pagewise addressing
+ *
+ * Asynchronous version of mtd_write_page_raw(). @p src must stay valid until
+ * the request completed.
+ *
+ * @param[in] req       Initialized request, not in progress.
+ * @param[in] mtd       The device.
+ * @param[in] src       Data to write.
+ * @param[in] page      Page to start writing to.
+ * @param[in] offset    Offset from the start of @p page.
+ * @param[in] size      Number of bytes to write.
+ */
+void mtd_async_write_page_raw(mtd_async_req_t *req, mtd_dev_t *mtd,
+                              const void *src, uint32_t page,
+                              uint32_t offset, uint32_t size);
+
+#if defined(MODULE_MTD_WRITE_PAGE) || DOXYGEN
+/**
+ * @brief   Submits a request to write with pagewise addressing, erasing
+ *          the sectors as needed
+ *
+ * Asynchronous version of mtd_write_page(). @p src must stay valid until
+ * the request completed.
+ *
+ * @param[in] req       Initialized request, not in progress.
+ * @param[in] mtd       The device.
+ * @param[in] src       Data to write.
+ * @param[in] page      Page to start writing to.
+ * @param[in] offset    Offset from the start of @p page.
+ * @param[in] size      Number of bytes to write.
+ */
+void mtd_async_write_page(mtd_async_req_t *req, mtd_dev_t *mtd,
+                          const void *src, uint32_t page,
+                          uint32_t offset, uint32_t size);
+#endif
+
+/**
+ * @brief   Submits a request to erase sectors
+ *
+ * Asynchronous version of mtd_erase_sector().
+ *
+ * @param[in] req       Initialized request, not in progress.
+ * @param[in] mtd       The device.
+ * @param[in] sector    First sector to erase.
+ * @param[in] count     Number of sectors to erase.
+ */
+void mtd_async_erase_sector(mtd_async_req_t *req, mtd_dev_t *mtd,
+                            uint32_t sector, uint32_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MTD_ASYNC_H */
+/** @} */
@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2023 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    drivers_mtd_cache  MTD page cache
+ * @ingroup     drivers_storage
+ * @brief       Write-back page cache on top of another MTD device
+ *
+ * This MTD module keeps the most recently used pages of a backing MTD device
+ * in RAM and presents itself as an MTD device with the same geometry.
+ * File systems tend to read the same metadata pages over and over and to
+ * write them in small chunks, which the cache turns into RAM accesses.
+ *
+ * - Reads of cached pages are served from RAM. A read of less than a page
+ *   loads the page into the cache, a read of a whole page that is not cached
+ *   is passed through without evicting any other page.
+ * - Writes go to the cached page and are written to the backing device when
+ *   the page is evicted, when a write to the page does not touch the range
+ *   written before, or on mtd_cache_flush(). Consecutive small writes to a
+ *   page are thus written to the device in one go, and every byte is still
+ *   written to the device only once.
+ * - Erasing sectors drops their pages from the cache, including unwritten
+ *   data.
+ *
+ * Pages are replaced least recently used first.
+ *
+ * @warning Data written to the cache is lost on a reset unless
+ *          mtd_cache_flush() was called. Call it where the file system or
+ *          application expects its data to be persistent, e.g. after
+ *          vfs_fsync().
+ *
+ * ## Usage
+ *
+ * ```
+ * USEMODULE += mtd_cache
+ * ```
+ *
+ * ```
+ * static mtd_cache_line_t lines[4];
+ * static uint8_t buf[4 * PAGE_SIZE];
+ *
+ * static mtd_cache_t cache = MTD_CACHE_INIT(MTD_0, lines, buf);
+ *
+ * mtd_dev_t *dev = &cache.mtd;
+ * ```
+ *
+ * The snippet caches four pages of `MTD_0`, whose page size is `PAGE_SIZE`.
+ *
+ * @{
+ *
+ * @file
+ * @brief       Interface definitions for the MTD page cache
+ */
+
+#ifndef MTD_CACHE_H
+#define MTD_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "container.h"
+#include "mtd.h"
+#include "mutex.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Initializer for an @ref mtd_cache_t
+ *
+ * @param[in] _parent   Backing MTD device
+ * @param[in] _lines    Array of @ref mtd_cache_line_t, one per cached page
+ * @param[in] _buf      Array of `uint8_t` holding the cached pages, at least
+ *                      one page per line
+ */
+#define MTD_CACHE_INIT(_parent, _lines, _buf) \
+{ \
+    .mtd = { .driver = &mtd_cache_driver }, \
+    .parent = _parent, \
+    .lines = _lines, \
+    .buf = _buf, \
+    .buf_size = sizeof(_buf), \
+    .lines_numof = ARRAY_SIZE(_lines), \
+    .lock = MUTEX_INIT, \
+}
+
+/**
+ * @brief   A cached page
+ */
+typedef struct {
+    uint32_t page;          /**< page number, UINT32_MAX if unused */
+    uint32_t used;          /**< time of last use, for LRU replacement */
+    uint16_t dirty_start;   /**< start of the range not yet written back */
+    uint16_t dirty_end;     /**< end of the range not yet written back */
+} mtd_cache_line_t;
+
+/**
+ * @brief   Cache statistics
+ */
+typedef struct {
+    uint32_t hits;          /**< accesses served by a cached page */
+    uint32_t misses;        /**< accesses that needed the backing device */
+    uint32_t writebacks;    /**< writes to the backing device */
+} mtd_cache_stats_t;
+
+/**
+ * @brief   MTD page cache device
+ */
+typedef struct {
+    mtd_dev_t mtd;              /**< MTD context */
+    mtd_dev_t *parent;          /**< backing MTD device */
+    mtd_cache_line_t *lines;    /**< cached pages */
+    uint8_t *buf;               /**< page data, one page per line */
+    size_t buf_size;            /**< size of @p buf */
+    uint8_t lines_numof;        /**< number of lines */
+    uint32_t clock;             /**< counts accesses, for LRU replacement */
+    mutex_t lock;               /**< guards the cache */
+    mtd_cache_stats_t stats;    /**< cache statistics */
+} mtd_cache_t;
+
+/**
+ * @brief   MTD page cache operations table
+ */
+extern const mtd_desc_t mtd_cache_driver;
+
+/**
+ * @brief   Writes all cached data to the backing device
+ *
+ * @param[in] cache     The cache.
+ *
+ * @return  0 on success
+ * @return  <0 error of the backing device, data that could not be written
+ *          stays in the cache
+ */
+int mtd_cache_flush(mtd_cache_t *cache);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MTD_CACHE_H */
+/** @} */
@@ -0,0 +1,207 @@
+/*
+ * Copyright (C) 2023 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    drivers_mtd_ftl  MTD flash translation layer
+ * @ingroup     drivers_storage
+ * @brief       Overwritable pages with wear levelling on top of a raw MTD
+ *              device
+ *
+ * File systems like FAT expect to overwrite small blocks in place. On raw
+ * flash every such write requires erasing, and thus rewriting, a whole
+ * sector, which is slow and wears the flash out quickly. This MTD module maps
+ * the logical pages it presents to physical locations on the backing device
+ * instead:
+ *
+ * - Writes of a logical page go to the next free slot of the sector currently
+ *   being filled, regardless of the page's address. The old copy of the page
+ *   becomes stale. No sector is erased on a write.
+ * - Once there are too few free sectors left, the sector with the least
+ *   valid pages is garbage collected: its valid pages are copied and it is
+ *   freed. This happens on demand while writing, or ahead of time with
+ *   mtd_ftl_collect().
+ * - Free sectors are used least erased first. mtd_ftl_collect() also moves
+ *   data that is never rewritten off sectors that are erased much less often
+ *   than others, so that these are used as well.
+ *
+ * The device presents itself with one page per sector and
+ * @ref MTD_DRIVER_FLAG_DIRECT_WRITE: pages can be overwritten without
+ * erasing them. Erasing a sector only marks the page as unused, so it is not
+ * copied by the garbage collection; after a reboot, the previous content of
+ * an erased page may be read again until it is written.
+ *
+ * The first slot of every sector of the backing device holds its erase
+ * count and the addresses of the logical pages in the other slots. The
+ * mapping is rebuilt from these when the device is initialized, and a page
+ * is only mapped to its new copy once that is completely written, so data is
+ * not lost on a reset while writing.
+ *
+ * ## Usage
+ *
+ * ```
+ * USEMODULE += mtd_ftl
+ * ```
+ *
+ * ```
+ * static uint16_t map[1024];
+ * static mtd_ftl_block_t blocks[256];
+ * static uint8_t buf[512];
+ *
+ * static mtd_ftl_t ftl = MTD_FTL_INIT(MTD_0, 512, map, blocks, buf);
+ *
+ * fatfs_desc.dev = &ftl.mtd;
+ * ```
+ *
+ * The snippet presents up to 1024 logical pages of 512 bytes backed by up to
+ * 256 sectors of `MTD_0`, e.g. a 1 MiB SPI NOR flash with 4 KiB sectors,
+ * which holds (256 - @ref CONFIG_MTD_FTL_SPARE_BLOCKS) * 7 logical pages.
+ * `map` needs one entry per logical page, `blocks` one entry per sector of
+ * the backing device; the smaller one limits the capacity.
+ *
+ * @{
+ *
+ * @file
+ * @brief       Interface definitions for the MTD flash translation layer
+ */
+
+#ifndef MTD_FTL_H
+#define MTD_FTL_H
+
+#include <stdint.h>
+
+#include "container.h"
+#include "mtd.h"
+#include "mutex.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup drivers_mtd_ftl_conf MTD flash translation layer compile time configuration
+ * @ingroup config
+ * @{
+ */
+/**
+ * @brief   Sectors of the backing device not used for logical pages
+ *
+ * At least two are needed for garbage collection to make progress; more
+ * spare sectors lower the number of pages copied by garbage collection.
+ */
+#ifndef CONFIG_MTD_FTL_SPARE_BLOCKS
+#define CONFIG_MTD_FTL_SPARE_BLOCKS     (2U)
+#endif
+
+/**
+ * @brief   mtd_ftl_collect() collects garbage while there are fewer free
+ *          sectors than this
+ */
+#ifndef CONFIG_MTD_FTL_GC_FREE_BLOCKS
+#define CONFIG_MTD_FTL_GC_FREE_BLOCKS   (4U)
+#endif
+
+/**
+ * @brief   mtd_ftl_collect() moves data off a sector once its erase count is
+ *          this much below the most erased sector's
+ */
+#ifndef CONFIG_MTD_FTL_WEAR_DELTA
+#define CONFIG_MTD_FTL_WEAR_DELTA       (16U)
+#endif
+/** @} */
+
+/**
+ * @brief   Initializer for an @ref mtd_ftl_t
+ *
+ * @param[in] _parent       Backing MTD device
+ * @param[in] _page_size    Size of a logical page, a power of two of at most
+ *                          half the sector size of @p _parent
+ * @param[in] _map          Array of `uint16_t`, one per logical page
+ * @param[in] _blocks       Array of @ref mtd_ftl_block_t, one per sector of
+ *                          @p _parent
+ * @param[in] _buf          Array of `uint8_t`, one logical page
+ */
+#define MTD_FTL_INIT(_parent, _page_size, _map, _blocks, _buf) \
+{ \
+    .mtd = { .driver = &mtd_ftl_driver }, \
+    .parent = _parent, \
+    .map = _map, \
+    .blocks = _blocks, \
+    .buf = _buf, \
+    .map_numof = ARRAY_SIZE(_map), \
+    .blocks_numof = ARRAY_SIZE(_blocks), \
+    .page_size = _page_size, \
+    .lock = MUTEX_INIT, \
+}
+
+/**
+ * @brief   State of a sector of the backing device
+ */
+typedef struct {
+    uint32_t erase_count;   /**< number of times the sector was erased */
+    uint32_t seq;           /**< order in which sectors were filled, 0 if free */
+    uint16_t valid;         /**< number of slots holding mapped pages */
+} mtd_ftl_block_t;
+
+/**
+ * @brief   Flash translation layer statistics
+ */
+typedef struct {
+    uint32_t writes;        /**< pages written on behalf of the user */
+    uint32_t copies;        /**< pages copied by garbage collection */
+    uint32_t erases;        /**< sectors erased */
+} mtd_ftl_stats_t;
+
+/**
+ * @brief   MTD flash translation layer device
+ */
+typedef struct {
+    mtd_dev_t mtd;              /**< MTD context */
+    mtd_dev_t *parent;          /**< backing MTD device */
+    uint16_t *map;              /**< physical slot of each logical page */
+    mtd_ftl_block_t *blocks;    /**< state of each sector */
+    uint8_t *buf;               /**< buffer of one logical page */
+    uint32_t map_numof;         /**< number of entries in @p map */
+    uint32_t blocks_numof;      /**< number of entries in @p blocks */
+    uint32_t seq;               /**< sequence number of the next sector */
+    uint16_t page_size;         /**< size of a logical page */
+    uint16_t slots;             /**< data slots per sector */
+    uint16_t head;              /**< sector being filled */
+    uint16_t head_slot;         /**< next free slot in @p head */
+    uint16_t free_numof;        /**< number of free sectors */
+    mutex_t lock;               /**< guards the device */
+    mtd_ftl_stats_t stats;      /**< statistics */
+} mtd_ftl_t;
+
+/**
+ * @brief   MTD flash translation layer operations table
+ */
+extern const mtd_desc_t mtd_ftl_driver;
+
+/**
+ * @brief   Does one step of background maintenance
+ *
+ * Garbage collects one sector if there are fewer than
+ * @ref CONFIG_MTD_FTL_GC_FREE_BLOCKS free sectors, or else moves the data of
+ * the least erased sector if it lags @ref CONFIG_MTD_FTL_WEAR_DELTA erases
+ * behind. Call this when the system is idle, so that writes rarely have to
+ * wait for garbage collection.
+ *
+ * @param[in] ftl       The initialized device.
+ *
+ * @return  1 if a sector was freed
+ * @return  0 if there was nothing to do
+ * @return  <0 error of the backing device
+ */
+int mtd_ftl_collect(mtd_ftl_t *ftl);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MTD_FTL_H */
+/** @} */
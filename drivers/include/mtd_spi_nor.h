@@ -53,6 +53,8 @@ typedef struct {
     uint8_t chip_erase;      /**< Chip erase */
     uint8_t sleep;           /**< Deep power down */
     uint8_t wake;            /**< Release from deep power down */
+    uint8_t suspend;         /**< Suspend erase */
+    uint8_t resume;          /**< Resume suspended erase */
     /* TODO: enter 4 byte address mode for large memories */
 } mtd_spi_nor_opcode_t;
 
@@ -96,6 +98,35 @@ typedef struct __attribute__((packed)) {
  */
 #define SPI_NOR_F_SECT_64K  (4)
 
+/**
+ * @brief   Flag to set when the device should be read with the fast read
+ *          command (read_fast opcode, one dummy byte after the address)
+ *
+ * Most devices require it for reading at their highest SPI clock.
+ */
+#define SPI_NOR_F_FAST_READ (8)
+
+/**
+ * @brief   Flag to set when the device supports suspending an erase
+ *          (suspend and resume opcodes)
+ *
+ * With `mtd_async`, reads during an erase suspend the erase instead of waiting
+ * for it to complete. Reads of the block being erased still wait for the
+ * erase.
+ */
+#define SPI_NOR_F_SUSPEND   (16)
+
+/**
+ * @brief   Minimum time in ms an erase runs after it was started or resumed,
+ *          before a read suspends it again
+ *
+ * Reads wait for the rest of this time, so that a stream of reads can not keep
+ * an erase from completing.
+ */
+#ifndef CONFIG_MTD_SPI_NOR_SUSPEND_INTERVAL_MS
+#define CONFIG_MTD_SPI_NOR_SUSPEND_INTERVAL_MS  (1)
+#endif
+
 /**
  * @brief Compile-time parameters for a serial flash device
  */
@@ -155,6 +186,20 @@ typedef struct {
      * Computed by mtd_spi_nor_init, no need to touch outside the driver.
      */
     uint8_t addr_width;
+#if defined(MODULE_MTD_ASYNC) || defined(DOXYGEN)
+    /**
+     * @brief   Address of the block erased asynchronously
+     */
+    uint32_t erase_addr;
+    /**
+     * @brief   Size of the block erased asynchronously
+     */
+    uint32_t erase_size;
+    /**
+     * @brief   Time in ms the asynchronous erase was started or last resumed
+     */
+    uint32_t erase_resumed;
+#endif
 } mtd_spi_nor_t;
 
 /**
@@ -0,0 +1,216 @@
+/*
+ * Copyright (C) 2023 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     drivers_mtd_async
+ * @{
+ *
+ * @file
+ * @brief       Asynchronous MTD requests
+ *
+ * @}
+ */
+
+#include <errno.h>
+
+#include "container.h"
+#include "mtd_async.h"
+#include "mutex.h"
+#include "thread.h"
+
+#define ENABLE_DEBUG 0
+#include "debug.h"
+
+/* shortest interval between two polls of a busy device */
+#define POLL_MIN_US     (1000U)
+
+static char _stack[MTD_ASYNC_STACK_SIZE];
+static kernel_pid_t _pid = KERNEL_PID_UNDEF;
+static mutex_t _init_lock = MUTEX_INIT;
+static event_queue_t _queue = EVENT_QUEUE_INIT_DETACHED;
+
+static void *_worker(void *arg)
+{
+    (void)arg;
+
+    event_queue_claim(&_queue);
+    event_loop(&_queue);
+
+    return NULL;
+}
+
+static void _complete(mtd_async_req_t *req, int res)
+{
+    DEBUG("mtd_async: %p done: %d\n", (void *)req, res);
+
+    req->res = res;
+    event_post(req->queue, &req->event);
+}
+
+/* runs a request with the synchronous driver functions */
+static void _work(event_t *event)
+{
+    mtd_async_req_t *req = container_of(event, mtd_async_req_t, work);
+    int res = -ENOTSUP;
+
+    switch (req->op) {
+    case MTD_ASYNC_READ:
+        res = mtd_read_page(req->mtd, req->buf, req->page, req->offset,
+                            req->size);
+        break;
+    case MTD_ASYNC_WRITE_RAW:
+        res = mtd_write_page_raw(req->mtd, req->buf, req->page, req->offset,
+                                 req->size);
+        break;
+#ifdef MODULE_MTD_WRITE_PAGE
+    case MTD_ASYNC_WRITE:
+        res = mtd_write_page(req->mtd, req->buf, req->page, req->offset,
+                             req->size);
+        break;
+#endif
+    case MTD_ASYNC_ERASE:
+        res = mtd_erase_sector(req->mtd, req->page, req->size);
+        break;
+    }
+    _complete(req, res);
+}
+
+static void _timeout(void *arg)
+{
+    mtd_async_req_t *req = arg;
+
+    event_post(req->queue, &req->work);
+}
+
+static void _wait(mtd_async_req_t *req)
+{
+    ztimer_set(ZTIMER_MSEC, &req->timer, (req->wait + 999) / 1000);
+}
+
+/* handles the result of mtd_desc::async_step */
+static void _stepped(mtd_async_req_t *req, int res)
+{
+    if (res > 0) {
+        req->wait = res;
+        _wait(req);
+    }
+    else {
+        _complete(req, res);
+    }
+}
+
+/* polls the device for a request started with mtd_desc::async_step */
+static void _poll(event_t *event)
+{
+    mtd_async_req_t *req = container_of(event, mtd_async_req_t, work);
+    const mtd_desc_t *driver = req->mtd->driver;
+    int res = driver->async_busy(req->mtd);
+
+    if (res > 0) {
+        /* poll more often if the estimate was too short */
+        req->wait = (req->wait / 2 > POLL_MIN_US) ? req->wait / 2 : POLL_MIN_US;
+        _wait(req);
+    }
+    else if (res < 0) {
+        _complete(req, res);
+    }
+    else {
+        _stepped(req, driver->async_step(req->mtd, req));
+    }
+}
+
+static int _start_worker(void)
+{
+    int res = 0;
+
+    mutex_lock(&_init_lock);
+    if (_pid == KERNEL_PID_UNDEF) {
+        res = thread_create(_stack, sizeof(_stack), MTD_ASYNC_PRIO,
+                            THREAD_CREATE_STACKTEST, _worker, NULL,
+                            "mtd_async");
+        if (res < 0) {
+            /* leave _pid undefined to try again with the next request */
+            DEBUG("mtd_async: cannot create worker: %d\n", res);
+        }
+        else {
+            _pid = res;
+            res = 0;
+        }
+    }
+    mutex_unlock(&_init_lock);
+    return res;
+}
+
+static void _submit(mtd_async_req_t *req, mtd_dev_t *mtd, uint8_t op,
+                    void *buf, uint32_t page, uint32_t offset, uint32_t size)
+{
+    const mtd_desc_t *driver = mtd->driver;
+
+    req->mtd = mtd;
+    req->op = op;
+    req->buf = buf;
+    req->page = page;
+    req->offset = offset;
+    req->size = size;
+
+    if (driver->async_step) {
+        int res = driver->async_step(mtd, req);
+
+        if (res != -ENOTSUP) {
+            req->work.handler = _poll;
+            _stepped(req, res);
+            return;
+        }
+    }
+
+    req->work.handler = _work;
+    int res = _start_worker();
+    if (res < 0) {
+        _complete(req, res);
+        return;
+    }
+    event_post(&_queue, &req->work);
+}
+
+void mtd_async_req_init(mtd_async_req_t *req, event_queue_t *queue,
+                        event_handler_t handler)
+{
+    *req = (mtd_async_req_t) {
+        .event.handler = handler,
+        .timer = { .callback = _timeout, .arg = req },
+        .queue = queue,
+    };
+}
+
+void mtd_async_read_page(mtd_async_req_t *req, mtd_dev_t *mtd, void *dest,
+                         uint32_t page, uint32_t offset, uint32_t size)
+{
+    _submit(req, mtd, MTD_ASYNC_READ, dest, page, offset, size);
+}
+
+void mtd_async_write_page_raw(mtd_async_req_t *req, mtd_dev_t *mtd,
+                              const void *src, uint32_t page,
+                              uint32_t offset, uint32_t size)
+{
+    _submit(req, mtd, MTD_ASYNC_WRITE_RAW, (void *)src, page, offset, size);
+}
+
+#ifdef MODULE_MTD_WRITE_PAGE
+void mtd_async_write_page(mtd_async_req_t *req, mtd_dev_t *mtd,
+                          const void *src, uint32_t page,
+                          uint32_t offset, uint32_t size)
+{
+    _submit(req, mtd, MTD_ASYNC_WRITE, (void *)src, page, offset, size);
+}
+#endif
+
+void mtd_async_erase_sector(mtd_async_req_t *req, mtd_dev_t *mtd,
+                            uint32_t sector, uint32_t count)
+{
+    _submit(req, mtd, MTD_ASYNC_ERASE, NULL, sector, 0, count);
+}
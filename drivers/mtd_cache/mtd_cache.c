@@ -0,0 +1,283 @@
+/*
+ * Copyright (C) 2023 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     drivers_mtd_cache
+ * @{
+ *
+ * @file
+ * @brief       Write-back page cache for MTD devices
+ *
+ * @}
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include "macros/utils.h"
+#include "mtd.h"
+#include "mtd_cache.h"
+#include "mutex.h"
+
+#define ENABLE_DEBUG 0
+#include "debug.h"
+
+#define PAGE_NONE   (UINT32_MAX)
+
+static uint8_t *_data(mtd_cache_t *cache, mtd_cache_line_t *line)
+{
+    return &cache->buf[(line - cache->lines) * cache->mtd.page_size];
+}
+
+static bool _is_dirty(const mtd_cache_line_t *line)
+{
+    return line->dirty_end > line->dirty_start;
+}
+
+static mtd_cache_line_t *_find(mtd_cache_t *cache, uint32_t page)
+{
+    for (unsigned i = 0; i < cache->lines_numof; i++) {
+        if (cache->lines[i].page == page) {
+            cache->lines[i].used = ++cache->clock;
+            return &cache->lines[i];
+        }
+    }
+    return NULL;
+}
+
+static int _writeback(mtd_cache_t *cache, mtd_cache_line_t *line)
+{
+    if (!_is_dirty(line)) {
+        return 0;
+    }
+
+    DEBUG("mtd_cache: write back page %" PRIu32 " [%u, %u)\n", line->page,
+          line->dirty_start, line->dirty_end);
+
+    int res = mtd_write_page_raw(cache->parent,
+                                 _data(cache, line) + line->dirty_start,
+                                 line->page, line->dirty_start,
+                                 line->dirty_end - line->dirty_start);
+    if (res < 0) {
+        return res;
+    }
+    cache->stats.writebacks++;
+    line->dirty_start = line->dirty_end = 0;
+    return 0;
+}
+
+/* gets a line for @p page, filled from the backing device if @p fill */
+static int _alloc(mtd_cache_t *cache, uint32_t page, bool fill,
+                  mtd_cache_line_t **line)
+{
+    mtd_cache_line_t *lru = &cache->lines[0];
+
+    for (unsigned i = 0; i < cache->lines_numof; i++) {
+        mtd_cache_line_t *cur = &cache->lines[i];
+
+        if (cur->page == PAGE_NONE) {
+            lru = cur;
+            break;
+        }
+        if ((int32_t)(cur->used - lru->used) < 0) {
+            lru = cur;
+        }
+    }
+
+    int res = _writeback(cache, lru);
+    if (res < 0) {
+        return res;
+    }
+    lru->page = PAGE_NONE;
+
+    if (fill) {
+        res = mtd_read_page(cache->parent, _data(cache, lru), page, 0,
+                            cache->mtd.page_size);
+        if (res < 0) {
+            return res;
+        }
+    }
+    lru->page = page;
+    lru->used = ++cache->clock;
+    *line = lru;
+    return 0;
+}
+
+static int _init(mtd_dev_t *mtd)
+{
+    mtd_cache_t *cache = container_of(mtd, mtd_cache_t, mtd);
+    mtd_dev_t *parent = cache->parent;
+
+    int res = mtd_init(parent);
+    if (res < 0) {
+        return res;
+    }
+
+    mtd->sector_count = parent->sector_count;
+    mtd->pages_per_sector = parent->pages_per_sector;
+    mtd->page_size = parent->page_size;
+    mtd->write_size = parent->write_size;
+
+    assert(parent->page_size <= UINT16_MAX);
+    if (cache->buf_size < cache->lines_numof * parent->page_size) {
+        return -ENOMEM;
+    }
+
+    for (unsigned i = 0; i < cache->lines_numof; i++) {
+        cache->lines[i].page = PAGE_NONE;
+        cache->lines[i].dirty_start = cache->lines[i].dirty_end = 0;
+    }
+    return 0;
+}
+
+static int _read_page(mtd_dev_t *mtd, void *dest, uint32_t page,
+                      uint32_t offset, uint32_t size)
+{
+    mtd_cache_t *cache = container_of(mtd, mtd_cache_t, mtd);
+    mtd_cache_line_t *line;
+    int res = 0;
+
+    if (size > mtd->page_size - offset) {
+        size = mtd->page_size - offset;
+    }
+
+    mutex_lock(&cache->lock);
+    line = _find(cache, page);
+    if (line) {
+        cache->stats.hits++;
+    }
+    else {
+        cache->stats.misses++;
+        /* a whole page is read past the cache, so it is not flushed out */
+        if (size == mtd->page_size) {
+            res = mtd_read_page(cache->parent, dest, page, 0, size);
+        }
+        else {
+            res = _alloc(cache, page, true, &line);
+        }
+    }
+    if (line && (res == 0)) {
+        memcpy(dest, _data(cache, line) + offset, size);
+    }
+    mutex_unlock(&cache->lock);
+
+    return (res < 0) ? res : (int)size;
+}
+
+static int _write_page(mtd_dev_t *mtd, const void *src, uint32_t page,
+                       uint32_t offset, uint32_t size)
+{
+    mtd_cache_t *cache = container_of(mtd, mtd_cache_t, mtd);
+    mtd_cache_line_t *line;
+    int res = 0;
+
+    if (size > mtd->page_size - offset) {
+        size = mtd->page_size - offset;
+    }
+    uint32_t end = offset + size;
+
+    mutex_lock(&cache->lock);
+    line = _find(cache, page);
+    if (line) {
+        cache->stats.hits++;
+        /* only extend the unwritten range, so no byte is written twice */
+        if (_is_dirty(line) &&
+            ((offset > line->dirty_end) || (end < line->dirty_start))) {
+            res = _writeback(cache, line);
+        }
+    }
+    else {
+        cache->stats.misses++;
+        res = _alloc(cache, page, size < mtd->page_size, &line);
+    }
+    if (res == 0) {
+        memcpy(_data(cache, line) + offset, src, size);
+        if (!_is_dirty(line)) {
+            line->dirty_start = offset;
+            line->dirty_end = end;
+        }
+        else {
+            line->dirty_start = MIN(line->dirty_start, offset);
+            line->dirty_end = MAX(line->dirty_end, end);
+        }
+    }
+    mutex_unlock(&cache->lock);
+
+    return (res < 0) ? res : (int)size;
+}
+
+static int _erase_sector(mtd_dev_t *mtd, uint32_t sector, uint32_t count)
+{
+    mtd_cache_t *cache = container_of(mtd, mtd_cache_t, mtd);
+    uint32_t first = sector * mtd->pages_per_sector;
+    uint32_t last = first + count * mtd->pages_per_sector;
+
+    mutex_lock(&cache->lock);
+    /* erasing supersedes data not yet written back */
+    for (unsigned i = 0; i < cache->lines_numof; i++) {
+        mtd_cache_line_t *line = &cache->lines[i];
+
+        if ((line->page >= first) && (line->page < last)) {
+            line->page = PAGE_NONE;
+            line->dirty_start = line->dirty_end = 0;
+        }
+    }
+    int res = mtd_erase_sector(cache->parent, sector, count);
+    mutex_unlock(&cache->lock);
+
+    return res;
+}
+
+static int _flush(mtd_cache_t *cache)
+{
+    int res = 0;
+
+    for (unsigned i = 0; i < cache->lines_numof; i++) {
+        int err = _writeback(cache, &cache->lines[i]);
+        if (res == 0) {
+            res = err;
+        }
+    }
+    return res;
+}
+
+static int _power(mtd_dev_t *mtd, enum mtd_power_state power)
+{
+    mtd_cache_t *cache = container_of(mtd, mtd_cache_t, mtd);
+    int res = 0;
+
+    mutex_lock(&cache->lock);
+    if (power == MTD_POWER_DOWN) {
+        res = _flush(cache);
+    }
+    if (res == 0) {
+        res = mtd_power(cache->parent, power);
+    }
+    mutex_unlock(&cache->lock);
+
+    return res;
+}
+
+int mtd_cache_flush(mtd_cache_t *cache)
+{
+    mutex_lock(&cache->lock);
+    int res = _flush(cache);
+    mutex_unlock(&cache->lock);
+
+    return res;
+}
+
+const mtd_desc_t mtd_cache_driver = {
+    .init = _init,
+    .read_page = _read_page,
+    .write_page = _write_page,
+    .erase_sector = _erase_sector,
+    .power = _power,
+};
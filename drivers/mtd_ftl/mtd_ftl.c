@@ -0,0 +1,505 @@
+/*
+ * Copyright (C) 2023 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     drivers_mtd_ftl
+ * @{
+ *
+ * @file
+ * @brief       Flash translation layer for MTD devices
+ *
+ * @}
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include "bitarithm.h"
+#include "macros/utils.h"
+#include "mtd.h"
+#include "mtd_ftl.h"
+#include "mutex.h"
+
+#define ENABLE_DEBUG 0
+#include "debug.h"
+
+#if CONFIG_MTD_FTL_SPARE_BLOCKS < 2
+#error "CONFIG_MTD_FTL_SPARE_BLOCKS must be at least 2"
+#endif
+
+#define MAGIC           (0x314c5446)    /* "FTL1" */
+#define SLOT_NONE       (UINT16_MAX)
+#define BLOCK_NONE      (UINT16_MAX)
+
+/**
+ * @brief   Header in the first slot of every sector, followed by the
+ *          logical page number of each data slot
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t erase_count;
+    uint32_t seq;
+    uint32_t page_size;
+} _header_t;
+
+static uint32_t _record_offset(unsigned slot)
+{
+    return sizeof(_header_t) + slot * sizeof(uint32_t);
+}
+
+static uint32_t _slot_offset(mtd_ftl_t *ftl, unsigned slot)
+{
+    return (slot + 1) * ftl->page_size;
+}
+
+static int _read(mtd_ftl_t *ftl, unsigned block, uint32_t offset,
+                 void *dest, uint32_t size)
+{
+    mtd_dev_t *parent = ftl->parent;
+    uint32_t addr = block * parent->pages_per_sector * parent->page_size + offset;
+
+    int res = mtd_read_page(parent, dest, addr / parent->page_size,
+                            addr % parent->page_size, size);
+    return (res < 0) ? res : 0;
+}
+
+static int _write(mtd_ftl_t *ftl, unsigned block, uint32_t offset,
+                  const void *src, uint32_t size)
+{
+    mtd_dev_t *parent = ftl->parent;
+    uint32_t addr = block * parent->pages_per_sector * parent->page_size + offset;
+
+    return mtd_write_page_raw(parent, src, addr / parent->page_size,
+                              addr % parent->page_size, size);
+}
+
+static void _unmap(mtd_ftl_t *ftl, uint32_t lpn)
+{
+    uint16_t ppn = ftl->map[lpn];
+
+    if (ppn != SLOT_NONE) {
+        ftl->blocks[ppn / ftl->slots].valid--;
+        ftl->map[lpn] = SLOT_NONE;
+    }
+}
+
+static void _map(mtd_ftl_t *ftl, uint32_t lpn, uint16_t ppn)
+{
+    _unmap(ftl, lpn);
+    ftl->map[lpn] = ppn;
+    ftl->blocks[ppn / ftl->slots].valid++;
+}
+
+/* erases the least erased free sector and makes it the head */
+static int _open(mtd_ftl_t *ftl)
+{
+    unsigned block = BLOCK_NONE;
+
+    for (unsigned i = 0; i < ftl->blocks_numof; i++) {
+        if ((ftl->blocks[i].seq == 0) &&
+            ((block == BLOCK_NONE) ||
+             (ftl->blocks[i].erase_count < ftl->blocks[block].erase_count))) {
+            block = i;
+        }
+    }
+    if (block == BLOCK_NONE) {
+        return -ENOSPC;
+    }
+
+    mtd_ftl_block_t *b = &ftl->blocks[block];
+    int res = mtd_erase_sector(ftl->parent, block, 1);
+    if (res < 0) {
+        return res;
+    }
+    b->erase_count++;
+    ftl->stats.erases++;
+
+    _header_t hdr = {
+        .magic = MAGIC,
+        .erase_count = b->erase_count,
+        .seq = ftl->seq,
+        .page_size = ftl->page_size,
+    };
+    res = _write(ftl, block, 0, &hdr, sizeof(hdr));
+    if (res < 0) {
+        return res;
+    }
+
+    DEBUG("mtd_ftl: open sector %u, erased %" PRIu32 " times\n", block,
+          b->erase_count);
+
+    b->seq = ftl->seq++;
+    b->valid = 0;
+    ftl->free_numof--;
+    ftl->head = block;
+    ftl->head_slot = 0;
+    return 0;
+}
+
+/* writes @p data as the new copy of logical page @p lpn */
+static int _append(mtd_ftl_t *ftl, uint32_t lpn, const void *data)
+{
+    int res;
+
+    if (ftl->head == BLOCK_NONE) {
+        res = _open(ftl);
+        if (res < 0) {
+            return res;
+        }
+    }
+
+    unsigned block = ftl->head;
+    unsigned slot = ftl->head_slot++;
+
+    if (ftl->head_slot == ftl->slots) {
+        ftl->head = BLOCK_NONE;
+    }
+
+    /* the slot is consumed even if writing fails, it may be written partly */
+    res = _write(ftl, block, _slot_offset(ftl, slot), data, ftl->page_size);
+    if (res < 0) {
+        return res;
+    }
+    /* the new copy is valid once its record is written */
+    res = _write(ftl, block, _record_offset(slot), &lpn, sizeof(lpn));
+    if (res < 0) {
+        return res;
+    }
+
+    _map(ftl, lpn, block * ftl->slots + slot);
+    return 0;
+}
+
+/* finds the used sector with the least valid pages */
+static unsigned _victim(mtd_ftl_t *ftl)
+{
+    unsigned victim = BLOCK_NONE;
+
+    for (unsigned i = 0; i < ftl->blocks_numof; i++) {
+        const mtd_ftl_block_t *b = &ftl->blocks[i];
+
+        if ((b->seq == 0) || (i == ftl->head)) {
+            continue;
+        }
+        if ((victim == BLOCK_NONE) || (b->valid < ftl->blocks[victim].valid)) {
+            victim = i;
+        }
+    }
+    return victim;
+}
+
+/* copies the valid pages of @p victim and frees it */
+static int _collect(mtd_ftl_t *ftl, unsigned victim)
+{
+    mtd_ftl_block_t *b = &ftl->blocks[victim];
+
+    DEBUG("mtd_ftl: collect sector %u, %u valid\n", victim, b->valid);
+
+    for (unsigned slot = 0; (slot < ftl->slots) && b->valid; slot++) {
+        uint32_t lpn;
+        int res = _read(ftl, victim, _record_offset(slot), &lpn, sizeof(lpn));
+        if (res < 0) {
+            return res;
+        }
+        if ((lpn >= ftl->mtd.sector_count) ||
+            (ftl->map[lpn] != victim * ftl->slots + slot)) {
+            continue;
+        }
+
+        res = _read(ftl, victim, _slot_offset(ftl, slot), ftl->buf,
+                    ftl->page_size);
+        if (res == 0) {
+            res = _append(ftl, lpn, ftl->buf);
+        }
+        if (res < 0) {
+            return res;
+        }
+        ftl->stats.copies++;
+    }
+
+    /* the sector is erased when it is used again */
+    b->seq = 0;
+    ftl->free_numof++;
+    return 0;
+}
+
+/* makes room for writing a page, keeping one free sector for collecting */
+static int _reserve(mtd_ftl_t *ftl)
+{
+    while ((ftl->head == BLOCK_NONE) && (ftl->free_numof <= 1)) {
+        unsigned victim = _victim(ftl);
+
+        if ((victim == BLOCK_NONE) ||
+            (ftl->blocks[victim].valid == ftl->slots)) {
+            return -ENOSPC;
+        }
+
+        int res = _collect(ftl, victim);
+        if (res < 0) {
+            return res;
+        }
+    }
+    return 0;
+}
+
+/* rebuilds the mapping from the records of all used sectors, oldest first */
+static int _mount(mtd_ftl_t *ftl)
+{
+    uint32_t prev = 0;
+    uint32_t table_size = _record_offset(ftl->slots);
+
+    for (unsigned i = 0; i < ftl->mtd.sector_count; i++) {
+        ftl->map[i] = SLOT_NONE;
+    }
+
+    ftl->seq = 1;
+    for (unsigned i = 0; i < ftl->blocks_numof; i++) {
+        mtd_ftl_block_t *b = &ftl->blocks[i];
+        _header_t hdr;
+
+        int res = _read(ftl, i, 0, &hdr, sizeof(hdr));
+        if (res < 0) {
+            return res;
+        }
+
+        b->valid = 0;
+        if ((hdr.magic == MAGIC) && (hdr.page_size == ftl->page_size)) {
+            b->erase_count = hdr.erase_count;
+            b->seq = hdr.seq;
+            ftl->seq = MAX(ftl->seq, hdr.seq + 1);
+        }
+        else {
+            b->erase_count = 0;
+            b->seq = 0;
+        }
+    }
+
+    while (1) {
+        unsigned block = BLOCK_NONE;
+
+        for (unsigned i = 0; i < ftl->blocks_numof; i++) {
+            uint32_t seq = ftl->blocks[i].seq;
+
+            if ((seq > prev) &&
+                ((block == BLOCK_NONE) || (seq < ftl->blocks[block].seq))) {
+                block = i;
+            }
+        }
+        if (block == BLOCK_NONE) {
+            break;
+        }
+        prev = ftl->blocks[block].seq;
+
+        int res = _read(ftl, block, 0, ftl->buf, table_size);
+        if (res < 0) {
+            return res;
+        }
+        for (unsigned slot = 0; slot < ftl->slots; slot++) {
+            uint32_t lpn;
+
+            memcpy(&lpn, &ftl->buf[_record_offset(slot)], sizeof(lpn));
+            if (lpn < ftl->mtd.sector_count) {
+                _map(ftl, lpn, block * ftl->slots + slot);
+            }
+        }
+    }
+
+    /* sectors without valid pages are reused, the partly written sector of
+     * before the reset is not continued */
+    ftl->free_numof = 0;
+    for (unsigned i = 0; i < ftl->blocks_numof; i++) {
+        if (ftl->blocks[i].valid == 0) {
+            ftl->blocks[i].seq = 0;
+        }
+        if (ftl->blocks[i].seq == 0) {
+            ftl->free_numof++;
+        }
+    }
+    ftl->head = BLOCK_NONE;
+
+    DEBUG("mtd_ftl: %" PRIu32 " pages, %u free sectors\n",
+          ftl->mtd.sector_count, ftl->free_numof);
+    return 0;
+}
+
+static int _init(mtd_dev_t *mtd)
+{
+    mtd_ftl_t *ftl = container_of(mtd, mtd_ftl_t, mtd);
+    mtd_dev_t *parent = ftl->parent;
+
+    int res = mtd_init(parent);
+    if (res < 0) {
+        return res;
+    }
+
+    uint32_t sector_size = parent->pages_per_sector * parent->page_size;
+
+    if ((bitarithm_bits_set(ftl->page_size) != 1) ||
+        (ftl->page_size * 2 > sector_size) ||
+        (parent->write_size > sizeof(uint32_t))) {
+        return -ENOTSUP;
+    }
+
+    ftl->slots = sector_size / ftl->page_size - 1;
+    ftl->blocks_numof = MIN(ftl->blocks_numof, parent->sector_count);
+    if ((_record_offset(ftl->slots) > ftl->page_size) ||
+        (ftl->blocks_numof <= CONFIG_MTD_FTL_SPARE_BLOCKS) ||
+        (ftl->blocks_numof * ftl->slots >= SLOT_NONE)) {
+        return -EINVAL;
+    }
+
+    mtd->sector_count = MIN(ftl->map_numof, (ftl->blocks_numof -
+                            CONFIG_MTD_FTL_SPARE_BLOCKS) * ftl->slots);
+    mtd->pages_per_sector = 1;
+    mtd->page_size = ftl->page_size;
+    mtd->write_size = 1;
+
+    mutex_lock(&ftl->lock);
+    res = _mount(ftl);
+    mutex_unlock(&ftl->lock);
+
+    return res;
+}
+
+static int _read_page(mtd_dev_t *mtd, void *dest, uint32_t page,
+                      uint32_t offset, uint32_t size)
+{
+    mtd_ftl_t *ftl = container_of(mtd, mtd_ftl_t, mtd);
+    int res = 0;
+
+    if (size > mtd->page_size - offset) {
+        size = mtd->page_size - offset;
+    }
+
+    mutex_lock(&ftl->lock);
+    uint16_t ppn = ftl->map[page];
+    if (ppn == SLOT_NONE) {
+        memset(dest, 0xff, size);
+    }
+    else {
+        res = _read(ftl, ppn / ftl->slots,
+                    _slot_offset(ftl, ppn % ftl->slots) + offset, dest, size);
+    }
+    mutex_unlock(&ftl->lock);
+
+    return (res < 0) ? res : (int)size;
+}
+
+static int _write_page(mtd_dev_t *mtd, const void *src, uint32_t page,
+                       uint32_t offset, uint32_t size)
+{
+    mtd_ftl_t *ftl = container_of(mtd, mtd_ftl_t, mtd);
+
+    if (size > mtd->page_size - offset) {
+        size = mtd->page_size - offset;
+    }
+
+    mutex_lock(&ftl->lock);
+    int res = _reserve(ftl);
+
+    /* a partial write is merged with the current content of the page */
+    if ((res == 0) && (size < mtd->page_size)) {
+        uint16_t ppn = ftl->map[page];
+
+        if (ppn == SLOT_NONE) {
+            memset(ftl->buf, 0xff, mtd->page_size);
+        }
+        else {
+            res = _read(ftl, ppn / ftl->slots, _slot_offset(ftl, ppn % ftl->slots),
+                        ftl->buf, mtd->page_size);
+        }
+        memcpy(&ftl->buf[offset], src, size);
+        src = ftl->buf;
+    }
+    if (res == 0) {
+        res = _append(ftl, page, src);
+        ftl->stats.writes++;
+    }
+    mutex_unlock(&ftl->lock);
+
+    return (res < 0) ? res : (int)size;
+}
+
+static int _erase_sector(mtd_dev_t *mtd, uint32_t sector, uint32_t count)
+{
+    mtd_ftl_t *ftl = container_of(mtd, mtd_ftl_t, mtd);
+
+    /* erased pages are merely dropped, so they are not copied */
+    mutex_lock(&ftl->lock);
+    while (count--) {
+        _unmap(ftl, sector++);
+    }
+    mutex_unlock(&ftl->lock);
+
+    return 0;
+}
+
+static int _power(mtd_dev_t *mtd, enum mtd_power_state power)
+{
+    mtd_ftl_t *ftl = container_of(mtd, mtd_ftl_t, mtd);
+
+    return mtd_power(ftl->parent, power);
+}
+
+int mtd_ftl_collect(mtd_ftl_t *ftl)
+{
+    unsigned victim = BLOCK_NONE;
+    int res = 0;
+
+    mutex_lock(&ftl->lock);
+    if (ftl->free_numof < CONFIG_MTD_FTL_GC_FREE_BLOCKS) {
+        victim = _victim(ftl);
+        if ((victim != BLOCK_NONE) &&
+            (ftl->blocks[victim].valid == ftl->slots)) {
+            victim = BLOCK_NONE;
+        }
+    }
+
+    /* moving a full sector needs a free sector besides the one kept for
+     * collecting */
+    if ((victim == BLOCK_NONE) && (ftl->free_numof >= 2)) {
+        uint32_t most = 0;
+
+        for (unsigned i = 0; i < ftl->blocks_numof; i++) {
+            const mtd_ftl_block_t *b = &ftl->blocks[i];
+
+            most = MAX(most, b->erase_count);
+            if ((b->seq == 0) || (i == ftl->head)) {
+                continue;
+            }
+            if ((victim == BLOCK_NONE) ||
+                (b->erase_count < ftl->blocks[victim].erase_count)) {
+                victim = i;
+            }
+        }
+        if ((victim != BLOCK_NONE) &&
+            (most - ftl->blocks[victim].erase_count < CONFIG_MTD_FTL_WEAR_DELTA)) {
+            victim = BLOCK_NONE;
+        }
+    }
+
+    if (victim != BLOCK_NONE) {
+        res = _collect(ftl, victim);
+        if (res == 0) {
+            res = 1;
+        }
+    }
+    mutex_unlock(&ftl->lock);
+
+    return res;
+}
+
+const mtd_desc_t mtd_ftl_driver = {
+    .init = _init,
+    .read_page = _read_page,
+    .write_page = _write_page,
+    .erase_sector = _erase_sector,
+    .power = _power,
+    .flags = MTD_DRIVER_FLAG_DIRECT_WRITE,
+};
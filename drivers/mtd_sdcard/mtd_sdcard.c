@@ -29,6 +29,7 @@
 
 #include <inttypes.h>
 #include <errno.h>
+#include <stdlib.h>
 #include <string.h>
 
 static int mtd_sdcard_init(mtd_dev_t *dev)
@@ -45,6 +46,17 @@ static int mtd_sdcard_init(mtd_dev_t *dev)
         /* sdcard_spi always uses the fixed block size of SD-HC cards */
         dev->page_size        = SD_HC_BLOCK_SIZE;
         dev->write_size       = SD_HC_BLOCK_SIZE;
+
+#if IS_USED(MODULE_MTD_WRITE_PAGE)
+        /* the MTD layer does not allocate a work area for devices that can
+           be written directly, but it is needed for partial blocks */
+        if (dev->work_area == NULL) {
+            dev->work_area = malloc(SD_HC_BLOCK_SIZE);
+            if (dev->work_area == NULL) {
+                return -ENOMEM;
+            }
+        }
+#endif
         return 0;
     }
     return -EIO;
@@ -59,7 +71,11 @@ static int mtd_sdcard_read_page(mtd_dev_t *dev, void *buff, uint32_t page,
     DEBUG("mtd_sdcard_read_page: page:%" PRIu32 " offset:%" PRIu32 " size:%" PRIu32 "\n",
           page, offset, size);
 
-    if (offset || size % SD_HC_BLOCK_SIZE) {
+    /* whole blocks are read with a single multi-block read, the number of
+       blocks per read is limited by the sdcard_spi API */
+    uint32_t nblocks = MIN(size / SD_HC_BLOCK_SIZE, UINT16_MAX);
+
+    if (offset || nblocks == 0) {
 #if IS_USED(MODULE_MTD_WRITE_PAGE)
         if (dev->work_area == NULL) {
             DEBUG("mtd_sdcard_read_page: no work area\n");
@@ -85,11 +101,11 @@ static int mtd_sdcard_read_page(mtd_dev_t *dev, void *buff, uint32_t page,
 
     sdcard_spi_read_blocks(mtd_sd->sd_card, page,
                            buff, SD_HC_BLOCK_SIZE,
-                           size / SD_HC_BLOCK_SIZE, &err);
+                           nblocks, &err);
     if (err != SD_RW_OK) {
         return -EIO;
     }
-    return size;
+    return nblocks * SD_HC_BLOCK_SIZE;
 }
 
 static int mtd_sdcard_write_page(mtd_dev_t *dev, const void *buff, uint32_t page,
@@ -101,7 +117,10 @@ static int mtd_sdcard_write_page(mtd_dev_t *dev, const void *buff, uint32_t page
     DEBUG("mtd_sdcard_write_page: page:%" PRIu32 " offset:%" PRIu32 " size:%" PRIu32 "\n",
           page, offset, size);
 
-    if (offset || size % SD_HC_BLOCK_SIZE) {
+    /* whole blocks are written with a single multi-block write */
+    uint32_t nblocks = MIN(size / SD_HC_BLOCK_SIZE, UINT16_MAX);
+
+    if (offset || nblocks == 0) {
 #if IS_USED(MODULE_MTD_WRITE_PAGE)
         if (dev->work_area == NULL) {
             DEBUG("mtd_sdcard_write_page: no work area\n");
@@ -128,7 +147,8 @@ static int mtd_sdcard_write_page(mtd_dev_t *dev, const void *buff, uint32_t page
     } else {
         sdcard_spi_write_blocks(mtd_sd->sd_card, page,
                                 buff, SD_HC_BLOCK_SIZE,
-                                size / SD_HC_BLOCK_SIZE, &err);
+                                nblocks, &err);
+        size = nblocks * SD_HC_BLOCK_SIZE;
     }
 
     if (err != SD_RW_OK) {
@@ -187,29 +207,33 @@ static int mtd_sdcard_power(mtd_dev_t *dev, enum mtd_power_state power)
 static int mtd_sdcard_read(mtd_dev_t *dev, void *buff, uint32_t addr,
                            uint32_t size)
 {
-    int res = mtd_sdcard_read_page(dev, buff, addr / SD_HC_BLOCK_SIZE,
-                                   addr % SD_HC_BLOCK_SIZE, size);
-    if (res < 0) {
-        return res;
-    }
-    if (res == (int)size) {
-        return 0;
+    while (size) {
+        int res = mtd_sdcard_read_page(dev, buff, addr / SD_HC_BLOCK_SIZE,
+                                       addr % SD_HC_BLOCK_SIZE, size);
+        if (res < 0) {
+            return res;
+        }
+        buff = (uint8_t *)buff + res;
+        addr += res;
+        size -= res;
     }
-    return -EOVERFLOW;
+    return 0;
 }
 
 static int mtd_sdcard_write(mtd_dev_t *dev, const void *buff, uint32_t addr,
                             uint32_t size)
 {
-    int res =  mtd_sdcard_write_page(dev, buff, addr / SD_HC_BLOCK_SIZE,
-                                     addr % SD_HC_BLOCK_SIZE, size);
-    if (res < 0) {
-        return res;
-    }
-    if (res == (int)size) {
-        return 0;
+    while (size) {
+        int res = mtd_sdcard_write_page(dev, buff, addr / SD_HC_BLOCK_SIZE,
+                                        addr % SD_HC_BLOCK_SIZE, size);
+        if (res < 0) {
+            return res;
+        }
+        buff = (const uint8_t *)buff + res;
+        addr += res;
+        size -= res;
     }
-    return -EOVERFLOW;
+    return 0;
 }
 
 const mtd_desc_t mtd_sdcard_driver = {
@@ -220,6 +244,7 @@ const mtd_desc_t mtd_sdcard_driver = {
     .write_page = mtd_sdcard_write_page,
     .erase_sector = mtd_sdcard_erase_sector,
     .power = mtd_sdcard_power,
+    .flags = MTD_DRIVER_FLAG_DIRECT_WRITE,
 };
 
 #if IS_USED(MODULE_MTD_SDCARD_DEFAULT)
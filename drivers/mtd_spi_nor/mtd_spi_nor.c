@@ -32,7 +32,11 @@
 #include "mtd_spi_nor.h"
 #include "thread.h"
 
-#if IS_USED(MODULE_ZTIMER_USEC)
+#if IS_USED(MODULE_MTD_ASYNC)
+#include "mtd_async.h"
+#endif
+
+#if IS_USED(MODULE_ZTIMER_USEC) || IS_USED(MODULE_MTD_ASYNC)
 #include "ztimer.h"
 #elif IS_USED(MODULE_XTIMER)
 #include "xtimer.h"
@@ -54,6 +58,8 @@
 
 #define SFLASH_CMD_ULBPR       (0x98)   /**< Global Block Protection Unlock */
 
+#define SFLASH_STATUS_WIP      (0x01)   /**< Write In Progress bit of the status register */
+
 #define MTD_64K             (65536ul)
 #define MTD_64K_ADDR_MASK   (0xFFFF)
 #define MTD_32K             (32768ul)
@@ -106,14 +112,16 @@ static inline uint8_t* _be_addr(const mtd_spi_nor_t *dev, uint32_t *addr)
  * @param[in]  dev    pointer to device descriptor
  * @param[in]  opcode command opcode
  * @param[in]  addr   address (big endian)
+ * @param[in]  dummy  number of dummy bytes between address and data
  * @param[out] dest   read buffer
  * @param[in]  count  number of bytes to read after the address has been sent
  */
 static void mtd_spi_cmd_addr_read(const mtd_spi_nor_t *dev, uint8_t opcode,
-                                  uint32_t addr, void *dest, uint32_t count)
+                                  uint32_t addr, uint8_t dummy,
+                                  void *dest, uint32_t count)
 {
-    TRACE("mtd_spi_cmd_addr_read: %p, %02x, (%06"PRIx32"), %p, %" PRIu32 "\n",
-          (void *)dev, (unsigned int)opcode, addr, dest, count);
+    TRACE("mtd_spi_cmd_addr_read: %p, %02x, (%06"PRIx32"), %u, %p, %" PRIu32 "\n",
+          (void *)dev, (unsigned int)opcode, addr, dummy, dest, count);
 
     uint8_t *addr_buf = _be_addr(dev, &addr);
 
@@ -130,6 +138,11 @@ static void mtd_spi_cmd_addr_read(const mtd_spi_nor_t *dev, uint8_t opcode,
     spi_transfer_bytes(_get_spi(dev), dev->params->cs, true,
                        (char *)addr_buf, NULL, dev->addr_width);
 
+    /* Skip dummy cycles, spi_transfer_bytes() needs either out or in */
+    while (dummy--) {
+        spi_transfer_byte(_get_spi(dev), dev->params->cs, true, 0);
+    }
+
     /* Read data */
     spi_transfer_bytes(_get_spi(dev), dev->params->cs, false,
                        NULL, dest, count);
@@ -228,7 +241,7 @@ static void mtd_spi_cmd(const mtd_spi_nor_t *dev, uint8_t opcode)
 
 static bool mtd_spi_manuf_match(const mtd_jedec_id_t *id, jedec_manuf_t manuf)
 {
-    return manuf == ((id->bank << 8) | id->manuf);
+    return manuf == (jedec_manuf_t)((id->bank << 8) | id->manuf);
 }
 
 /**
@@ -356,7 +369,7 @@ static inline void wait_for_write_complete(const mtd_spi_nor_t *dev, uint32_t us
         mtd_spi_cmd_read(dev, dev->params->opcode->rdsr, &status, sizeof(status));
 
         TRACE("mtd_spi_nor: wait device status = 0x%02x\n", (unsigned int)status);
-        if ((status & 1) == 0) { /* TODO magic number */
+        if ((status & SFLASH_STATUS_WIP) == 0) {
             break;
         }
         i++;
@@ -410,6 +423,77 @@ static inline void wait_for_write_complete(const mtd_spi_nor_t *dev, uint32_t us
     DEBUG("\n");
 }
 
+/* acquires the device, after an asynchronous erase completed */
+static void _acquire_idle(const mtd_spi_nor_t *dev)
+{
+    mtd_spi_acquire(dev);
+    if (IS_USED(MODULE_MTD_ASYNC)) {
+        wait_for_write_complete(dev, 0);
+    }
+}
+
+#if IS_USED(MODULE_MTD_ASYNC)
+static bool _is_busy(const mtd_spi_nor_t *dev)
+{
+    uint8_t status;
+
+    mtd_spi_cmd_read(dev, dev->params->opcode->rdsr, &status, sizeof(status));
+    return status & SFLASH_STATUS_WIP;
+}
+#endif
+
+/* acquires the device for reading, suspending an asynchronous erase if the
+ * device supports it, returns true if the erase must be resumed */
+static bool _acquire_read(mtd_spi_nor_t *dev, uint32_t addr, uint32_t size)
+{
+#if IS_USED(MODULE_MTD_ASYNC)
+    while (dev->params->flag & SPI_NOR_F_SUSPEND) {
+        mtd_spi_acquire(dev);
+        if (!_is_busy(dev)) {
+            return false;
+        }
+        /* the block being erased can not be read before the erase completed */
+        if ((addr < dev->erase_addr + dev->erase_size) &&
+            (dev->erase_addr < addr + size)) {
+            DEBUG("mtd_spi_nor: read of erased block\n");
+            wait_for_write_complete(dev, 0);
+            return false;
+        }
+        uint32_t since = ztimer_now(ZTIMER_MSEC) - dev->erase_resumed;
+        if (since >= CONFIG_MTD_SPI_NOR_SUSPEND_INTERVAL_MS) {
+            DEBUG("mtd_spi_nor: suspend erase\n");
+            mtd_spi_cmd(dev, dev->params->opcode->suspend);
+            /* the device stops being busy within the suspend latency */
+            wait_for_write_complete(dev, 0);
+            return true;
+        }
+        /* let the erase progress before it is suspended again */
+        mtd_spi_release(dev);
+        ztimer_sleep(ZTIMER_MSEC, CONFIG_MTD_SPI_NOR_SUSPEND_INTERVAL_MS - since);
+    }
+#else
+    (void)addr;
+    (void)size;
+#endif
+
+    _acquire_idle(dev);
+    return false;
+}
+
+static void _release_read(mtd_spi_nor_t *dev, bool suspended)
+{
+#if IS_USED(MODULE_MTD_ASYNC)
+    if (suspended) {
+        DEBUG("mtd_spi_nor: resume erase\n");
+        mtd_spi_cmd(dev, dev->params->opcode->resume);
+        dev->erase_resumed = ztimer_now(ZTIMER_MSEC);
+    }
+#else
+    (void)suspended;
+#endif
+    mtd_spi_release(dev);
+}
+
 static void _init_pins(mtd_spi_nor_t *dev)
 {
     DEBUG("mtd_spi_nor_init: init pins\n");
@@ -592,7 +676,7 @@ static int mtd_spi_nor_read(mtd_dev_t *mtd, void *dest, uint32_t addr, uint32_t
 {
     DEBUG("mtd_spi_nor_read: %p, %p, 0x%" PRIx32 ", 0x%" PRIx32 "\n",
           (void *)mtd, dest, addr, size);
-    const mtd_spi_nor_t *dev = (mtd_spi_nor_t *)mtd;
+    mtd_spi_nor_t *dev = (mtd_spi_nor_t *)mtd;
     uint32_t chipsize = mtd->page_size * mtd->pages_per_sector * mtd->sector_count;
 
     if (addr > chipsize) {
@@ -605,9 +689,14 @@ static int mtd_spi_nor_read(mtd_dev_t *mtd, void *dest, uint32_t addr, uint32_t
         return 0;
     }
 
-    mtd_spi_acquire(dev);
-    mtd_spi_cmd_addr_read(dev, dev->params->opcode->read, addr, dest, size);
-    mtd_spi_release(dev);
+    bool suspended = _acquire_read(dev, addr, size);
+    if (dev->params->flag & SPI_NOR_F_FAST_READ) {
+        mtd_spi_cmd_addr_read(dev, dev->params->opcode->read_fast, addr, 1, dest, size);
+    }
+    else {
+        mtd_spi_cmd_addr_read(dev, dev->params->opcode->read, addr, 0, dest, size);
+    }
+    _release_read(dev, suspended);
 
     return 0;
 }
@@ -635,7 +724,7 @@ static int mtd_spi_nor_write(mtd_dev_t *mtd, const void *src, uint32_t addr, uin
         return -EOVERFLOW;
     }
 
-    mtd_spi_acquire(dev);
+    _acquire_idle(dev);
 
     /* write enable */
     mtd_spi_cmd(dev, dev->params->opcode->wren);
@@ -664,7 +753,7 @@ static int mtd_spi_nor_write_page(mtd_dev_t *mtd, const void *src, uint32_t page
 
     uint32_t addr = page * mtd->page_size + offset;
 
-    mtd_spi_acquire(dev);
+    _acquire_idle(dev);
 
     /* write enable */
     mtd_spi_cmd(dev, dev->params->opcode->wren);
@@ -680,11 +769,9 @@ static int mtd_spi_nor_write_page(mtd_dev_t *mtd, const void *src, uint32_t page
     return size;
 }
 
-static int mtd_spi_nor_erase(mtd_dev_t *mtd, uint32_t addr, uint32_t size)
+static int _erase_check(const mtd_dev_t *mtd, uint32_t addr, uint32_t size)
 {
-    DEBUG("mtd_spi_nor_erase: %p, 0x%" PRIx32 ", 0x%" PRIx32 "\n",
-          (void *)mtd, addr, size);
-    mtd_spi_nor_t *dev = (mtd_spi_nor_t *)mtd;
+    const mtd_spi_nor_t *dev = (mtd_spi_nor_t *)mtd;
     uint32_t sector_size = mtd->page_size * mtd->pages_per_sector;
     uint32_t total_size = sector_size * mtd->sector_count;
 
@@ -703,45 +790,82 @@ static int mtd_spi_nor_erase(mtd_dev_t *mtd, uint32_t addr, uint32_t size)
     if (size % sector_size != 0) {
         return -EOVERFLOW;
     }
+    return 0;
+}
 
-    mtd_spi_acquire(dev);
+/**
+ * @brief   Starts erasing the largest erase block at @p addr that fits into
+ *          @p size
+ *
+ * @param[in]       dev     Device, acquired
+ * @param[in,out]   addr    Address to erase at, advanced past the block
+ * @param[in,out]   size    Bytes to erase, reduced by the block
+ * @param[out]      us      Expected time to erase the block
+ *
+ * @return  0 on success
+ * @return  -EINVAL if no erase block fits
+ */
+static int _erase_start(const mtd_spi_nor_t *dev, uint32_t *addr,
+                        uint32_t *size, uint32_t *us)
+{
+    const mtd_dev_t *mtd = &dev->base;
+    uint32_t total_size = mtd->page_size * mtd->pages_per_sector * mtd->sector_count;
+
+    /* write enable */
+    mtd_spi_cmd(dev, dev->params->opcode->wren);
+
+    if (*size == total_size) {
+        mtd_spi_cmd(dev, dev->params->opcode->chip_erase);
+        *size -= total_size;
+        *us = dev->params->wait_chip_erase;
+    }
+    else if ((dev->params->flag & SPI_NOR_F_SECT_64K) && (*size >= MTD_64K) &&
+             ((*addr & MTD_64K_ADDR_MASK) == 0)) {
+        /* 64 KiB blocks can be erased with block erase command */
+        mtd_spi_cmd_addr_write(dev, dev->params->opcode->block_erase_64k, *addr, NULL, 0);
+        *addr += MTD_64K;
+        *size -= MTD_64K;
+        *us = dev->params->wait_64k_erase;
+    }
+    else if ((dev->params->flag & SPI_NOR_F_SECT_32K) && (*size >= MTD_32K) &&
+             ((*addr & MTD_32K_ADDR_MASK) == 0)) {
+        /* 32 KiB blocks can be erased with block erase command */
+        mtd_spi_cmd_addr_write(dev, dev->params->opcode->block_erase_32k, *addr, NULL, 0);
+        *addr += MTD_32K;
+        *size -= MTD_32K;
+        *us = dev->params->wait_32k_erase;
+    }
+    else if ((dev->params->flag & SPI_NOR_F_SECT_4K) && (*size >= MTD_4K) &&
+             ((*addr & MTD_4K_ADDR_MASK) == 0)) {
+        /* 4 KiB sectors can be erased with sector erase command */
+        mtd_spi_cmd_addr_write(dev, dev->params->opcode->sector_erase, *addr, NULL, 0);
+        *addr += MTD_4K;
+        *size -= MTD_4K;
+        *us = dev->params->wait_sector_erase;
+    }
+    else {
+        /* no suitable erase block found */
+        return -EINVAL;
+    }
+    return 0;
+}
+
+static int mtd_spi_nor_erase(mtd_dev_t *mtd, uint32_t addr, uint32_t size)
+{
+    DEBUG("mtd_spi_nor_erase: %p, 0x%" PRIx32 ", 0x%" PRIx32 "\n",
+          (void *)mtd, addr, size);
+    mtd_spi_nor_t *dev = (mtd_spi_nor_t *)mtd;
+
+    int res = _erase_check(mtd, addr, size);
+    if (res < 0) {
+        return res;
+    }
+
+    _acquire_idle(dev);
     while (size) {
         uint32_t us;
 
-        /* write enable */
-        mtd_spi_cmd(dev, dev->params->opcode->wren);
-
-        if (size == total_size) {
-            mtd_spi_cmd(dev, dev->params->opcode->chip_erase);
-            size -= total_size;
-            us = dev->params->wait_chip_erase;
-        }
-        else if ((dev->params->flag & SPI_NOR_F_SECT_64K) && (size >= MTD_64K) &&
-                 ((addr & MTD_64K_ADDR_MASK) == 0)) {
-            /* 64 KiB blocks can be erased with block erase command */
-            mtd_spi_cmd_addr_write(dev, dev->params->opcode->block_erase_64k, addr, NULL, 0);
-            addr += MTD_64K;
-            size -= MTD_64K;
-            us = dev->params->wait_64k_erase;
-        }
-        else if ((dev->params->flag & SPI_NOR_F_SECT_32K) && (size >= MTD_32K) &&
-                 ((addr & MTD_32K_ADDR_MASK) == 0)) {
-            /* 32 KiB blocks can be erased with block erase command */
-            mtd_spi_cmd_addr_write(dev, dev->params->opcode->block_erase_32k, addr, NULL, 0);
-            addr += MTD_32K;
-            size -= MTD_32K;
-            us = dev->params->wait_32k_erase;
-        }
-        else if ((dev->params->flag & SPI_NOR_F_SECT_4K) && (size >= MTD_4K) &&
-                 ((addr & MTD_4K_ADDR_MASK) == 0)) {
-            /* 4 KiB sectors can be erased with sector erase command */
-            mtd_spi_cmd_addr_write(dev, dev->params->opcode->sector_erase, addr, NULL, 0);
-            addr += MTD_4K;
-            size -= MTD_4K;
-            us = dev->params->wait_sector_erase;
-        }
-        else {
-            /* no suitable erase block found */
+        if (_erase_start(dev, &addr, &size, &us) < 0) {
             assert(0);
 
             mtd_spi_release(dev);
@@ -756,6 +880,60 @@ static int mtd_spi_nor_erase(mtd_dev_t *mtd, uint32_t addr, uint32_t size)
     return 0;
 }
 
+#if IS_USED(MODULE_MTD_ASYNC)
+static int mtd_spi_nor_async_step(mtd_dev_t *mtd, mtd_async_req_t *req)
+{
+    mtd_spi_nor_t *dev = (mtd_spi_nor_t *)mtd;
+    uint32_t sector_size = mtd->page_size * mtd->pages_per_sector;
+    uint32_t addr = req->page * sector_size;
+    uint32_t size = req->size * sector_size;
+    uint32_t us;
+
+    /* only erasing takes long enough to be worth it */
+    if (req->op != MTD_ASYNC_ERASE) {
+        return -ENOTSUP;
+    }
+    if (size == 0) {
+        return 0;
+    }
+
+    int res = _erase_check(mtd, addr, size);
+    if (res < 0) {
+        return res;
+    }
+
+    _acquire_idle(dev);
+    uint32_t start = addr;
+    uint32_t remaining = size;
+    res = _erase_start(dev, &addr, &size, &us);
+    if (res == 0) {
+        /* reads of the block must wait, other reads may suspend the erase */
+        dev->erase_addr = start;
+        dev->erase_size = remaining - size;
+        dev->erase_resumed = ztimer_now(ZTIMER_MSEC);
+    }
+    mtd_spi_release(dev);
+    if (res < 0) {
+        return res;
+    }
+
+    req->page = addr / sector_size;
+    req->size = size / sector_size;
+    return us ? (int)us : 1;
+}
+
+static int mtd_spi_nor_async_busy(mtd_dev_t *mtd)
+{
+    mtd_spi_nor_t *dev = (mtd_spi_nor_t *)mtd;
+
+    mtd_spi_acquire(dev);
+    bool busy = _is_busy(dev);
+    mtd_spi_release(dev);
+
+    return busy;
+}
+#endif
+
 const mtd_desc_t mtd_spi_nor_driver = {
     .init = mtd_spi_nor_init,
     .read = mtd_spi_nor_read,
@@ -763,4 +941,8 @@ const mtd_desc_t mtd_spi_nor_driver = {
     .write_page = mtd_spi_nor_write_page,
     .erase = mtd_spi_nor_erase,
     .power = mtd_spi_nor_power,
+#if IS_USED(MODULE_MTD_ASYNC)
+    .async_step = mtd_spi_nor_async_step,
+    .async_busy = mtd_spi_nor_async_busy,
+#endif
 };
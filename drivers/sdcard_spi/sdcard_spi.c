@@ -67,8 +67,10 @@ static inline void _sw_spi_rxtx_byte(sdcard_spi_t *card, uint8_t out, uint8_t *i
 /* wrapper for default spi_transfer_byte function */
 static inline void _hw_spi_rxtx_byte(sdcard_spi_t *card, uint8_t out, uint8_t *in);
 
-/* function pointer to switch to hw spi mode after init sequence */
-static void (*_dyn_spi_rxtx_byte)(sdcard_spi_t *card, uint8_t out, uint8_t *in);
+/* function pointer to switch to hw spi mode after init sequence, hw spi is
+   used by default for cards that were initialized before */
+static void (*_dyn_spi_rxtx_byte)(sdcard_spi_t *card, uint8_t out, uint8_t *in) =
+    &_hw_spi_rxtx_byte;
 
 static inline uint32_t _deadline_from_interval(uint32_t interval)
 {
@@ -583,6 +585,19 @@ static inline uint16_t _transfer_bytes(sdcard_spi_t *card, const uint8_t *out,
     unsigned trans_bytes = 0;
     uint8_t in_temp;
 
+    /* hw spi transfers whole buffers at once, so that the driver can use DMA */
+    if (_dyn_spi_rxtx_byte == &_hw_spi_rxtx_byte && (out != NULL || in != NULL)) {
+        if (out == NULL) {
+            /* the card expects dummy bytes while it sends data, they are
+               sent from the receive buffer */
+            memset(in, SD_CARD_DUMMY_BYTE, length);
+            out = in;
+        }
+        spi_transfer_bytes(card->params.spi_dev, SPI_CS_UNDEF, true,
+                           out, in, length);
+        return length;
+    }
+
     for (trans_bytes = 0; trans_bytes < length; trans_bytes++) {
         if (out != NULL) {
             _dyn_spi_rxtx_byte(card, out[trans_bytes], &in_temp);
@@ -770,6 +785,16 @@ static uint16_t _write_blocks(sdcard_spi_t *card, uint8_t cmd_idx,
     _select_card_spi(card);
     uint16_t written = 0;
 
+    /* let the card pre-erase the blocks of a multi-block write, this is only a
+       hint and not supported by MMC cards, so failing is not an error */
+    if (cmd_idx == SD_CMD_25 && card->card_type != MMC_V3) {
+        uint8_t acmd23_r1 = sdcard_spi_send_acmd(card, SD_CMD_23, nbl,
+                                                 SD_BLOCK_WRITE_CMD_RETRY_US);
+        if (!R1_VALID(acmd23_r1) || R1_ERROR(acmd23_r1)) {
+            DEBUG("_write_blocks: send ACMD23: [ERROR]\n");
+        }
+    }
+
     uint32_t addr = card->use_block_addr ? bladdr : (bladdr * SD_HC_BLOCK_SIZE);
     uint8_t cmd_r1_resu = sdcard_spi_send_cmd(card, cmd_idx, addr, SD_BLOCK_WRITE_CMD_RETRY_US);
 
@@ -812,7 +837,6 @@ static uint16_t _write_blocks(sdcard_spi_t *card, uint8_t cmd_idx,
                state */
             _send_dummy_byte(card);
             if (!_wait_for_not_busy(card, SD_WAIT_FOR_NOT_BUSY_US)) {
-                _unselect_card_spi(card);
                 *state = SD_RW_TIMEOUT;
             }
         }
@@ -198,7 +198,7 @@ int gcoap_cli_cmd(int argc, char **argv)
     }
 
     if (strcmp(argv[1], "info") == 0) {
-        uint8_t open_reqs = gcoap_op_state();
+        unsigned open_reqs = gcoap_op_state();
 
         if (IS_USED(MODULE_GCOAP_DTLS)) {
             printf("CoAP server is listening on port %u\n", CONFIG_GCOAPS_PORT);
@@ -143,7 +143,7 @@ int gcoap_cli_cmd(int argc, char **argv)
     }
 
     if (strcmp(argv[1], "info") == 0) {
-        uint8_t open_reqs = gcoap_op_state();
+        unsigned open_reqs = gcoap_op_state();
 
         printf("CoAP server is listening on port %u\n", CONFIG_GCOAP_PORT);
         printf("CoAP open requests: %u\n", open_reqs);
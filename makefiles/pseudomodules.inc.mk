@@ -59,6 +59,7 @@ PSEUDOMODULES += dhcpv6_relay
 PSEUDOMODULES += dns_cache
 PSEUDOMODULES += dns_msg
 PSEUDOMODULES += ecc_%
+PSEUDOMODULES += emcute_pubq
 PSEUDOMODULES += ethos_stdio
 PSEUDOMODULES += event_%
 ## @defgroup sys_event_thread_lowest event_thread_lowest
@@ -78,6 +79,7 @@ PSEUDOMODULES += gcoap_forward_proxy
 PSEUDOMODULES += gcoap_fileserver
 PSEUDOMODULES += gcoap_fileserver_callback
 PSEUDOMODULES += gcoap_fileserver_delete
+PSEUDOMODULES += gcoap_fileserver_file_cache
 PSEUDOMODULES += gcoap_fileserver_put
 PSEUDOMODULES += gcoap_dtls
 ## @addtogroup net_gcoap_dns
@@ -411,8 +413,10 @@ PSEUDOMODULES += sema_deprecated
 ## @}
 PSEUDOMODULES += semtech_loramac_rx
 PSEUDOMODULES += senml_cbor
+PSEUDOMODULES += senml_json
 PSEUDOMODULES += senml_phydat
 PSEUDOMODULES += senml_saul
+PSEUDOMODULES += senml_stream
 ## @defgroup drivers_servo_pwm PWM based servo driver
 ## @ingroup drivers_servo
 ## @{
@@ -569,6 +573,23 @@ PSEUDOMODULES += vfs_auto_mount
 ## backends.
 PSEUDOMODULES += vfs_default
 
+## @defgroup pseudomodule_vfs_lookup_cache vfs_lookup_cache
+## @brief Cache the results of looking up paths in the VFS
+##
+## When this module is active, the results of vfs_stat() and of vfs_open()
+## failing with -ENOENT are cached for file systems that set
+## @ref VFS_FS_FLAG_LOOKUP_CACHE, until a file on the same mount is modified.
+## See @ref CONFIG_VFS_LOOKUP_CACHE_NUMOF.
+PSEUDOMODULES += vfs_lookup_cache
+
+## @defgroup pseudomodule_vfs_readahead vfs_readahead
+## @brief Read files ahead when they are read sequentially
+##
+## When this module is active, small consecutive vfs_read() calls on files of
+## file systems that set @ref VFS_FS_FLAG_READAHEAD are served from a buffer
+## that is filled by larger reads. See @ref CONFIG_VFS_READAHEAD_SIZE.
+PSEUDOMODULES += vfs_readahead
+
 PSEUDOMODULES += wakaama_objects_%
 PSEUDOMODULES += wifi_enterprise
 PSEUDOMODULES += xtimer_on_ztimer
@@ -135,11 +135,15 @@ DRESULT disk_write(BYTE pdrv, const BYTE *buff, DWORD sector, UINT count)
         return RES_PARERR;
     }
 
-    /* erase memory before writing to it */
-    int res = mtd_erase_sector(fatfs_mtd_devs[pdrv], sector, count);
+    int res;
 
-    if (res != 0) {
-        return RES_ERROR; /* erase failed! */
+    /* erase memory before writing to it, unless it can be overwritten */
+    if (!(fatfs_mtd_devs[pdrv]->driver->flags & MTD_DRIVER_FLAG_DIRECT_WRITE)) {
+        res = mtd_erase_sector(fatfs_mtd_devs[pdrv], sector, count);
+
+        if (res != 0) {
+            return RES_ERROR; /* erase failed! */
+        }
     }
 
     uint32_t sector_size = fatfs_mtd_devs[pdrv]->page_size
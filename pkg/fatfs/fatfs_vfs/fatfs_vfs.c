@@ -340,6 +340,49 @@ static ssize_t _read(vfs_file_t *filp, void *dest, size_t nbytes)
     return (ssize_t)br;
 }
 
+static ssize_t _prw(vfs_file_t *filp, const iolist_t *iolist, off_t off,
+                    bool write)
+{
+    fatfs_file_desc_t *fd = _get_fatfs_file_desc(filp);
+    FSIZE_t pos = f_tell(&fd->file);
+    ssize_t sum = 0;
+
+    FRESULT res = f_lseek(&fd->file, off);
+
+    for (; (res == FR_OK) && iolist; iolist = iolist->iol_next) {
+        UINT n;
+
+        res = write
+            ? f_write(&fd->file, iolist->iol_base, iolist->iol_len, &n)
+            : f_read(&fd->file, iolist->iol_base, iolist->iol_len, &n);
+        sum += n;
+        if (n < iolist->iol_len) {
+            break;
+        }
+    }
+
+    FRESULT seek = f_lseek(&fd->file, pos);
+
+    if (res != FR_OK) {
+        return fatfs_err_to_errno(res);
+    }
+    if (seek != FR_OK) {
+        return fatfs_err_to_errno(seek);
+    }
+
+    return sum;
+}
+
+static ssize_t _preadv(vfs_file_t *filp, const iolist_t *iolist, off_t off)
+{
+    return _prw(filp, iolist, off, false);
+}
+
+static ssize_t _pwritev(vfs_file_t *filp, const iolist_t *iolist, off_t off)
+{
+    return _prw(filp, iolist, off, true);
+}
+
 static off_t _lseek(vfs_file_t *filp, off_t off, int whence)
 {
     fatfs_file_desc_t *fd = _get_fatfs_file_desc(filp);
@@ -575,6 +618,8 @@ static const vfs_file_ops_t fatfs_file_ops = {
     .read = _read,
     .write = _write,
     .lseek = _lseek,
+    .preadv = _preadv,
+    .pwritev = _pwritev,
     .fstat = _fstat,
     .fsync = _fsync,
 };
@@ -589,4 +634,5 @@ const vfs_file_system_t fatfs_file_system = {
     .fs_op = &fatfs_fs_ops,
     .f_op = &fatfs_file_ops,
     .d_op = &fatfs_dir_ops,
+    .flags = VFS_FS_FLAG_READAHEAD,
 };
@@ -560,4 +560,5 @@ const vfs_file_system_t littlefs_file_system = {
     .fs_op = &littlefs_fs_ops,
     .f_op = &littlefs_file_ops,
     .d_op = &littlefs_dir_ops,
+    .flags = VFS_FS_FLAG_LOOKUP_CACHE | VFS_FS_FLAG_READAHEAD,
 };
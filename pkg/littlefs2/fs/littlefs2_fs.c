@@ -395,6 +395,64 @@ static off_t _lseek(vfs_file_t *filp, off_t off, int whence)
     return littlefs_err_to_errno(ret);
 }
 
+static ssize_t _prw(vfs_file_t *filp, const iolist_t *iolist, off_t off,
+                    bool write)
+{
+    littlefs2_desc_t *fs = filp->mp->private_data;
+    lfs_file_t *fp = _get_lfs_file(filp);
+
+    mutex_lock(&fs->lock);
+
+    DEBUG("littlefs: %s: filp=%p, fp=%p, iolist=%p, off=%ld\n",
+          write ? "pwritev" : "preadv", (void *)filp, (void *)fp,
+          (void *)iolist, (long)off);
+
+    lfs_soff_t pos = lfs_file_tell(&fs->fs, fp);
+    if (pos < 0) {
+        mutex_unlock(&fs->lock);
+        return littlefs_err_to_errno(pos);
+    }
+
+    lfs_ssize_t ret = lfs_file_seek(&fs->fs, fp, off, LFS_SEEK_SET);
+    ssize_t sum = 0;
+
+    for (; (ret >= 0) && iolist; iolist = iolist->iol_next) {
+        ret = write
+            ? lfs_file_write(&fs->fs, fp, iolist->iol_base, iolist->iol_len)
+            : lfs_file_read(&fs->fs, fp, iolist->iol_base, iolist->iol_len);
+        if (ret >= 0) {
+            sum += ret;
+            if ((size_t)ret < iolist->iol_len) {
+                break;
+            }
+        }
+    }
+
+    /* the file position must not change, or the next read or write would
+     * happen elsewhere */
+    lfs_soff_t res = lfs_file_seek(&fs->fs, fp, pos, LFS_SEEK_SET);
+    mutex_unlock(&fs->lock);
+
+    if (res < 0) {
+        return littlefs_err_to_errno(res);
+    }
+    /* as preadv() and pwritev(), report the bytes transferred before an error */
+    if ((ret < 0) && (sum == 0)) {
+        return littlefs_err_to_errno(ret);
+    }
+    return sum;
+}
+
+static ssize_t _preadv(vfs_file_t *filp, const iolist_t *iolist, off_t off)
+{
+    return _prw(filp, iolist, off, false);
+}
+
+static ssize_t _pwritev(vfs_file_t *filp, const iolist_t *iolist, off_t off)
+{
+    return _prw(filp, iolist, off, true);
+}
+
 static int _fsync(vfs_file_t *filp)
 {
     littlefs2_desc_t *fs = filp->mp->private_data;
@@ -552,6 +610,8 @@ static const vfs_file_ops_t littlefs_file_ops = {
     .read = _read,
     .write = _write,
     .lseek = _lseek,
+    .preadv = _preadv,
+    .pwritev = _pwritev,
     .fsync = _fsync,
 };
 
@@ -565,4 +625,5 @@ const vfs_file_system_t littlefs2_file_system = {
     .fs_op = &littlefs_fs_ops,
     .f_op = &littlefs_file_ops,
     .d_op = &littlefs_dir_ops,
+    .flags = VFS_FS_FLAG_LOOKUP_CACHE | VFS_FS_FLAG_READAHEAD,
 };
@@ -515,5 +515,5 @@ const vfs_file_system_t lwext4_file_system = {
     .fs_op = &lwext4_fs_ops,
     .f_op = &lwext4_file_ops,
     .d_op = &lwext4_dir_ops,
-    .flags = VFS_FS_FLAG_WANT_ABS_PATH,
+    .flags = VFS_FS_FLAG_WANT_ABS_PATH | VFS_FS_FLAG_READAHEAD,
 };
@@ -531,4 +531,5 @@ const vfs_file_system_t spiffs_file_system = {
     .fs_op = &spiffs_fs_ops,
     .f_op = &spiffs_file_ops,
     .d_op = &spiffs_dir_ops,
+    .flags = VFS_FS_FLAG_LOOKUP_CACHE | VFS_FS_FLAG_READAHEAD,
 };
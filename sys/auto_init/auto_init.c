@@ -253,6 +253,11 @@ extern void saul_init_devs(void);
 AUTO_INIT(saul_init_devs,
           AUTO_INIT_PRIO_MOD_SAUL);
 #endif
+#if IS_USED(MODULE_SAUL_SAMPLER)
+extern void saul_sampler_init(void);
+AUTO_INIT(saul_sampler_init,
+          AUTO_INIT_PRIO_MOD_SAUL_SAMPLER);
+#endif
 #if IS_USED(MODULE_AUTO_INIT_GNRC_RPL)
 extern void auto_init_gnrc_rpl(void);
 AUTO_INIT(auto_init_gnrc_rpl,
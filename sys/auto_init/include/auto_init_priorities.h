@@ -287,6 +287,12 @@ extern "C" {
  */
 #define AUTO_INIT_PRIO_MOD_SAUL                         1400
 #endif
+#ifndef AUTO_INIT_PRIO_MOD_SAUL_SAMPLER
+/**
+ * @brief   SAUL sampling scheduler priority
+ */
+#define AUTO_INIT_PRIO_MOD_SAUL_SAMPLER                 1405
+#endif
 #ifndef AUTO_INIT_PRIO_MOD_GNRC_RPL
 /**
  * @brief   GNRC RPL priority
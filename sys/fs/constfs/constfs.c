@@ -41,6 +41,7 @@ static int constfs_fstat(vfs_file_t *filp, struct stat *buf);
 static off_t constfs_lseek(vfs_file_t *filp, off_t off, int whence);
 static int constfs_open(vfs_file_t *filp, const char *name, int flags, mode_t mode);
 static ssize_t constfs_read(vfs_file_t *filp, void *dest, size_t nbytes);
+static int constfs_mmap(vfs_file_t *filp, off_t off, size_t len, const void **addr);
 
 /* Directory operations */
 static int constfs_opendir(vfs_DIR *dirp, const char *dirname);
@@ -56,6 +57,7 @@ static const vfs_file_ops_t constfs_file_ops = {
     .lseek = constfs_lseek,
     .open  = constfs_open,
     .read  = constfs_read,
+    .mmap  = constfs_mmap,
 };
 
 static const vfs_dir_ops_t constfs_dir_ops = {
@@ -202,6 +204,17 @@ static ssize_t constfs_read(vfs_file_t *filp, void *dest, size_t nbytes)
     return nbytes;
 }
 
+static int constfs_mmap(vfs_file_t *filp, off_t off, size_t len, const void **addr)
+{
+    constfs_file_t *fp = filp->private_data.ptr;
+    DEBUG("constfs_mmap: %p, %ld, %lu\n", (void *)filp, (long)off, (unsigned long)len);
+    if (((size_t)off > fp->size) || (len > fp->size - off)) {
+        return -ENXIO;
+    }
+    *addr = (const uint8_t *)fp->data + off;
+    return 0;
+}
+
 static int constfs_opendir(vfs_DIR *dirp, const char *dirname)
 {
     DEBUG("constfs_opendir: %p, \"%s\"\n", (void *)dirp, dirname);
@@ -15,6 +15,8 @@
  * RIOT VFS layer. The implementation uses an array of @c constfs_file_t objects
  * as its storage back-end.
  *
+ * Files can be used in place, e.g. from flash, with @ref vfs_mmap.
+ *
  * @{
  * @file
  * @brief   ConstFS public API
@@ -36,6 +36,8 @@ extern "C" {
 #define DNS_TYPE_A              (1)
 #define DNS_TYPE_AAAA           (28)
 #define DNS_CLASS_IN            (1)
+#define DNS_RCODE_MASK          (0x000f)    /**< RCODE bits of the header flags */
+#define DNS_RCODE_NAME_ERROR    (3)         /**< RCODE of NXDOMAIN responses */
 /** @} */
 
 /**
@@ -27,6 +27,19 @@
  * If there is communication to many different hosts, the addition of a
  * least-recently used counter could likely improve the behavior.
  *
+ * Entries are chained by the hash of their name, so a lookup only compares
+ * the entries that share a hash bucket instead of every entry.
+ *
+ * Names the DNS server answered with NXDOMAIN are stored as negative entries
+ * (see @ref dns_cache_add_negative()) for @ref CONFIG_DNS_CACHE_NEGATIVE_TTL,
+ * so repeated lookups of a name that does not exist do not cause repeated
+ * queries. A negative entry answers lookups for any address family.
+ *
+ * A resolver can use @ref dns_cache_query_claim() instead of
+ * @ref dns_cache_query() to coalesce concurrent lookups of the same name:
+ * only the first caller gets a miss and sends a query, the others wait until
+ * it calls @ref dns_cache_release() and are then answered from the cache.
+ *
  * @author  Benjamin Valentin <benjamin.valentin@ml-pa.com>
  */
 
@@ -43,6 +56,8 @@ extern "C" {
 
 /**
  * @brief   Maximum number of DNS cache entries
+ *
+ * Must be between 1 and 254.
  */
 #ifndef CONFIG_DNS_CACHE_SIZE
 #define CONFIG_DNS_CACHE_SIZE   4
@@ -62,6 +77,36 @@ extern "C" {
 #define CONFIG_DNS_CACHE_AAAA   IS_USED(MODULE_IPV6)
 #endif
 
+/**
+ * @brief   Lifetime of negative entries in seconds
+ *
+ * Upper bound for how long a name is considered non-existent after the
+ * DNS server answered with NXDOMAIN.
+ */
+#ifndef CONFIG_DNS_CACHE_NEGATIVE_TTL
+#define CONFIG_DNS_CACHE_NEGATIVE_TTL       60
+#endif
+
+/**
+ * @brief   Maximum number of queries in flight tracked for coalescing
+ *
+ * Further lookups that miss the cache are not coalesced.
+ */
+#ifndef CONFIG_DNS_CACHE_PENDING_NUMOF
+#define CONFIG_DNS_CACHE_PENDING_NUMOF      2
+#endif
+
+/**
+ * @brief   DNS cache statistics
+ */
+typedef struct {
+    uint32_t hits;          /**< lookups answered with an address */
+    uint32_t negative_hits; /**< lookups answered by a negative entry */
+    uint32_t misses;        /**< lookups not answered by the cache */
+    uint32_t coalesced;     /**< lookups that waited for a query in flight */
+    uint32_t evictions;     /**< live entries replaced by a new entry */
+} dns_cache_stats_t;
+
 #if IS_USED(MODULE_DNS_CACHE) || DOXYGEN
 /**
  * @brief Get IP address for a DNS name from the DNS cache
@@ -71,10 +116,41 @@ extern "C" {
  * @param[in]   family          Either AF_INET, AF_INET6 or AF_UNSPEC
  *
  * @return      the size of the resolved address on success
- * @return      <= 0 otherwise
+ * @return      -ENOENT if @p domain_name is cached as non-existent
+ * @return      0 if @p domain_name is not in the cache
  */
 int dns_cache_query(const char *domain_name, void *addr_out, int family);
 
+/**
+ * @brief Get IP address for a DNS name from the DNS cache or claim the query
+ *
+ * Like @ref dns_cache_query(), but if another thread claimed the query for
+ * @p domain_name and @p family, this waits until that thread released it and
+ * looks up the cache again.
+ *
+ * On a miss, the query is claimed by the caller, which then must call
+ * @ref dns_cache_release() once it added the result to the cache or failed.
+ *
+ * @param[in]   domain_name     DNS name to resolve into address
+ * @param[out]  addr_out        buffer to write result into
+ * @param[in]   family          Either AF_INET, AF_INET6 or AF_UNSPEC
+ *
+ * @return      the size of the resolved address on success
+ * @return      -ENOENT if @p domain_name is cached as non-existent
+ * @return      0 if the caller has to resolve @p domain_name
+ */
+int dns_cache_query_claim(const char *domain_name, void *addr_out, int family);
+
+/**
+ * @brief Release a query claimed by @ref dns_cache_query_claim()
+ *
+ * Wakes up the threads waiting for the result of the query.
+ *
+ * @param[in]   domain_name     DNS name passed to @ref dns_cache_query_claim()
+ * @param[in]   family          family passed to @ref dns_cache_query_claim()
+ */
+void dns_cache_release(const char *domain_name, int family);
+
 /**
  * @brief Add an IP address for a DNS name to the DNS cache
  *
@@ -84,6 +160,24 @@ int dns_cache_query(const char *domain_name, void *addr_out, int family);
  * @param[in]   ttl             lifetime of the entry in seconds
  */
 void dns_cache_add(const char *domain_name, const void *addr, int addr_len, uint32_t ttl);
+
+/**
+ * @brief Add a DNS name that does not exist to the DNS cache
+ *
+ * Replaces all addresses cached for @p domain_name. A later
+ * @ref dns_cache_add() for @p domain_name replaces the negative entry.
+ *
+ * @param[in]   domain_name     DNS name the DNS server answered NXDOMAIN for
+ * @param[in]   ttl             lifetime of the entry in seconds
+ */
+void dns_cache_add_negative(const char *domain_name, uint32_t ttl);
+
+/**
+ * @brief Get the DNS cache statistics
+ *
+ * @param[out]  stats           the counters since boot
+ */
+void dns_cache_get_stats(dns_cache_stats_t *stats);
 #else
 static inline int dns_cache_query(const char *domain_name, void *addr_out, int family)
 {
@@ -101,6 +195,27 @@ static inline void dns_cache_add(const char *domain_name, const void *addr,
     (void)addr_len;
     (void)ttl;
 }
+
+static inline int dns_cache_query_claim(const char *domain_name, void *addr_out,
+                                        int family)
+{
+    (void)domain_name;
+    (void)addr_out;
+    (void)family;
+    return 0;
+}
+
+static inline void dns_cache_release(const char *domain_name, int family)
+{
+    (void)domain_name;
+    (void)family;
+}
+
+static inline void dns_cache_add_negative(const char *domain_name, uint32_t ttl)
+{
+    (void)domain_name;
+    (void)ttl;
+}
 #endif
 
 #ifdef __cplusplus
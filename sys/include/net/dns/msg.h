@@ -109,6 +109,8 @@ size_t dns_msg_compose_query(void *dns_buf, const char *domain_name,
  * @return  Length of the @p addr_out on success.
  * @return  -EBADMSG, when an address corresponding to @p family can not be found
  *          in @p buf.
+ * @return  -ENOENT, when the server answered that @p domain_name does not
+ *          exist (NXDOMAIN).
  */
 int dns_msg_parse_reply(const uint8_t *buf, size_t len, int family,
                         void *addr_out, uint32_t *ttl);
@@ -60,6 +60,23 @@
  * - sending out periodic PINGREQ messages
  * - handling re-transmits
  *
+ * # Publish Queue
+ * emcute_pub() waits for the PUBACK of a QoS 1 message before it returns, so
+ * a burst of messages is published at one message per round trip. With module
+ * `emcute_pubq`, emcute_pub_queue() copies the message into one of
+ * @ref CONFIG_EMCUTE_PUBQ_WINDOW slots, sends it and returns right away. The
+ * emCute thread matches the PUBACKs to the slots and retransmits messages
+ * that were not acknowledged in time. emcute_pub_flush() waits until all
+ * queued messages were acknowledged and reports the first failure.
+ *
+ * Because the emCute thread only checks for due retransmissions when it
+ * wakes up, it does so at least every @ref CONFIG_EMCUTE_T_RETRY seconds
+ * with this module.
+ *
+ * The module also makes emcute_reg() remember the topic IDs assigned by the
+ * gateway, so registering a topic name again does not cost a round trip until
+ * the next emcute_con().
+ *
  * The following features are however still missing (but planned):
  * @todo        Gateway discovery (so far there is no support for handling
  *              ADVERTISE, GWINFO, and SEARCHGW). Open question to answer here:
@@ -171,6 +188,41 @@ extern "C" {
 #ifndef CONFIG_EMCUTE_N_RETRY
 #define CONFIG_EMCUTE_N_RETRY               (3U)
 #endif
+
+/**
+ * @brief   Number of QoS 1 publish messages in flight (module `emcute_pubq`)
+ *
+ * emcute_pub_queue() blocks while this many publish messages wait for their
+ * PUBACK.
+ */
+#ifndef CONFIG_EMCUTE_PUBQ_WINDOW
+#define CONFIG_EMCUTE_PUBQ_WINDOW           (4U)
+#endif
+
+/**
+ * @brief   Buffer size of each publish message in flight (module `emcute_pubq`)
+ *
+ * Limits the data of a queued publish message to this value minus 9 bytes.
+ */
+#ifndef CONFIG_EMCUTE_PUBQ_BUFSIZE
+#define CONFIG_EMCUTE_PUBQ_BUFSIZE          (64U)
+#endif
+
+/**
+ * @brief   Number of topic IDs remembered by emcute_reg() (module `emcute_pubq`)
+ */
+#ifndef CONFIG_EMCUTE_TOPIC_CACHE_SIZE
+#define CONFIG_EMCUTE_TOPIC_CACHE_SIZE      (4U)
+#endif
+
+/**
+ * @brief   Maximum length of topic names remembered by emcute_reg()
+ *
+ * Topics with longer names are registered with the gateway every time.
+ */
+#ifndef CONFIG_EMCUTE_TOPIC_CACHE_NAMELEN
+#define CONFIG_EMCUTE_TOPIC_CACHE_NAMELEN   (32U)
+#endif
 /** @} */
 
 /**
@@ -302,6 +354,44 @@ int emcute_reg(emcute_topic_t *topic);
 int emcute_pub(emcute_topic_t *topic, const void *buf, size_t len,
                unsigned flags);
 
+/**
+ * @brief   Publish data on the given topic without waiting for the PUBACK
+ *
+ * QoS 1 messages are copied into a free slot of the publish queue and sent.
+ * If all @ref CONFIG_EMCUTE_PUBQ_WINDOW slots are in use, this blocks until
+ * a PUBACK frees one. QoS 0 messages are passed to emcute_pub().
+ *
+ * @note    Only available with module `emcute_pubq`.
+ *
+ * @param[in] topic     topic to send data to, topic **must** be registered
+ *                      (topic.id **must** populated).
+ * @param[in] buf       data to publish
+ * @param[in] len       length of @p buf in bytes
+ * @param[in] flags     flags used for publication, allowed are QoS 0 or 1
+ *                      and retain
+ *
+ * @return  EMCUTE_OK if the message was sent
+ * @return  EMCUTE_NOGW if not connected to a gateway
+ * @return  EMCUTE_OVERFLOW if length of data exceeds
+ *          @ref CONFIG_EMCUTE_PUBQ_BUFSIZE
+ */
+int emcute_pub_queue(emcute_topic_t *topic, const void *buf, size_t len,
+                     unsigned flags);
+
+/**
+ * @brief   Wait until all messages queued by emcute_pub_queue() are
+ *          acknowledged
+ *
+ * @note    Only available with module `emcute_pubq`.
+ *
+ * @return  EMCUTE_OK if all messages queued since the last call were
+ *          accepted by the gateway
+ * @return  EMCUTE_REJECT if a message was rejected
+ * @return  EMCUTE_TIMEOUT if a message was not acknowledged in time
+ * @return  EMCUTE_NOGW if the connection was closed with messages in flight
+ */
+int emcute_pub_flush(void);
+
 /**
  * @brief   Subscribe to the given topic
  *
@@ -191,6 +191,24 @@
  * Finally, call gcoap_obs_send() for the resource, with the sum of the
  * metadata length and payload length for the representation.
  *
+ * ### Notification templates ###
+ *
+ * If the options of the notifications do not change, a notification template
+ * avoids encoding them again for every notification. The template holds the
+ * encoded options. Message ID, token and Observe value are written into it
+ * for each observer when it is sent.
+ *
+ * -# Call gcoap_obs_template_init() with a buffer that lives as long as the
+ *    template.
+ * -# Use the coap_opt_add_xxx() functions to include any Options except
+ *    Observe, which is already included. As for gcoap_obs_init(), options
+ *    with a number lower than Observe cannot be added.
+ * -# Call gcoap_obs_template_finish().
+ *
+ * For each notification, write the payload to
+ * gcoap_obs_template_t::payload and call gcoap_obs_template_send() with its
+ * length.
+ *
  * ### Other considerations ###
  *
  * By default, the value for the Observe option in a notification is three
@@ -464,6 +482,9 @@ extern "C" {
 
 /**
  * @brief   Maximum number of requests awaiting a response
+ *
+ * Responses are matched to requests by a hash index, so this may be raised
+ * to several hundreds for gateways. Must be less than 65535.
  */
 #ifndef CONFIG_GCOAP_REQ_WAITING_MAX
 #define CONFIG_GCOAP_REQ_WAITING_MAX   (2)
@@ -550,6 +571,9 @@ extern "C" {
 /**
  * @ingroup net_gcoap_conf
  * @brief   Maximum number of Observe clients
+ *
+ * Observers are found by a hash index over their endpoint. Must be less
+ * than 65535.
  */
 #ifndef CONFIG_GCOAP_OBS_CLIENTS_MAX
 #define CONFIG_GCOAP_OBS_CLIENTS_MAX   (2)
@@ -558,6 +582,9 @@ extern "C" {
 /**
  * @ingroup net_gcoap_conf
  * @brief   Maximum number of registrations for Observable resources
+ *
+ * Registrations are found by hash indexes over their observer and their
+ * resource. Must be less than 65535.
  */
 #ifndef CONFIG_GCOAP_OBS_REGISTRATIONS_MAX
 #define CONFIG_GCOAP_OBS_REGISTRATIONS_MAX     (2)
@@ -651,6 +678,20 @@ extern "C" {
 #define CONFIG_GCOAP_RESEND_BUFS_MAX      (1)
 #endif
 
+/**
+ * @ingroup net_gcoap_conf
+ * @brief   Count of registered listeners with a hash index over their
+ *          resources
+ *
+ * Only used with module `nanocoap_resource_index`, see
+ * @ref net_nanocoap_resource_index. Each index uses
+ * @ref CONFIG_NANOCOAP_RESOURCE_INDEX_SLOTS slots. The resources of further
+ * listeners are searched linearly.
+ */
+#ifndef CONFIG_GCOAP_RESOURCE_INDEX_NUMOF
+#define CONFIG_GCOAP_RESOURCE_INDEX_NUMOF (2)
+#endif
+
 /**
  * @name Bitwise positional flags for encoding resource links
  * @anchor COAP_LINK_FLAG_
@@ -841,6 +882,22 @@ typedef struct {
     gcoap_socket_t socket;              /**< Transport type to observer */
 } gcoap_observe_memo_t;
 
+/**
+ * @brief   Template for Observe notifications
+ *
+ * Holds the encoded options of the notifications for a resource, see
+ * gcoap_obs_template_init().
+ */
+typedef struct {
+    const coap_resource_t *resource;    /**< Resource of the notifications */
+    uint8_t *buf;                       /**< Buffer with the encoded options,
+                                             preceded by room for header and
+                                             token */
+    uint8_t *observe;                   /**< Value of the Observe option */
+    uint8_t *payload;                   /**< Payload of the notification */
+    size_t payload_max;                 /**< Maximum length of the payload */
+} gcoap_obs_template_t;
+
 /**
  * @brief   Initializes the gcoap thread and device
  *
@@ -1074,6 +1131,55 @@ int gcoap_obs_init(coap_pkt_t *pdu, uint8_t *buf, size_t len,
 size_t gcoap_obs_send(const uint8_t *buf, size_t len,
                       const coap_resource_t *resource);
 
+/**
+ * @brief   Initializes a template for the Observe notifications of a resource
+ *
+ * The Observe option is added with a width of @ref CONFIG_GCOAP_OBS_VALUE_WIDTH
+ * bytes, further options may be added to @p pdu afterwards. Call
+ * gcoap_obs_template_finish() when all options are added.
+ *
+ * @param[out] tmpl     Template to initialize
+ * @param[out] pdu      Used to add options to the template
+ * @param[in] buf       Buffer for the template, must stay valid as long as
+ *                      the template is used
+ * @param[in] len       Length of @p buf
+ * @param[in] resource  Resource for the notifications
+ *
+ * @return  0 on success
+ * @return  -ENOBUFS if @p buf is too small
+ */
+int gcoap_obs_template_init(gcoap_obs_template_t *tmpl, coap_pkt_t *pdu,
+                            uint8_t *buf, size_t len,
+                            const coap_resource_t *resource);
+
+/**
+ * @brief   Completes the options of a notification template
+ *
+ * Sets gcoap_obs_template_t::payload and gcoap_obs_template_t::payload_max.
+ *
+ * @param[in,out] tmpl  Template to complete
+ * @param[in] pdu       Packet passed to gcoap_obs_template_init()
+ *
+ * @return  maximum length of the payload
+ */
+size_t gcoap_obs_template_finish(gcoap_obs_template_t *tmpl, coap_pkt_t *pdu);
+
+/**
+ * @brief   Sends a notification from a template to the observers of its
+ *          resource
+ *
+ * Updates the Observe value of the template and writes message ID and token
+ * of each observer in front of the encoded options before sending it.
+ *
+ * @param[in,out] tmpl      Template completed with gcoap_obs_template_finish()
+ * @param[in] payload_len   Length of the payload written to
+ *                          gcoap_obs_template_t::payload, at most
+ *                          gcoap_obs_template_t::payload_max
+ *
+ * @return  number of observers the notification was sent to
+ */
+unsigned gcoap_obs_template_send(gcoap_obs_template_t *tmpl, size_t payload_len);
+
 /**
  * @brief   Provides important operational statistics
  *
@@ -1081,7 +1187,7 @@ size_t gcoap_obs_send(const uint8_t *buf, size_t len,
  *
  * @return  count of unanswered requests
  */
-uint8_t gcoap_op_state(void);
+unsigned gcoap_op_state(void);
 
 /**
  * @brief   Get the resource list, currently only `CoRE Link Format`
@@ -67,6 +67,22 @@
  *   If you want to support ``PUT`` and `DELETE`, you need to enable the modules
  *   ``gcoap_fileserver_put`` and ``gcoap_fileserver_delete``.
  *
+ * # Open file cache
+ *
+ * Without further configuration, every block of a file download stats, opens,
+ * seeks and closes the file. With the module ``gcoap_fileserver_file_cache``,
+ * up to @ref CONFIG_GCOAP_FILESERVER_FILE_CACHE_NUMOF files are kept open
+ * together with their ETag and file position. Requests for a cached file skip
+ * the lookup of the path, and consecutive blocks skip the seek as well. This
+ * is most useful when many clients download the same file at once, e.g. a
+ * firmware image.
+ *
+ * A cached file is checked for changes with `vfs_stat()` after
+ * @ref CONFIG_GCOAP_FILESERVER_FILE_CACHE_TIMEOUT_MS, and closed when no request
+ * used it for that long. Changes by PUT and DELETE requests to the file server
+ * take effect immediately. Each cached file occupies one of the
+ * @ref VFS_MAX_OPEN_FILES file descriptors.
+ *
  * @{
  *
  * @file
@@ -84,6 +100,21 @@ extern "C" {
 
 #include "net/nanocoap.h"
 
+/**
+ * @brief   Number of files kept open by the `gcoap_fileserver_file_cache` module
+ */
+#ifndef CONFIG_GCOAP_FILESERVER_FILE_CACHE_NUMOF
+#define CONFIG_GCOAP_FILESERVER_FILE_CACHE_NUMOF        (2)
+#endif
+
+/**
+ * @brief   Time in ms after which a cached file is checked for changes, or
+ *          closed if it was not requested
+ */
+#ifndef CONFIG_GCOAP_FILESERVER_FILE_CACHE_TIMEOUT_MS
+#define CONFIG_GCOAP_FILESERVER_FILE_CACHE_TIMEOUT_MS   (5000)
+#endif
+
 /**
  * @brief   Randomly generated Etag, used by a client when a directory should only be
  *          deleted, if it is empty
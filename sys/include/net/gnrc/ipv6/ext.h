@@ -100,6 +100,37 @@ extern "C" {
 #define CONFIG_GNRC_IPV6_EXT_FRAG_RBUF_DO_NOT_OVERRIDE
 #endif
 
+/**
+ * @brief   Maximum number of bytes all IPv6 reassembly buffer entries may
+ *          occupy in the packet buffer together
+ *
+ * @note    Only applicable with [gnrc_ipv6_ext_frag](@ref net_gnrc_ipv6_ext_frag) module
+ *
+ * When a fragment would exceed this budget, the entries that are the furthest
+ * from completion are evicted first. If the datagram of the fragment itself is
+ * the least complete, the fragment is dropped early instead. Set to 0 to
+ * disable the budget.
+ *
+ * The default is half of the default @ref CONFIG_GNRC_PKTBUF_SIZE.
+ */
+#ifndef CONFIG_GNRC_IPV6_EXT_FRAG_RBUF_BUDGET
+#define CONFIG_GNRC_IPV6_EXT_FRAG_RBUF_BUDGET      (3072U)
+#endif
+
+/**
+ * @brief   Maximum number of reassembly buffer entries a single source may
+ *          occupy
+ *
+ * @note    Only applicable with [gnrc_ipv6_ext_frag](@ref net_gnrc_ipv6_ext_frag) module
+ *
+ * When a source exceeds this quota with a new datagram, its own least complete
+ * datagram is evicted, so a single source flooding first fragments can not
+ * push out the datagrams of other sources.
+ */
+#ifndef CONFIG_GNRC_IPV6_EXT_FRAG_RBUF_SRC_QUOTA
+#define CONFIG_GNRC_IPV6_EXT_FRAG_RBUF_SRC_QUOTA   (CONFIG_GNRC_IPV6_EXT_FRAG_RBUF_SIZE)
+#endif
+
 /** @} **/
 
 /**
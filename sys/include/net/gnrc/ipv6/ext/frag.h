@@ -103,6 +103,13 @@ typedef struct {
                              *   no @ref gnrc_sixlowpan_frag_fb_t available */
     unsigned datagrams;     /**< reassembled datagrams */
     unsigned fragments;     /**< total fragments of reassembled fragments */
+    unsigned budget_drops;  /**< fragments dropped early since they would
+                             *   exceed @ref CONFIG_GNRC_IPV6_EXT_FRAG_RBUF_BUDGET */
+    unsigned budget_evicts; /**< reassembly buffer entries evicted to stay within
+                             *   @ref CONFIG_GNRC_IPV6_EXT_FRAG_RBUF_BUDGET */
+    unsigned quota_evicts;  /**< reassembly buffer entries evicted since their
+                             *   source exceeded
+                             *   @ref CONFIG_GNRC_IPV6_EXT_FRAG_RBUF_SRC_QUOTA */
 } gnrc_ipv6_ext_frag_stats_t;
 
 /**
@@ -158,9 +165,13 @@ gnrc_pktsnip_t *gnrc_ipv6_ext_frag_reass(gnrc_pktsnip_t *pkt);
  *
  * @return  A reassembly buffer matching @p id ipv6_hdr_t::src and ipv6_hdr::dst
  *          of @p hdr or first free reassembly buffer. Will never be NULL, as
- *          in the case of the reassembly buffer being full, the entry with the
- *          lowest gnrc_ipv6_ext_frag_rbuf_t::arrival (serial-number-like) is
- *          removed.
+ *          in the case of the reassembly buffer being full, the entry that is
+ *          the furthest from completion is removed. Ties are broken by
+ *          removing the entry with the lowest
+ *          gnrc_ipv6_ext_frag_rbuf_t::arrival (serial-number-like).
+ *          If the source of @p hdr already occupies
+ *          @ref CONFIG_GNRC_IPV6_EXT_FRAG_RBUF_SRC_QUOTA entries, only
+ *          entries of that source are considered for removal.
  */
 gnrc_ipv6_ext_frag_rbuf_t *gnrc_ipv6_ext_frag_rbuf_get(ipv6_hdr_t *ipv6,
                                                        uint32_t id);
@@ -197,6 +208,15 @@ static inline void gnrc_ipv6_ext_frag_rbuf_del(gnrc_ipv6_ext_frag_rbuf_t *rbuf)
  * @ref CONFIG_GNRC_IPV6_EXT_FRAG_RBUF_TIMEOUT_US in the past.
  */
 void gnrc_ipv6_ext_frag_rbuf_gc(void);
+
+/**
+ * @brief   Get the number of packet buffer bytes currently occupied by the
+ *          reassembly buffer
+ *
+ * @return  The number of bytes accounted against
+ *          @ref CONFIG_GNRC_IPV6_EXT_FRAG_RBUF_BUDGET.
+ */
+size_t gnrc_ipv6_ext_frag_rbuf_usage(void);
 /** @} */
 
 /**
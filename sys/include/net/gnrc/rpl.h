@@ -108,16 +108,19 @@
  * ------
  *
  * The GNRC RPL implementation only implements storing mode
- * with OF0 ([RFC6552](https://tools.ietf.org/html/rfc6552)).
+ * with OF0 ([RFC6552](https://tools.ietf.org/html/rfc6552)) and, with the
+ * [@c gnrc_rpl_mrhof](@ref net_gnrc_rpl_mrhof) module, MRHOF based on ETX
+ * ([RFC6719](https://tools.ietf.org/html/rfc6719)) without a metric container.
  * The RPL routing header is parsed by the nodes when the [@c gnrc_rpl_srh](@ref net_gnrc_rpl_srh)
- * module is used, but anything else
- * for non-storing mode is missing.
+ * module is used and a non-storing root can keep the topology reported in DAOs
+ * with the [@c gnrc_rpl_sr_table](@ref net_gnrc_rpl_sr_table) module, but
+ * anything else for non-storing mode is missing.
  * For interoperability with other RPL implementations, open task include:
  *
  * - IPv6 Hop-by-hop RPL option
  *   (see [#7231](https://github.com/RIOT-OS/RIOT/pull/7231#issuecomment-651237343))
- * - Metric based routing ([RFC6551](https://tools.ietf.org/html/rfc6551)
- *   and [RFC6719](https://tools.ietf.org/html/rfc6719))
+ * - Metric based routing with metric containers
+ *   ([RFC6551](https://tools.ietf.org/html/rfc6551))
  *   (see [14448](https://github.com/RIOT-OS/RIOT/pull/14448) and
  *   [#14623](https://github.com/RIOT-OS/RIOT/pull/14623))
  * - Non-Storing mode
@@ -248,12 +251,21 @@ extern "C" {
 /**
  * @brief   Number of implemented Objective Functions
  */
+#ifdef MODULE_GNRC_RPL_MRHOF
+#define GNRC_RPL_IMPLEMENTED_OFS_NUMOF (2)
+#else
 #define GNRC_RPL_IMPLEMENTED_OFS_NUMOF (1)
+#endif
 
 /**
  * @brief   Default Objective Code Point (OF0)
+ *
+ * Set to @ref GNRC_RPL_MRHOF_OCP to let a root advertise MRHOF (requires the
+ * `gnrc_rpl_mrhof` module).
  */
+#ifndef GNRC_RPL_DEFAULT_OCP
 #define GNRC_RPL_DEFAULT_OCP (0)
+#endif
 
 /**
  * @brief   Default Instance ID
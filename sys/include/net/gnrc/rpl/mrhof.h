@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2023 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    net_gnrc_rpl_mrhof Minimum Rank with Hysteresis Objective Function
+ * @ingroup     net_gnrc_rpl
+ * @brief       Implementation of MRHOF using the ETX metric
+ *
+ * The link metric of a parent is the ETX reported by
+ * [netstats_neighbor](@ref net_netstats) for the parent's link-layer
+ * address. No metric container is used, so the path cost is advertised as
+ * rank, as described in RFC 6719, section 3.3.
+ *
+ * @see <a href="https://tools.ietf.org/html/rfc6719">
+ *          RFC 6719
+ *      </a>
+ * @{
+ *
+ * @file
+ * @brief       MRHOF definitions
+ */
+#ifndef NET_GNRC_RPL_MRHOF_H
+#define NET_GNRC_RPL_MRHOF_H
+
+#include "net/gnrc/rpl/structs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Objective Code Point of MRHOF
+ */
+#define GNRC_RPL_MRHOF_OCP                          (0x1)
+
+/**
+ * @brief   Routing metric type of ETX
+ *
+ * @see <a href="https://tools.ietf.org/html/rfc6551#section-6.1">
+ *          RFC 6551, section 6.1
+ *      </a>
+ */
+#define GNRC_RPL_MRHOF_METRIC_ETX                   (7)
+
+/**
+ * @defgroup    net_gnrc_rpl_mrhof_conf MRHOF compile configurations
+ * @ingroup     net_gnrc_rpl_mrhof
+ * @{
+ */
+/**
+ * @brief   Maximum link metric (ETX * 128) for a neighbor to be a parent
+ */
+#ifndef CONFIG_GNRC_RPL_MRHOF_MAX_LINK_METRIC
+#define CONFIG_GNRC_RPL_MRHOF_MAX_LINK_METRIC       (512U)
+#endif
+
+/**
+ * @brief   Maximum path cost for a neighbor to be a parent
+ */
+#ifndef CONFIG_GNRC_RPL_MRHOF_MAX_PATH_COST
+#define CONFIG_GNRC_RPL_MRHOF_MAX_PATH_COST         (32768U)
+#endif
+
+/**
+ * @brief   Path cost difference below which the preferred parent is kept
+ */
+#ifndef CONFIG_GNRC_RPL_MRHOF_PARENT_SWITCH_THRESHOLD
+#define CONFIG_GNRC_RPL_MRHOF_PARENT_SWITCH_THRESHOLD   (192U)
+#endif
+/** @} */
+
+/**
+ * @brief   Return the address to the MRHOF objective function
+ *
+ * @return  Address of the MRHOF objective function
+ */
+gnrc_rpl_of_t *gnrc_rpl_get_of_mrhof(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NET_GNRC_RPL_MRHOF_H */
+/** @} */
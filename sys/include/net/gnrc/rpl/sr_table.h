@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2023 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    net_gnrc_rpl_sr_table Source routing table of a non-storing root
+ * @ingroup     net_gnrc_rpl
+ * @brief       Parent-pointer tree of the DODAG learned from non-storing DAOs
+ *
+ * In non-storing mode every node reports its DAO parent to the root via the
+ * Transit Information option. This module keeps these reports as a compact
+ * tree: each entry holds a target address and the index of the entry of its
+ * parent. Entries are found via a hash table over the target address, so the
+ * hop list for a source routing header can be computed in O(depth) by
+ * following the parent indexes towards the root.
+ *
+ * Parents which did not announce themselves yet are kept as placeholder
+ * entries, so a route becomes available as soon as the missing DAO arrives.
+ * Computed hop lists are cached per destination in a small direct-mapped
+ * cache that is invalidated whenever the topology changes.
+ *
+ * All functions are thread-safe.
+ *
+ * @see <a href="https://tools.ietf.org/html/rfc6550#section-9.7">
+ *          RFC 6550, section 9.7
+ *      </a>
+ * @{
+ *
+ * @file
+ * @brief       Source routing table definitions
+ */
+#ifndef NET_GNRC_RPL_SR_TABLE_H
+#define NET_GNRC_RPL_SR_TABLE_H
+
+#include <stdint.h>
+
+#include "net/ipv6/addr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup    net_gnrc_rpl_sr_table_conf Source routing table compile configurations
+ * @ingroup     net_gnrc_rpl_sr_table
+ * @{
+ */
+/**
+ * @brief   Maximum number of nodes (including placeholders) in the table
+ */
+#ifndef CONFIG_GNRC_RPL_SR_TABLE_NUMOF
+#define CONFIG_GNRC_RPL_SR_TABLE_NUMOF          (32U)
+#endif
+
+/**
+ * @brief   Number of hash buckets
+ *
+ * @note    Must be a power of two.
+ */
+#ifndef CONFIG_GNRC_RPL_SR_TABLE_BUCKETS
+#define CONFIG_GNRC_RPL_SR_TABLE_BUCKETS        (16U)
+#endif
+
+/**
+ * @brief   Maximum number of hops of a source route
+ *
+ * Longer routes are treated as routing loops.
+ */
+#ifndef CONFIG_GNRC_RPL_SR_TABLE_MAX_DEPTH
+#define CONFIG_GNRC_RPL_SR_TABLE_MAX_DEPTH      (16U)
+#endif
+
+/**
+ * @brief   Number of hop lists cached
+ *
+ * Set to 0 to disable the cache.
+ */
+#ifndef CONFIG_GNRC_RPL_SR_TABLE_CACHE_NUMOF
+#define CONFIG_GNRC_RPL_SR_TABLE_CACHE_NUMOF    (4U)
+#endif
+/** @} */
+
+/**
+ * @brief   Lookup statistics of the source routing table
+ */
+typedef struct {
+    uint32_t lookups;       /**< number of route lookups */
+    uint32_t cache_hits;    /**< lookups answered from the cache */
+} gnrc_rpl_sr_table_stats_t;
+
+/**
+ * @brief   Removes all entries from the table
+ */
+void gnrc_rpl_sr_table_reset(void);
+
+/**
+ * @brief   Adds or updates the parent of a target
+ *
+ * @param[in] target    Address of the target.
+ * @param[in] parent    Address of the DAO parent of @p target. NULL if
+ *                      @p target is attached to the root directly.
+ * @param[in] lifetime  Lifetime of the entry in seconds. Must not be 0.
+ *
+ * @return  0 on success.
+ * @return  -EINVAL if @p lifetime is 0 or @p parent equals @p target.
+ * @return  -ELOOP if @p target would become its own ancestor.
+ * @return  -ENOMEM if the table is full.
+ */
+int gnrc_rpl_sr_table_add(const ipv6_addr_t *target, const ipv6_addr_t *parent,
+                          uint32_t lifetime);
+
+/**
+ * @brief   Removes a target (e.g. on a No-Path DAO)
+ *
+ * If other targets still use @p target as parent, the entry is kept as
+ * placeholder without a route.
+ *
+ * @param[in] target    Address of the target.
+ */
+void gnrc_rpl_sr_table_del(const ipv6_addr_t *target);
+
+/**
+ * @brief   Ages all entries
+ *
+ * Entries whose lifetime runs out are removed as with
+ * gnrc_rpl_sr_table_del().
+ *
+ * @param[in] elapsed   Seconds passed since the last call.
+ */
+void gnrc_rpl_sr_table_timeout(uint32_t elapsed);
+
+/**
+ * @brief   Computes the source route to a target
+ *
+ * The hops are written in forwarding order, i.e. @p hops[0] is the child of
+ * the root and the last hop is @p target itself.
+ *
+ * @param[in] target    Address of the target.
+ * @param[out] hops     Hop list.
+ * @param[in] max_hops  Maximum number of entries in @p hops.
+ *
+ * @return  Number of hops written to @p hops.
+ * @return  -ENOENT if @p target is unknown.
+ * @return  -EHOSTUNREACH if the route to @p target is incomplete.
+ * @return  -ELOOP if the route exceeds @ref CONFIG_GNRC_RPL_SR_TABLE_MAX_DEPTH.
+ * @return  -ENOBUFS if the route does not fit into @p hops.
+ */
+int gnrc_rpl_sr_table_get_route(const ipv6_addr_t *target, ipv6_addr_t *hops,
+                                unsigned max_hops);
+
+/**
+ * @brief   Returns the number of entries in use, including placeholders
+ *
+ * @return  Number of entries in use.
+ */
+unsigned gnrc_rpl_sr_table_numof(void);
+
+/**
+ * @brief   Returns the lookup statistics
+ *
+ * @param[out] stats    Lookup statistics.
+ */
+void gnrc_rpl_sr_table_get_stats(gnrc_rpl_sr_table_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NET_GNRC_RPL_SR_TABLE_H */
+/** @} */
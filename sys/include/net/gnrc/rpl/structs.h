@@ -28,6 +28,8 @@
 extern "C" {
 #endif
 
+#include <stdbool.h>
+
 #include "byteorder.h"
 #include "net/ipv6/addr.h"
 #include "evtimer.h"
@@ -243,7 +245,8 @@ struct gnrc_rpl_parent {
     uint8_t dtsn;                   /**< last seen dtsn of this parent */
     uint16_t rank;                  /**< rank of the parent */
     gnrc_rpl_dodag_t *dodag;        /**< DODAG the parent belongs to */
-    double link_metric;             /**< metric of the link */
+    uint16_t link_metric;           /**< metric of the link (for ETX in units
+                                         of 1/128, see RFC 6551) */
     uint8_t link_metric_type;       /**< type of the metric */
     /**
      * @brief Parent timeout events (see @ref GNRC_RPL_MSG_TYPE_PARENT_TIMEOUT)
@@ -304,6 +307,34 @@ typedef struct {
      */
     void (*init)(gnrc_rpl_dodag_t *dodag);
     void (*process_dio)(void);  /**< DIO processing callback (acc. to OF0 spec, chpt 5) */
+
+    /**
+     * @brief Update the link metric of a parent.
+     *
+     * Called whenever a DIO of @p parent was received, before the parent is
+     * re-positioned in the parent list. May be NULL, if the objective
+     * function does not use link metrics.
+     *
+     * @param[in]   parent  The parent to update
+     *                      gnrc_rpl_parent_t::link_metric for.
+     */
+    void (*update_link_metric)(gnrc_rpl_parent_t *parent);
+
+    /**
+     * @brief Decide whether to switch the preferred parent.
+     *
+     * Called when gnrc_rpl_of_t::parent_cmp prefers @p candidate over the
+     * current preferred parent @p current. May be NULL, if the objective
+     * function always switches to the most preferred parent.
+     *
+     * @param[in]   current     The current preferred parent.
+     * @param[in]   candidate   The most preferred parent of the parent list.
+     *
+     * @return      true, to make @p candidate the preferred parent.
+     * @return      false, to keep @p current as the preferred parent.
+     */
+    bool (*parent_switch)(gnrc_rpl_parent_t *current,
+                          gnrc_rpl_parent_t *candidate);
 } gnrc_rpl_of_t;
 
 /**
@@ -11,6 +11,11 @@
  * @ingroup     net_nanocoap
  * @brief       A cache implementation for nanocoap response messages
  *
+ * Entries are found by a hash index over their cache key. The responses of
+ * all entries share a buffer of @ref CONFIG_NANOCOAP_CACHE_BYTES bytes, so
+ * small responses leave room for more entries. When a new response does not
+ * fit, the least recently used entries are evicted until it does.
+ *
  * @{
  *
  * @file
@@ -49,12 +54,20 @@ extern "C" {
 #endif
 
 /**
- * @brief Size of the buffer to store responses in the cache.
+ * @brief Maximum size of a single response to store in the cache.
  */
 #ifndef CONFIG_NANOCOAP_CACHE_RESPONSE_SIZE
 #define CONFIG_NANOCOAP_CACHE_RESPONSE_SIZE    (128)
 #endif
 
+/**
+ * @brief Size of the buffer shared by all cached responses.
+ */
+#ifndef CONFIG_NANOCOAP_CACHE_BYTES
+#define CONFIG_NANOCOAP_CACHE_BYTES \
+    (CONFIG_NANOCOAP_CACHE_ENTRIES * CONFIG_NANOCOAP_CACHE_RESPONSE_SIZE)
+#endif
+
 /**
  * @brief   Cache container that holds a @p coap_pkt_t struct.
  */
@@ -75,9 +88,12 @@ typedef struct {
     coap_pkt_t response_pkt;
 
     /**
-     * @brief buffer to hold the response message.
+     * @brief the response message, in the buffer shared by all entries.
+     *
+     * Only valid until the next modification of the cache, as the buffer is
+     * compacted when entries are removed.
      */
-    uint8_t response_buf[CONFIG_NANOCOAP_CACHE_RESPONSE_SIZE];
+    uint8_t *response_buf;
 
     size_t response_len; /**< length of the message in @p response */
 
@@ -93,6 +109,16 @@ typedef struct {
     uint32_t max_age;
 } nanocoap_cache_entry_t;
 
+/**
+ * @brief   Cache statistics
+ */
+typedef struct {
+    uint32_t hits;          /**< lookups that found an entry */
+    uint32_t misses;        /**< lookups that found no entry */
+    uint32_t evictions;     /**< entries removed to make room for others */
+    size_t bytes;           /**< bytes used by cached responses */
+} nanocoap_cache_stats_t;
+
 /**
  * @brief Typedef for the cache replacement strategy on full cache list.
  *
@@ -137,6 +163,16 @@ size_t nanocoap_cache_used_count(void);
  */
 size_t nanocoap_cache_free_count(void);
 
+/**
+ * @brief   Returns the cache statistics.
+ *
+ * Only lookups with nanocoap_cache_key_lookup() and
+ * nanocoap_cache_request_lookup() are counted as hits or misses.
+ *
+ * @param[out] stats    The statistics since nanocoap_cache_init().
+ */
+void nanocoap_cache_get_stats(nanocoap_cache_stats_t *stats);
+
 /**
  * @brief   Determines if a response is cacheable and modifies the cache
  *          as reflected in RFC7252, Section 5.9.
@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2023 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    net_nanocoap_resource_index Hash index for CoAP resources
+ * @ingroup     net_nanocoap
+ * @brief       Constant time lookup of the resource handling a request
+ *
+ * Without this module, the resource handling a request is found by comparing
+ * the request's path to the path of every resource in order. With module
+ * `nanocoap_resource_index`, a hash table over the resource paths is built
+ * once, so the lookup only compares the paths that share a hash.
+ *
+ * Resources with @ref COAP_MATCH_SUBTREE are hashed over their path as well.
+ * On lookup, the prefix of the request path with the length of each
+ * distinct subtree path is looked up, so the cost grows with the number of
+ * distinct subtree path lengths only.
+ *
+ * The result is the same as with the linear search: the first resource in
+ * the array that matches the path and allows the request method.
+ *
+ * The index is used by coap_handle_req() for the resources of the nanocoap
+ * server and by the default request matcher of @ref net_gcoap for every
+ * registered listener.
+ *
+ * @{
+ *
+ * @file
+ * @brief       nanocoap resource index API
+ */
+
+#ifndef NET_NANOCOAP_RESOURCE_INDEX_H
+#define NET_NANOCOAP_RESOURCE_INDEX_H
+
+#include <stdint.h>
+
+#include "net/nanocoap.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Number of hash slots for the resources of the nanocoap server
+ *
+ * Must be a power of two and at least twice the number of resources,
+ * otherwise the resources are searched linearly.
+ */
+#ifndef CONFIG_NANOCOAP_RESOURCE_INDEX_SLOTS
+#define CONFIG_NANOCOAP_RESOURCE_INDEX_SLOTS    (64)
+#endif
+
+/**
+ * @brief   Hash index over the paths of a resource array
+ */
+typedef struct {
+    const coap_resource_t *resources;   /**< indexed resources */
+    uint16_t *slots;                    /**< hash slots, resource index + 1 */
+    uint64_t subtree_lens;              /**< bit n set: a subtree path has length n */
+    uint16_t resources_numof;           /**< number of indexed resources */
+    uint16_t slots_numof;               /**< number of slots, a power of two */
+} coap_resource_index_t;
+
+/**
+ * @brief   Builds the index over a resource array
+ *
+ * @param[out] index            The index.
+ * @param[in] resources         Resources to index. Must stay valid and
+ *                              unchanged while the index is used.
+ * @param[in] resources_numof   Number of entries in @p resources.
+ * @param[in] slots             Memory for the hash slots.
+ * @param[in] slots_numof       Number of entries in @p slots. Must be a power
+ *                              of two.
+ *
+ * @return  0 on success.
+ * @return  -ENOSPC, if @p slots_numof is less than twice @p resources_numof.
+ */
+int coap_resource_index_init(coap_resource_index_t *index,
+                             const coap_resource_t *resources,
+                             size_t resources_numof,
+                             uint16_t *slots, size_t slots_numof);
+
+/**
+ * @brief   Finds the resource for a request path and method
+ *
+ * @param[in] index     The index.
+ * @param[in] uri       Request path, as returned by coap_get_uri_path().
+ * @param[in] method    Request method flag, see coap_method2flag().
+ * @param[out] resource The first matching resource that allows @p method.
+ *
+ * @return  0 if a resource was found.
+ * @return  -ENOENT, if no resource matches @p uri.
+ * @return  -EPERM, if resources match @p uri, but none allows @p method.
+ */
+int coap_resource_index_find(const coap_resource_index_t *index,
+                             const char *uri, coap_method_flags_t method,
+                             const coap_resource_t **resource);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NET_NANOCOAP_RESOURCE_INDEX_H */
+/** @} */
@@ -153,6 +153,23 @@ extern "C" {
 #define CONFIG_NANOCOAP_SOCK_DTLS_TAG           (0xc0ab)
 #endif
 
+/**
+ * @brief   Maximum number of Block2 requests kept in flight by
+ *          nanocoap_sock_get_blockwise()
+ *
+ * With a value greater than 1, block-wise GETs request the following blocks
+ * without waiting for the response to the previous one, which reduces the
+ * transfer time on links with a high round trip time. Responses received out
+ * of order are buffered on the stack of nanocoap_sock_get_blockwise(), which
+ * takes `(CONFIG_NANOCOAP_BLOCKWISE_WINDOW - 1)` blocks of
+ * @ref CONFIG_NANOCOAP_BLOCKSIZE_DEFAULT.
+ *
+ * The default of 1 requests one block after the other.
+ */
+#ifndef CONFIG_NANOCOAP_BLOCKWISE_WINDOW
+#define CONFIG_NANOCOAP_BLOCKWISE_WINDOW        (1)
+#endif
+
 /**
  * @brief   NanoCoAP socket types
  */
@@ -426,6 +443,9 @@ ssize_t nanocoap_sock_delete_url(const char *url);
  * block-wise-transfer. A coap_blockwise_cb_t will be called on each received
  * block.
  *
+ * With @ref CONFIG_NANOCOAP_BLOCKWISE_WINDOW greater than 1, this uses
+ * nanocoap_sock_get_blockwise_window() with a buffer on the stack.
+ *
  * @param[in]   sock       socket to use for the request
  * @param[in]   path       pointer to source path
  * @param[in]   blksize    sender suggested SZX for the COAP block request
@@ -439,6 +459,37 @@ int nanocoap_sock_get_blockwise(nanocoap_sock_t *sock, const char *path,
                                 coap_blksize_t blksize,
                                 coap_blockwise_cb_t callback, void *arg);
 
+/**
+ * @brief    Performs a blockwise coap get request on a socket with multiple
+ *           requests in flight.
+ *
+ * After the first block, up to @ref CONFIG_NANOCOAP_BLOCKWISE_WINDOW blocks
+ * are requested at once (similar to Q-Block2 of RFC 9177, but with plain
+ * Block2 options, so any server supporting RFC 7959 can be used). Each
+ * request is retransmitted on its own.
+ *
+ * @p callback is called for each block in order of the offset, responses
+ * received out of order are kept in @p buf until their predecessors arrived.
+ * The window is limited to one block more than @p buf can hold, so with
+ * a @p buf smaller than one block the blocks are requested one after the
+ * other like with nanocoap_sock_get_blockwise().
+ *
+ * @param[in]   sock       socket to use for the request
+ * @param[in]   path       pointer to source path
+ * @param[in]   blksize    sender suggested SZX for the COAP block request
+ * @param[in]   buf        buffer for blocks received out of order
+ * @param[in]   len        length of @p buf
+ * @param[in]   callback   callback to be executed on each received block
+ * @param[in]   arg        optional function arguments
+ *
+ * @returns     <0         if failed to fetch the url content
+ * @returns      0         on success
+ */
+int nanocoap_sock_get_blockwise_window(nanocoap_sock_t *sock, const char *path,
+                                       coap_blksize_t blksize,
+                                       void *buf, size_t len,
+                                       coap_blockwise_cb_t callback, void *arg);
+
 /**
  * @brief    Performs a blockwise coap get request to the specified url.
  *
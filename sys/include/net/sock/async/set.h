@@ -0,0 +1,255 @@
+/*
+ * Copyright (C) 2023 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup        net_sock_async_set  Readiness sets for asynchronous sock
+ * @ingroup         net_sock
+ * @brief           Waits for events on many socks at once
+ *
+ * A readiness set aggregates the asynchronous notifications of many sock
+ * objects (and socket file descriptors of @ref posix_sockets) into a single
+ * queue, similar to `epoll()`. Instead of dispatching a callback per sock as
+ * @ref net_sock_async_event does, sock_set_wait() returns the members that
+ * became ready, so a single thread can serve many socks in its own loop.
+ *
+ * Notifications are edge-triggered: a member is returned once per batch of
+ * notifications that arrived since it was last returned. After a member
+ * was reported with @ref SOCK_ASYNC_MSG_RECV, the application must receive
+ * (non-blocking) until the sock reports `-EAGAIN`, otherwise remaining
+ * data is not reported again until new data arrives.
+ *
+ * Members reported by one sock_set_wait() call are taken from the queue
+ * without waking the calling thread again, so the cost of a wakeup does not
+ * depend on the number of members.
+ *
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ {.c}
+ * sock_set_t set;
+ * sock_set_entry_t entries[SOCKS_NUMOF];
+ * sock_set_entry_t *ready[8];
+ *
+ * sock_set_init(&set);
+ * for (unsigned i = 0; i < SOCKS_NUMOF; i++) {
+ *     sock_set_add_udp(&set, &entries[i], &socks[i], NULL);
+ * }
+ * while (1) {
+ *     int n = sock_set_wait(&set, ready, ARRAY_SIZE(ready), SOCK_NO_TIMEOUT);
+ *
+ *     for (int i = 0; i < n; i++) {
+ *         if (ready[i]->flags & SOCK_ASYNC_MSG_RECV) {
+ *             while (sock_udp_recv(ready[i]->sock, buf, sizeof(buf), 0,
+ *                                  &remote) >= 0) {
+ *                 ...
+ *             }
+ *         }
+ *     }
+ * }
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ * @note    A sock can either be member of a readiness set or be used with
+ *          @ref net_sock_async_event, as both use the sock's callback.
+ *
+ * @experimental    This API is still under development and should not be used
+ *                  in production yet.
+ * @{
+ *
+ * @file
+ * @brief   Readiness set definitions
+ */
+#ifndef NET_SOCK_ASYNC_SET_H
+#define NET_SOCK_ASYNC_SET_H
+
+#include <stdint.h>
+
+#include "event.h"
+#include "net/sock/ip.h"
+#include "net/sock/tcp.h"
+#include "net/sock/udp.h"
+#include "net/sock/async.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Type of a readiness set member
+ */
+typedef enum {
+    SOCK_SET_TYPE_NONE = 0,         /**< entry is not in a set */
+    SOCK_SET_TYPE_IP,               /**< raw IPv4/IPv6 sock */
+    SOCK_SET_TYPE_TCP,              /**< TCP sock */
+    SOCK_SET_TYPE_TCP_QUEUE,        /**< TCP listening queue */
+    SOCK_SET_TYPE_UDP,              /**< UDP sock */
+    SOCK_SET_TYPE_FD,               /**< VFS file descriptor */
+} sock_set_type_t;
+
+/**
+ * @brief   Readiness set
+ */
+typedef struct {
+    event_queue_t queue;            /**< queue of members with notifications */
+} sock_set_t;
+
+/**
+ * @brief   Member of a readiness set
+ *
+ * The memory is provided by the application and must stay valid until the
+ * member is removed with sock_set_del().
+ */
+typedef struct {
+    event_t super;                  /**< event structure that gets extended */
+    sock_set_t *set;                /**< set the member belongs to */
+    void *sock;                     /**< sock object, NULL for file descriptors */
+    void *arg;                      /**< application context */
+    int fd;                         /**< file descriptor, -1 for sock objects */
+    sock_set_type_t type;           /**< type of the member */
+    sock_async_flags_t pending;     /**< notifications not reported yet */
+    /**
+     * @brief   Notifications reported by the last sock_set_wait()
+     */
+    sock_async_flags_t flags;
+} sock_set_entry_t;
+
+/**
+ * @brief   Initializes a readiness set
+ *
+ * The first thread calling sock_set_wait() becomes the only thread allowed
+ * to wait on @p set.
+ *
+ * @param[out] set  The readiness set.
+ */
+void sock_set_init(sock_set_t *set);
+
+#if defined(MODULE_SOCK_IP) || defined(DOXYGEN)
+/**
+ * @brief   Adds a raw IPv4/IPv6 sock to a readiness set
+ *
+ * @param[in] set       The readiness set.
+ * @param[out] entry    Member storage.
+ * @param[in] sock      A raw IPv4/IPv6 sock object.
+ * @param[in] arg       Application context, stored in sock_set_entry_t::arg.
+ *
+ * @note    Only available with module `sock_ip`.
+ */
+void sock_set_add_ip(sock_set_t *set, sock_set_entry_t *entry,
+                     sock_ip_t *sock, void *arg);
+#endif
+
+#if defined(MODULE_SOCK_TCP) || defined(DOXYGEN)
+/**
+ * @brief   Adds a TCP sock to a readiness set
+ *
+ * @param[in] set       The readiness set.
+ * @param[out] entry    Member storage.
+ * @param[in] sock      A TCP sock object.
+ * @param[in] arg       Application context, stored in sock_set_entry_t::arg.
+ *
+ * @note    Only available with module `sock_tcp`.
+ */
+void sock_set_add_tcp(sock_set_t *set, sock_set_entry_t *entry,
+                      sock_tcp_t *sock, void *arg);
+
+/**
+ * @brief   Adds a TCP listening queue to a readiness set
+ *
+ * @param[in] set       The readiness set.
+ * @param[out] entry    Member storage.
+ * @param[in] queue     A TCP listening queue.
+ * @param[in] arg       Application context, stored in sock_set_entry_t::arg.
+ *
+ * @note    Only available with module `sock_tcp`.
+ */
+void sock_set_add_tcp_queue(sock_set_t *set, sock_set_entry_t *entry,
+                            sock_tcp_queue_t *queue, void *arg);
+#endif
+
+#if defined(MODULE_SOCK_UDP) || defined(DOXYGEN)
+/**
+ * @brief   Adds a UDP sock to a readiness set
+ *
+ * @param[in] set       The readiness set.
+ * @param[out] entry    Member storage.
+ * @param[in] sock      A UDP sock object.
+ * @param[in] arg       Application context, stored in sock_set_entry_t::arg.
+ *
+ * @note    Only available with module `sock_udp`.
+ */
+void sock_set_add_udp(sock_set_t *set, sock_set_entry_t *entry,
+                      sock_udp_t *sock, void *arg);
+#endif
+
+#if defined(MODULE_VFS) || defined(DOXYGEN)
+/**
+ * @brief   Adds a file descriptor to a readiness set
+ *
+ * Sockets of @ref posix_sockets report received data. Other file
+ * descriptors never block, so they are reported as readable and writable
+ * once when added.
+ *
+ * @param[in] set       The readiness set.
+ * @param[out] entry    Member storage.
+ * @param[in] fd        A file descriptor.
+ * @param[in] arg       Application context, stored in sock_set_entry_t::arg.
+ *
+ * @note    Only available with module `vfs`.
+ *
+ * @return  0 on success.
+ * @return  -EBADF, if @p fd is not an open file descriptor.
+ * @return  -EBUSY, if the socket of @p fd is already in a readiness set.
+ */
+int sock_set_add_fd(sock_set_t *set, sock_set_entry_t *entry, int fd,
+                    void *arg);
+#endif
+
+/**
+ * @brief   Removes a member from its readiness set
+ *
+ * @param[in] entry     A member of a readiness set.
+ */
+void sock_set_del(sock_set_entry_t *entry);
+
+/**
+ * @brief   Notifies the set of an event on a member
+ *
+ * This is called by the sock callbacks, but may also be used to report
+ * events from other sources.
+ *
+ * @note    May be called from interrupt context.
+ *
+ * @param[in] entry     A member of a readiness set.
+ * @param[in] flags     The event flags.
+ */
+void sock_set_notify(sock_set_entry_t *entry, sock_async_flags_t flags);
+
+/**
+ * @brief   Waits for members of a readiness set to become ready
+ *
+ * Waits for the first member with notifications and then takes all other
+ * members with notifications, up to @p numof, without waiting again. The
+ * notifications of each returned member are in sock_set_entry_t::flags.
+ *
+ * @param[in] set       The readiness set.
+ * @param[out] ready    The members that became ready.
+ * @param[in] numof     Number of entries in @p ready.
+ * @param[in] timeout   Timeout for the first member in microseconds.
+ *                      If 0 and no member is ready, the function returns
+ *                      immediately.
+ *                      May be @ref SOCK_NO_TIMEOUT for no timeout.
+ *
+ * @return  The number of members in @p ready.
+ * @return  -EAGAIN, if @p timeout is `0` and no member is ready.
+ * @return  -ETIMEDOUT, if @p timeout expired.
+ */
+int sock_set_wait(sock_set_t *set, sock_set_entry_t **ready, unsigned numof,
+                  uint32_t timeout);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NET_SOCK_ASYNC_SET_H */
+/** @} */
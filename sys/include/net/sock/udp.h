@@ -624,6 +624,83 @@ static inline ssize_t sock_udp_recv_buf(sock_udp_t *sock,
     return sock_udp_recv_buf_aux(sock, data, buf_ctx, timeout, remote, NULL);
 }
 
+/**
+ * @brief   Descriptor of a datagram received with sock_udp_recv_many()
+ */
+typedef struct {
+    void *data;                 /**< stack-internal buffer containing the datagram */
+    void *buf_ctx;              /**< stack-internal buffer context of the datagram */
+    size_t len;                 /**< length of sock_udp_msg_t::data */
+    sock_udp_ep_t remote;       /**< remote end point of the datagram */
+    /**
+     * @brief   Auxiliary data of the datagram
+     *
+     * Set sock_udp_aux_rx_t::flags before the call to request the
+     * information, as with sock_udp_recv_buf_aux().
+     */
+    sock_udp_aux_rx_t aux;
+} sock_udp_msg_t;
+
+/**
+ * @brief   Provides stack-internal buffer space for multiple UDP messages
+ *          at once
+ *
+ * Waits up to @p timeout for the first datagram like
+ * sock_udp_recv_buf_aux() and then takes all further datagrams that are
+ * already queued for @p sock without waiting again, up to @p numof.
+ * Datagrams not matching the remote of @p sock are dropped silently after
+ * the first one.
+ *
+ * Every returned buffer must be released with sock_udp_recv_many_release()
+ * before @p sock is used for receiving again.
+ *
+ * @pre `(sock != NULL) && (msgs != NULL) && (numof > 0)`
+ * @pre `msgs[i].buf_ctx == NULL` for all `i < numof`
+ *
+ * @param[in] sock      A UDP sock object.
+ * @param[in,out] msgs  Descriptors of the received datagrams.
+ * @param[in] numof     Number of entries in @p msgs.
+ * @param[in] timeout   Timeout for the first datagram in microseconds.
+ *                      If 0 and no data is available, the function returns
+ *                      immediately.
+ *                      May be @ref SOCK_NO_TIMEOUT for no timeout (wait until
+ *                      data is available).
+ *
+ * @experimental    This function is only implemented for GNRC, where a
+ *                  datagram is always provided in a single buffer.
+ *
+ * @return  The number of datagrams received on success.
+ * @return  -EADDRNOTAVAIL, if local of @p sock is not given.
+ * @return  -EAGAIN, if @p timeout is `0` and no data is available.
+ * @return  -EINVAL, if @p sock is not properly initialized (or closed while
+ *          sock_udp_recv_many() blocks).
+ * @return  -ENOMEM, if no memory was available to receive the first datagram.
+ * @return  -EPROTO, if source address of the first received packet did not
+ *          equal the remote of @p sock.
+ * @return  -ETIMEDOUT, if @p timeout expired.
+ */
+ssize_t sock_udp_recv_many(sock_udp_t *sock, sock_udp_msg_t *msgs,
+                           unsigned numof, uint32_t timeout);
+
+/**
+ * @brief   Releases the buffers provided by sock_udp_recv_many()
+ *
+ * @param[in] sock      The UDP sock object the datagrams were received with.
+ * @param[in,out] msgs  Descriptors of the received datagrams.
+ * @param[in] numof     Number of received datagrams, i.e. the return value
+ *                      of sock_udp_recv_many().
+ */
+static inline void sock_udp_recv_many_release(sock_udp_t *sock,
+                                              sock_udp_msg_t *msgs,
+                                              unsigned numof)
+{
+    for (unsigned i = 0; i < numof; i++) {
+        /* releases the buffer, as every datagram is provided in one buffer */
+        sock_udp_recv_buf_aux(sock, &msgs[i].data, &msgs[i].buf_ctx, 0,
+                              NULL, NULL);
+    }
+}
+
 /**
  * @brief   Sends a UDP message to remote end point with non-continous payload
  *
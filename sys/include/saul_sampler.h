@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 2023 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    sys_saul_sampler SAUL sampling scheduler
+ * @ingroup     sys_saul_reg
+ * @brief       Periodic reads of SAUL devices shared by many consumers
+ *
+ * Instead of every consumer polling the SAUL devices it is interested in on
+ * its own timer, devices are registered with the sampler together with a
+ * sampling period. A single thread reads all devices that are due and puts
+ * the results into a time-stamped ring buffer. Consumers read the ring
+ * buffer with a cursor of their own, or look up the most recent sample of a
+ * device, without touching the hardware.
+ *
+ * Devices that become due within @ref CONFIG_SAUL_SAMPLER_MERGE_MS of each
+ * other are read in the same wakeup. Devices registered with the same
+ * non-zero bus key (e.g. all sensors on one I2C bus) are read back to back
+ * within a wakeup. The bus key is only a hint given by the caller: the
+ * sampler does not hold the bus across these reads, as each SAUL driver
+ * acquires and releases its bus within its read function. Threads of higher
+ * priority may still access the bus in between two reads.
+ *
+ * ```c
+ * static saul_sampler_entry_t temp_entry;
+ *
+ * // all devices on the first I2C bus use bus key 1
+ * saul_sampler_add(&temp_entry, saul_reg_find_type(SAUL_SENSE_TEMP), 1000, 1);
+ *
+ * saul_sampler_cursor_t cursor;
+ * saul_sample_t sample;
+ *
+ * saul_sampler_cursor_init(&cursor);
+ * while (1) {
+ *     while (saul_sampler_read(&cursor, &sample) == 0) {
+ *         phydat_dump(&sample.data, sample.res);
+ *     }
+ *     ztimer_sleep(ZTIMER_MSEC, 5000);
+ * }
+ * ```
+ *
+ * @{
+ *
+ * @file
+ * @brief       SAUL sampling scheduler interface definition
+ */
+
+#ifndef SAUL_SAMPLER_H
+#define SAUL_SAMPLER_H
+
+#include <stdint.h>
+
+#include "phydat.h"
+#include "saul_reg.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @defgroup sys_saul_sampler_conf SAUL sampling scheduler compile time configuration
+ * @ingroup config
+ * @{
+ */
+/**
+ * @brief   Number of samples kept in the ring buffer
+ *
+ * Must be a power of two.
+ */
+#ifndef CONFIG_SAUL_SAMPLER_BUF_NUMOF
+#define CONFIG_SAUL_SAMPLER_BUF_NUMOF   (16U)
+#endif
+
+/**
+ * @brief   Devices due within this many milliseconds are read together
+ */
+#ifndef CONFIG_SAUL_SAMPLER_MERGE_MS
+#define CONFIG_SAUL_SAMPLER_MERGE_MS    (10U)
+#endif
+/** @} */
+
+/**
+ * @brief   Stack size of the sampler thread
+ */
+#ifndef SAUL_SAMPLER_STACK_SIZE
+#define SAUL_SAMPLER_STACK_SIZE     (THREAD_STACKSIZE_DEFAULT)
+#endif
+
+/**
+ * @brief   Priority of the sampler thread
+ */
+#ifndef SAUL_SAMPLER_PRIO
+#define SAUL_SAMPLER_PRIO           (THREAD_PRIORITY_MAIN - 1)
+#endif
+
+/**
+ * @brief   Device scheduled for sampling
+ *
+ * All members are private, use saul_sampler_add() to set them.
+ */
+typedef struct saul_sampler_entry {
+    struct saul_sampler_entry *next;    /**< next scheduled device */
+    saul_reg_t *dev;                    /**< device to read */
+    uint32_t period;                    /**< sampling period in ms */
+    uint32_t due;                       /**< time of the next read in ms */
+    uint8_t bus;                        /**< bus key, 0 for none */
+} saul_sampler_entry_t;
+
+/**
+ * @brief   A sample in the ring buffer
+ */
+typedef struct {
+    const saul_reg_t *dev;  /**< device that was read */
+    uint32_t time;          /**< time of the read, ZTIMER_MSEC */
+    phydat_t data;          /**< the data read */
+    int8_t res;             /**< result of saul_reg_read(): dimensions of
+                                 @p data or negative errno */
+} saul_sample_t;
+
+/**
+ * @brief   Read position of a consumer in the ring buffer
+ */
+typedef struct {
+    uint32_t seq;           /**< sequence number of the next sample */
+} saul_sampler_cursor_t;
+
+/**
+ * @brief   Starts the sampler thread
+ *
+ * Called by auto_init after the SAUL devices are registered.
+ */
+void saul_sampler_init(void);
+
+/**
+ * @brief   Schedules periodic reads of a device
+ *
+ * The first read happens right away.
+ *
+ * @param[out] entry    Entry to use for the device. Must stay valid until
+ *                      it is passed to saul_sampler_remove().
+ * @param[in] dev       Device to read.
+ * @param[in] period    Sampling period in ms, must be larger than
+ *                      @ref CONFIG_SAUL_SAMPLER_MERGE_MS.
+ * @param[in] bus       Devices with the same non-zero key are read back to
+ *                      back, 0 if the device does not share a bus. No bus
+ *                      lock is held between these reads.
+ *
+ * @return  0 on success
+ * @return  -EINVAL if @p dev is NULL or @p period is too short
+ */
+int saul_sampler_add(saul_sampler_entry_t *entry, saul_reg_t *dev,
+                     uint32_t period, uint8_t bus);
+
+/**
+ * @brief   Stops sampling a device
+ *
+ * Samples of the device already in the ring buffer are kept. Waits for a
+ * read in progress to complete.
+ *
+ * @param[in] entry     Entry passed to saul_sampler_add().
+ */
+void saul_sampler_remove(saul_sampler_entry_t *entry);
+
+/**
+ * @brief   Initializes a cursor, so that only samples taken from now on are
+ *          read with it
+ *
+ * @param[out] cursor   The cursor.
+ */
+void saul_sampler_cursor_init(saul_sampler_cursor_t *cursor);
+
+/**
+ * @brief   Reads the next sample at a cursor
+ *
+ * @param[in,out] cursor    Cursor of the consumer.
+ * @param[out] sample       The sample.
+ *
+ * @return  0 if @p sample was read
+ * @return  -EAGAIN if there is no new sample
+ * @return  -EOVERFLOW if samples were overwritten before they were read.
+ *          @p cursor now points to the oldest sample in the buffer.
+ */
+int saul_sampler_read(saul_sampler_cursor_t *cursor, saul_sample_t *sample);
+
+/**
+ * @brief   Gets the most recent sample of a device in the ring buffer
+ *
+ * @param[in] dev       The device.
+ * @param[out] sample   The sample.
+ *
+ * @return  0 on success
+ * @return  -ENOENT if the ring buffer holds no sample of @p dev
+ */
+int saul_sampler_latest(const saul_reg_t *dev, saul_sample_t *sample);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SAUL_SAMPLER_H */
+/** @} */
@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2023 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    sys_senml_json SenML JSON
+ * @ingroup     sys_senml
+ * @brief       Functionality for encoding SenML values as JSON
+ *
+ * The `senml_json` module contains functionality for encoding @ref sys_senml
+ * values as JSON records (RFC 8428, section 5).
+ *
+ * Floating point values are formatted with @ref fmt_float() using
+ * @ref CONFIG_SENML_JSON_FLOAT_PRECISION digits after the decimal point, so
+ * their magnitude must be less than 2^32. Double values are formatted as
+ * floats. Decimal fractions and integers are formatted exactly.
+ *
+ * @{
+ *
+ * @file
+ * @brief       Functionality for encoding SenML values as JSON
+ */
+
+#ifndef SENML_JSON_H
+#define SENML_JSON_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "senml.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Number of digits after the decimal point of floating point values
+ */
+#ifndef CONFIG_SENML_JSON_FLOAT_PRECISION
+#define CONFIG_SENML_JSON_FLOAT_PRECISION   3
+#endif
+
+#if IS_ACTIVE(CONFIG_SENML_ATTR_SUM) || defined(DOXYGEN)
+/**
+ * @brief Encode @ref senml_attr_t containing `sum` as JSON object.
+ *
+ * Requires the `sum` attribute to be enabled by setting `CONFIG_SENML_ATTR_SUM` to 1.
+ *
+ * @param buf Buffer to write to, nothing is written beyond @p len.
+ * @param len Size of @p buf.
+ * @param attr Attributes (including `sum`) to encode.
+ *
+ * @return Size of the encoded record, which exceeds @p len if @p buf is too
+ *         small.
+ * @return -ERANGE if a floating point value is out of range.
+ */
+int senml_encode_sum_json(char *buf, size_t len, const senml_attr_t *attr);
+#endif
+
+/**
+ * @brief Encode @ref senml_bool_value_t as JSON object.
+ *
+ * @param buf Buffer to write to, nothing is written beyond @p len.
+ * @param len Size of @p buf.
+ * @param val value to encode.
+ *
+ * @return Size of the encoded record, which exceeds @p len if @p buf is too
+ *         small.
+ * @return -ERANGE if a floating point value is out of range.
+ */
+int senml_encode_bool_json(char *buf, size_t len, const senml_bool_value_t *val);
+
+/**
+ * @brief Encode @ref senml_value_t as JSON object.
+ *
+ * @param buf Buffer to write to, nothing is written beyond @p len.
+ * @param len Size of @p buf.
+ * @param val value to encode.
+ *
+ * @return Size of the encoded record, which exceeds @p len if @p buf is too
+ *         small.
+ * @return -ERANGE if a floating point value is out of range.
+ */
+int senml_encode_value_json(char *buf, size_t len, const senml_value_t *val);
+
+/**
+ * @brief Encode @ref senml_string_value_t as JSON object.
+ *
+ * @param buf Buffer to write to, nothing is written beyond @p len.
+ * @param len Size of @p buf.
+ * @param val value to encode.
+ *
+ * @return Size of the encoded record, which exceeds @p len if @p buf is too
+ *         small.
+ * @return -ERANGE if a floating point value is out of range.
+ */
+int senml_encode_string_json(char *buf, size_t len, const senml_string_value_t *val);
+
+/**
+ * @brief Encode @ref senml_data_value_t as JSON object.
+ *
+ * The data is encoded as base64url without padding.
+ *
+ * @param buf Buffer to write to, nothing is written beyond @p len.
+ * @param len Size of @p buf.
+ * @param val value to encode.
+ *
+ * @return Size of the encoded record, which exceeds @p len if @p buf is too
+ *         small.
+ * @return -ERANGE if a floating point value is out of range.
+ */
+int senml_encode_data_json(char *buf, size_t len, const senml_data_value_t *val);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SENML_JSON_H */
+/** @} */
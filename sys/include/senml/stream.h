@@ -0,0 +1,242 @@
+/*
+ * Copyright (C) 2023 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    sys_senml_stream SenML streaming encoder
+ * @ingroup     sys_senml
+ * @brief       Encode SenML packs record by record into a byte stream
+ *
+ * The `senml_stream` module encodes a SenML pack without a buffer for the
+ * whole pack. Each record is encoded into a small buffer that only needs to
+ * hold the largest record and is then passed to a write function, so the
+ * memory used does not depend on the number of records.
+ *
+ * Records are encoded as CBOR (with module `senml_cbor`) or as JSON (with
+ * module `senml_json`). The pack is a CBOR array of indefinite length or a
+ * JSON array.
+ *
+ * Write functions are provided for a CoAP block-wise response
+ * (@ref senml_stream_write_coap()) and for a TCP connection
+ * (@ref senml_stream_write_tcp()). For the former, the whole pack is encoded
+ * for each block and only the bytes of the requested block end up in the
+ * response, so the records must be encoded the same way for every block:
+ *
+ * ```
+ * static ssize_t _history_handler(coap_pkt_t *pdu, uint8_t *buf, size_t len,
+ *                                 coap_request_ctx_t *ctx)
+ * {
+ *     coap_block_slicer_t slicer;
+ *     uint8_t record[64];
+ *
+ *     coap_block2_init(pdu, &slicer);
+ *     gcoap_resp_init(pdu, buf, len, COAP_CODE_CONTENT);
+ *     coap_opt_add_format(pdu, COAP_FORMAT_SENML_CBOR);
+ *     coap_opt_add_block2(pdu, &slicer, 1);
+ *     ssize_t plen = coap_opt_finish(pdu, COAP_OPT_FINISH_PAYLOAD);
+ *
+ *     senml_stream_coap_t sink = { .slicer = &slicer, .pos = pdu->payload };
+ *     senml_stream_t stream;
+ *     senml_stream_init(&stream, SENML_STREAM_CBOR, record, sizeof(record),
+ *                       senml_stream_write_coap, &sink);
+ *     for (unsigned i = 0; i < history_numof; i++) {
+ *         senml_stream_value(&stream, &history[i]);
+ *     }
+ *     if (senml_stream_finish(&stream) < 0) {
+ *         return gcoap_response(pdu, buf, len, COAP_CODE_INTERNAL_SERVER_ERROR);
+ *     }
+ *     plen += sink.pos - pdu->payload;
+ *     coap_block2_finish(&slicer);
+ *     return plen;
+ * }
+ * ```
+ *
+ * @{
+ *
+ * @file
+ * @brief       SenML streaming encoder
+ */
+
+#ifndef SENML_STREAM_H
+#define SENML_STREAM_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "senml.h"
+#if IS_USED(MODULE_NANOCOAP) || defined(DOXYGEN)
+#include "net/nanocoap.h"
+#endif
+#if IS_USED(MODULE_SOCK_TCP) || defined(DOXYGEN)
+#include "net/sock/tcp.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Encoding of the records of a stream
+ */
+typedef enum {
+    SENML_STREAM_CBOR,      /**< SenML CBOR, requires module `senml_cbor` */
+    SENML_STREAM_JSON,      /**< SenML JSON, requires module `senml_json` */
+} senml_stream_format_t;
+
+/**
+ * @brief Writes encoded bytes to the destination of a stream
+ *
+ * @param arg  Argument passed to @ref senml_stream_init().
+ * @param data Encoded bytes.
+ * @param len  Number of bytes in @p data.
+ *
+ * @return @p len on success, negative errno on error.
+ */
+typedef ssize_t (*senml_stream_write_t)(void *arg, const void *data, size_t len);
+
+/**
+ * @brief SenML stream
+ */
+typedef struct {
+    senml_stream_write_t write; /**< write function */
+    void *arg;                  /**< argument of @ref senml_stream_t::write */
+    uint8_t *buf;               /**< buffer for a single record */
+    size_t buf_len;             /**< size of @ref senml_stream_t::buf */
+    size_t len;                 /**< number of bytes written */
+    int res;                    /**< first error, 0 if none */
+    senml_stream_format_t format; /**< record encoding */
+    bool empty;                 /**< no record was written yet */
+} senml_stream_t;
+
+/**
+ * @brief Starts a SenML pack
+ *
+ * Writes the start of the array holding the records.
+ *
+ * @param stream  Stream to initialize.
+ * @param format  Encoding of the pack.
+ * @param buf     Buffer for encoding a single record, must stay valid until
+ *                @ref senml_stream_finish().
+ * @param buf_len Size of @p buf, limits the size of each encoded record.
+ * @param write   Write function for the encoded bytes.
+ * @param arg     Argument passed to @p write.
+ */
+void senml_stream_init(senml_stream_t *stream, senml_stream_format_t format,
+                       void *buf, size_t buf_len,
+                       senml_stream_write_t write, void *arg);
+
+#if IS_ACTIVE(CONFIG_SENML_ATTR_SUM) || defined(DOXYGEN)
+/**
+ * @brief Adds a record of @ref senml_attr_t containing `sum` to a stream
+ *
+ * @param stream Stream to write to.
+ * @param attr   Attributes (including `sum`) to encode.
+ *
+ * @return 0 on success or the first error of the stream.
+ */
+int senml_stream_sum(senml_stream_t *stream, const senml_attr_t *attr);
+#endif
+
+/**
+ * @brief Adds a @ref senml_bool_value_t record to a stream
+ *
+ * @param stream Stream to write to.
+ * @param val    Value to encode.
+ *
+ * @return 0 on success or the first error of the stream.
+ * @return -ENOBUFS if the record does not fit in the record buffer.
+ */
+int senml_stream_bool(senml_stream_t *stream, const senml_bool_value_t *val);
+
+/**
+ * @brief Adds a @ref senml_value_t record to a stream
+ *
+ * @param stream Stream to write to.
+ * @param val    Value to encode.
+ *
+ * @return 0 on success or the first error of the stream.
+ * @return -ENOBUFS if the record does not fit in the record buffer.
+ */
+int senml_stream_value(senml_stream_t *stream, const senml_value_t *val);
+
+/**
+ * @brief Adds a @ref senml_string_value_t record to a stream
+ *
+ * @param stream Stream to write to.
+ * @param val    Value to encode.
+ *
+ * @return 0 on success or the first error of the stream.
+ * @return -ENOBUFS if the record does not fit in the record buffer.
+ */
+int senml_stream_string(senml_stream_t *stream, const senml_string_value_t *val);
+
+/**
+ * @brief Adds a @ref senml_data_value_t record to a stream
+ *
+ * @param stream Stream to write to.
+ * @param val    Value to encode.
+ *
+ * @return 0 on success or the first error of the stream.
+ * @return -ENOBUFS if the record does not fit in the record buffer.
+ */
+int senml_stream_data(senml_stream_t *stream, const senml_data_value_t *val);
+
+/**
+ * @brief Ends the SenML pack
+ *
+ * @param stream Stream to finish.
+ *
+ * @return Number of bytes written for the whole pack.
+ * @return The first error of the stream, if any. Records added after an
+ *         error are not written.
+ */
+ssize_t senml_stream_finish(senml_stream_t *stream);
+
+#if IS_USED(MODULE_NANOCOAP) || defined(DOXYGEN)
+/**
+ * @brief Argument of @ref senml_stream_write_coap()
+ */
+typedef struct {
+    coap_block_slicer_t *slicer;    /**< slicer of the block-wise response */
+    uint8_t *pos;                   /**< write position in the payload,
+                                         advanced by the written bytes */
+} senml_stream_coap_t;
+
+/**
+ * @brief Writes the part of the stream within the current block to a CoAP
+ *        response
+ *
+ * @param arg  A @ref senml_stream_coap_t.
+ * @param data Encoded bytes.
+ * @param len  Number of bytes in @p data.
+ *
+ * @return @p len
+ */
+ssize_t senml_stream_write_coap(void *arg, const void *data, size_t len);
+#endif
+
+#if IS_USED(MODULE_SOCK_TCP) || defined(DOXYGEN)
+/**
+ * @brief Writes the stream to a TCP connection
+ *
+ * @param arg  A connected `sock_tcp_t`.
+ * @param data Encoded bytes.
+ * @param len  Number of bytes in @p data.
+ *
+ * @return @p len on success, the error of sock_tcp_write() otherwise.
+ */
+ssize_t senml_stream_write_tcp(void *arg, const void *data, size_t len);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SENML_STREAM_H */
+/** @} */
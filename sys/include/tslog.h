@@ -0,0 +1,241 @@
+/*
+ * Copyright (C) 2023 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    sys_tslog Time-series log store
+ * @ingroup     sys
+ * @brief       Append-only log of time stamped records on an MTD device
+ *
+ * This module stores records, e.g. sensor readings, with a time stamp
+ * directly on an MTD device. Unlike a file on a file system, appending a
+ * record does not update any metadata, and the records of a time range are
+ * found without reading the whole log.
+ *
+ * The log uses the sectors of the device as a ring: records are appended to
+ * the current sector until the next one does not fit, then the following
+ * sector is erased and written next. Once all sectors are used, the oldest
+ * sector is erased with all its records.
+ *
+ * Every sector starts with a header holding a sequence number and the time
+ * stamp of its first record, followed by the records, each made of its time
+ * stamp, length and CRC16 and the data. Records do not span sectors. The
+ * time stamps of the sectors are kept in RAM, so that the sector holding a
+ * time is found by binary search; only the record headers of that sector
+ * are read to find the first record.
+ *
+ * Iterating the log reads the record headers only. The data of a record is
+ * read on request, from the device straight into the buffer of the caller.
+ *
+ * Time stamps are in a unit chosen by the application and must not
+ * decrease from one record to the next.
+ *
+ * When the log is initialized, it is restored from the sector headers. A
+ * record torn by a reset while writing ends its sector; such records are
+ * detected by their CRC when their data is read.
+ *
+ * ## Usage
+ *
+ * ```
+ * USEMODULE += tslog
+ * ```
+ *
+ * ```
+ * static tslog_sector_t sectors[64];
+ * static tslog_t log = TSLOG_INIT(MTD_0, sectors);
+ *
+ * tslog_init(&log);
+ * tslog_append(&log, now, &reading, sizeof(reading));
+ *
+ * tslog_iter_t iter;
+ * tslog_rec_t rec;
+ * tslog_query(&log, &iter, start, end);
+ * while (tslog_next(&log, &iter, &rec) > 0) {
+ *     tslog_read(&log, &rec, &reading, 0, sizeof(reading));
+ * }
+ * ```
+ *
+ * The log uses up to as many sectors of the device as `sectors` has
+ * entries; use @ref drivers_mtd_mapper to place it on a part of a device.
+ *
+ * @{
+ *
+ * @file
+ * @brief       Interface definitions for the time-series log store
+ */
+
+#ifndef TSLOG_H
+#define TSLOG_H
+
+#include <stdint.h>
+
+#include "container.h"
+#include "mtd.h"
+#include "mutex.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Initializer for a @ref tslog_t
+ *
+ * @param[in] _mtd      MTD device to store the log on
+ * @param[in] _sectors  Array of @ref tslog_sector_t, one per sector to use
+ */
+#define TSLOG_INIT(_mtd, _sectors) \
+{ \
+    .mtd = _mtd, \
+    .sectors = _sectors, \
+    .sectors_numof = ARRAY_SIZE(_sectors), \
+    .lock = MUTEX_INIT, \
+}
+
+/**
+ * @brief   State of a sector of the log
+ */
+typedef struct {
+    uint32_t seq;           /**< sequence number, 0 if not part of the log */
+    uint32_t ts_start;      /**< time stamp of the first record */
+} tslog_sector_t;
+
+/**
+ * @brief   Time-series log
+ */
+typedef struct {
+    mtd_dev_t *mtd;             /**< MTD device storing the log */
+    tslog_sector_t *sectors;    /**< state of each sector */
+    uint32_t sectors_numof;     /**< number of sectors used */
+    uint32_t sector_size;       /**< size of a sector in bytes */
+    uint32_t seq;               /**< sequence number of @p head, 0 if empty */
+    uint32_t head;              /**< sector records are appended to */
+    uint32_t tail;              /**< sector with the oldest records */
+    uint32_t head_pos;          /**< offset of the next record in @p head */
+    uint32_t ts_last;           /**< time stamp of the last record */
+    uint8_t align;              /**< records are aligned to this many bytes */
+    mutex_t lock;               /**< guards the log */
+} tslog_t;
+
+/**
+ * @brief   Position in the log while iterating over a time range
+ */
+typedef struct {
+    uint32_t seq;           /**< sequence number of @p sector */
+    uint32_t sector;        /**< current sector */
+    uint32_t pos;           /**< offset of the next record in @p sector */
+    uint32_t ts_from;       /**< first time stamp of the range */
+    uint32_t ts_to;         /**< last time stamp of the range */
+} tslog_iter_t;
+
+/**
+ * @brief   Record found by @ref tslog_next
+ */
+typedef struct {
+    uint32_t timestamp;     /**< time stamp of the record */
+    uint32_t seq;           /**< sequence number of the sector */
+    uint32_t sector;        /**< sector holding the record */
+    uint32_t offset;        /**< offset of the data in the sector */
+    uint16_t len;           /**< length of the data */
+    uint16_t crc;           /**< CRC16 of the record */
+} tslog_rec_t;
+
+/**
+ * @brief   Initializes the log from the content of its MTD device
+ *
+ * @param[in] log       Log initialized with @ref TSLOG_INIT
+ *
+ * @return  0 on success
+ * @return  -EINVAL if the device has less than two sectors or a write size
+ *          larger than 8 bytes
+ * @return  <0 error of the MTD device
+ */
+int tslog_init(tslog_t *log);
+
+/**
+ * @brief   Appends a record
+ *
+ * If the record does not fit into the current sector, the next sector is
+ * erased first, and with it the oldest records once the log is full.
+ *
+ * @param[in] log       The log
+ * @param[in] timestamp Time stamp of the record, not less than the one of
+ *                      the previous record
+ * @param[in] data      Data of the record
+ * @param[in] len       Length of @p data
+ *
+ * @return  0 on success
+ * @return  -EINVAL if @p timestamp is less than the one of the last record
+ * @return  -EMSGSIZE if the record does not fit into a sector
+ * @return  <0 error of the MTD device
+ */
+int tslog_append(tslog_t *log, uint32_t timestamp, const void *data, size_t len);
+
+/**
+ * @brief   Erases all records
+ *
+ * @param[in] log       The log
+ *
+ * @return  0 on success
+ * @return  <0 error of the MTD device
+ */
+int tslog_clear(tslog_t *log);
+
+/**
+ * @brief   Starts iterating over the records of a time range
+ *
+ * @param[in] log       The log
+ * @param[out] iter     Iterator to pass to @ref tslog_next
+ * @param[in] from      First time stamp of the range
+ * @param[in] to        Last time stamp of the range, UINT32_MAX to include
+ *                      records appended while iterating
+ */
+void tslog_query(tslog_t *log, tslog_iter_t *iter, uint32_t from, uint32_t to);
+
+/**
+ * @brief   Gets the next record of a time range
+ *
+ * Only the header of the record is read; use @ref tslog_read to get its
+ * data. After the last record, records appended later are returned by
+ * subsequent calls.
+ *
+ * @param[in] log       The log
+ * @param[in,out] iter  Iterator started with @ref tslog_query
+ * @param[out] rec      The record
+ *
+ * @return  1 if a record was found
+ * @return  0 if there are no more records in the range
+ * @return  -ESTALE if records were erased before they were reached
+ * @return  <0 error of the MTD device
+ */
+int tslog_next(tslog_t *log, tslog_iter_t *iter, tslog_rec_t *rec);
+
+/**
+ * @brief   Reads the data of a record
+ *
+ * The data is checked against the CRC of the record if it is read as a
+ * whole.
+ *
+ * @param[in] log       The log
+ * @param[in] rec       Record found by @ref tslog_next
+ * @param[out] dest     Buffer to read into
+ * @param[in] offset    Offset into the data of the record
+ * @param[in] len       Number of bytes to read
+ *
+ * @return  number of bytes read
+ * @return  -EBADMSG if the data does not match the CRC
+ * @return  -ESTALE if the record was erased
+ * @return  <0 error of the MTD device
+ */
+int tslog_read(tslog_t *log, const tslog_rec_t *rec, void *dest,
+               size_t offset, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TSLOG_H */
+/** @} */
@@ -69,6 +69,7 @@
 #include "sched.h"
 #include "clist.h"
 #include "iolist.h"
+#include "modules.h"
 #include "mtd.h"
 #include "xfa.h"
 
@@ -197,6 +198,54 @@ extern "C" {
 #define VFS_MAX_OPEN_FILES (16)
 #endif
 
+/**
+ * @brief Number of entries of the lookup cache
+ *
+ * Only used with the `vfs_lookup_cache` module, see
+ * @ref VFS_FS_FLAG_LOOKUP_CACHE.
+ */
+#ifndef CONFIG_VFS_LOOKUP_CACHE_NUMOF
+#define CONFIG_VFS_LOOKUP_CACHE_NUMOF       (4)
+#endif
+
+/**
+ * @brief Size of the path buffer of a lookup cache entry
+ *
+ * Longer paths (including terminating null) are not cached.
+ */
+#ifndef CONFIG_VFS_LOOKUP_CACHE_PATH_LEN
+#define CONFIG_VFS_LOOKUP_CACHE_PATH_LEN    (32)
+#endif
+
+/**
+ * @brief Number of readahead buffers
+ *
+ * Only used with the `vfs_readahead` module, see @ref VFS_FS_FLAG_READAHEAD.
+ * Buffers are shared by all open files, a file gets one when it is read
+ * sequentially.
+ */
+#ifndef CONFIG_VFS_READAHEAD_NUMOF
+#define CONFIG_VFS_READAHEAD_NUMOF          (1)
+#endif
+
+/**
+ * @brief Size of a readahead buffer
+ *
+ * This is the size of the reads passed to the file system while a file is
+ * read sequentially, reads of at least this size are passed on unbuffered.
+ */
+#ifndef CONFIG_VFS_READAHEAD_SIZE
+#define CONFIG_VFS_READAHEAD_SIZE           (512)
+#endif
+
+/**
+ * @brief Number of consecutive smaller reads of a file before it gets a
+ *        readahead buffer
+ */
+#ifndef CONFIG_VFS_READAHEAD_THRESHOLD
+#define CONFIG_VFS_READAHEAD_THRESHOLD      (2)
+#endif
+
 #ifndef VFS_DIR_BUFFER_SIZE
 /**
  * @brief Size of buffer space in vfs_DIR
@@ -339,6 +388,29 @@ extern const vfs_file_ops_t mtd_vfs_ops;
  */
 #define VFS_FS_FLAG_WANT_ABS_PATH   (1 << 0)
 
+/**
+ * @brief   Results of looking up paths on the file system may be cached
+ *
+ * With the `vfs_lookup_cache` module, the VFS remembers the results of
+ * vfs_stat() and failed vfs_open() calls on such file systems, until a file
+ * on the same mount is created, removed or renamed. The status of a found file
+ * is also forgotten when a file on the same mount is written or synced. Only
+ * set this if the file system is not modified other than through the VFS.
+ */
+#define VFS_FS_FLAG_LOOKUP_CACHE    (1 << 1)
+
+/**
+ * @brief   Files may be read ahead
+ *
+ * With the `vfs_readahead` module, small sequential vfs_read() calls on files
+ * of such file systems are served from a buffer that is filled by reads of
+ * @ref CONFIG_VFS_READAHEAD_SIZE bytes. The buffer is dropped when the file is
+ * sought or a file on the same mount is written. Only set this for file
+ * systems of regular files on storage devices, not for ones of device files
+ * like @ref sys_fs_devfs.
+ */
+#define VFS_FS_FLAG_READAHEAD       (1 << 2)
+
 /**
  * @brief A file system driver
  */
@@ -359,6 +431,15 @@ struct vfs_mount_struct {
     size_t mount_point_len;      /**< Length of mount_point string (set by vfs_mount) */
     atomic_int open_files;       /**< Number of currently open files and directories */
     void *private_data;          /**< File system driver private data, implementation defined */
+    struct vfs_mount_struct *mount_child;   /**< First mount below this mount point (private) */
+    struct vfs_mount_struct *mount_sibling; /**< Next mount below the same mount point (private) */
+#if IS_USED(MODULE_VFS_LOOKUP_CACHE) || IS_USED(MODULE_VFS_READAHEAD) || defined(DOXYGEN)
+    atomic_int gen;              /**< Changed when files are created or removed,
+                                      invalidates cached lookups (private) */
+    atomic_int data_gen;         /**< Changed when file contents are modified,
+                                      invalidates cached file status and read
+                                      ahead data (private) */
+#endif
 };
 
 /**
@@ -530,6 +611,55 @@ struct vfs_file_ops {
      */
     ssize_t (*write) (vfs_file_t *filp, const void *src, size_t nbytes);
 
+    /**
+     * @brief Read bytes at a given offset of an open file into an iolist
+     *
+     * The file position is not changed. If the driver does not implement this,
+     * the VFS layer falls back to @c lseek and @c read.
+     *
+     * @param[in]  filp     pointer to open file
+     * @param[in]  iolist   destination buffers, filled in order
+     * @param[in]  off      offset in the file to read from
+     *
+     * @return number of bytes read on success, less than the size of
+     *         @p iolist only at the end of the file
+     * @return <0 on error
+     */
+    ssize_t (*preadv) (vfs_file_t *filp, const iolist_t *iolist, off_t off);
+
+    /**
+     * @brief Write bytes from an iolist at a given offset of an open file
+     *
+     * The file position is not changed. If the driver does not implement this,
+     * the VFS layer falls back to @c lseek and @c write.
+     *
+     * @param[in]  filp     pointer to open file
+     * @param[in]  iolist   source buffers, written in order
+     * @param[in]  off      offset in the file to write to
+     *
+     * @return number of bytes written on success
+     * @return <0 on error
+     */
+    ssize_t (*pwritev) (vfs_file_t *filp, const iolist_t *iolist, off_t off);
+
+    /**
+     * @brief Get a pointer to the contents of an open file in memory
+     *
+     * Only file systems that store the contents of a file contiguously in
+     * memory mapped storage can implement this. The contents must stay at
+     * @p addr as long as the file is open.
+     *
+     * @param[in]  filp     pointer to open file
+     * @param[in]  off      offset in the file of the first byte to map
+     * @param[in]  len      number of bytes to map
+     * @param[out] addr     address of the byte at @p off
+     *
+     * @return 0 on success
+     * @return -ENXIO if @p off + @p len is beyond the end of the file
+     * @return <0 on other errors
+     */
+    int (*mmap) (vfs_file_t *filp, off_t off, size_t len, const void **addr);
+
     /**
      * @brief Synchronize a file on storage
      *        Any pending writes are written out to storage.
@@ -849,6 +979,97 @@ ssize_t vfs_write(int fd, const void *src, size_t count);
  */
 ssize_t vfs_write_iol(int fd, const iolist_t *iolist);
 
+/**
+ * @brief Read bytes at a given offset of an open file into an iolist
+ *
+ * Unlike a @ref vfs_lseek followed by @ref vfs_read, this does not change the
+ * file position, and file systems that support it do it in one operation.
+ *
+ * @param[in]  fd       fd number obtained from vfs_open
+ * @param[in]  iolist   destination buffers, filled in order
+ * @param[in]  off      offset in the file to read from
+ *
+ * @return number of bytes read on success, less than the size of @p iolist
+ *         only at the end of the file
+ * @return <0 on error
+ */
+ssize_t vfs_preadv(int fd, const iolist_t *iolist, off_t off);
+
+/**
+ * @brief Write bytes from an iolist at a given offset of an open file
+ *
+ * Unlike a @ref vfs_lseek followed by @ref vfs_write, this does not change
+ * the file position, and file systems that support it do it in one operation.
+ *
+ * @param[in]  fd       fd number obtained from vfs_open
+ * @param[in]  iolist   source buffers, written in order
+ * @param[in]  off      offset in the file to write to
+ *
+ * @return number of bytes written on success
+ * @return <0 on error
+ */
+ssize_t vfs_pwritev(int fd, const iolist_t *iolist, off_t off);
+
+/**
+ * @brief Get a read-only pointer to the contents of an open file
+ *
+ * This allows using data stored in memory mapped flash, e.g. bytecode or
+ * model data in a @ref sys_fs_constfs, in place instead of copying it to RAM.
+ * Only some file systems support this; callers should fall back to
+ * @ref vfs_read on -ENODEV. The pointer stays valid until @p fd is closed.
+ *
+ * @param[in]  fd       fd number obtained from vfs_open
+ * @param[in]  off      offset in the file of the first byte to map
+ * @param[in]  len      number of bytes to map
+ * @param[out] addr     address of the byte at @p off
+ *
+ * @return 0 on success
+ * @return -ENODEV if the file system does not support mapping files
+ * @return -ENXIO if @p off + @p len is beyond the end of the file
+ * @return <0 on other errors
+ */
+int vfs_mmap(int fd, off_t off, size_t len, const void **addr);
+
+/**
+ * @brief Read bytes at a given offset of an open file
+ *
+ * @see vfs_preadv
+ *
+ * @param[in]  fd       fd number obtained from vfs_open
+ * @param[out] dest     destination buffer to hold the file contents
+ * @param[in]  count    maximum number of bytes to read
+ * @param[in]  off      offset in the file to read from
+ *
+ * @return number of bytes read on success
+ * @return <0 on error
+ */
+static inline ssize_t vfs_pread(int fd, void *dest, size_t count, off_t off)
+{
+    const iolist_t iol = { .iol_base = dest, .iol_len = count };
+
+    return vfs_preadv(fd, &iol, off);
+}
+
+/**
+ * @brief Write bytes at a given offset of an open file
+ *
+ * @see vfs_pwritev
+ *
+ * @param[in]  fd       fd number obtained from vfs_open
+ * @param[in]  src      pointer to source buffer
+ * @param[in]  count    maximum number of bytes to write
+ * @param[in]  off      offset in the file to write to
+ *
+ * @return number of bytes written on success
+ * @return <0 on error
+ */
+static inline ssize_t vfs_pwrite(int fd, const void *src, size_t count, off_t off)
+{
+    const iolist_t iol = { .iol_base = (void *)src, .iol_len = count };
+
+    return vfs_pwritev(fd, &iol, off);
+}
+
 /**
  * @brief Synchronize a file on storage
  *        Any pending writes are written out to storage.
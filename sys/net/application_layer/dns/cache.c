@@ -15,8 +15,12 @@
  * @}
  */
 
-#include "bitfield.h"
+#include <assert.h>
+#include <errno.h>
+#include <string.h>
+
 #include "checksum/fletcher32.h"
+#include "cond.h"
 #include "mutex.h"
 #include "net/af.h"
 #include "net/dns/cache.h"
@@ -28,6 +32,11 @@
 #define ENABLE_DEBUG 0
 #include "debug.h"
 
+/* entry length of an unused entry */
+#define LEN_UNUSED      (0U)
+/* entry length of a negative entry, address entries use the address length */
+#define LEN_NEGATIVE    (1U)
+
 static struct dns_cache_entry {
     uint32_t hash;
     uint32_t expires;
@@ -40,60 +49,23 @@ static struct dns_cache_entry {
 #endif
     } addr;
 } cache[CONFIG_DNS_CACHE_SIZE];
+/* length of the address of each entry or LEN_UNUSED / LEN_NEGATIVE */
+static uint8_t cache_len[CONFIG_DNS_CACHE_SIZE];
+/* entries are chained by hash, both hold an entry index + 1, 0 ends a chain */
+static uint8_t cache_bucket[CONFIG_DNS_CACHE_SIZE];
+static uint8_t cache_next[CONFIG_DNS_CACHE_SIZE];
+static_assert(CONFIG_DNS_CACHE_SIZE < UINT8_MAX,
+              "CONFIG_DNS_CACHE_SIZE too large for the 8 bit entry chains");
 static mutex_t cache_mutex = MUTEX_INIT;
 
-#if IS_ACTIVE(CONFIG_DNS_CACHE_A) && IS_ACTIVE(CONFIG_DNS_CACHE_AAAA)
-BITFIELD(cache_is_v6, CONFIG_DNS_CACHE_SIZE);
-
-static inline uint8_t _get_len(unsigned idx)
-{
-    return bf_isset(cache_is_v6, idx) ? 16 : 4;
-}
-#elif IS_ACTIVE(CONFIG_DNS_CACHE_A)
-static inline uint8_t _get_len(unsigned idx)
-{
-    (void)idx;
-    return 4;
-}
-#elif IS_ACTIVE(CONFIG_DNS_CACHE_AAAA)
-static inline uint8_t _get_len(unsigned idx)
-{
-    (void)idx;
-    return 16;
-}
-#endif
-
-static void _set_len(unsigned idx, uint8_t len)
-{
-#if IS_ACTIVE(CONFIG_DNS_CACHE_A) && IS_ACTIVE(CONFIG_DNS_CACHE_AAAA)
-    if (len == 16) {
-        bf_set(cache_is_v6, idx);
-    } else {
-        bf_unset(cache_is_v6, idx);
-    }
-#else
-    (void)idx;
-    (void)len;
-#endif
-}
-
-static bool _is_empty(unsigned idx)
-{
-    const uint8_t len = _get_len(idx);
-    const uint8_t *addr = (void *)&cache[idx].addr;
-    for (unsigned i = 0; i < len; ++i) {
-        if (addr[i]) {
-            return false;
-        }
-    }
-
-    return true;
-}
+/* queries in flight, holding the address length + 1, 0 marks an unused slot */
+static struct {
+    uint32_t hash;
+    uint8_t addr_len;
+} pending[CONFIG_DNS_CACHE_PENDING_NUMOF];
+static cond_t pending_cond = COND_INIT;
 
-static void _set_empty(unsigned idx)
-{
-    memset(&cache[idx].addr, 0, _get_len(idx));
-}
+static dns_cache_stats_t stats;
 
 static uint8_t _addr_len(int family)
 {
@@ -118,78 +90,185 @@ static uint32_t _hash(const void *data, size_t len)
     return fletcher32(data, (len + 1) / 2);
 }
 
-int dns_cache_query(const char *domain_name, void *addr_out, int family)
+static uint32_t _now(void)
 {
-    int res = 0;
-    uint32_t now = ztimer_now(ZTIMER_MSEC) / MS_PER_SEC;
-    uint32_t hash = _hash(domain_name, strlen(domain_name));
-    uint8_t addr_len = _addr_len(family);
+    return ztimer_now(ZTIMER_MSEC) / MS_PER_SEC;
+}
+
+static bool _matches(unsigned i, uint32_t hash, uint8_t addr_len)
+{
+    /* a negative entry answers queries of any family */
+    return (cache[i].hash == hash) &&
+           (!addr_len || (cache_len[i] == LEN_NEGATIVE) ||
+            (cache_len[i] == addr_len));
+}
+
+/* returns the link to the first matching entry of the bucket of @p hash,
+ * the link holds 0 if there is none. Expired entries are removed on the way */
+static uint8_t *_find(uint32_t hash, uint8_t addr_len, uint32_t now)
+{
+    uint8_t *link = &cache_bucket[hash % CONFIG_DNS_CACHE_SIZE];
+
+    while (*link) {
+        unsigned i = *link - 1;
 
-    mutex_lock(&cache_mutex);
-    for (unsigned i = 0; i < CONFIG_DNS_CACHE_SIZE; ++i) {
-        /* empty slot */
-        if (_is_empty(i)) {
-            continue;
-        }
-        /* TTL expired - invalidate slot */
         if (now > cache[i].expires) {
             DEBUG("dns_cache[%u] expired\n", i);
-            _set_empty(i);
+            *link = cache_next[i];
+            cache_len[i] = LEN_UNUSED;
             continue;
         }
-        /* check if hash and length match */
-        if (cache[i].hash == hash && (!addr_len || addr_len == _get_len(i))) {
-            DEBUG("dns_cache[%u] hit\n", i);
-            memcpy(addr_out, &cache[i].addr, _get_len(i));
-            res = _get_len(i);
+        if (_matches(i, hash, addr_len)) {
             break;
         }
+        link = &cache_next[i];
+    }
+    return link;
+}
+
+static void _remove(unsigned i)
+{
+    uint8_t *link = &cache_bucket[cache[i].hash % CONFIG_DNS_CACHE_SIZE];
+
+    while (*link != i + 1) {
+        link = &cache_next[*link - 1];
+    }
+    *link = cache_next[i];
+    cache_len[i] = LEN_UNUSED;
+}
+
+static int _query(uint32_t hash, void *addr_out, uint8_t addr_len)
+{
+    uint8_t *link = _find(hash, addr_len, _now());
+
+    if (!*link) {
+        return 0;
+    }
+
+    unsigned i = *link - 1;
+
+    if (cache_len[i] == LEN_NEGATIVE) {
+        DEBUG("dns_cache[%u] negative hit\n", i);
+        return -ENOENT;
     }
-    if (res == 0) {
+    DEBUG("dns_cache[%u] hit\n", i);
+    memcpy(addr_out, &cache[i].addr, cache_len[i]);
+    return cache_len[i];
+}
+
+static void _count(int res)
+{
+    if (res > 0) {
+        stats.hits++;
+    }
+    else if (res < 0) {
+        stats.negative_hits++;
+    }
+    else {
         DEBUG("dns_cache miss\n");
+        stats.misses++;
     }
+}
+
+int dns_cache_query(const char *domain_name, void *addr_out, int family)
+{
+    uint32_t hash = _hash(domain_name, strlen(domain_name));
+    int res;
+
+    mutex_lock(&cache_mutex);
+    res = _query(hash, addr_out, _addr_len(family));
+    _count(res);
     mutex_unlock(&cache_mutex);
     return res;
 }
 
-static void _add_entry(uint8_t i, uint32_t hash, const void *addr_out,
-                       int addr_len, uint32_t expires)
+static int _pending_find(uint32_t hash, uint8_t pending_len)
 {
-    DEBUG("dns_cache[%u] add cache entry\n", i);
-    cache[i].hash = hash;
-    cache[i].expires = expires;
-    memcpy(&cache[i].addr, addr_out, addr_len);
-    _set_len(i, addr_len);
+    for (unsigned i = 0; i < CONFIG_DNS_CACHE_PENDING_NUMOF; i++) {
+        if (pending[i].addr_len && (pending[i].addr_len == pending_len) &&
+            (pending[i].hash == hash)) {
+            return i;
+        }
+    }
+    return -1;
 }
 
-void dns_cache_add(const char *domain_name, const void *addr_out,
-                        int addr_len, uint32_t ttl)
+int dns_cache_query_claim(const char *domain_name, void *addr_out, int family)
 {
-    uint32_t now = ztimer_now(ZTIMER_MSEC) / MS_PER_SEC;
     uint32_t hash = _hash(domain_name, strlen(domain_name));
+    uint8_t addr_len = _addr_len(family);
+    uint8_t pending_len = addr_len + 1;
+    bool waited = false;
+    int res;
+
+    mutex_lock(&cache_mutex);
+    while ((res = _query(hash, addr_out, addr_len)) == 0) {
+        if (_pending_find(hash, pending_len) < 0) {
+            /* no query in flight (anymore), the caller resolves the name */
+            for (unsigned i = 0; i < CONFIG_DNS_CACHE_PENDING_NUMOF; i++) {
+                if (!pending[i].addr_len) {
+                    pending[i].hash = hash;
+                    pending[i].addr_len = pending_len;
+                    break;
+                }
+            }
+            break;
+        }
+        if (!waited) {
+            DEBUG("dns_cache: wait for query in flight\n");
+            stats.coalesced++;
+            waited = true;
+        }
+        cond_wait(&pending_cond, &cache_mutex);
+    }
+    _count(res);
+    mutex_unlock(&cache_mutex);
+    return res;
+}
+
+void dns_cache_release(const char *domain_name, int family)
+{
+    uint32_t hash = _hash(domain_name, strlen(domain_name));
+    uint8_t addr_len = _addr_len(family);
+    int i;
+
+    mutex_lock(&cache_mutex);
+    i = _pending_find(hash, addr_len + 1);
+    if (i >= 0) {
+        pending[i].addr_len = 0;
+        cond_broadcast(&pending_cond);
+    }
+    mutex_unlock(&cache_mutex);
+}
+
+static void _add(uint32_t hash, const void *addr, uint8_t len, uint32_t ttl)
+{
+    uint32_t now = _now();
     uint32_t oldest = ttl;
     int idx = -1;
-
-    assert(addr_len == 4 || addr_len == 16);
-    DEBUG("dns_cache: lifetime of %s is %"PRIu32" s\n", domain_name, ttl);
+    uint8_t *link;
 
     mutex_lock(&cache_mutex);
-    /* iterate even if TTL = 0 just in case we need to expire */
+    /* drop the entry this one replaces, a negative entry replaces all
+     * entries of the name and is replaced by any address */
+    while (*(link = _find(hash, len == LEN_NEGATIVE ? 0 : len, now))) {
+        unsigned i = *link - 1;
+
+        DEBUG("dns_cache[%u] replace\n", i);
+        *link = cache_next[i];
+        cache_len[i] = LEN_UNUSED;
+    }
+    if (!ttl) {
+        goto exit;
+    }
+
     for (unsigned i = 0; i < CONFIG_DNS_CACHE_SIZE; ++i) {
-        if (ttl && (now > cache[i].expires || _is_empty(i))) {
-            _add_entry(i, hash, addr_out, addr_len, now + ttl);
-            goto exit;
-        }
-        if (cache[i].hash == hash && _get_len(i) == addr_len) {
-            DEBUG("dns_cache[%u] update ttl\n", i);
-            if (ttl) {
-                cache[i].expires = now + ttl;
+        if ((cache_len[i] == LEN_UNUSED) || (now > cache[i].expires)) {
+            if (cache_len[i] != LEN_UNUSED) {
+                _remove(i);
             }
-            else {
-                /* put one second into past so that it is immediately expired */
-                cache[i].expires = now - 1;
-            }
-            goto exit;
+            idx = i;
+            break;
         }
         uint32_t _ttl = cache[i].expires - now;
         if (_ttl < oldest) {
@@ -197,11 +276,49 @@ void dns_cache_add(const char *domain_name, const void *addr_out,
             idx = i;
         }
     }
-
-    if (ttl && idx >= 0) {
+    if (idx < 0) {
+        DEBUG("dns_cache: all entries outlive the new one\n");
+        goto exit;
+    }
+    if (cache_len[idx] != LEN_UNUSED) {
         DEBUG("dns_cache: evict first entry to expire\n");
-        _add_entry(idx, hash, addr_out, addr_len, now + ttl);
+        stats.evictions++;
+        _remove(idx);
     }
+
+    DEBUG("dns_cache[%d] add cache entry\n", idx);
+    cache[idx].hash = hash;
+    cache[idx].expires = now + ttl;
+    if (len != LEN_NEGATIVE) {
+        memcpy(&cache[idx].addr, addr, len);
+    }
+    cache_len[idx] = len;
+    link = &cache_bucket[hash % CONFIG_DNS_CACHE_SIZE];
+    cache_next[idx] = *link;
+    *link = idx + 1;
 exit:
     mutex_unlock(&cache_mutex);
 }
+
+void dns_cache_add(const char *domain_name, const void *addr_out,
+                        int addr_len, uint32_t ttl)
+{
+    assert(addr_len == 4 || addr_len == 16);
+    DEBUG("dns_cache: lifetime of %s is %"PRIu32" s\n", domain_name, ttl);
+
+    _add(_hash(domain_name, strlen(domain_name)), addr_out, addr_len, ttl);
+}
+
+void dns_cache_add_negative(const char *domain_name, uint32_t ttl)
+{
+    DEBUG("dns_cache: %s does not exist for %"PRIu32" s\n", domain_name, ttl);
+
+    _add(_hash(domain_name, strlen(domain_name)), NULL, LEN_NEGATIVE, ttl);
+}
+
+void dns_cache_get_stats(dns_cache_stats_t *out)
+{
+    mutex_lock(&cache_mutex);
+    *out = stats;
+    mutex_unlock(&cache_mutex);
+}
@@ -137,6 +137,10 @@ int dns_msg_parse_reply(const uint8_t *buf, size_t len, int family,
     const dns_hdr_t *hdr = (dns_hdr_t *)buf;
     const uint8_t *bufpos = buf + sizeof(*hdr);
 
+    if ((ntohs(hdr->flags) & DNS_RCODE_MASK) == DNS_RCODE_NAME_ERROR) {
+        return -ENOENT;
+    }
+
     /* skip all queries that are part of the reply */
     for (unsigned n = 0; n < ntohs(hdr->qdcount); n++) {
         ssize_t tmp = _skip_hostname(buf, len, bufpos);
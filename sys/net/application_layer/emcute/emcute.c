@@ -21,6 +21,7 @@
 #include <assert.h>
 #include <string.h>
 
+#include "cond.h"
 #include "log.h"
 #include "mutex.h"
 #include "sched.h"
@@ -44,6 +45,8 @@
 #define TFLAGS_TIMEOUT      (0x0002)
 #define TFLAGS_ANY          (TFLAGS_RESP | TFLAGS_TIMEOUT)
 
+#define RETRY_TO            (CONFIG_EMCUTE_T_RETRY * US_PER_SEC)
+
 static const char *cli_id;
 static sock_udp_t sock;
 static sock_udp_ep_t gateway;
@@ -61,6 +64,30 @@ static volatile uint8_t waiton = 0xff;
 static volatile uint16_t waitonid = 0;
 static volatile int result;
 
+#if IS_USED(MODULE_EMCUTE_PUBQ)
+typedef struct {
+    uint8_t buf[CONFIG_EMCUTE_PUBQ_BUFSIZE];
+    uint32_t deadline;      /* time of the next retransmission in us */
+    uint16_t len;           /* length of the message, 0 for unused slots */
+    uint16_t id;            /* message ID the PUBACK must carry */
+    uint8_t retries;        /* retransmissions left */
+    uint8_t flags_pos;      /* position of the flags field in buf */
+} pubq_slot_t;
+
+static pubq_slot_t pubq[CONFIG_EMCUTE_PUBQ_WINDOW];
+static mutex_t pubq_lock = MUTEX_INIT;
+static cond_t pubq_cond = COND_INIT;
+/* first error of the messages queued since the last emcute_pub_flush() */
+static int pubq_res = EMCUTE_OK;
+
+/* topic IDs assigned by the gateway, guarded by txlock */
+static struct {
+    char name[CONFIG_EMCUTE_TOPIC_CACHE_NAMELEN + 1];
+    uint16_t id;
+} topic_cache[CONFIG_EMCUTE_TOPIC_CACHE_SIZE];
+static unsigned topic_cache_next;
+#endif
+
 static size_t set_len(uint8_t *buf, size_t len)
 {
     /* - `len` field minimum length == 1
@@ -71,7 +98,7 @@ static size_t set_len(uint8_t *buf, size_t len)
     }
     else {
         buf[0] = 0x01;
-        byteorder_htobebufs(&tbuf[1], (uint16_t)(len + 3));
+        byteorder_htobebufs(&buf[1], (uint16_t)(len + 3));
         return 3;
     }
 }
@@ -212,6 +239,156 @@ static void send_ping(void)
     }
 }
 
+#if IS_USED(MODULE_EMCUTE_PUBQ)
+/* @pre pubq_lock is held */
+static void pubq_fail(pubq_slot_t *slot, int res)
+{
+    slot->len = 0;
+    if (pubq_res == EMCUTE_OK) {
+        pubq_res = res;
+    }
+    cond_broadcast(&pubq_cond);
+}
+
+static void pubq_drop(void)
+{
+    mutex_lock(&pubq_lock);
+    for (unsigned i = 0; i < CONFIG_EMCUTE_PUBQ_WINDOW; i++) {
+        if (pubq[i].len) {
+            pubq_fail(&pubq[i], EMCUTE_NOGW);
+        }
+    }
+    mutex_unlock(&pubq_lock);
+}
+
+static bool pubq_on_puback(void)
+{
+    uint16_t id = byteorder_bebuftohs(&rbuf[4]);
+    bool found = false;
+
+    mutex_lock(&pubq_lock);
+    for (unsigned i = 0; i < CONFIG_EMCUTE_PUBQ_WINDOW; i++) {
+        if (pubq[i].len && (pubq[i].id == id)) {
+            DEBUG("[emcute] pubq: PUBACK for message %u\n", (unsigned)id);
+            if (rbuf[6] != ACCEPT) {
+                pubq_fail(&pubq[i], EMCUTE_REJECT);
+            }
+            else {
+                pubq[i].len = 0;
+                cond_broadcast(&pubq_cond);
+            }
+            found = true;
+            break;
+        }
+    }
+    mutex_unlock(&pubq_lock);
+    return found;
+}
+
+/* retransmits due messages and returns the time until the next one is due,
+ * at most @p t_out */
+static uint32_t pubq_process(uint32_t now, uint32_t t_out)
+{
+    /* messages queued while the emCute thread waits are only noticed when
+     * it wakes up */
+    t_out = (t_out < RETRY_TO) ? t_out : RETRY_TO;
+
+    mutex_lock(&pubq_lock);
+    for (unsigned i = 0; i < CONFIG_EMCUTE_PUBQ_WINDOW; i++) {
+        pubq_slot_t *slot = &pubq[i];
+
+        if (!slot->len) {
+            continue;
+        }
+        if ((int32_t)(slot->deadline - now) <= 0) {
+            if (!slot->retries) {
+                DEBUG("[emcute] pubq: message %u timed out\n", (unsigned)slot->id);
+                pubq_fail(slot, EMCUTE_TIMEOUT);
+                continue;
+            }
+            slot->retries--;
+            slot->buf[slot->flags_pos] |= EMCUTE_DUP;
+            slot->deadline = now + RETRY_TO;
+            sock_udp_send(&sock, slot->buf, slot->len, &gateway);
+        }
+        if ((slot->deadline - now) < t_out) {
+            t_out = slot->deadline - now;
+        }
+    }
+    mutex_unlock(&pubq_lock);
+    return t_out;
+}
+
+/* @pre txlock is held */
+static bool topic_cache_get(emcute_topic_t *topic)
+{
+    for (unsigned i = 0; i < CONFIG_EMCUTE_TOPIC_CACHE_SIZE; i++) {
+        if (topic_cache[i].id && !strcmp(topic_cache[i].name, topic->name)) {
+            topic->id = topic_cache[i].id;
+            return true;
+        }
+    }
+    return false;
+}
+
+/* @pre txlock is held */
+static void topic_cache_put(const emcute_topic_t *topic)
+{
+    size_t len = strlen(topic->name);
+
+    if (len > CONFIG_EMCUTE_TOPIC_CACHE_NAMELEN) {
+        return;
+    }
+    memcpy(topic_cache[topic_cache_next].name, topic->name, len + 1);
+    topic_cache[topic_cache_next].id = topic->id;
+    topic_cache_next = (topic_cache_next + 1) % CONFIG_EMCUTE_TOPIC_CACHE_SIZE;
+}
+
+/* @pre txlock is held */
+static void topic_cache_clear(void)
+{
+    memset(topic_cache, 0, sizeof(topic_cache));
+}
+#else
+static void pubq_drop(void)
+{
+}
+
+static bool pubq_on_puback(void)
+{
+    return false;
+}
+
+static uint32_t pubq_process(uint32_t now, uint32_t t_out)
+{
+    (void)now;
+    return t_out;
+}
+
+static bool topic_cache_get(emcute_topic_t *topic)
+{
+    (void)topic;
+    return false;
+}
+
+static void topic_cache_put(const emcute_topic_t *topic)
+{
+    (void)topic;
+}
+
+static void topic_cache_clear(void)
+{
+}
+#endif
+
+static void on_puback(void)
+{
+    /* PUBACKs of queued messages are not waited for by syncsend() */
+    if (!pubq_on_puback()) {
+        on_ack(PUBACK, 4, 6, 0);
+    }
+}
+
 int emcute_con(sock_udp_ep_t *remote, bool clean, const char *will_topic,
                const void *will_msg, size_t will_msg_len, unsigned will_flags)
 {
@@ -227,6 +404,8 @@ int emcute_con(sock_udp_ep_t *remote, bool clean, const char *will_topic,
         return EMCUTE_NOGW;
     }
     memcpy(&gateway, remote, sizeof(sock_udp_ep_t));
+    /* topic IDs are only valid for the session they were assigned in */
+    topic_cache_clear();
 
     /* figure out which flags to set */
     uint8_t flags = (clean) ? EMCUTE_CS : 0;
@@ -296,7 +475,9 @@ int emcute_discon(void)
     tbuf[0] = 2;
     tbuf[1] = DISCONNECT;
 
-    return syncsend(DISCONNECT, 2, true);
+    int res = syncsend(DISCONNECT, 2, true);
+    pubq_drop();
+    return res;
 }
 
 int emcute_reg(emcute_topic_t *topic)
@@ -312,6 +493,11 @@ int emcute_reg(emcute_topic_t *topic)
 
     mutex_lock(&txlock);
 
+    if (topic_cache_get(topic)) {
+        mutex_unlock(&txlock);
+        return EMCUTE_OK;
+    }
+
     tbuf[0] = (strlen(topic->name) + 6);
     tbuf[1] = REGISTER;
     byteorder_htobebufs(&tbuf[2], 0);
@@ -319,11 +505,13 @@ int emcute_reg(emcute_topic_t *topic)
     waitonid = id_next++;
     memcpy(&tbuf[6], topic->name, strlen(topic->name));
 
-    int res = syncsend(REGACK, (size_t)tbuf[0], true);
+    int res = syncsend(REGACK, (size_t)tbuf[0], false);
     if (res > 0) {
         topic->id = (uint16_t)res;
+        topic_cache_put(topic);
         res = EMCUTE_OK;
     }
+    mutex_unlock(&txlock);
     return res;
 }
 
@@ -374,6 +562,87 @@ int emcute_pub(emcute_topic_t *topic, const void *data, size_t len,
     return res;
 }
 
+#if IS_USED(MODULE_EMCUTE_PUBQ)
+int emcute_pub_queue(emcute_topic_t *topic, const void *data, size_t len,
+                     unsigned flags)
+{
+    pubq_slot_t *slot = NULL;
+    uint16_t id;
+
+    assert((topic->id != 0) && data && (len > 0) && !(flags & ~PUB_FLAGS) &&
+           !(flags & EMCUTE_QOS_2));
+
+    if (!(flags & EMCUTE_QOS_1)) {
+        return emcute_pub(topic, data, len, flags);
+    }
+    if (gateway.port == 0) {
+        return EMCUTE_NOGW;
+    }
+    if ((len + 9) > CONFIG_EMCUTE_PUBQ_BUFSIZE) {
+        return EMCUTE_OVERFLOW;
+    }
+
+    /* message IDs are handed out under txlock, but txlock must not be held
+     * while waiting for a free slot */
+    mutex_lock(&txlock);
+    id = id_next++;
+    mutex_unlock(&txlock);
+
+    mutex_lock(&pubq_lock);
+    while (!slot) {
+        if (gateway.port == 0) {
+            mutex_unlock(&pubq_lock);
+            return EMCUTE_NOGW;
+        }
+        for (unsigned i = 0; i < CONFIG_EMCUTE_PUBQ_WINDOW; i++) {
+            if (!pubq[i].len) {
+                slot = &pubq[i];
+                break;
+            }
+        }
+        if (!slot) {
+            cond_wait(&pubq_cond, &pubq_lock);
+        }
+    }
+
+    size_t pos = set_len(slot->buf, (len + 6));
+    slot->buf[pos++] = PUBLISH;
+    slot->flags_pos = pos;
+    slot->buf[pos++] = flags;
+    byteorder_htobebufs(&slot->buf[pos], topic->id);
+    pos += 2;
+    byteorder_htobebufs(&slot->buf[pos], id);
+    pos += 2;
+    memcpy(&slot->buf[pos], data, len);
+
+    slot->len = pos + len;
+    slot->id = id;
+    slot->retries = CONFIG_EMCUTE_N_RETRY;
+    slot->deadline = xtimer_now_usec() + RETRY_TO;
+    sock_udp_send(&sock, slot->buf, slot->len, &gateway);
+    mutex_unlock(&pubq_lock);
+
+    return EMCUTE_OK;
+}
+
+int emcute_pub_flush(void)
+{
+    int res;
+
+    mutex_lock(&pubq_lock);
+    for (unsigned i = 0; i < CONFIG_EMCUTE_PUBQ_WINDOW; i++) {
+        while (pubq[i].len) {
+            cond_wait(&pubq_cond, &pubq_lock);
+        }
+    }
+    res = pubq_res;
+    pubq_res = EMCUTE_OK;
+    mutex_unlock(&pubq_lock);
+
+    return res;
+}
+#endif
+
 int emcute_sub(emcute_sub_t *sub, unsigned flags)
 {
     assert(sub && (sub->cb) && (sub->topic.name) && !(flags & ~SUB_FLAGS));
@@ -547,7 +816,7 @@ void emcute_run(uint16_t port, const char *id)
                 case WILLMSGREQ:    on_ack(type, 0, 0, 0);              break;
                 case REGACK:        on_ack(type, 4, 6, 2);              break;
                 case PUBLISH:       on_publish((size_t)pkt_len, pos);   break;
-                case PUBACK:        on_ack(type, 4, 6, 0);              break;
+                case PUBACK:        on_puback();                        break;
                 case SUBACK:        on_ack(type, 5, 7, 3);              break;
                 case UNSUBACK:      on_ack(type, 2, 0, 0);              break;
                 case PINGREQ:       on_pingreq(&remote);                break;
@@ -570,5 +839,6 @@ void emcute_run(uint16_t port, const char *id)
         else {
             t_out = (CONFIG_EMCUTE_KEEPALIVE * US_PER_SEC) - (now - start);
         }
+        t_out = pubq_process(now, t_out);
     }
 }
@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2023 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @addtogroup  net_gcoap
+ * @internal
+ * @{
+ *
+ * @file
+ * @brief       Chained hash index over the tables of gcoap
+ *
+ * An index maps hashes to the entries of a table, so a packet is matched
+ * without scanning the whole table. Entries with the same hash are chained
+ * through their table index. A table with n entries has n buckets. Entries
+ * and buckets are stored plus one, so zeroed memory is an empty index.
+ */
+#ifndef PRIV_GCOAP_INDEX_H
+#define PRIV_GCOAP_INDEX_H
+
+#include <limits.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   Returned by _index_first() and _index_next() after the last entry
+ */
+#define INDEX_NONE              (UINT_MAX)
+
+/**
+ * @brief   Hash index over a table
+ */
+typedef struct {
+    uint16_t *heads;                    /**< first entry per bucket */
+    uint16_t *next;                     /**< next entry in the same bucket */
+    uint16_t *bucket;                   /**< bucket of an entry, 0 if unlinked */
+    uint16_t numof;                     /**< number of buckets and entries */
+} _index_t;
+
+/**
+ * @brief   Unlinks all entries
+ *
+ * @param[in] index     index to reset
+ */
+static inline void _index_reset(const _index_t *index)
+{
+    memset(index->heads, 0, index->numof * sizeof(uint16_t));
+    memset(index->bucket, 0, index->numof * sizeof(uint16_t));
+}
+
+/**
+ * @brief   Unlinks an entry, if it is linked
+ *
+ * @param[in] index     index to remove the entry from
+ * @param[in] entry     table index of the entry
+ */
+static inline void _index_del(const _index_t *index, unsigned entry)
+{
+    if (index->bucket[entry] == 0) {
+        return;
+    }
+
+    uint16_t *pos = &index->heads[index->bucket[entry] - 1];
+    while (*pos != entry + 1) {
+        pos = &index->next[*pos - 1];
+    }
+    *pos = index->next[entry];
+    index->bucket[entry] = 0;
+}
+
+/**
+ * @brief   Links an entry under a hash, replacing its previous hash
+ *
+ * @param[in] index     index to add the entry to
+ * @param[in] entry     table index of the entry
+ * @param[in] hash      hash of the entry
+ */
+static inline void _index_add(const _index_t *index, unsigned entry, uint32_t hash)
+{
+    unsigned bucket = hash % index->numof;
+
+    _index_del(index, entry);
+    index->next[entry] = index->heads[bucket];
+    index->heads[bucket] = entry + 1;
+    index->bucket[entry] = bucket + 1;
+}
+
+/**
+ * @brief   Gets the first entry that may match a hash
+ *
+ * The entries returned by this and _index_next() share the bucket of
+ * @p hash, the caller has to compare them with what it looks for.
+ *
+ * @param[in] index     index to search
+ * @param[in] hash      hash to look up
+ *
+ * @return  table index of the entry, INDEX_NONE if there is none
+ */
+static inline unsigned _index_first(const _index_t *index, uint32_t hash)
+{
+    return index->heads[hash % index->numof] - 1;
+}
+
+/**
+ * @brief   Gets the next entry in the bucket of an entry
+ *
+ * @param[in] index     index to search
+ * @param[in] entry     entry returned by _index_first() or _index_next()
+ *
+ * @return  table index of the entry, INDEX_NONE if there is none
+ */
+static inline unsigned _index_next(const _index_t *index, unsigned entry)
+{
+    return index->next[entry] - 1;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PRIV_GCOAP_INDEX_H */
+/** @} */
@@ -124,7 +124,8 @@ int gcoap_dns_query(const char *domain_name, void *addr_out, int family)
 {
     int res;
 
-    if ((res = dns_cache_query(domain_name, addr_out, family)) > 0) {
+    /* waits for the same query issued by another thread */
+    if ((res = dns_cache_query_claim(domain_name, addr_out, family)) != 0) {
         return res;
     }
 
@@ -148,6 +149,7 @@ int gcoap_dns_query(const char *domain_name, void *addr_out, int family)
         res = req_ctx.res;
     }
     mutex_unlock(&_client_mutex);
+    dns_cache_release(domain_name, family);
     return res;
 }
 
@@ -745,6 +747,10 @@ static void _resp_handler(const gcoap_request_memo_t *memo, coap_pkt_t *pdu,
                 ttl += max_age;
                 dns_cache_add(_domain_name_from_ctx(context), context->addr_out, context->res, ttl);
             }
+            else if (context->res == -ENOENT) {
+                dns_cache_add_negative(_domain_name_from_ctx(context),
+                                       CONFIG_DNS_CACHE_NEGATIVE_TTL);
+            }
             else if (ENABLE_DEBUG && (context->res < 0)) {
                 DEBUG("gcoap_dns: Unable to parse DNS reply: %d\n",
                       context->res);
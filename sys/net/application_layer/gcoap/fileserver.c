@@ -27,6 +27,11 @@
 #include "net/gcoap.h"
 #include "vfs.h"
 #include "vfs_util.h"
+#if IS_USED(MODULE_GCOAP_FILESERVER_FILE_CACHE)
+#include "compiler_hints.h"
+#include "container.h"
+#include "ztimer.h"
+#endif
 
 #define ENABLE_DEBUG 0
 #include "debug.h"
@@ -72,6 +77,29 @@ struct requestdata {
     struct requestoptions options;
 };
 
+/** A file opened to serve a GET request */
+typedef struct {
+    int fd;                 /**< file descriptor, negative if not yet opened */
+    uint32_t etag;          /**< ETag of the file */
+    off_t size;             /**< size of the file */
+    off_t pos;              /**< current position of @ref fd */
+} _file_t;
+
+#if IS_USED(MODULE_GCOAP_FILESERVER_FILE_CACHE)
+/** An entry of the open file cache */
+typedef struct {
+    _file_t file;                           /**< the open file */
+    char path[COAPFILESERVER_PATH_MAX];     /**< VFS path, empty if unused */
+    uint32_t validated;                     /**< time of the last vfs_stat() */
+    uint32_t used;                          /**< time of the last request */
+} _file_cache_entry_t;
+
+/**
+ * @brief   Open file cache, only accessed from the handler thread
+ */
+static _file_cache_entry_t _file_cache[CONFIG_GCOAP_FILESERVER_FILE_CACHE_NUMOF];
+#endif
+
 /**
  * @brief  Return true if path/name is a directory.
  */
@@ -126,6 +154,138 @@ static void stat_etag(struct stat *stat, uint32_t *etag)
     *etag = fletcher32((void *)stat, sizeof(*stat) / 2);
 }
 
+#if IS_USED(MODULE_GCOAP_FILESERVER_FILE_CACHE)
+static void _file_cache_close(_file_cache_entry_t *entry)
+{
+    if (entry->path[0]) {
+        DEBUG("gcoap_fileserver: closing cached file %s\n", entry->path);
+        vfs_close(entry->file.fd);
+        entry->path[0] = '\0';
+    }
+}
+
+/** Closes the cached files at path and below */
+MAYBE_UNUSED
+static void _file_cache_invalidate(const char *path)
+{
+    size_t len = strlen(path);
+
+    for (unsigned i = 0; i < ARRAY_SIZE(_file_cache); i++) {
+        _file_cache_entry_t *entry = &_file_cache[i];
+        if (!strncmp(entry->path, path, len) &&
+            ((entry->path[len] == '\0') || (entry->path[len] == '/'))) {
+            _file_cache_close(entry);
+        }
+    }
+}
+
+/** Gets the file for path from the cache, opens it if needed */
+static int _file_get(const char *path, _file_t *local, _file_t **file)
+{
+    uint32_t now = ztimer_now(ZTIMER_MSEC);
+    _file_cache_entry_t *hit = NULL;
+    _file_cache_entry_t *victim = NULL;
+    struct stat stat;
+    int err;
+
+    (void)local;
+
+    for (unsigned i = 0; i < ARRAY_SIZE(_file_cache); i++) {
+        _file_cache_entry_t *entry = &_file_cache[i];
+        if (entry->path[0] &&
+            (now - entry->used > CONFIG_GCOAP_FILESERVER_FILE_CACHE_TIMEOUT_MS)) {
+            _file_cache_close(entry);
+        }
+        if (entry->path[0] && !strcmp(entry->path, path)) {
+            hit = entry;
+        }
+        /* reuse a free entry or the least recently used one */
+        if (!victim || (victim->path[0] &&
+                        (!entry->path[0] || (now - entry->used > now - victim->used)))) {
+            victim = entry;
+        }
+    }
+
+    if (hit && (now - hit->validated <= CONFIG_GCOAP_FILESERVER_FILE_CACHE_TIMEOUT_MS)) {
+        hit->used = now;
+        *file = &hit->file;
+        return 0;
+    }
+
+    if ((err = vfs_stat(path, &stat)) < 0) {
+        return err;
+    }
+    uint32_t etag;
+    stat_etag(&stat, &etag);
+    if (hit) {
+        if (hit->file.etag == etag) {
+            hit->file.size = stat.st_size;
+            hit->validated = now;
+            hit->used = now;
+            *file = &hit->file;
+            return 0;
+        }
+        /* file changed, open it again */
+        _file_cache_close(hit);
+        victim = hit;
+    }
+
+    int fd = vfs_open(path, O_RDONLY, 0);
+    if (fd < 0) {
+        return fd;
+    }
+    _file_cache_close(victim);
+    DEBUG("gcoap_fileserver: caching file %s\n", path);
+    victim->file.fd = fd;
+    victim->file.etag = etag;
+    victim->file.size = stat.st_size;
+    victim->file.pos = 0;
+    strcpy(victim->path, path);
+    victim->validated = now;
+    victim->used = now;
+    *file = &victim->file;
+
+    return 0;
+}
+
+/** Releases a file obtained by _file_get(), drops it from the cache on error */
+static void _file_put(_file_t *file, bool failed)
+{
+    if (failed) {
+        _file_cache_close(container_of(file, _file_cache_entry_t, file));
+    }
+}
+#else
+static inline void _file_cache_invalidate(const char *path)
+{
+    (void)path;
+}
+
+/** Gets the ETag of the file at path, the file is opened later */
+static int _file_get(const char *path, _file_t *local, _file_t **file)
+{
+    struct stat stat;
+    int err;
+
+    if ((err = vfs_stat(path, &stat)) < 0) {
+        return err;
+    }
+    stat_etag(&stat, &local->etag);
+    local->size = stat.st_size;
+    local->fd = -1;
+    *file = local;
+
+    return 0;
+}
+
+/** Closes a file obtained by _file_get() */
+static void _file_put(_file_t *file, bool failed)
+{
+    (void)failed;
+    vfs_close(file->fd);
+}
+#endif
+
 /** Create a CoAP response for a given errno (eg. EACCESS -> 4.03 Forbidden
  * etc., defaulting to 5.03 Internal Server Error), or interpret a positive
  * value for err as a CoAP response code */
@@ -185,47 +345,53 @@ static ssize_t _get_file(coap_pkt_t *pdu, uint8_t *buf, size_t len,
                          struct requestdata *request)
 {
     int err;
-    uint32_t etag;
+    _file_t local;
+    _file_t *file;
     coap_block1_t block2 = { .szx = CONFIG_NANOCOAP_BLOCK_SIZE_EXP_MAX };
-    {
-        struct stat stat;
-        if ((err = vfs_stat(request->namebuf, &stat)) < 0) {
-            return gcoap_fileserver_error_handler(pdu, buf, len, err);
-        }
-        stat_etag(&stat, &etag);
+
+    if ((err = _file_get(request->namebuf, &local, &file)) < 0) {
+        return gcoap_fileserver_error_handler(pdu, buf, len, err);
     }
     if (request->options.exists.block2 && !coap_get_block2(pdu, &block2)) {
         return gcoap_fileserver_error_handler(pdu, buf, len, COAP_CODE_BAD_OPTION);
     }
     if (request->options.exists.if_match &&
-        memcmp(&etag, &request->options.if_match, request->options.if_match_len)) {
+        memcmp(&file->etag, &request->options.if_match, request->options.if_match_len)) {
         return gcoap_fileserver_error_handler(pdu, buf, len, COAP_CODE_PRECONDITION_FAILED);
     }
     if (request->options.exists.etag &&
-        !memcmp(&etag, &request->options.etag, sizeof(etag))) {
+        !memcmp(&file->etag, &request->options.etag, sizeof(file->etag))) {
         gcoap_resp_init(pdu, buf, len, COAP_CODE_VALID);
-        coap_opt_add_opaque(pdu, COAP_OPT_ETAG, &etag, sizeof(etag));
+        coap_opt_add_opaque(pdu, COAP_OPT_ETAG, &file->etag, sizeof(file->etag));
         return coap_opt_finish(pdu, COAP_OPT_FINISH_NONE);
     }
 
-    int fd = vfs_open(request->namebuf, O_RDONLY, 0);
-    if (fd < 0) {
-        return gcoap_fileserver_error_handler(pdu, buf, len, fd);
+    if (file->fd < 0) {
+        int fd = vfs_open(request->namebuf, O_RDONLY, 0);
+        if (fd < 0) {
+            return gcoap_fileserver_error_handler(pdu, buf, len, fd);
+        }
+        file->fd = fd;
+        file->pos = 0;
     }
 
     gcoap_resp_init(pdu, buf, len, COAP_CODE_CONTENT);
-    coap_opt_add_opaque(pdu, COAP_OPT_ETAG, &etag, sizeof(etag));
+    coap_opt_add_opaque(pdu, COAP_OPT_ETAG, &file->etag, sizeof(file->etag));
     coap_block_slicer_t slicer;
     _calc_szx2(pdu,
-               5 + 1 + 1 /* reserve BLOCK2 size + payload marker + more */,
+               5 + 1 /* reserve BLOCK2 size + payload marker */,
                &block2);
     coap_block_slicer_init(&slicer, block2.blknum, coap_szx2size(block2.szx));
     coap_opt_add_block2(pdu, &slicer, true);
     size_t resp_len = coap_opt_finish(pdu, COAP_OPT_FINISH_PAYLOAD);
 
-    err = vfs_lseek(fd, slicer.start, SEEK_SET);
-    if (err < 0) {
-        goto late_err;
+    /* consecutive blocks of a cached file need no seek */
+    if (file->pos != (off_t)slicer.start) {
+        err = vfs_lseek(file->fd, slicer.start, SEEK_SET);
+        if (err < 0) {
+            goto late_err;
+        }
+        file->pos = slicer.start;
     }
 
     if (block2.blknum == 0) {
@@ -239,15 +405,18 @@ static ssize_t _get_file(coap_pkt_t *pdu, uint8_t *buf, size_t len,
      * space by CONFIG_GCOAP_RESP_OPTIONS_BUF
      * */
     assert(pdu->payload + slicer.end - slicer.start <= buf + len);
-    bool more = 1;
-    int read = vfs_read(fd, pdu->payload, slicer.end - slicer.start + more);
+    /* the file is read right into the payload of the response, the size of
+     * the file tells if there is more, so the position ends at the end of the
+     * block and the next block is read without a seek */
+    int read = vfs_read(file->fd, pdu->payload, slicer.end - slicer.start);
     if (read < 0) {
         goto late_err;
     }
-    more = (unsigned)read > slicer.end - slicer.start;
-    read -= more;
+    file->pos += read;
+    bool more = ((unsigned)read == slicer.end - slicer.start) &&
+                (file->pos < file->size);
 
-    vfs_close(fd);
+    _file_put(file, false);
 
     slicer.cur = slicer.end + more;
     coap_block2_finish(&slicer);
@@ -264,7 +433,7 @@ static ssize_t _get_file(coap_pkt_t *pdu, uint8_t *buf, size_t len,
     return resp_len + read;
 
 late_err:
-    vfs_close(fd);
+    _file_put(file, true);
     coap_hdr_set_code(pdu->hdr, COAP_CODE_INTERNAL_SERVER_ERROR);
     return coap_get_total_hdr_len(pdu);
 }
@@ -277,6 +446,8 @@ static ssize_t _put_file(coap_pkt_t *pdu, uint8_t *buf, size_t len,
     uint32_t etag;
     struct stat stat;
     coap_block1_t block1 = {0};
+
+    _file_cache_invalidate(request->namebuf);
     bool create = (vfs_stat(request->namebuf, &stat) == -ENOENT);
     if (create) {
         /* While a file 'f' is initially being created,
@@ -339,11 +510,8 @@ static ssize_t _put_file(coap_pkt_t *pdu, uint8_t *buf, size_t len,
             ret = COAP_CODE_REQUEST_ENTITY_INCOMPLETE;
             goto close_on_error;
         }
-        if ((ret = vfs_lseek(fd, block1.offset, SEEK_SET)) < 0) {
-            goto close_on_error;
-        }
     }
-    if ((ret = vfs_write(fd, pdu->payload, pdu->payload_len)) < 0 ||
+    if ((ret = vfs_pwrite(fd, pdu->payload, pdu->payload_len, block1.offset)) < 0 ||
         (unsigned)ret != pdu->payload_len) {
         goto close_on_error;
     }
@@ -404,6 +572,7 @@ static ssize_t _delete_file(coap_pkt_t *pdu, uint8_t *buf, size_t len,
 
     _event_file(GCOAP_FILESERVER_DELETE_FILE, request);
 
+    _file_cache_invalidate(request->namebuf);
     if ((ret = vfs_unlink(request->namebuf)) < 0) {
         return gcoap_fileserver_error_handler(pdu, buf, len, ret);
     }
@@ -525,6 +694,8 @@ static ssize_t _delete_directory(coap_pkt_t *pdu, uint8_t *buf, size_t len,
                                  struct requestdata *request)
 {
     int err;
+
+    _file_cache_invalidate(request->namebuf);
     if (request->options.exists.if_match && request->options.if_match_len) {
         if (request->options.if_match != byteorder_htonl(COAPFILESERVER_DIR_DELETE_ETAG).u32) {
             return gcoap_fileserver_error_handler(pdu, buf, len, COAP_CODE_PRECONDITION_FAILED);
@@ -21,15 +21,18 @@
  */
 
 #include <errno.h>
+#include <limits.h>
 #include <stdint.h>
 #include <stdatomic.h>
 #include <string.h>
 
 #include "assert.h"
+#include "container.h"
 #include "net/coap.h"
 #include "net/gcoap.h"
 #include "net/gcoap/forward_proxy.h"
 #include "net/nanocoap/cache.h"
+#include "net/nanocoap/resource_index.h"
 #include "net/sock/async/event.h"
 #include "net/sock/util.h"
 #include "mutex.h"
@@ -37,6 +40,8 @@
 #include "thread.h"
 #include "ztimer.h"
 
+#include "_gcoap-index.h"
+
 #if IS_USED(MODULE_GCOAP_DTLS)
 #include "net/sock/dtls.h"
 #include "net/credman.h"
@@ -68,6 +73,7 @@ static void _cease_retransmission(gcoap_request_memo_t *memo);
 static size_t _handle_req(gcoap_socket_t *sock, coap_pkt_t *pdu, uint8_t *buf,
                           size_t len, sock_udp_ep_t *remote);
 static void _expire_request(gcoap_request_memo_t *memo);
+static void _free_req_memo(gcoap_request_memo_t *memo);
 static void _find_req_memo(gcoap_request_memo_t **memo_ptr, coap_pkt_t *pdu,
                            const sock_udp_ep_t *remote, bool by_mid);
 static int _find_resource(gcoap_socket_type_t tl_type,
@@ -109,6 +115,17 @@ static gcoap_listener_t _default_listener = {
     _request_matcher_default
 };
 
+#if IS_USED(MODULE_NANOCOAP_RESOURCE_INDEX)
+/* Hash index over the resources of a registered listener */
+typedef struct {
+    const gcoap_listener_t *listener;   /* NULL if unused */
+    coap_resource_index_t index;
+    uint16_t slots[CONFIG_NANOCOAP_RESOURCE_INDEX_SLOTS];
+} _listener_index_t;
+
+static _listener_index_t _listener_indexes[CONFIG_GCOAP_RESOURCE_INDEX_NUMOF];
+#endif
+
 /* Container for the state of gcoap itself */
 typedef struct {
     mutex_t lock;                       /* Shares state attributes safely */
@@ -133,6 +150,107 @@ static gcoap_state_t _coap_state = {
     .listeners   = &_default_listener,
 };
 
+/* hash indexes over the tables of _coap_state, see _gcoap-index.h */
+static uint16_t _req_by_token_mem[3][CONFIG_GCOAP_REQ_WAITING_MAX];
+static uint16_t _req_by_mid_mem[3][CONFIG_GCOAP_REQ_WAITING_MAX];
+static uint16_t _observer_by_ep_mem[3][CONFIG_GCOAP_OBS_CLIENTS_MAX];
+static uint16_t _obs_by_observer_mem[3][CONFIG_GCOAP_OBS_REGISTRATIONS_MAX];
+static uint16_t _obs_by_resource_mem[3][CONFIG_GCOAP_OBS_REGISTRATIONS_MAX];
+
+/* open_reqs by token */
+static const _index_t _req_by_token = {
+    _req_by_token_mem[0], _req_by_token_mem[1], _req_by_token_mem[2],
+    CONFIG_GCOAP_REQ_WAITING_MAX
+};
+/* open_reqs by message ID */
+static const _index_t _req_by_mid = {
+    _req_by_mid_mem[0], _req_by_mid_mem[1], _req_by_mid_mem[2],
+    CONFIG_GCOAP_REQ_WAITING_MAX
+};
+/* observers by endpoint */
+static const _index_t _observer_by_ep = {
+    _observer_by_ep_mem[0], _observer_by_ep_mem[1], _observer_by_ep_mem[2],
+    CONFIG_GCOAP_OBS_CLIENTS_MAX
+};
+/* observe_memos by observer */
+static const _index_t _obs_by_observer = {
+    _obs_by_observer_mem[0], _obs_by_observer_mem[1], _obs_by_observer_mem[2],
+    CONFIG_GCOAP_OBS_REGISTRATIONS_MAX
+};
+/* observe_memos by resource */
+static const _index_t _obs_by_resource = {
+    _obs_by_resource_mem[0], _obs_by_resource_mem[1], _obs_by_resource_mem[2],
+    CONFIG_GCOAP_OBS_REGISTRATIONS_MAX
+};
+
+/* 32-bit FNV-1a */
+static uint32_t _hash(uint32_t hash, const void *data, size_t len)
+{
+    const uint8_t *bytes = data;
+
+    while (len--) {
+        hash ^= *bytes++;
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+static uint32_t _hash_token(const coap_pkt_t *pdu)
+{
+    return _hash(2166136261U, coap_get_token(pdu), coap_get_token_len(pdu));
+}
+
+static uint32_t _hash_ep(const sock_udp_ep_t *ep)
+{
+    uint32_t hash = _hash(2166136261U, &ep->port, sizeof(ep->port));
+
+    switch (ep->family) {
+#ifdef SOCK_HAS_IPV4
+    case AF_INET:
+        return _hash(hash, ep->addr.ipv4, sizeof(ep->addr.ipv4));
+#endif
+#ifdef SOCK_HAS_IPV6
+    case AF_INET6:
+        return _hash(hash, ep->addr.ipv6, sizeof(ep->addr.ipv6));
+#endif
+    default:
+        return hash;
+    }
+}
+
+static uint32_t _hash_resource(const coap_resource_t *resource)
+{
+    /* resources are array members, so neighbors differ by one */
+    return (uintptr_t)resource / sizeof(*resource);
+}
+
+static void _index_observer(sock_udp_ep_t *observer, bool add)
+{
+    unsigned i = index_of(_coap_state.observers, observer);
+
+    if (add) {
+        _index_add(&_observer_by_ep, i, _hash_ep(observer));
+    }
+    else {
+        _index_del(&_observer_by_ep, i);
+    }
+}
+
+static void _index_obs_memo(gcoap_observe_memo_t *memo)
+{
+    unsigned i = index_of(_coap_state.observe_memos, memo);
+
+    if (memo->observer != NULL) {
+        _index_add(&_obs_by_observer, i,
+                   index_of(_coap_state.observers, memo->observer));
+        _index_add(&_obs_by_resource, i, _hash_resource(memo->resource));
+    }
+    else {
+        _index_del(&_obs_by_observer, i);
+        _index_del(&_obs_by_resource, i);
+    }
+}
+
 static kernel_pid_t _pid = KERNEL_PID_UNDEF;
 static char _msg_stack[GCOAP_STACK_SIZE];
 static event_queue_t _queue;
@@ -505,7 +623,7 @@ static void _process_coap_pdu(gcoap_socket_t *sock, sock_udp_ep_t *remote, sock_
                 if (memo->send_limit >= 0) {        /* if confirmable */
                     *memo->msg.data.pdu_buf = 0;    /* clear resend PDU buffer */
                 }
-                memo->state = GCOAP_MEMO_UNUSED;
+                _free_req_memo(memo);
                 break;
             default:
                 DEBUG("gcoap: illegal response type: %u\n", coap_get_type(&pdu));
@@ -674,6 +792,7 @@ static size_t _handle_req(gcoap_socket_t *sock, coap_pkt_t *pdu, uint8_t *buf,
                     if (obs_slot >= 0) {
                         observer = &_coap_state.observers[obs_slot];
                         memcpy(observer, remote, sizeof(sock_udp_ep_t));
+                        _index_observer(observer, true);
                     } else {
                         DEBUG("gcoap: can't register observer\n");
                     }
@@ -697,6 +816,7 @@ static size_t _handle_req(gcoap_socket_t *sock, coap_pkt_t *pdu, uint8_t *buf,
             if (memo->token_len) {
                 memcpy(&memo->token[0], coap_get_token(pdu), memo->token_len);
             }
+            _index_obs_memo(memo);
             DEBUG("gcoap: Registered observer for: %s\n", memo->resource->path);
         }
 
@@ -706,11 +826,13 @@ static size_t _handle_req(gcoap_socket_t *sock, coap_pkt_t *pdu, uint8_t *buf,
         if (memo != NULL) {
             DEBUG("gcoap: Deregistering observer for: %s\n", memo->resource->path);
             memo->observer = NULL;
+            _index_obs_memo(memo);
             memo           = NULL;
             _find_obs_memo(&memo, remote, NULL);
             if (memo == NULL) {
                 _find_observer(&observer, remote);
                 if (observer != NULL) {
+                    _index_observer(observer, false);
                     observer->family = AF_UNSPEC;
                 }
             }
@@ -756,6 +878,23 @@ static int _request_matcher_default(gcoap_listener_t *listener,
     coap_method_flags_t method_flag = coap_method2flag(
         coap_get_code_detail(pdu));
 
+#if IS_USED(MODULE_NANOCOAP_RESOURCE_INDEX)
+    for (unsigned i = 0; i < CONFIG_GCOAP_RESOURCE_INDEX_NUMOF; i++) {
+        if (_listener_indexes[i].listener != listener) {
+            continue;
+        }
+        switch (coap_resource_index_find(&_listener_indexes[i].index,
+                                         (char *)uri, method_flag, resource)) {
+            case 0:
+                return GCOAP_RESOURCE_FOUND;
+            case -EPERM:
+                return GCOAP_RESOURCE_WRONG_METHOD;
+            default:
+                return GCOAP_RESOURCE_NO_PATH;
+        }
+    }
+#endif
+
     for (size_t i = 0; i < listener->resources_len; i++) {
         *resource = &listener->resources[i];
 
@@ -862,12 +1001,12 @@ static void _find_req_memo(gcoap_request_memo_t **memo_ptr, coap_pkt_t *src_pdu,
     coap_pkt_t memo_pdu_data;
     coap_pkt_t *memo_pdu = &memo_pdu_data;
     unsigned cmplen      = coap_get_token_len(src_pdu);
+    const _index_t *index = by_mid ? &_req_by_mid : &_req_by_token;
+    uint32_t hash = by_mid ? src_pdu->hdr->id : _hash_token(src_pdu);
 
-    for (int i = 0; i < CONFIG_GCOAP_REQ_WAITING_MAX; i++) {
-        if (_coap_state.open_reqs[i].state == GCOAP_MEMO_UNUSED) {
-            continue;
-        }
-
+    mutex_lock(&_coap_state.lock);
+    for (unsigned i = _index_first(index, hash); i != INDEX_NONE;
+         i = _index_next(index, i)) {
         gcoap_request_memo_t *memo = &_coap_state.open_reqs[i];
 
         memo_pdu->hdr = gcoap_request_memo_get_hdr(memo);
@@ -888,6 +1027,33 @@ static void _find_req_memo(gcoap_request_memo_t **memo_ptr, coap_pkt_t *src_pdu,
             }
         }
     }
+    mutex_unlock(&_coap_state.lock);
+}
+
+/*
+ * Adds a request memo to the indexes by token and message ID.
+ *
+ * Caller must hold _coap_state.lock.
+ */
+static void _index_req_memo(gcoap_request_memo_t *memo)
+{
+    unsigned i = index_of(_coap_state.open_reqs, memo);
+    coap_pkt_t memo_pdu = { .hdr = gcoap_request_memo_get_hdr(memo) };
+
+    _index_add(&_req_by_token, i, _hash_token(&memo_pdu));
+    _index_add(&_req_by_mid, i, memo_pdu.hdr->id);
+}
+
+/* Marks a request memo unused and removes it from the indexes. */
+static void _free_req_memo(gcoap_request_memo_t *memo)
+{
+    unsigned i = index_of(_coap_state.open_reqs, memo);
+
+    mutex_lock(&_coap_state.lock);
+    _index_del(&_req_by_token, i);
+    _index_del(&_req_by_mid, i);
+    memo->state = GCOAP_MEMO_UNUSED;
+    mutex_unlock(&_coap_state.lock);
 }
 
 /* Calls handler callback on receipt of a timeout message. */
@@ -906,7 +1072,7 @@ static void _expire_request(gcoap_request_memo_t *memo)
         if (memo->send_limit != GCOAP_SEND_LIMIT_NON) {
             *memo->msg.data.pdu_buf = 0;    /* clear resend buffer */
         }
-        memo->state = GCOAP_MEMO_UNUSED;
+        _free_req_memo(memo);
     }
     else {
         /* Response already handled; timeout must have fired while response */
@@ -944,19 +1110,20 @@ static ssize_t _well_known_core_handler(coap_pkt_t* pdu, uint8_t *buf, size_t le
  */
 static int _find_observer(sock_udp_ep_t **observer, sock_udp_ep_t *remote)
 {
-    int empty_slot = -1;
-    *observer      = NULL;
+    *observer = NULL;
+    for (unsigned i = _index_first(&_observer_by_ep, _hash_ep(remote));
+         i != INDEX_NONE; i = _index_next(&_observer_by_ep, i)) {
+        if (sock_udp_ep_equal(&_coap_state.observers[i], remote)) {
+            *observer = &_coap_state.observers[i];
+            return -1;
+        }
+    }
     for (unsigned i = 0; i < CONFIG_GCOAP_OBS_CLIENTS_MAX; i++) {
-
         if (_coap_state.observers[i].family == AF_UNSPEC) {
-            empty_slot = i;
-        }
-        else if (sock_udp_ep_equal(&_coap_state.observers[i], remote)) {
-            *observer = &_coap_state.observers[i];
-            break;
+            return i;
         }
     }
-    return empty_slot;
+    return -1;
 }
 
 /*
@@ -972,22 +1139,22 @@ static int _find_observer(sock_udp_ep_t **observer, sock_udp_ep_t *remote)
 static int _find_obs_memo(gcoap_observe_memo_t **memo, sock_udp_ep_t *remote,
                                                        coap_pkt_t *pdu)
 {
-    int empty_slot = -1;
     *memo          = NULL;
 
     sock_udp_ep_t *remote_observer = NULL;
     _find_observer(&remote_observer, remote);
 
-    for (unsigned i = 0; i < CONFIG_GCOAP_OBS_REGISTRATIONS_MAX; i++) {
-        if (_coap_state.observe_memos[i].observer == NULL) {
-            empty_slot = i;
-            continue;
-        }
+    if (remote_observer != NULL) {
+        unsigned hash = index_of(_coap_state.observers, remote_observer);
 
-        if (_coap_state.observe_memos[i].observer == remote_observer) {
+        for (unsigned i = _index_first(&_obs_by_observer, hash);
+             i != INDEX_NONE; i = _index_next(&_obs_by_observer, i)) {
+            if (_coap_state.observe_memos[i].observer != remote_observer) {
+                continue;
+            }
             if (pdu == NULL) {
                 *memo = &_coap_state.observe_memos[i];
-                break;
+                return -1;
             }
             unsigned memo_token_len = _coap_state.observe_memos[i].token_len;
             if (memo_token_len == coap_get_token_len(pdu)
@@ -996,11 +1163,16 @@ static int _find_obs_memo(gcoap_observe_memo_t **memo, sock_udp_ep_t *remote,
                           coap_get_token(pdu),
                           memo_token_len) == 0) {
                 *memo = &_coap_state.observe_memos[i];
-                break;
+                return -1;
             }
         }
     }
-    return empty_slot;
+    for (unsigned i = 0; i < CONFIG_GCOAP_OBS_REGISTRATIONS_MAX; i++) {
+        if (_coap_state.observe_memos[i].observer == NULL) {
+            return i;
+        }
+    }
+    return -1;
 }
 
 /*
@@ -1013,7 +1185,8 @@ static void _find_obs_memo_resource(gcoap_observe_memo_t **memo,
                                    const coap_resource_t *resource)
 {
     *memo = NULL;
-    for (int i = 0; i < CONFIG_GCOAP_OBS_REGISTRATIONS_MAX; i++) {
+    for (unsigned i = _index_first(&_obs_by_resource, _hash_resource(resource));
+         i != INDEX_NONE; i = _index_next(&_obs_by_resource, i)) {
         if (_coap_state.observe_memos[i].observer != NULL
                 && _coap_state.observe_memos[i].resource == resource) {
             *memo = &_coap_state.observe_memos[i];
@@ -1246,7 +1419,7 @@ static void _receive_from_cache_cb(void *ctx)
                 if (memo->send_limit >= 0) {        /* if confirmable */
                     *memo->msg.data.pdu_buf = 0;    /* clear resend PDU buffer */
                 }
-                memo->state = GCOAP_MEMO_UNUSED;
+                _free_req_memo(memo);
             }
         }
     }
@@ -1379,6 +1552,11 @@ kernel_pid_t gcoap_init(void)
     memset(&_coap_state.observers[0], 0, sizeof(_coap_state.observers));
     memset(&_coap_state.observe_memos[0], 0, sizeof(_coap_state.observe_memos));
     memset(&_coap_state.resend_bufs[0], 0, sizeof(_coap_state.resend_bufs));
+    _index_reset(&_req_by_token);
+    _index_reset(&_req_by_mid);
+    _index_reset(&_observer_by_ep);
+    _index_reset(&_obs_by_observer);
+    _index_reset(&_obs_by_resource);
     /* randomize initial value */
     atomic_init(&_coap_state.next_message_id, (unsigned)random_uint32());
 
@@ -1414,6 +1592,26 @@ void gcoap_register_listener(gcoap_listener_t *listener)
     if (!listener->request_matcher) {
         listener->request_matcher = _request_matcher_default;
     }
+
+#if IS_USED(MODULE_NANOCOAP_RESOURCE_INDEX)
+    if (listener->request_matcher != _request_matcher_default) {
+        return;
+    }
+    for (unsigned i = 0; i < CONFIG_GCOAP_RESOURCE_INDEX_NUMOF; i++) {
+        _listener_index_t *entry = &_listener_indexes[i];
+
+        if (entry->listener != NULL) {
+            continue;
+        }
+        /* listeners without an index are searched linearly */
+        if (coap_resource_index_init(&entry->index, listener->resources,
+                                     listener->resources_len, entry->slots,
+                                     ARRAY_SIZE(entry->slots)) == 0) {
+            entry->listener = listener;
+        }
+        break;
+    }
+#endif
 }
 
 int gcoap_req_init_path_buffer(coap_pkt_t *pdu, uint8_t *buf, size_t len,
@@ -1546,6 +1744,9 @@ ssize_t gcoap_req_send_tl(const uint8_t *buf, size_t len,
             DEBUG("gcoap: illegal msg type %u\n", msg_type);
             break;
         }
+        if (memo->state != GCOAP_MEMO_UNUSED) {
+            _index_req_memo(memo);
+        }
         mutex_unlock(&_coap_state.lock);
         if (memo->state == GCOAP_MEMO_UNUSED) {
             return 0;
@@ -1600,7 +1801,7 @@ ssize_t gcoap_req_send_tl(const uint8_t *buf, size_t len,
             if (timeout > 0) {
                 event_timeout_clear(&memo->resp_evt_tmout);
             }
-            memo->state = GCOAP_MEMO_UNUSED;
+            _free_req_memo(memo);
         }
         DEBUG("gcoap: sock send failed: %d\n", (int)res);
     }
@@ -1676,9 +1877,76 @@ size_t gcoap_obs_send(const uint8_t *buf, size_t len,
     }
 }
 
-uint8_t gcoap_op_state(void)
+int gcoap_obs_template_init(gcoap_obs_template_t *tmpl, coap_pkt_t *pdu,
+                            uint8_t *buf, size_t len,
+                            const coap_resource_t *resource)
+{
+    /* header and token of each observer are written in front of the options,
+     * the longest token starts at the beginning of the buffer */
+    uint8_t value[CONFIG_GCOAP_OBS_VALUE_WIDTH] = { 0 };
+    coap_hdr_t *hdr = (coap_hdr_t *)(buf + GCOAP_TOKENLEN_MAX);
+
+    if (len < GCOAP_HEADER_MAXLEN + 1 + sizeof(value) + 1) {
+        return -ENOBUFS;
+    }
+
+    tmpl->resource = resource;
+    tmpl->buf = buf;
+    coap_build_hdr(hdr, COAP_TYPE_NON, NULL, 0, COAP_CODE_CONTENT, 0);
+    coap_pkt_init(pdu, (uint8_t *)hdr, len - GCOAP_TOKENLEN_MAX, sizeof(*hdr));
+
+    /* fixed width, so the value can be updated in place */
+    coap_opt_add_opaque(pdu, COAP_OPT_OBSERVE, value, sizeof(value));
+    tmpl->observe = pdu->payload - sizeof(value);
+
+    return 0;
+}
+
+size_t gcoap_obs_template_finish(gcoap_obs_template_t *tmpl, coap_pkt_t *pdu)
+{
+    coap_opt_finish(pdu, COAP_OPT_FINISH_PAYLOAD);
+    tmpl->payload = pdu->payload;
+    tmpl->payload_max = pdu->payload_len;
+
+    return tmpl->payload_max;
+}
+
+unsigned gcoap_obs_template_send(gcoap_obs_template_t *tmpl, size_t payload_len)
+{
+    uint32_t value = ztimer_now(ZTIMER_USEC) >> GCOAP_OBS_TICK_EXPONENT;
+    unsigned count = 0;
+
+    assert(payload_len <= tmpl->payload_max);
+
+    for (unsigned i = CONFIG_GCOAP_OBS_VALUE_WIDTH; i > 0; i--) {
+        tmpl->observe[i - 1] = value;
+        value >>= 8;
+    }
+
+    /* omit the payload marker without payload */
+    uint8_t *end = tmpl->payload + payload_len - (payload_len ? 0 : 1);
+
+    for (unsigned i = _index_first(&_obs_by_resource, _hash_resource(tmpl->resource));
+         i != INDEX_NONE; i = _index_next(&_obs_by_resource, i)) {
+        gcoap_observe_memo_t *memo = &_coap_state.observe_memos[i];
+        if ((memo->observer == NULL) || (memo->resource != tmpl->resource)) {
+            continue;
+        }
+
+        uint8_t *start = tmpl->buf + GCOAP_TOKENLEN_MAX - memo->token_len;
+        coap_build_hdr((coap_hdr_t *)start, COAP_TYPE_NON, memo->token,
+                       memo->token_len, COAP_CODE_CONTENT, gcoap_next_msg_id());
+        if (_tl_send(&memo->socket, start, end - start, memo->observer, NULL) > 0) {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+unsigned gcoap_op_state(void)
 {
-    uint8_t count = 0;
+    unsigned count = 0;
     for (int i = 0; i < CONFIG_GCOAP_REQ_WAITING_MAX; i++) {
         if (_coap_state.open_reqs[i].state != GCOAP_MEMO_UNUSED) {
             count++;
@@ -20,7 +20,9 @@
 
 #include <string.h>
 
+#include "container.h"
 #include "kernel_defines.h"
+#include "macros/utils.h"
 #include "net/nanocoap/cache.h"
 #include "hashes/sha256.h"
 
@@ -30,43 +32,158 @@
 static int _cache_replacement_lru(void);
 static int _cache_update_lru(clist_node_t *node);
 
-static clist_node_t _cache_list_head = { NULL };
 static clist_node_t _empty_list_head = { NULL };
 
 static nanocoap_cache_entry_t _cache_entries[CONFIG_NANOCOAP_CACHE_ENTRIES];
 
+/* cached entries, least recently used first, as doubly linked list of
+ * entry index + 1 */
+static uint16_t _lru_first;
+static uint16_t _lru_last;
+static uint16_t _lru_prev[CONFIG_NANOCOAP_CACHE_ENTRIES];
+static uint16_t _lru_next[CONFIG_NANOCOAP_CACHE_ENTRIES];
+static unsigned _used_count;
+
+/* hash index over the cache keys: first entry per bucket and next entry in
+ * the same bucket per entry, both stored as entry index + 1 */
+static uint16_t _buckets[CONFIG_NANOCOAP_CACHE_ENTRIES];
+static uint16_t _bucket_next[CONFIG_NANOCOAP_CACHE_ENTRIES];
+
+/* responses of all entries, without gaps */
+static uint8_t _response_bufs[CONFIG_NANOCOAP_CACHE_BYTES];
+static size_t _response_bufs_used;
+
+static nanocoap_cache_stats_t _stats;
+
 static const nanocoap_cache_replacement_strategy_t _replacement_strategy = _cache_replacement_lru;
 static const nanocoap_cache_update_strategy_t _update_strategy = _cache_update_lru;
 
-static int _cache_replacement_lru(void)
+static void _lru_remove(unsigned i)
 {
-    clist_node_t *lru_node = clist_lpeek(&_cache_list_head);
+    uint16_t prev = _lru_prev[i];
+    uint16_t next = _lru_next[i];
+
+    if (prev) {
+        _lru_next[prev - 1] = next;
+    }
+    else {
+        _lru_first = next;
+    }
+    if (next) {
+        _lru_prev[next - 1] = prev;
+    }
+    else {
+        _lru_last = prev;
+    }
+}
+
+static void _lru_append(unsigned i)
+{
+    _lru_prev[i] = _lru_last;
+    _lru_next[i] = 0;
+    if (_lru_last) {
+        _lru_next[_lru_last - 1] = i + 1;
+    }
+    else {
+        _lru_first = i + 1;
+    }
+    _lru_last = i + 1;
+}
 
+static int _cache_replacement_lru(void)
+{
     /* no element in the list */
-    if (!lru_node) {
+    if (!_lru_first) {
         return -1;
     }
 
-    nanocoap_cache_entry_t *lru_ce = container_of(lru_node, nanocoap_cache_entry_t, node);
-    return nanocoap_cache_del(lru_ce);
+    return nanocoap_cache_del(&_cache_entries[_lru_first - 1]);
 }
 
 static int _cache_update_lru(clist_node_t *node)
 {
-    if (clist_remove(&_cache_list_head, node)) {
-        /* Move an accessed node to the end of the list. Least
-         * recently used nodes are at the beginning of this list */
-        clist_rpush(&_cache_list_head, node);
-        return 0;
+    nanocoap_cache_entry_t *ce = container_of(node, nanocoap_cache_entry_t, node);
+    unsigned i = index_of(_cache_entries, ce);
+
+    /* Move an accessed node to the end of the list. Least
+     * recently used nodes are at the beginning of this list */
+    _lru_remove(i);
+    _lru_append(i);
+    return 0;
+}
+
+static unsigned _bucket(const uint8_t *cache_key)
+{
+    uint32_t hash = 0;
+
+    /* the key is a truncated SHA-256 digest, so any of its bytes will do */
+    memcpy(&hash, cache_key, MIN(sizeof(hash), CONFIG_NANOCOAP_CACHE_KEY_LENGTH));
+    return hash % CONFIG_NANOCOAP_CACHE_ENTRIES;
+}
+
+static void _index_add(nanocoap_cache_entry_t *ce)
+{
+    unsigned bucket = _bucket(ce->cache_key);
+    unsigned i = index_of(_cache_entries, ce);
+
+    _bucket_next[i] = _buckets[bucket];
+    _buckets[bucket] = i + 1;
+}
+
+static void _index_del(const nanocoap_cache_entry_t *ce)
+{
+    uint16_t *pos = &_buckets[_bucket(ce->cache_key)];
+    unsigned i = index_of(_cache_entries, ce);
+
+    while (*pos != i + 1) {
+        pos = &_bucket_next[*pos - 1];
     }
-    return -1;
+    *pos = _bucket_next[i];
+}
+
+static nanocoap_cache_entry_t *_index_find(const uint8_t *cache_key)
+{
+    for (unsigned i = _buckets[_bucket(cache_key)]; i != 0; i = _bucket_next[i - 1]) {
+        nanocoap_cache_entry_t *ce = &_cache_entries[i - 1];
+
+        if (!memcmp(ce->cache_key, cache_key, CONFIG_NANOCOAP_CACHE_KEY_LENGTH)) {
+            return ce;
+        }
+    }
+    return NULL;
+}
+
+/* removes the response of ce and moves the responses behind it into the gap */
+static void _response_buf_free(nanocoap_cache_entry_t *ce)
+{
+    uint8_t *start = ce->response_buf;
+    size_t len = ce->response_len;
+
+    memmove(start, start + len,
+            &_response_bufs[_response_bufs_used] - (start + len));
+    _response_bufs_used -= len;
+    for (unsigned i = 0; i < CONFIG_NANOCOAP_CACHE_ENTRIES; i++) {
+        nanocoap_cache_entry_t *moved = &_cache_entries[i];
+
+        if ((moved->response_buf != NULL) && (moved->response_buf > start)) {
+            moved->response_buf -= len;
+            moved->response_pkt.hdr = (coap_hdr_t *)moved->response_buf;
+            moved->response_pkt.payload -= len;
+        }
+    }
+    ce->response_buf = NULL;
 }
 
 void nanocoap_cache_init(void)
 {
-    _cache_list_head.next = NULL;
     _empty_list_head.next = NULL;
+    _lru_first = 0;
+    _lru_last = 0;
+    _used_count = 0;
     memset(_cache_entries, 0, sizeof(_cache_entries));
+    memset(_buckets, 0, sizeof(_buckets));
+    _response_bufs_used = 0;
+    memset(&_stats, 0, sizeof(_stats));
     /* construct list of empty entries */
     for (unsigned i = 0; i < CONFIG_NANOCOAP_CACHE_ENTRIES; i++) {
         clist_rpush(&_empty_list_head, &_cache_entries[i].node);
@@ -75,7 +192,7 @@ void nanocoap_cache_init(void)
 
 size_t nanocoap_cache_used_count(void)
 {
-    return clist_count(&_cache_list_head);
+    return _used_count;
 }
 
 size_t nanocoap_cache_free_count(void)
@@ -83,6 +200,12 @@ size_t nanocoap_cache_free_count(void)
     return clist_count(&_empty_list_head);
 }
 
+void nanocoap_cache_get_stats(nanocoap_cache_stats_t *stats)
+{
+    *stats = _stats;
+    stats->bytes = _response_bufs_used;
+}
+
 void nanocoap_cache_key_generate(const coap_pkt_t *req, uint8_t *cache_key)
 {
     sha256_context_t ctx;
@@ -122,31 +245,29 @@ ssize_t nanocoap_cache_key_compare(uint8_t *cache_key1, uint8_t *cache_key2)
     return memcmp(cache_key1, cache_key2, CONFIG_NANOCOAP_CACHE_KEY_LENGTH);
 }
 
-static int _compare_cache_keys(clist_node_t *ce, void *arg)
+static nanocoap_cache_entry_t *_lookup(const uint8_t *key)
 {
-    nanocoap_cache_entry_t *iterator = container_of(ce, nanocoap_cache_entry_t, node);
-    uint8_t *cache_key = (uint8_t *) arg;
+    nanocoap_cache_entry_t *ce = _index_find(key);
 
-    if (!memcmp(iterator->cache_key, cache_key, CONFIG_NANOCOAP_CACHE_KEY_LENGTH)) {
-        return 1;
+    if (ce) {
+        _update_strategy(&ce->node);
     }
-    return 0;
-}
 
-static clist_node_t *_nanocoap_cache_foreach(const uint8_t *key)
-{
-    return clist_foreach(&_cache_list_head, _compare_cache_keys, (uint8_t *)key);
+    return ce;
 }
 
 nanocoap_cache_entry_t *nanocoap_cache_key_lookup(const uint8_t *key)
 {
-    clist_node_t *node = _nanocoap_cache_foreach(key);
+    nanocoap_cache_entry_t *ce = _lookup(key);
 
-    if (node) {
-        _update_strategy(node);
+    if (ce) {
+        _stats.hits++;
+    }
+    else {
+        _stats.misses++;
     }
 
-    return container_of(node, nanocoap_cache_entry_t, node);
+    return ce;
 }
 
 nanocoap_cache_entry_t *nanocoap_cache_request_lookup(const coap_pkt_t *req)
@@ -167,7 +288,7 @@ nanocoap_cache_entry_t *nanocoap_cache_process(const uint8_t *cache_key, unsigne
                                                const coap_pkt_t *resp, size_t resp_len)
 {
     nanocoap_cache_entry_t *ce;
-    ce = nanocoap_cache_key_lookup(cache_key);
+    ce = _lookup(cache_key);
 
     /* This response is not cacheable. */
     if (resp->hdr->code == COAP_CODE_CREATED) {
@@ -245,39 +366,38 @@ nanocoap_cache_entry_t *nanocoap_cache_add_by_key(const uint8_t *cache_key,
                                                   const coap_pkt_t *resp,
                                                   size_t resp_len)
 {
-    nanocoap_cache_entry_t *ce = nanocoap_cache_key_lookup(cache_key);
-    bool add_to_cache = false;
-
-    if (resp_len > CONFIG_NANOCOAP_CACHE_RESPONSE_SIZE) {
-        DEBUG("nanocoap_cache: response too large to cache (%lu > %d)\n",
-              (long unsigned)resp_len, CONFIG_NANOCOAP_CACHE_RESPONSE_SIZE);
+    nanocoap_cache_entry_t *ce = _index_find(cache_key);
+
+    if (resp_len > MIN(CONFIG_NANOCOAP_CACHE_RESPONSE_SIZE,
+                       CONFIG_NANOCOAP_CACHE_BYTES)) {
+        DEBUG("nanocoap_cache: response too large to cache (%lu > %lu)\n",
+              (long unsigned)resp_len,
+              (long unsigned)MIN(CONFIG_NANOCOAP_CACHE_RESPONSE_SIZE,
+                                 CONFIG_NANOCOAP_CACHE_BYTES));
         return NULL;
     }
 
-    if (!ce) {
-        /* did not find .. get an empty cache container */
-        ce = _nanocoap_cache_pop();
-        add_to_cache = true;
+    if (ce) {
+        /* the response may differ in size, so store it like a new one */
+        nanocoap_cache_del(ce);
     }
 
-    /* no space left */
-    if (!ce) {
+    /* make room for the entry and its response */
+    while ((clist_lpeek(&_empty_list_head) == NULL) ||
+           (_response_bufs_used + resp_len > CONFIG_NANOCOAP_CACHE_BYTES)) {
         /* could not remove any entry */
         if (_replacement_strategy()) {
             return NULL;
         }
-        /* could remove an entry */
-        ce = _nanocoap_cache_pop();
-        add_to_cache = true;
-        if (!ce) {
-            /* still no free space ? stop trying now */
-            return NULL;
-        }
+        _stats.evictions++;
     }
+    ce = _nanocoap_cache_pop();
 
     memcpy(ce->cache_key, cache_key, CONFIG_NANOCOAP_CACHE_KEY_LENGTH);
     memcpy(&ce->response_pkt, resp, sizeof(coap_pkt_t));
-    memcpy(&ce->response_buf, resp->hdr, resp_len);
+    ce->response_buf = &_response_bufs[_response_bufs_used];
+    memcpy(ce->response_buf, resp->hdr, resp_len);
+    _response_bufs_used += resp_len;
     ce->response_pkt.hdr = (coap_hdr_t *) ce->response_buf;
     ce->response_pkt.payload = ce->response_buf + (resp->payload - ((uint8_t *)resp->hdr));
     ce->response_len = resp_len;
@@ -288,9 +408,9 @@ nanocoap_cache_entry_t *nanocoap_cache_add_by_key(const uint8_t *cache_key,
     coap_opt_get_uint((coap_pkt_t *)resp, COAP_OPT_MAX_AGE, &max_age);
     ce->max_age = ztimer_now(ZTIMER_SEC) + max_age;
 
-    if (add_to_cache) {
-        clist_rpush(&_cache_list_head, &ce->node);
-    }
+    _index_add(ce);
+    _lru_append(index_of(_cache_entries, ce));
+    _used_count++;
 
     return ce;
 }
@@ -312,14 +432,19 @@ nanocoap_cache_entry_t *nanocoap_cache_add_by_req(const coap_pkt_t *req,
 
 int nanocoap_cache_del(const nanocoap_cache_entry_t *ce)
 {
-    clist_node_t *entry = clist_find(&_cache_list_head, &ce->node);
-
-    if (entry) {
-        clist_remove(&_cache_list_head, entry);
-        memset(entry, 0, sizeof(nanocoap_cache_entry_t));
-        clist_rpush(&_empty_list_head, entry);
-        return 0;
+    /* only cached entries hold a response */
+    if (ce->response_buf == NULL) {
+        return -1;
     }
 
-    return -1;
+    unsigned i = index_of(_cache_entries, ce);
+    nanocoap_cache_entry_t *entry = &_cache_entries[i];
+
+    _index_del(entry);
+    _lru_remove(i);
+    _response_buf_free(entry);
+    _used_count--;
+    memset(entry, 0, sizeof(nanocoap_cache_entry_t));
+    clist_rpush(&_empty_list_head, &entry->node);
+    return 0;
 }
@@ -28,6 +28,11 @@
 
 #include "bitarithm.h"
 #include "net/nanocoap.h"
+#ifdef MODULE_NANOCOAP_RESOURCE_INDEX
+#include "container.h"
+#include "mutex.h"
+#include "net/nanocoap/resource_index.h"
+#endif
 
 #define ENABLE_DEBUG 0
 #include "debug.h"
@@ -414,6 +419,49 @@ bool coap_has_unprocessed_critical_options(const coap_pkt_t *pkt)
     return false;
 }
 
+#ifdef MODULE_NANOCOAP_RESOURCE_INDEX
+static const coap_resource_index_t *_get_resource_index(void)
+{
+    static mutex_t lock = MUTEX_INIT;
+    static coap_resource_index_t index;
+    static uint16_t slots[CONFIG_NANOCOAP_RESOURCE_INDEX_SLOTS];
+    /* 0: not built yet, 1: built, -1: resources do not fit */
+    static int state;
+
+    mutex_lock(&lock);
+    if (state == 0) {
+        state = (coap_resource_index_init(&index, coap_resources,
+                                          coap_resources_numof, slots,
+                                          ARRAY_SIZE(slots)) == 0) ? 1 : -1;
+    }
+    mutex_unlock(&lock);
+
+    return (state > 0) ? &index : NULL;
+}
+
+static ssize_t _index_handler(coap_pkt_t *pkt, uint8_t *resp_buf,
+                              unsigned resp_buf_len, coap_request_ctx_t *ctx,
+                              const coap_resource_index_t *index)
+{
+    coap_method_flags_t method_flag = coap_method2flag(coap_get_code_detail(pkt));
+    const coap_resource_t *resource;
+
+    uint8_t uri[CONFIG_NANOCOAP_URI_MAX];
+    if (coap_get_uri_path(pkt, uri) <= 0) {
+        return -EBADMSG;
+    }
+    DEBUG("nanocoap: URI path: \"%s\"\n", uri);
+
+    if (coap_resource_index_find(index, (char *)uri, method_flag,
+                                 &resource) != 0) {
+        return coap_build_reply(pkt, COAP_CODE_404, resp_buf, resp_buf_len, 0);
+    }
+
+    ctx->resource = resource;
+    return resource->handler(pkt, resp_buf, resp_buf_len, ctx);
+}
+#endif
+
 ssize_t coap_handle_req(coap_pkt_t *pkt, uint8_t *resp_buf, unsigned resp_buf_len,
                         coap_request_ctx_t *ctx)
 {
@@ -427,6 +475,12 @@ ssize_t coap_handle_req(coap_pkt_t *pkt, uint8_t *resp_buf, unsigned resp_buf_le
     if (pkt->hdr->code == 0) {
         return coap_build_reply(pkt, COAP_CODE_EMPTY, resp_buf, resp_buf_len, 0);
     }
+#ifdef MODULE_NANOCOAP_RESOURCE_INDEX
+    const coap_resource_index_t *index = _get_resource_index();
+    if (index) {
+        return _index_handler(pkt, resp_buf, resp_buf_len, ctx, index);
+    }
+#endif
     return coap_tree_handler(pkt, resp_buf, resp_buf_len, ctx,
                              coap_resources, coap_resources_numof);
 }
@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2023 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     net_nanocoap_resource_index
+ * @{
+ *
+ * @file
+ * @brief       Hash index for CoAP resources
+ *
+ * @}
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <string.h>
+
+#include "net/nanocoap/resource_index.h"
+
+#define ENABLE_DEBUG 0
+#include "debug.h"
+
+/* slot value of an unused slot, used slots hold the resource index + 1 */
+#define SLOT_EMPTY      (0U)
+
+/* 32-bit FNV-1a */
+static uint32_t _hash(const char *path, size_t len)
+{
+    uint32_t hash = 2166136261U;
+
+    while (len--) {
+        hash ^= (uint8_t)*path++;
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+static bool _is_subtree(const coap_resource_t *resource)
+{
+    return resource->methods & COAP_MATCH_SUBTREE;
+}
+
+int coap_resource_index_init(coap_resource_index_t *index,
+                             const coap_resource_t *resources,
+                             size_t resources_numof,
+                             uint16_t *slots, size_t slots_numof)
+{
+    assert((slots_numof & (slots_numof - 1)) == 0);
+
+    if ((slots_numof > UINT16_MAX) || (resources_numof > slots_numof / 2)) {
+        return -ENOSPC;
+    }
+    index->resources = resources;
+    index->resources_numof = resources_numof;
+    index->slots = slots;
+    index->slots_numof = slots_numof;
+    index->subtree_lens = 0;
+    memset(slots, 0, slots_numof * sizeof(*slots));
+
+    for (unsigned i = 0; i < resources_numof; i++) {
+        size_t len = strlen(resources[i].path);
+        unsigned slot = _hash(resources[i].path, len) & (slots_numof - 1);
+
+        if (_is_subtree(&resources[i])) {
+            if (len >= 64) {
+                DEBUG("nanocoap: subtree path too long for index: %s\n",
+                      resources[i].path);
+                return -ENOSPC;
+            }
+            index->subtree_lens |= (uint64_t)1 << len;
+        }
+        while (slots[slot] != SLOT_EMPTY) {
+            slot = (slot + 1) & (slots_numof - 1);
+        }
+        slots[slot] = i + 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief   Looks up the first @p len bytes of @p uri
+ *
+ * @param[in] full      True, if @p len is the length of @p uri
+ * @param[in,out] best  Array index of the best match so far
+ * @param[in,out] res   -ENOENT if no resource matched the path so far
+ */
+static void _probe(const coap_resource_index_t *index, const char *uri,
+                   size_t len, bool full, coap_method_flags_t method,
+                   unsigned *best, int *res)
+{
+    unsigned mask = index->slots_numof - 1;
+    unsigned slot = _hash(uri, len) & mask;
+
+    for (; index->slots[slot] != SLOT_EMPTY; slot = (slot + 1) & mask) {
+        unsigned i = index->slots[slot] - 1;
+        const coap_resource_t *resource = &index->resources[i];
+
+        /* a prefix only matches subtree resources */
+        if ((i >= *best) || (!full && !_is_subtree(resource))) {
+            continue;
+        }
+        if ((strncmp(resource->path, uri, len) != 0) ||
+            (resource->path[len] != '\0')) {
+            continue;
+        }
+        if (resource->methods & method) {
+            *best = i;
+            *res = 0;
+        }
+        else if (*res == -ENOENT) {
+            *res = -EPERM;
+        }
+    }
+}
+
+int coap_resource_index_find(const coap_resource_index_t *index,
+                             const char *uri, coap_method_flags_t method,
+                             const coap_resource_t **resource)
+{
+    size_t uri_len = strlen(uri);
+    uint64_t lens = index->subtree_lens;
+    unsigned best = index->resources_numof;
+    int res = -ENOENT;
+
+    _probe(index, uri, uri_len, true, method, &best, &res);
+    /* prefixes of the request path with the length of a subtree path */
+    for (size_t len = 0; lens && (len < uri_len); len++, lens >>= 1) {
+        if (lens & 1) {
+            _probe(index, uri, len, false, method, &best, &res);
+        }
+    }
+    if (res == 0) {
+        *resource = &index->resources[best];
+    }
+    return res;
+}
@@ -26,6 +26,7 @@
 #include <stdio.h>
 
 #include "atomic_utils.h"
+#include "macros/utils.h"
 #include "net/credman.h"
 #include "net/nanocoap_sock.h"
 #include "net/sock/util.h"
@@ -60,8 +61,54 @@ typedef struct {
     coap_blockwise_cb_t callback;
     void *arg;
     bool more;
+    uint8_t szx;
 } _block_ctx_t;
 
+enum {
+    SLOT_PENDING,           /**< block was requested, no response yet        */
+    SLOT_DONE,              /**< response received, waits for its turn       */
+};
+
+/**
+ * @brief   State of a block request in the window
+ */
+typedef struct {
+    uint32_t deadline;      /**< retransmission deadline in µs               */
+    uint32_t timeout;       /**< current retransmission timeout in µs        */
+    int res;                /**< error of a received response or 0           */
+    uint16_t id;            /**< message ID, doubles as token                */
+    uint16_t len;           /**< payload length of a received block          */
+    uint8_t tries_left;     /**< retransmissions left                        */
+    uint8_t state;          /**< SLOT_PENDING or SLOT_DONE                   */
+    bool more;              /**< more flag of a received block               */
+} _window_slot_t;
+
+/**
+ * @brief   State of a windowed block-wise GET
+ *
+ * Blocks `next` to `sent - 1` are requested. Block `n` uses slot
+ * `n % window`, a received block waiting for its predecessors is stored in
+ * block `n % (window - 1)` of @p buf.
+ *
+ * Until the last block is known, blocks past the end of the resource are
+ * requested as well. Responses to those, including errors, are ignored once
+ * a block without the more flag arrived.
+ */
+typedef struct {
+    nanocoap_sock_t *sock;  /**< socket used for the transfer                */
+    const char *path;       /**< path on the server                          */
+    uint8_t *buf;           /**< reorder buffer, (window - 1) blocks         */
+    coap_blockwise_cb_t callback;   /**< user callback                       */
+    void *arg;              /**< user callback argument                      */
+    uint32_t next;          /**< next block to pass to the callback          */
+    uint32_t sent;          /**< next block to request                       */
+    uint32_t last;          /**< last block, UINT32_MAX while unknown        */
+    unsigned window;        /**< maximum number of requests in flight        */
+    uint8_t szx;            /**< block size used by the server               */
+    bool done;              /**< last block was passed to the callback       */
+    _window_slot_t slots[CONFIG_NANOCOAP_BLOCKWISE_WINDOW]; /**< requests    */
+} _window_t;
+
 int nanocoap_sock_dtls_connect(nanocoap_sock_t *sock, sock_udp_ep_t *local,
                                const sock_udp_ep_t *remote, credman_tag_t tag)
 {
@@ -578,6 +625,7 @@ static int _block_cb(void *arg, coap_pkt_t *pkt)
     }
 
     ctx->more = block2.more;
+    ctx->szx = block2.szx;
     return ctx->callback(ctx->arg, block2.offset, pkt->payload, pkt->payload_len, block2.more);
 }
 
@@ -651,23 +699,296 @@ int nanocoap_sock_block_request(coap_block_request_t *req,
     return len;
 }
 
-int nanocoap_sock_get_blockwise(nanocoap_sock_t *sock, const char *path,
-                                coap_blksize_t blksize,
-                                coap_blockwise_cb_t callback, void *arg)
+static int _window_send(_window_t *w, uint32_t num)
 {
     uint8_t buf[CONFIG_NANOCOAP_BLOCK_HEADER_MAX];
+    _window_slot_t *slot = &w->slots[num % w->window];
+    coap_hdr_t *hdr = (void *)buf;
+    uint8_t *pos = buf;
+    uint16_t lastonum = 0;
+
+    /* requests carry a token to match separate responses */
+    pos += coap_build_hdr(hdr, COAP_TYPE_CON, (uint8_t *)&slot->id,
+                          sizeof(slot->id), COAP_METHOD_GET, slot->id);
+    pos += coap_opt_put_uri_pathquery(pos, &lastonum, w->path);
+    pos += coap_opt_put_uint(pos, lastonum, COAP_OPT_BLOCK2, (num << 4) | w->szx);
+    assert((uintptr_t)pos - (uintptr_t)buf < sizeof(buf));
+
+    const iolist_t snip = {
+        .iol_base = buf,
+        .iol_len  = (uintptr_t)pos - (uintptr_t)buf,
+    };
+
+    DEBUG("nanocoap: request block %"PRIu32" (%u tries left)\n",
+          num, slot->tries_left);
+    int res = _sock_sendv(w->sock, &snip);
+    return (res < 0) ? res : 0;
+}
+
+static int _window_request(_window_t *w, uint32_t num)
+{
+    _window_slot_t *slot = &w->slots[num % w->window];
+
+    slot->id = nanocoap_sock_next_msg_id(w->sock);
+    slot->timeout = random_uint32_range(CONFIG_COAP_ACK_TIMEOUT_MS * US_PER_MS,
+                                        CONFIG_COAP_ACK_TIMEOUT_MS * CONFIG_COAP_RANDOM_FACTOR_1000);
+    slot->deadline = _deadline_from_interval(slot->timeout);
+    slot->tries_left = CONFIG_COAP_MAX_RETRANSMIT;
+    slot->state = SLOT_PENDING;
+
+    return _window_send(w, num);
+}
+
+/* keeps the window filled with requests */
+static int _window_fill(_window_t *w)
+{
+    while ((w->sent < w->next + w->window) && (w->sent <= w->last)) {
+        int res = _window_request(w, w->sent);
+        if (res < 0) {
+            return res;
+        }
+        w->sent++;
+    }
+    return 0;
+}
+
+/* retransmits expired requests, returns the time until the next deadline */
+static int _window_retransmit(_window_t *w, uint32_t *timeout)
+{
+    *timeout = UINT32_MAX;
+    for (uint32_t num = w->next; (num < w->sent) && (num <= w->last); num++) {
+        _window_slot_t *slot = &w->slots[num % w->window];
+        if (slot->state == SLOT_DONE) {
+            continue;
+        }
+
+        uint32_t left = _deadline_left_us(slot->deadline);
+        if (left == 0) {
+            if (slot->tries_left == 0) {
+                DEBUG("nanocoap: maximum retries reached for block %"PRIu32"\n",
+                      num);
+                if (num == w->next) {
+                    return -ETIMEDOUT;
+                }
+                /* the block may be past the end, fail only once it is due */
+                slot->state = SLOT_DONE;
+                slot->res = -ETIMEDOUT;
+                continue;
+            }
+            --slot->tries_left;
+            slot->timeout *= 2;
+            slot->deadline = _deadline_from_interval(slot->timeout);
+            left = slot->timeout;
+
+            int res = _window_send(w, num);
+            if (res < 0) {
+                return res;
+            }
+        }
+        *timeout = MIN(*timeout, left);
+    }
+    return 0;
+}
+
+static uint8_t *_window_buf(_window_t *w, uint32_t num)
+{
+    return w->buf + (num % (w->window - 1)) * coap_szx2size(w->szx);
+}
+
+/* passes the next block and all buffered blocks following it to the user */
+static int _window_deliver(_window_t *w, uint8_t *data, size_t len, bool more)
+{
+    while (1) {
+        int res = w->callback(w->arg, w->next * coap_szx2size(w->szx),
+                              data, len, more);
+        if (res < 0) {
+            return res;
+        }
+        w->next++;
+        if (!more) {
+            w->done = true;
+            return 0;
+        }
+
+        _window_slot_t *slot = &w->slots[w->next % w->window];
+        if ((w->next == w->sent) || (slot->state != SLOT_DONE)) {
+            return 0;
+        }
+        if (slot->res < 0) {
+            return slot->res;
+        }
+        data = _window_buf(w, w->next);
+        len = slot->len;
+        more = slot->more;
+    }
+}
+
+static int _window_response(_window_t *w, coap_pkt_t *pkt)
+{
+    _window_slot_t *slot = NULL;
+    uint32_t num;
+
+    for (num = w->next; (num < w->sent) && (num <= w->last); num++) {
+        _window_slot_t *tmp = &w->slots[num % w->window];
+        if ((tmp->state == SLOT_PENDING) &&
+            !_id_or_token_missmatch(pkt, tmp->id, &tmp->id, sizeof(tmp->id))) {
+            slot = tmp;
+            break;
+        }
+    }
+    if (slot == NULL) {
+        DEBUG("nanocoap: ignoring unexpected message %u\n", coap_get_id(pkt));
+        return 0;
+    }
+
+    int res = 0;
+    switch (coap_get_type(pkt)) {
+    case COAP_TYPE_RST:
+        /* may be the reply to a request past the end, fail only once due */
+        res = -EBADMSG;
+        break;
+    case COAP_TYPE_CON:
+        _send_ack(w->sock, pkt);
+        break;
+    case COAP_TYPE_ACK:
+        if (coap_get_code(pkt) == COAP_CODE_EMPTY) {
+            /* empty ACK, wait for separate response */
+            slot->deadline = _deadline_from_interval(CONFIG_COAP_SEPARATE_RESPONSE_TIMEOUT_MS
+                                                     * US_PER_MS);
+            return 0;
+        }
+        break;
+    default:
+        break;
+    }
+
+    coap_block1_t block2 = { .more = 0 };
+    if (!res) {
+        res = _get_error(pkt);
+    }
+    if (!res && (!coap_get_block2(pkt, &block2) || (block2.blknum != num) ||
+                 (block2.szx != w->szx) ||
+                 (pkt->payload_len > coap_szx2size(w->szx)))) {
+        DEBUG("nanocoap: unexpected block in response for block %"PRIu32"\n",
+              num);
+        res = -EBADMSG;
+    }
+    if (!res && !block2.more) {
+        /* stop requesting and retransmitting blocks past the end */
+        w->last = num;
+    }
+
+    if (num == w->next) {
+        return res ? res : _window_deliver(w, pkt->payload, pkt->payload_len,
+                                           block2.more);
+    }
+
+    /* out of order, keep it until its predecessors arrived */
+    DEBUG("nanocoap: buffering block %"PRIu32", waiting for %"PRIu32"\n",
+          num, w->next);
+    slot->state = SLOT_DONE;
+    slot->res = res;
+    if (!res) {
+        slot->len = pkt->payload_len;
+        slot->more = block2.more;
+        memcpy(_window_buf(w, num), pkt->payload, pkt->payload_len);
+    }
+    return 0;
+}
+
+static int _get_blockwise_window(_window_t *w)
+{
+    while (!w->done) {
+        void *payload, *ctx = NULL;
+        uint32_t timeout;
+        coap_pkt_t pkt;
+
+        int res = _window_fill(w);
+        if (res < 0) {
+            return res;
+        }
+        res = _window_retransmit(w, &timeout);
+        if (res < 0) {
+            return res;
+        }
+
+        res = _sock_recv_buf(w->sock, &payload, &ctx, timeout);
+        if ((res == -ETIMEDOUT) || (res == -EAGAIN)) {
+            continue;
+        }
+        if (res < 0) {
+            DEBUG("nanocoap: error receiving coap response, %d\n", res);
+            return res;
+        }
+
+        if (coap_parse(&pkt, payload, res) < 0) {
+            DEBUG("nanocoap: error parsing packet\n");
+            res = 0;
+        }
+        else {
+            res = _window_response(w, &pkt);
+        }
+
+        /* release the receive buffer */
+        if (ctx) {
+            _sock_recv_buf(w->sock, &payload, &ctx, 0);
+        }
+        if (res < 0) {
+            return res;
+        }
+    }
+
+    return 0;
+}
+
+int nanocoap_sock_get_blockwise_window(nanocoap_sock_t *sock, const char *path,
+                                       coap_blksize_t blksize,
+                                       void *buf, size_t len,
+                                       coap_blockwise_cb_t callback, void *arg)
+{
+    uint8_t hdr[CONFIG_NANOCOAP_BLOCK_HEADER_MAX];
 
     _block_ctx_t ctx = {
         .callback = callback,
         .arg = arg,
         .more = true,
+        .szx = blksize,
     };
 
-    unsigned num = 0;
+    /* the first block tells whether there are more and their size */
+    DEBUG("fetching block 0\n");
+    int res = _fetch_block(sock, hdr, sizeof(hdr), path, blksize, 0, &ctx);
+    if (res < 0) {
+        DEBUG("error fetching block 0: %d\n", res);
+        return res;
+    }
+    if (!ctx.more) {
+        return 0;
+    }
+
+    _window_t w = {
+        .sock = sock,
+        .path = path,
+        .buf = buf,
+        .callback = callback,
+        .arg = arg,
+        .next = 1,
+        .sent = 1,
+        .last = UINT32_MAX,
+        .window = 1 + len / coap_szx2size(ctx.szx),
+        .szx = ctx.szx,
+    };
+    w.window = MIN(w.window, CONFIG_NANOCOAP_BLOCKWISE_WINDOW);
+
+    if (w.window > 1) {
+        return _get_blockwise_window(&w);
+    }
+
+    unsigned num = 1;
     while (ctx.more) {
         DEBUG("fetching block %u\n", num);
 
-        int res = _fetch_block(sock, buf, sizeof(buf), path, blksize, num, &ctx);
+        res = _fetch_block(sock, hdr, sizeof(hdr), path, ctx.szx, num, &ctx);
         if (res < 0) {
             DEBUG("error fetching block %u: %d\n", num, res);
             return res;
@@ -679,6 +1000,23 @@ int nanocoap_sock_get_blockwise(nanocoap_sock_t *sock, const char *path,
     return 0;
 }
 
+int nanocoap_sock_get_blockwise(nanocoap_sock_t *sock, const char *path,
+                                coap_blksize_t blksize,
+                                coap_blockwise_cb_t callback, void *arg)
+{
+#if CONFIG_NANOCOAP_BLOCKWISE_WINDOW > 1
+    uint8_t buf[(CONFIG_NANOCOAP_BLOCKWISE_WINDOW - 1)
+                << (CONFIG_NANOCOAP_BLOCKSIZE_DEFAULT + 4)];
+    size_t len = sizeof(buf);
+#else
+    uint8_t *buf = NULL;
+    size_t len = 0;
+#endif
+
+    return nanocoap_sock_get_blockwise_window(sock, path, blksize, buf, len,
+                                              callback, arg);
+}
+
 int nanocoap_sock_url_connect(const char *url, nanocoap_sock_t *sock)
 {
     char hostport[CONFIG_SOCK_HOSTPORT_MAXLEN];
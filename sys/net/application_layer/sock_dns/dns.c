@@ -80,14 +80,15 @@ int sock_dns_query(const char *domain_name, void *addr_out, int family)
         return -ENOSPC;
     }
 
-    res = dns_cache_query(domain_name, addr_out, family);
+    /* waits for the same query issued by another thread */
+    res = dns_cache_query_claim(domain_name, addr_out, family);
     if (res) {
         return res;
     }
 
     res = sock_udp_create(&sock_dns, NULL, &sock_dns_server, 0);
     if (res) {
-        goto out;
+        goto release;
     }
 
     uint16_t id = 0;
@@ -107,6 +108,12 @@ int sock_dns_query(const char *domain_name, void *addr_out, int family)
                     dns_cache_add(domain_name, addr_out, res, ttl);
                     goto out;
                 }
+                if (res == -ENOENT) {
+                    /* the name does not exist, no need to ask again */
+                    dns_cache_add_negative(domain_name,
+                                           CONFIG_DNS_CACHE_NEGATIVE_TTL);
+                    goto out;
+                }
             }
             else {
                 res = -EBADMSG;
@@ -116,5 +123,7 @@ int sock_dns_query(const char *domain_name, void *addr_out, int family)
 
 out:
     sock_udp_close(&sock_dns);
+release:
+    dns_cache_release(domain_name, family);
     return res;
 }
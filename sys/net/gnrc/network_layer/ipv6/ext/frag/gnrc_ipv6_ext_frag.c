@@ -61,6 +61,8 @@ void gnrc_ipv6_ext_frag_init(void)
 {
 #ifdef TEST_SUITES
     memset(_rbuf, 0, sizeof(_rbuf));
+    /* the pool is refilled below, so drop the nodes of a previous run */
+    _free_limits.next = NULL;
 #endif
     _last_id = random_uint32();
     for (unsigned i = 0; i < CONFIG_GNRC_IPV6_EXT_FRAG_LIMITS_POOL_SIZE; i++) {
@@ -408,6 +410,45 @@ static inline void _set_nh(gnrc_pktsnip_t *hdr_snip, uint8_t nh);
  */
 static gnrc_pktsnip_t *_completed(gnrc_ipv6_ext_frag_rbuf_t *rbuf);
 
+/**
+ * @brief   Determines how close a reassembly buffer entry is to completion
+ *
+ * @param[in] rbuf      A reassembly buffer entry.
+ *
+ * @return  The share of the datagram received so far in 1/256.
+ */
+static unsigned _progress(const gnrc_ipv6_ext_frag_rbuf_t *rbuf);
+
+/**
+ * @brief   Finds the reassembly buffer entry that is the furthest from
+ *          completion
+ *
+ * Ties are broken by choosing the entry with the oldest arrival time.
+ *
+ * @param[in] exclude   An entry to ignore. May be NULL.
+ * @param[in] src       Only consider entries from this source. May be NULL to
+ *                      consider all entries.
+ *
+ * @return  The least complete reassembly buffer entry.
+ * @return  NULL, if there is no entry matching the criteria.
+ */
+static gnrc_ipv6_ext_frag_rbuf_t *_least_complete(
+        const gnrc_ipv6_ext_frag_rbuf_t *exclude, const ipv6_addr_t *src);
+
+/**
+ * @brief   Makes room for a fragment within
+ *          @ref CONFIG_GNRC_IPV6_EXT_FRAG_RBUF_BUDGET
+ *
+ * Evicts entries less complete than @p rbuf until @p cost fits into the budget.
+ *
+ * @param[in] rbuf      The reassembly buffer entry the fragment belongs to.
+ * @param[in] cost      The number of bytes the fragment adds to @p rbuf.
+ *
+ * @return  true, if the fragment fits into the budget.
+ * @return  false, if the fragment should be dropped.
+ */
+static bool _reserve(gnrc_ipv6_ext_frag_rbuf_t *rbuf, size_t cost);
+
 gnrc_pktsnip_t *gnrc_ipv6_ext_frag_reass(gnrc_pktsnip_t *pkt)
 {
     gnrc_ipv6_ext_frag_rbuf_t *rbuf;
@@ -452,19 +493,37 @@ gnrc_pktsnip_t *gnrc_ipv6_ext_frag_reass(gnrc_pktsnip_t *pkt)
             DEBUG("ipv6_ext_frag: can't store fragment limits\n");
             goto error_exit;
     }
+    if ((offset > 0) && !ipv6_ext_frag_more(fh)) {
+        /* last fragment; add to rbuf->pkt_len, so the length of the datagram
+         * is also known to _reserve() */
+        rbuf->last++;
+        rbuf->pkt_len += offset + pkt->size;
+    }
+    if ((offset > 0) || ipv6_ext_frag_more(fh)) {
+        size_t cost = offset + pkt->size;
+
+        if (rbuf->pkt != NULL) {
+            /* the first fragment is copied into already allocated space,
+             * subsequent ones may grow the reassembled datagram */
+            cost = ((offset > 0) && (rbuf->pkt->size < cost))
+                 ? cost - rbuf->pkt->size
+                 : 0;
+        }
+        if (!_reserve(rbuf, cost)) {
+            DEBUG("ipv6_ext_frag: reassembly buffer budget exhausted\n");
+            if (IS_USED(MODULE_GNRC_IPV6_EXT_FRAG_STATS)) {
+                _stats.budget_drops++;
+            }
+            goto error_exit;
+        }
+    }
     if (offset > 0) {
         size_t size_until = offset + pkt->size;
 
         /* use IPv6 header in reassembly buffer from here on */
         ipv6 = rbuf->ipv6;
-        /* subsequent fragment */
-        if (!ipv6_ext_frag_more(fh)) {
-            /* last fragment; add to rbuf->pkt_len */
-            rbuf->last++;
-            rbuf->pkt_len += size_until;
-        }
-        /* not divisible by 8 */
-        else if ((pkt->size & 0x7)) {
+        /* subsequent fragment, not divisible by 8 */
+        if (ipv6_ext_frag_more(fh) && (pkt->size & 0x7)) {
             DEBUG("ipv6_ext_frag: fragment length not divisible by 8");
             goto error_exit;
         }
@@ -555,41 +614,55 @@ error_release:
 gnrc_ipv6_ext_frag_rbuf_t *gnrc_ipv6_ext_frag_rbuf_get(ipv6_hdr_t *ipv6,
                                                        uint32_t id)
 {
-    gnrc_ipv6_ext_frag_rbuf_t *res = NULL, *oldest = NULL;
+    gnrc_ipv6_ext_frag_rbuf_t *res = NULL;
+    unsigned src_entries = 0;
+
     for (unsigned i = 0; i < CONFIG_GNRC_IPV6_EXT_FRAG_RBUF_SIZE; i++) {
         gnrc_ipv6_ext_frag_rbuf_t *tmp = &_rbuf[i];
         if (tmp->ipv6 != NULL) {
-            if ((tmp->id == id) &&
-                ipv6_addr_equal(&tmp->ipv6->src, &ipv6->src) &&
-                ipv6_addr_equal(&tmp->ipv6->dst, &ipv6->dst)) {
-                return tmp;
+            if (ipv6_addr_equal(&tmp->ipv6->src, &ipv6->src)) {
+                if ((tmp->id == id) &&
+                    ipv6_addr_equal(&tmp->ipv6->dst, &ipv6->dst)) {
+                    return tmp;
+                }
+                src_entries++;
             }
         }
         else if (res == NULL) {
             res = tmp;
-            _init_rbuf(res, ipv6, id);
         }
-        if ((oldest == NULL) ||
-            /* xtimer_now_usec() overflows every ~1.2 hours */
-            ((tmp->arrival - oldest->arrival) < (UINT32_MAX / 2))) {
-            oldest = tmp;
+    }
+    if ((CONFIG_GNRC_IPV6_EXT_FRAG_RBUF_SRC_QUOTA <
+         CONFIG_GNRC_IPV6_EXT_FRAG_RBUF_SIZE) &&
+        (src_entries >= CONFIG_GNRC_IPV6_EXT_FRAG_RBUF_SRC_QUOTA)) {
+        /* source exceeds its quota, so it has to give up one of its own
+         * entries */
+        DEBUG("ipv6_ext_frag: source exceeds quota, dropping its least "
+              "complete entry\n");
+        if (IS_USED(MODULE_GNRC_IPV6_EXT_FRAG_STATS)) {
+            _stats.quota_evicts++;
         }
+        res = _least_complete(NULL, &ipv6->src);
+        assert(res != NULL);    /* there are entries from this source */
+        gnrc_ipv6_ext_frag_rbuf_del(res);
     }
-    if ((res == NULL) &&
-        !IS_ACTIVE(CONFIG_GNRC_IPV6_EXT_FRAG_RBUF_DO_NOT_OVERRIDE)) {
-        assert(oldest != NULL); /* reassembly buffer is full, so there needs
-                                 * to be an oldest entry */
-        DEBUG("ipv6_ext_frag: dropping oldest entry\n");
+    else if ((res == NULL) &&
+             !IS_ACTIVE(CONFIG_GNRC_IPV6_EXT_FRAG_RBUF_DO_NOT_OVERRIDE)) {
+        DEBUG("ipv6_ext_frag: dropping least complete entry\n");
         if (IS_USED(MODULE_GNRC_IPV6_EXT_FRAG_STATS)) {
             _stats.rbuf_full++;
         }
-        gnrc_ipv6_ext_frag_rbuf_del(oldest);
-        res = oldest;
-        _init_rbuf(res, ipv6, id);
+        res = _least_complete(NULL, NULL);
+        assert(res != NULL);    /* reassembly buffer is full, so there needs
+                                 * to be a least complete entry */
+        gnrc_ipv6_ext_frag_rbuf_del(res);
     }
     else if (IS_USED(MODULE_GNRC_IPV6_EXT_FRAG_STATS) && (res == NULL)) {
         _stats.rbuf_full++;
     }
+    if (res != NULL) {
+        _init_rbuf(res, ipv6, id);
+    }
     return res;
 }
 
@@ -613,6 +686,19 @@ void gnrc_ipv6_ext_frag_rbuf_gc(void)
     }
 }
 
+size_t gnrc_ipv6_ext_frag_rbuf_usage(void)
+{
+    size_t usage = 0;
+
+    for (unsigned i = 0; i < CONFIG_GNRC_IPV6_EXT_FRAG_RBUF_SIZE; i++) {
+        gnrc_ipv6_ext_frag_rbuf_t *rbuf = &_rbuf[i];
+        if ((rbuf->ipv6 != NULL) && (rbuf->pkt != NULL)) {
+            usage += rbuf->pkt->size;
+        }
+    }
+    return usage;
+}
+
 gnrc_ipv6_ext_frag_stats_t *gnrc_ipv6_ext_frag_stats(void)
 {
     return (IS_USED(MODULE_GNRC_IPV6_EXT_FRAG_STATS)) ? &_stats : NULL;
@@ -737,4 +823,89 @@ static gnrc_pktsnip_t *_completed(gnrc_ipv6_ext_frag_rbuf_t *rbuf)
     return NULL;
 }
 
+static unsigned _progress(const gnrc_ipv6_ext_frag_rbuf_t *rbuf)
+{
+    uint32_t received = 0;
+    uint32_t total = 0;
+    clist_node_t *node = rbuf->limits.next;
+
+    if (node == NULL) {
+        return 0;
+    }
+    do {
+        gnrc_ipv6_ext_frag_limits_t *limits;
+
+        node = node->next;
+        limits = (gnrc_ipv6_ext_frag_limits_t *)node;
+        received += limits->end - limits->start;
+        if (limits->end > total) {
+            total = limits->end;
+        }
+    } while (node != rbuf->limits.next);
+    if (!rbuf->last) {
+        /* length of the datagram is not known yet, so assume the worst */
+        total = UINT16_MAX >> 3U;
+    }
+    return (received >= total) ? 256U : (unsigned)((received << 8U) / total);
+}
+
+static gnrc_ipv6_ext_frag_rbuf_t *_least_complete(
+        const gnrc_ipv6_ext_frag_rbuf_t *exclude, const ipv6_addr_t *src)
+{
+    gnrc_ipv6_ext_frag_rbuf_t *res = NULL;
+    unsigned res_progress = 0;
+
+    for (unsigned i = 0; i < CONFIG_GNRC_IPV6_EXT_FRAG_RBUF_SIZE; i++) {
+        gnrc_ipv6_ext_frag_rbuf_t *tmp = &_rbuf[i];
+        unsigned tmp_progress;
+
+        if ((tmp == exclude) || (tmp->ipv6 == NULL) ||
+            ((src != NULL) && !ipv6_addr_equal(&tmp->ipv6->src, src))) {
+            continue;
+        }
+        tmp_progress = _progress(tmp);
+        if ((res == NULL) || (tmp_progress < res_progress) ||
+            ((tmp_progress == res_progress) &&
+             /* xtimer_now_usec() overflows every ~1.2 hours */
+             ((res->arrival - tmp->arrival) < (UINT32_MAX / 2)))) {
+            res = tmp;
+            res_progress = tmp_progress;
+        }
+    }
+    return res;
+}
+
+static bool _reserve(gnrc_ipv6_ext_frag_rbuf_t *rbuf, size_t cost)
+{
+    unsigned progress;
+    size_t usage;
+
+    if ((CONFIG_GNRC_IPV6_EXT_FRAG_RBUF_BUDGET == 0) || (cost == 0)) {
+        return true;
+    }
+    if (cost > CONFIG_GNRC_IPV6_EXT_FRAG_RBUF_BUDGET) {
+        return false;
+    }
+    progress = _progress(rbuf);
+    usage = gnrc_ipv6_ext_frag_rbuf_usage();
+    while ((usage + cost) > CONFIG_GNRC_IPV6_EXT_FRAG_RBUF_BUDGET) {
+        gnrc_ipv6_ext_frag_rbuf_t *victim = _least_complete(rbuf, NULL);
+
+        /* only make room for datagrams that are closer to completion than
+         * the ones already occupying the budget */
+        if ((victim == NULL) || (_progress(victim) >= progress)) {
+            return false;
+        }
+        DEBUG("ipv6_ext_frag: evicting entry to stay within budget\n");
+        if (victim->pkt != NULL) {
+            usage -= victim->pkt->size;
+        }
+        gnrc_ipv6_ext_frag_rbuf_del(victim);
+        if (IS_USED(MODULE_GNRC_IPV6_EXT_FRAG_STATS)) {
+            _stats.budget_evicts++;
+        }
+    }
+    return true;
+}
+
 /** @} */
@@ -40,6 +40,9 @@
 #include "net/gnrc/rpl/p2p.h"
 #include "net/gnrc/rpl/p2p_dodag.h"
 #endif
+#ifdef MODULE_GNRC_RPL_SR_TABLE
+#include "net/gnrc/rpl/sr_table.h"
+#endif
 
 #define ENABLE_DEBUG 0
 #include "debug.h"
@@ -47,7 +50,7 @@
 static char _stack[GNRC_RPL_STACK_SIZE];
 kernel_pid_t gnrc_rpl_pid = KERNEL_PID_UNDEF;
 const ipv6_addr_t ipv6_addr_all_rpl_nodes = GNRC_RPL_ALL_NODES_ADDR;
-#ifdef MODULE_GNRC_RPL_P2P
+#if defined(MODULE_GNRC_RPL_P2P) || defined(MODULE_GNRC_RPL_SR_TABLE)
 #if IS_USED(MODULE_ZTIMER_MSEC)
 static uint32_t _lt_time = GNRC_RPL_LIFETIME_UPDATE_STEP * MS_PER_SEC;
 static ztimer_t _lt_timer;
@@ -69,7 +72,7 @@ gnrc_rpl_parent_t gnrc_rpl_parents[GNRC_RPL_PARENTS_NUMOF];
 netstats_rpl_t gnrc_rpl_netstats;
 #endif
 
-#ifdef MODULE_GNRC_RPL_P2P
+#if defined(MODULE_GNRC_RPL_P2P) || defined(MODULE_GNRC_RPL_SR_TABLE)
 static void _update_lifetime(void);
 #endif
 static void _dao_handle_send(gnrc_rpl_dodag_t *dodag);
@@ -107,7 +110,7 @@ kernel_pid_t gnrc_rpl_init(kernel_pid_t if_pid)
 
         gnrc_rpl_of_manager_init();
         evtimer_init_msg(&gnrc_rpl_evtimer);
-#ifdef MODULE_GNRC_RPL_P2P
+#if defined(MODULE_GNRC_RPL_P2P) || defined(MODULE_GNRC_RPL_SR_TABLE)
 #if IS_USED(MODULE_ZTIMER_MSEC)
         ztimer_set_msg(ZTIMER_MSEC, &_lt_timer, _lt_time,
                        &_lt_msg, gnrc_rpl_pid);
@@ -295,7 +298,7 @@ static void *_event_loop(void *args)
         msg_receive(&msg);
 
         switch (msg.type) {
-#ifdef MODULE_GNRC_RPL_P2P
+#if defined(MODULE_GNRC_RPL_P2P) || defined(MODULE_GNRC_RPL_SR_TABLE)
             case GNRC_RPL_MSG_TYPE_LIFETIME_UPDATE:
                 DEBUG("RPL: GNRC_RPL_MSG_TYPE_LIFETIME_UPDATE received\n");
                 _update_lifetime();
@@ -345,10 +348,15 @@ static void *_event_loop(void *args)
     return NULL;
 }
 
-#ifdef MODULE_GNRC_RPL_P2P
+#if defined(MODULE_GNRC_RPL_P2P) || defined(MODULE_GNRC_RPL_SR_TABLE)
 void _update_lifetime(void)
 {
+#ifdef MODULE_GNRC_RPL_P2P
     gnrc_rpl_p2p_update();
+#endif
+#ifdef MODULE_GNRC_RPL_SR_TABLE
+    gnrc_rpl_sr_table_timeout(GNRC_RPL_LIFETIME_UPDATE_STEP);
+#endif
 
 #if IS_USED(MODULE_ZTIMER_MSEC)
     ztimer_set_msg(ZTIMER_MSEC, &_lt_timer, _lt_time, &_lt_msg, gnrc_rpl_pid);
@@ -48,6 +48,10 @@
 #include "net/gnrc/rpl/p2p.h"
 #endif
 
+#ifdef MODULE_GNRC_RPL_SR_TABLE
+#include "net/gnrc/rpl/sr_table.h"
+#endif
+
 #define ENABLE_DEBUG 0
 #include "debug.h"
 
@@ -506,6 +510,34 @@ static inline uint32_t _sec_to_ms(uint32_t sec)
     }
 }
 
+#ifdef MODULE_GNRC_RPL_SR_TABLE
+static void _sr_table_update(gnrc_rpl_dodag_t *dodag, gnrc_rpl_opt_target_t *target,
+                             gnrc_rpl_opt_transit_t *transit)
+{
+    ipv6_addr_t *parent = (ipv6_addr_t *)(transit + 1);
+
+    /* the parent address is only included in non-storing mode (validated
+     * along the option length) */
+    if ((dodag->node_status != GNRC_RPL_ROOT_NODE) ||
+        (dodag->instance->mop != GNRC_RPL_MOP_NON_STORING_MODE) ||
+        (target->prefix_length != IPV6_ADDR_BIT_LEN)) {
+        return;
+    }
+    if (transit->path_lifetime == 0) {
+        gnrc_rpl_sr_table_del(&target->target);
+        return;
+    }
+    if (ipv6_addr_equal(parent, &dodag->dodag_id)) {
+        parent = NULL;
+    }
+    if (gnrc_rpl_sr_table_add(&target->target, parent,
+                              transit->path_lifetime * dodag->lifetime_unit) < 0) {
+        DEBUG("RPL: unable to add %s to source routing table\n",
+              ipv6_addr_to_str(addr_str, &target->target, sizeof(addr_str)));
+    }
+}
+#endif
+
 /** @todo allow target prefixes in target options to be of variable length */
 bool _parse_options(int msg_type, gnrc_rpl_instance_t *inst, gnrc_rpl_opt_t *opt, uint16_t len,
                     ipv6_addr_t *src, uint32_t *included_opts)
@@ -661,6 +693,9 @@ bool _parse_options(int msg_type, gnrc_rpl_instance_t *inst, gnrc_rpl_opt_t *opt
                                          first_target->prefix_length, src,
                                          dodag->iface,
                                          transit->path_lifetime * dodag->lifetime_unit);
+#ifdef MODULE_GNRC_RPL_SR_TABLE
+                    _sr_table_update(dodag, first_target, transit);
+#endif
 
                     first_target = (gnrc_rpl_opt_target_t *) (((uint8_t *) (first_target)) +
                                    sizeof(gnrc_rpl_opt_t) + first_target->length);
@@ -40,7 +40,8 @@
 
 static char addr_str[IPV6_ADDR_MAX_STR_LEN];
 
-static gnrc_rpl_parent_t *_gnrc_rpl_find_preferred_parent(gnrc_rpl_dodag_t *dodag);
+static gnrc_rpl_parent_t *_gnrc_rpl_find_preferred_parent(gnrc_rpl_dodag_t *dodag,
+                                                          gnrc_rpl_parent_t *changed);
 
 static void _rpl_trickle_send_dio(void *args)
 {
@@ -305,21 +306,61 @@ void gnrc_rpl_parent_update(gnrc_rpl_dodag_t *dodag, gnrc_rpl_parent_t *parent)
 #endif
     }
 
-    if (_gnrc_rpl_find_preferred_parent(dodag) == NULL) {
+    if ((parent != NULL) && (parent->state == GNRC_RPL_PARENT_UNUSED)) {
+        /* parent is not part of the parent list anymore */
+        parent = NULL;
+    }
+    if ((parent != NULL) && (dodag->instance->of->update_link_metric != NULL)) {
+        dodag->instance->of->update_link_metric(parent);
+    }
+
+    if (_gnrc_rpl_find_preferred_parent(dodag, parent) == NULL) {
         gnrc_rpl_local_repair(dodag);
     }
 }
 
+/**
+ * @brief   Insert a parent at its position in the sorted parent list
+ *
+ * @param[in] dodag     Pointer to the DODAG
+ * @param[in] parent    The parent to insert
+ * @param[in] ahead     Insert in front of the parents of equal preference
+ *                      instead of behind them.
+ */
+static void _parent_insert(gnrc_rpl_dodag_t *dodag, gnrc_rpl_parent_t *parent,
+                           bool ahead)
+{
+    int (*cmp)(gnrc_rpl_parent_t *, gnrc_rpl_parent_t *) = dodag->instance->of->parent_cmp;
+    int bias = ahead ? 0 : 1;
+    gnrc_rpl_parent_t **pos = &dodag->parents;
+
+    while ((*pos != NULL) && (cmp(*pos, parent) < bias)) {
+        pos = &(*pos)->next;
+    }
+    parent->next = *pos;
+    *pos = parent;
+}
+
 /**
  * @brief   Find the parent with the lowest rank and update the DODAG's preferred parent
  *
+ * Apart from the preferred parent in front, the parent list is kept sorted,
+ * so if only a single parent changed, only that parent is re-positioned. The
+ * preferred parent is only replaced by the most preferred parent of the list
+ * if the objective function agrees to switch. The rank of this node is only
+ * re-calculated if the preferred parent or its rank changed.
+ *
  * @param[in] dodag     Pointer to the DODAG
+ * @param[in] changed   The parent that changed, NULL to re-sort the whole
+ *                      parent list.
  *
  * @return  Pointer to the preferred parent, on success.
  * @return  NULL, otherwise.
  */
-static gnrc_rpl_parent_t *_gnrc_rpl_find_preferred_parent(gnrc_rpl_dodag_t *dodag)
+static gnrc_rpl_parent_t *_gnrc_rpl_find_preferred_parent(gnrc_rpl_dodag_t *dodag,
+                                                          gnrc_rpl_parent_t *changed)
 {
+    gnrc_rpl_of_t *of = dodag->instance->of;
     gnrc_rpl_parent_t *old_best = dodag->parents;
     gnrc_rpl_parent_t *new_best;
     uint16_t old_rank = dodag->my_rank;
@@ -330,13 +371,42 @@ static gnrc_rpl_parent_t *_gnrc_rpl_find_preferred_parent(gnrc_rpl_dodag_t *doda
         return NULL;
     }
 
-    LL_SORT(dodag->parents, dodag->instance->of->parent_cmp);
+    /* the preferred parent may be less preferred than the parents behind it,
+     * so it is sorted in only after the rest of the list */
+    LL_DELETE(dodag->parents, old_best);
+    if (changed == NULL) {
+        LL_SORT(dodag->parents, of->parent_cmp);
+    }
+    else if (changed != old_best) {
+        LL_DELETE(dodag->parents, changed);
+        _parent_insert(dodag, changed, false);
+    }
+    _parent_insert(dodag, old_best, true);
     new_best = dodag->parents;
 
+    if ((new_best != old_best) && (of->parent_switch != NULL) &&
+        !of->parent_switch(old_best, new_best)) {
+        /* keep the preferred parent in front */
+        LL_DELETE(dodag->parents, old_best);
+        LL_PREPEND(dodag->parents, old_best);
+        new_best = old_best;
+    }
+
     if (new_best->rank == GNRC_RPL_INFINITE_RANK) {
         return NULL;
     }
 
+    if ((changed != NULL) && (new_best == old_best) && (changed != new_best) &&
+        (old_rank != GNRC_RPL_INFINITE_RANK)) {
+        /* preferred parent and thus our rank are unchanged, only check if the
+         * changed parent is still eligible */
+        if (DAGRANK(old_rank, dodag->instance->min_hop_rank_inc)
+            <= DAGRANK(changed->rank, dodag->instance->min_hop_rank_inc)) {
+            gnrc_rpl_parent_remove(changed);
+        }
+        return dodag->parents;
+    }
+
     if (new_best != old_best) {
         /* no-path DAOs only for the storing mode */
         if ((dodag->instance->mop == GNRC_RPL_MOP_STORING_MODE_NO_MC) ||
@@ -359,7 +429,13 @@ static gnrc_rpl_parent_t *_gnrc_rpl_find_preferred_parent(gnrc_rpl_dodag_t *doda
 
     dodag->my_rank = dodag->instance->of->calc_rank(dodag, 0);
     if (dodag->my_rank != old_rank) {
-        trickle_reset_timer(&dodag->trickle);
+        /* only reset trickle if our DAGRank or the preferred parent changed,
+         * so link metric jitter does not cause DIO storms */
+        if ((new_best != old_best) ||
+            (DAGRANK(dodag->my_rank, dodag->instance->min_hop_rank_inc) !=
+             DAGRANK(old_rank, dodag->instance->min_hop_rank_inc))) {
+            trickle_reset_timer(&dodag->trickle);
+        }
         gnrc_rpl_rpble_update(dodag);
     }
 
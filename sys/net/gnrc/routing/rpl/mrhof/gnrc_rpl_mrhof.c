@@ -0,0 +1,166 @@
+/*
+ * Copyright (C) 2023 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @{
+ *
+ * @file
+ */
+
+#include "net/gnrc/ipv6/nib/nc.h"
+#include "net/gnrc/netif.h"
+#include "net/gnrc/rpl.h"
+#include "net/gnrc/rpl/mrhof.h"
+#include "net/gnrc/rpl/structs.h"
+#include "net/netstats/neighbor.h"
+
+#define ENABLE_DEBUG 0
+#include "debug.h"
+
+static uint16_t calc_rank(gnrc_rpl_dodag_t *, uint16_t);
+static int parent_cmp(gnrc_rpl_parent_t *, gnrc_rpl_parent_t *);
+static gnrc_rpl_dodag_t *which_dodag(gnrc_rpl_dodag_t *, gnrc_rpl_dodag_t *);
+static void reset(gnrc_rpl_dodag_t *);
+static void update_link_metric(gnrc_rpl_parent_t *);
+static bool parent_switch(gnrc_rpl_parent_t *, gnrc_rpl_parent_t *);
+
+static gnrc_rpl_of_t gnrc_rpl_mrhof = {
+    .ocp          = GNRC_RPL_MRHOF_OCP,
+    .calc_rank    = calc_rank,
+    .parent_cmp   = parent_cmp,
+    .which_dodag  = which_dodag,
+    .reset        = reset,
+    .parent_state_callback = NULL,
+    .init         = NULL,
+    .process_dio  = NULL,
+    .update_link_metric = update_link_metric,
+    .parent_switch = parent_switch,
+};
+
+gnrc_rpl_of_t *gnrc_rpl_get_of_mrhof(void)
+{
+    return &gnrc_rpl_mrhof;
+}
+
+/**
+ * @brief   Path cost through @p parent as defined in RFC 6719, section 3.1
+ */
+static uint32_t _path_cost(const gnrc_rpl_parent_t *parent)
+{
+    uint32_t cost;
+
+    if ((parent->rank == GNRC_RPL_INFINITE_RANK) ||
+        (parent->link_metric > CONFIG_GNRC_RPL_MRHOF_MAX_LINK_METRIC)) {
+        return GNRC_RPL_INFINITE_RANK;
+    }
+    cost = (uint32_t)parent->rank + parent->link_metric;
+    if (cost > CONFIG_GNRC_RPL_MRHOF_MAX_PATH_COST) {
+        return GNRC_RPL_INFINITE_RANK;
+    }
+    return cost;
+}
+
+static void reset(gnrc_rpl_dodag_t *dodag)
+{
+    /* Nothing to do in MRHOF */
+    (void)dodag;
+}
+
+static uint16_t calc_rank(gnrc_rpl_dodag_t *dodag, uint16_t base_rank)
+{
+    uint32_t rank;
+
+    if (base_rank == 0) {
+        uint32_t cost;
+
+        if (dodag->parents == NULL) {
+            return GNRC_RPL_INFINITE_RANK;
+        }
+        cost = _path_cost(dodag->parents);
+        if (cost == GNRC_RPL_INFINITE_RANK) {
+            return GNRC_RPL_INFINITE_RANK;
+        }
+        rank = (uint32_t)dodag->parents->rank + dodag->instance->min_hop_rank_inc;
+        /* the rank must increase by at least MinHopRankIncrease */
+        if (cost > rank) {
+            rank = cost;
+        }
+    }
+    else {
+        rank = (uint32_t)base_rank + CONFIG_GNRC_RPL_DEFAULT_MIN_HOP_RANK_INCREASE;
+    }
+
+    return (rank >= GNRC_RPL_INFINITE_RANK) ? GNRC_RPL_INFINITE_RANK : rank;
+}
+
+static int parent_cmp(gnrc_rpl_parent_t *parent1, gnrc_rpl_parent_t *parent2)
+{
+    uint32_t cost1 = _path_cost(parent1);
+    uint32_t cost2 = _path_cost(parent2);
+
+    if (cost1 < cost2) {
+        return -1;
+    }
+    else if (cost1 > cost2) {
+        return 1;
+    }
+    return 0;
+}
+
+static bool parent_switch(gnrc_rpl_parent_t *current, gnrc_rpl_parent_t *candidate)
+{
+    uint32_t cost_current = _path_cost(current);
+    uint32_t cost_candidate = _path_cost(candidate);
+
+    if (cost_current == GNRC_RPL_INFINITE_RANK) {
+        return true;
+    }
+    /* RFC 6719, section 3.2: only switch if the path cost decreases by at
+     * least PARENT_SWITCH_THRESHOLD */
+    return (cost_candidate < cost_current) &&
+           ((cost_current - cost_candidate) >=
+            CONFIG_GNRC_RPL_MRHOF_PARENT_SWITCH_THRESHOLD);
+}
+
+/* Not used yet */
+static gnrc_rpl_dodag_t *which_dodag(gnrc_rpl_dodag_t *d1, gnrc_rpl_dodag_t *d2)
+{
+    (void)d2;
+    return d1;
+}
+
+static void update_link_metric(gnrc_rpl_parent_t *parent)
+{
+    gnrc_netif_t *netif = gnrc_netif_get_by_pid(parent->dodag->iface);
+    gnrc_ipv6_nib_nc_t nce;
+    void *state = NULL;
+
+    /* assume a mediocre link until the neighbor statistics tell otherwise */
+    parent->link_metric = NETSTATS_NB_ETX_INIT * NETSTATS_NB_ETX_DIVISOR;
+    parent->link_metric_type = GNRC_RPL_MRHOF_METRIC_ETX;
+    if (netif == NULL) {
+        return;
+    }
+    while (gnrc_ipv6_nib_nc_iter(netif->pid, &state, &nce)) {
+        if (ipv6_addr_equal(&nce.ipv6, &parent->addr)) {
+            netstats_nb_t stats;
+
+            if ((nce.l2addr_len > 0) &&
+                netstats_nb_get(&netif->netif, nce.l2addr, nce.l2addr_len,
+                                &stats) &&
+                netstats_nb_isfresh(&netif->netif, &stats)) {
+                parent->link_metric = stats.etx;
+            }
+            break;
+        }
+    }
+    DEBUG("RPL MRHOF: link metric of parent is %u\n",
+          (unsigned)parent->link_metric);
+}
+
+/** @} */
@@ -0,0 +1,373 @@
+/*
+ * Copyright (C) 2023 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @{
+ *
+ * @file
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "mutex.h"
+#include "net/gnrc/rpl/sr_table.h"
+
+#define ENABLE_DEBUG 0
+#include "debug.h"
+
+#define _IDX_NONE   (UINT16_MAX)        /**< end of list / unknown parent */
+#define _IDX_ROOT   (UINT16_MAX - 1)    /**< parent is the root */
+#define _IDX_FREE   (UINT16_MAX - 2)    /**< entry is not in use */
+
+static_assert(CONFIG_GNRC_RPL_SR_TABLE_NUMOF < _IDX_FREE,
+              "CONFIG_GNRC_RPL_SR_TABLE_NUMOF too large");
+static_assert((CONFIG_GNRC_RPL_SR_TABLE_BUCKETS &
+               (CONFIG_GNRC_RPL_SR_TABLE_BUCKETS - 1)) == 0,
+              "CONFIG_GNRC_RPL_SR_TABLE_BUCKETS must be a power of two");
+
+typedef struct {
+    ipv6_addr_t target;
+    uint32_t lifetime;      /**< remaining lifetime, 0 for placeholders */
+    uint16_t next;          /**< next entry in bucket or free list */
+    uint16_t parent;        /**< index of parent entry, _IDX_ROOT or _IDX_NONE */
+    uint16_t children;      /**< number of entries referring to this one */
+} _entry_t;
+
+#if CONFIG_GNRC_RPL_SR_TABLE_CACHE_NUMOF
+typedef struct {
+    uint32_t gen;           /**< topology generation the hop list is valid for */
+    uint16_t target;        /**< index of the target entry */
+    uint16_t numof;         /**< number of hops */
+    /**
+     * @brief   indexes of the hops, starting with the target
+     */
+    uint16_t hops[CONFIG_GNRC_RPL_SR_TABLE_MAX_DEPTH];
+} _cache_entry_t;
+
+static _cache_entry_t _cache[CONFIG_GNRC_RPL_SR_TABLE_CACHE_NUMOF];
+#endif
+
+static mutex_t _mutex = MUTEX_INIT;
+static _entry_t _entries[CONFIG_GNRC_RPL_SR_TABLE_NUMOF];
+static uint16_t _buckets[CONFIG_GNRC_RPL_SR_TABLE_BUCKETS];
+static uint16_t _free;
+static uint16_t _used;
+static uint32_t _gen;
+static bool _initialized;
+static gnrc_rpl_sr_table_stats_t _stats;
+
+static void _init(void)
+{
+    for (unsigned i = 0; i < CONFIG_GNRC_RPL_SR_TABLE_BUCKETS; i++) {
+        _buckets[i] = _IDX_NONE;
+    }
+    for (unsigned i = 0; i < CONFIG_GNRC_RPL_SR_TABLE_NUMOF; i++) {
+        _entries[i].parent = _IDX_FREE;
+        _entries[i].next = (i + 1 < CONFIG_GNRC_RPL_SR_TABLE_NUMOF)
+                         ? i + 1 : _IDX_NONE;
+    }
+    _free = 0;
+    _used = 0;
+    /* invalidates all cache entries */
+    _gen++;
+    _initialized = true;
+}
+
+static void _lock(void)
+{
+    mutex_lock(&_mutex);
+    if (!_initialized) {
+        _init();
+    }
+}
+
+static unsigned _hash(const ipv6_addr_t *addr)
+{
+    uint32_t h = addr->u32[0].u32 ^ addr->u32[1].u32 ^ addr->u32[2].u32 ^
+                 addr->u32[3].u32;
+
+    /* Fibonacci hashing, as the IIDs within a DODAG are often sequential */
+    h *= 2654435769UL;
+    return (h >> 16) & (CONFIG_GNRC_RPL_SR_TABLE_BUCKETS - 1);
+}
+
+static uint16_t _find(const ipv6_addr_t *addr)
+{
+    uint16_t idx = _buckets[_hash(addr)];
+
+    while ((idx != _IDX_NONE) && !ipv6_addr_equal(&_entries[idx].target, addr)) {
+        idx = _entries[idx].next;
+    }
+    return idx;
+}
+
+static uint16_t _alloc(const ipv6_addr_t *addr)
+{
+    uint16_t idx = _free;
+    _entry_t *entry = &_entries[idx];
+    unsigned bucket = _hash(addr);
+
+    assert(idx != _IDX_NONE);
+    _free = entry->next;
+    entry->target = *addr;
+    entry->lifetime = 0;
+    entry->parent = _IDX_NONE;
+    entry->children = 0;
+    entry->next = _buckets[bucket];
+    _buckets[bucket] = idx;
+    _used++;
+    return idx;
+}
+
+static void _free_entry(uint16_t idx)
+{
+    uint16_t *prev = &_buckets[_hash(&_entries[idx].target)];
+
+    while (*prev != idx) {
+        prev = &_entries[*prev].next;
+    }
+    *prev = _entries[idx].next;
+    _entries[idx].parent = _IDX_FREE;
+    _entries[idx].next = _free;
+    _free = idx;
+    _used--;
+}
+
+/* frees placeholders no longer referred to, walking towards the root */
+static void _release(uint16_t idx)
+{
+    while ((idx < CONFIG_GNRC_RPL_SR_TABLE_NUMOF) &&
+           (_entries[idx].lifetime == 0) && (_entries[idx].children == 0)) {
+        uint16_t parent = _entries[idx].parent;
+
+        DEBUG("gnrc_rpl_sr_table: freeing entry %u\n", idx);
+        _free_entry(idx);
+        if (parent < CONFIG_GNRC_RPL_SR_TABLE_NUMOF) {
+            _entries[parent].children--;
+        }
+        idx = parent;
+    }
+}
+
+static void _set_parent(uint16_t idx, uint16_t parent)
+{
+    uint16_t old = _entries[idx].parent;
+
+    _entries[idx].parent = parent;
+    if (parent < CONFIG_GNRC_RPL_SR_TABLE_NUMOF) {
+        _entries[parent].children++;
+    }
+    if (old < CONFIG_GNRC_RPL_SR_TABLE_NUMOF) {
+        _entries[old].children--;
+        _release(old);
+    }
+}
+
+static void _remove(uint16_t idx)
+{
+    _entries[idx].lifetime = 0;
+    _set_parent(idx, _IDX_NONE);
+    _release(idx);
+    _gen++;
+}
+
+static bool _is_ancestor(uint16_t ancestor, uint16_t idx)
+{
+    for (unsigned depth = 0; (idx < CONFIG_GNRC_RPL_SR_TABLE_NUMOF) &&
+                             (depth <= CONFIG_GNRC_RPL_SR_TABLE_MAX_DEPTH);
+         depth++) {
+        if (idx == ancestor) {
+            return true;
+        }
+        idx = _entries[idx].parent;
+    }
+    return false;
+}
+
+void gnrc_rpl_sr_table_reset(void)
+{
+    mutex_lock(&_mutex);
+    _init();
+    memset(&_stats, 0, sizeof(_stats));
+    mutex_unlock(&_mutex);
+}
+
+int gnrc_rpl_sr_table_add(const ipv6_addr_t *target, const ipv6_addr_t *parent,
+                          uint32_t lifetime)
+{
+    uint16_t t_idx, p_idx;
+    unsigned needed = 0;
+    int res = 0;
+
+    if ((lifetime == 0) || ((parent != NULL) && ipv6_addr_equal(target, parent))) {
+        return -EINVAL;
+    }
+    _lock();
+    t_idx = _find(target);
+    p_idx = (parent == NULL) ? _IDX_ROOT : _find(parent);
+    if ((t_idx != _IDX_NONE) && (p_idx != _IDX_NONE) &&
+        (_entries[t_idx].parent == p_idx)) {
+        /* refresh only, the topology did not change */
+        _entries[t_idx].lifetime = lifetime;
+        goto out;
+    }
+    if ((t_idx != _IDX_NONE) && _is_ancestor(t_idx, p_idx)) {
+        DEBUG("gnrc_rpl_sr_table: DAO parent would create a loop\n");
+        res = -ELOOP;
+        goto out;
+    }
+    needed += (t_idx == _IDX_NONE) ? 1 : 0;
+    needed += (p_idx == _IDX_NONE) ? 1 : 0;
+    if ((_used + needed) > CONFIG_GNRC_RPL_SR_TABLE_NUMOF) {
+        DEBUG("gnrc_rpl_sr_table: table full\n");
+        res = -ENOMEM;
+        goto out;
+    }
+    if (t_idx == _IDX_NONE) {
+        t_idx = _alloc(target);
+    }
+    if (p_idx == _IDX_NONE) {
+        /* placeholder until the parent announces itself */
+        p_idx = _alloc(parent);
+    }
+    _entries[t_idx].lifetime = lifetime;
+    _set_parent(t_idx, p_idx);
+    _gen++;
+out:
+    mutex_unlock(&_mutex);
+    return res;
+}
+
+void gnrc_rpl_sr_table_del(const ipv6_addr_t *target)
+{
+    uint16_t idx;
+
+    _lock();
+    idx = _find(target);
+    if ((idx != _IDX_NONE) && (_entries[idx].lifetime > 0)) {
+        _remove(idx);
+    }
+    mutex_unlock(&_mutex);
+}
+
+void gnrc_rpl_sr_table_timeout(uint32_t elapsed)
+{
+    _lock();
+    for (uint16_t i = 0; i < CONFIG_GNRC_RPL_SR_TABLE_NUMOF; i++) {
+        _entry_t *entry = &_entries[i];
+
+        if ((entry->parent == _IDX_FREE) || (entry->lifetime == 0)) {
+            continue;
+        }
+        if (entry->lifetime <= elapsed) {
+            DEBUG("gnrc_rpl_sr_table: entry %u timed out\n", i);
+            _remove(i);
+        }
+        else {
+            entry->lifetime -= elapsed;
+        }
+    }
+    mutex_unlock(&_mutex);
+}
+
+/* fills hops with the entry indexes from the target up to the child of
+ * the root */
+static int _walk(uint16_t idx, uint16_t *hops)
+{
+    unsigned numof = 0;
+
+    while (idx != _IDX_ROOT) {
+        if ((idx == _IDX_NONE) || (_entries[idx].lifetime == 0)) {
+            return -EHOSTUNREACH;
+        }
+        if (numof == CONFIG_GNRC_RPL_SR_TABLE_MAX_DEPTH) {
+            return -ELOOP;
+        }
+        hops[numof++] = idx;
+        idx = _entries[idx].parent;
+    }
+    return numof;
+}
+
+int gnrc_rpl_sr_table_get_route(const ipv6_addr_t *target, ipv6_addr_t *hops,
+                                unsigned max_hops)
+{
+    uint16_t idx;
+    uint16_t *path;
+    int res;
+#if CONFIG_GNRC_RPL_SR_TABLE_CACHE_NUMOF
+    _cache_entry_t *cached;
+#else
+    uint16_t path_buf[CONFIG_GNRC_RPL_SR_TABLE_MAX_DEPTH];
+#endif
+
+    _lock();
+    _stats.lookups++;
+    idx = _find(target);
+    if (idx == _IDX_NONE) {
+        res = -ENOENT;
+        goto out;
+    }
+#if CONFIG_GNRC_RPL_SR_TABLE_CACHE_NUMOF
+    cached = &_cache[idx % CONFIG_GNRC_RPL_SR_TABLE_CACHE_NUMOF];
+    path = cached->hops;
+    if ((cached->target == idx) && (cached->gen == _gen)) {
+        _stats.cache_hits++;
+        res = cached->numof;
+    }
+    else {
+        res = _walk(idx, path);
+        if (res < 0) {
+            /* the hop list is partially overwritten */
+            cached->gen = _gen - 1;
+            goto out;
+        }
+        cached->target = idx;
+        cached->numof = res;
+        cached->gen = _gen;
+    }
+#else
+    path = path_buf;
+    res = _walk(idx, path);
+    if (res < 0) {
+        goto out;
+    }
+#endif
+    if ((unsigned)res > max_hops) {
+        res = -ENOBUFS;
+        goto out;
+    }
+    for (int i = 0; i < res; i++) {
+        hops[i] = _entries[path[res - 1 - i]].target;
+    }
+out:
+    mutex_unlock(&_mutex);
+    return res;
+}
+
+unsigned gnrc_rpl_sr_table_numof(void)
+{
+    unsigned res;
+
+    _lock();
+    res = _used;
+    mutex_unlock(&_mutex);
+    return res;
+}
+
+void gnrc_rpl_sr_table_get_stats(gnrc_rpl_sr_table_stats_t *stats)
+{
+    mutex_lock(&_mutex);
+    *stats = _stats;
+    mutex_unlock(&_mutex);
+}
+
+/** @} */
@@ -312,6 +312,38 @@ ssize_t sock_udp_recv_buf_aux(sock_udp_t *sock, void **data, void **buf_ctx,
     return res;
 }
 
+ssize_t sock_udp_recv_many(sock_udp_t *sock, sock_udp_msg_t *msgs,
+                           unsigned numof, uint32_t timeout)
+{
+    unsigned received = 0;
+
+    assert((sock != NULL) && (msgs != NULL) && (numof > 0));
+    while (received < numof) {
+        sock_udp_msg_t *msg = &msgs[received];
+        ssize_t res;
+
+        assert(msg->buf_ctx == NULL);
+        res = sock_udp_recv_buf_aux(sock, &msg->data, &msg->buf_ctx, timeout,
+                                    &msg->remote, &msg->aux);
+        if (res < 0) {
+            if (received == 0) {
+                return res;
+            }
+            if (res == -EPROTO) {
+                /* datagram from another remote was dropped, check next */
+                continue;
+            }
+            /* queue is drained (-EAGAIN) or out of packet buffer */
+            break;
+        }
+        msg->len = res;
+        received++;
+        /* only take what is already queued from here on */
+        timeout = 0;
+    }
+    return received;
+}
+
 ssize_t sock_udp_sendv_aux(sock_udp_t *sock,
                            const iolist_t *snips,
                            const sock_udp_ep_t *remote, sock_udp_aux_tx_t *aux)
@@ -0,0 +1,241 @@
+/*
+ * Copyright (C) 2023 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @{
+ *
+ * @file
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <sys/stat.h>
+
+#include "irq.h"
+#include "ztimer.h"
+#include "net/sock/async/set.h"
+#ifdef MODULE_VFS
+#include "vfs.h"
+#endif
+
+#if IS_USED(MODULE_POSIX_SOCKETS)
+extern int posix_socket_set_entry(int fd, sock_set_entry_t *entry);
+#else
+static inline int posix_socket_set_entry(int fd, sock_set_entry_t *entry)
+{
+    (void)fd;
+    (void)entry;
+    return -ENOTSOCK;
+}
+#endif
+
+static void _event_handler(event_t *ev)
+{
+    /* members are taken by sock_set_wait(), not by an event loop */
+    (void)ev;
+}
+
+#ifdef MODULE_SOCK_IP
+static void _ip_cb(sock_ip_t *sock, sock_async_flags_t type, void *arg)
+{
+    (void)sock;
+    sock_set_notify(arg, type);
+}
+#endif
+
+#ifdef MODULE_SOCK_TCP
+static void _tcp_cb(sock_tcp_t *sock, sock_async_flags_t type, void *arg)
+{
+    (void)sock;
+    sock_set_notify(arg, type);
+}
+
+static void _tcp_queue_cb(sock_tcp_queue_t *queue, sock_async_flags_t type,
+                          void *arg)
+{
+    (void)queue;
+    sock_set_notify(arg, type);
+}
+#endif
+
+#ifdef MODULE_SOCK_UDP
+static void _udp_cb(sock_udp_t *sock, sock_async_flags_t type, void *arg)
+{
+    (void)sock;
+    sock_set_notify(arg, type);
+}
+#endif
+
+static void _init_entry(sock_set_t *set, sock_set_entry_t *entry,
+                        sock_set_type_t type, void *sock, int fd, void *arg)
+{
+    entry->super.list_node.next = NULL;
+    entry->super.handler = _event_handler;
+    entry->set = set;
+    entry->sock = sock;
+    entry->arg = arg;
+    entry->fd = fd;
+    entry->type = type;
+    entry->pending = 0;
+    entry->flags = 0;
+}
+
+void sock_set_init(sock_set_t *set)
+{
+    event_queue_init_detached(&set->queue);
+}
+
+#ifdef MODULE_SOCK_IP
+void sock_set_add_ip(sock_set_t *set, sock_set_entry_t *entry,
+                     sock_ip_t *sock, void *arg)
+{
+    _init_entry(set, entry, SOCK_SET_TYPE_IP, sock, -1, arg);
+    sock_ip_set_cb(sock, _ip_cb, entry);
+}
+#endif
+
+#ifdef MODULE_SOCK_TCP
+void sock_set_add_tcp(sock_set_t *set, sock_set_entry_t *entry,
+                      sock_tcp_t *sock, void *arg)
+{
+    _init_entry(set, entry, SOCK_SET_TYPE_TCP, sock, -1, arg);
+    sock_tcp_set_cb(sock, _tcp_cb, entry);
+}
+
+void sock_set_add_tcp_queue(sock_set_t *set, sock_set_entry_t *entry,
+                            sock_tcp_queue_t *queue, void *arg)
+{
+    _init_entry(set, entry, SOCK_SET_TYPE_TCP_QUEUE, queue, -1, arg);
+    sock_tcp_queue_set_cb(queue, _tcp_queue_cb, entry);
+}
+#endif
+
+#ifdef MODULE_SOCK_UDP
+void sock_set_add_udp(sock_set_t *set, sock_set_entry_t *entry,
+                      sock_udp_t *sock, void *arg)
+{
+    _init_entry(set, entry, SOCK_SET_TYPE_UDP, sock, -1, arg);
+    sock_udp_set_cb(sock, _udp_cb, entry);
+}
+#endif
+
+#ifdef MODULE_VFS
+int sock_set_add_fd(sock_set_t *set, sock_set_entry_t *entry, int fd,
+                    void *arg)
+{
+    struct stat stat;
+    int res;
+
+    if (vfs_fstat(fd, &stat) < 0) {
+        return -EBADF;
+    }
+    _init_entry(set, entry, SOCK_SET_TYPE_FD, NULL, fd, arg);
+    res = posix_socket_set_entry(fd, entry);
+    if (res == -ENOTSOCK) {
+        /* regular files never block */
+        sock_set_notify(entry, SOCK_ASYNC_MSG_RECV | SOCK_ASYNC_MSG_SENT);
+        return 0;
+    }
+    if (res < 0) {
+        entry->type = SOCK_SET_TYPE_NONE;
+    }
+    return res;
+}
+#endif
+
+void sock_set_del(sock_set_entry_t *entry)
+{
+    switch (entry->type) {
+#ifdef MODULE_SOCK_IP
+        case SOCK_SET_TYPE_IP:
+            sock_ip_set_cb(entry->sock, NULL, NULL);
+            break;
+#endif
+#ifdef MODULE_SOCK_TCP
+        case SOCK_SET_TYPE_TCP:
+            sock_tcp_set_cb(entry->sock, NULL, NULL);
+            break;
+        case SOCK_SET_TYPE_TCP_QUEUE:
+            sock_tcp_queue_set_cb(entry->sock, NULL, NULL);
+            break;
+#endif
+#ifdef MODULE_SOCK_UDP
+        case SOCK_SET_TYPE_UDP:
+            sock_udp_set_cb(entry->sock, NULL, NULL);
+            break;
+#endif
+        case SOCK_SET_TYPE_FD:
+            posix_socket_set_entry(entry->fd, NULL);
+            break;
+        default:
+            break;
+    }
+    if (entry->set != NULL) {
+        event_cancel(&entry->set->queue, &entry->super);
+    }
+    entry->type = SOCK_SET_TYPE_NONE;
+    entry->set = NULL;
+}
+
+void sock_set_notify(sock_set_entry_t *entry, sock_async_flags_t flags)
+{
+    unsigned state = irq_disable();
+
+    entry->pending |= flags;
+    irq_restore(state);
+    /* does nothing if the member is already queued */
+    event_post(&entry->set->queue, &entry->super);
+}
+
+static sock_set_entry_t *_take(sock_set_entry_t *entry)
+{
+    unsigned state = irq_disable();
+
+    entry->flags = entry->pending;
+    entry->pending = 0;
+    irq_restore(state);
+    /* the member may have been queued again after it was reported with
+     * the notifications already */
+    return (entry->flags) ? entry : NULL;
+}
+
+int sock_set_wait(sock_set_t *set, sock_set_entry_t **ready, unsigned numof,
+                  uint32_t timeout)
+{
+    unsigned res = 0;
+
+    assert((ready != NULL) && (numof > 0));
+    if ((timeout != 0) && (set->queue.waiter == NULL)) {
+        event_queue_claim(&set->queue);
+    }
+    while (res == 0) {
+        event_t *ev;
+
+        if (timeout == 0) {
+            ev = event_get(&set->queue);
+        }
+        else if (timeout == SOCK_NO_TIMEOUT) {
+            ev = event_wait(&set->queue);
+        }
+        else {
+            ev = event_wait_timeout_ztimer(&set->queue, ZTIMER_USEC, timeout);
+        }
+        if (ev == NULL) {
+            return (timeout == 0) ? -EAGAIN : -ETIMEDOUT;
+        }
+        /* take all other ready members without waiting */
+        do {
+            if ((ready[res] = _take((sock_set_entry_t *)ev)) != NULL) {
+                res++;
+            }
+        } while ((res < numof) && ((ev = event_get(&set->queue)) != NULL));
+    }
+    return res;
+}
+
+/** @} */
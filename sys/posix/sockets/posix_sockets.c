@@ -41,6 +41,9 @@
 #if IS_USED(MODULE_SOCK_ASYNC)
 #include "net/sock/async.h"
 #endif
+#if IS_USED(MODULE_SOCK_ASYNC_SET)
+#include "net/sock/async/set.h"
+#endif
 #if IS_USED(MODULE_POSIX_SELECT)
 #include <sys/select.h>
 
@@ -95,6 +98,9 @@ typedef struct {
 #endif
 #if IS_USED(MODULE_POSIX_SELECT)
     thread_t *selecting_thread;
+#endif
+#if IS_USED(MODULE_SOCK_ASYNC_SET)
+    sock_set_entry_t *set_entry;
 #endif
     sock_tcp_ep_t local;        /* to store bind before connect/listen */
 } socket_t;
@@ -127,6 +133,9 @@ static socket_t *_get_free_socket(void)
 #endif
 #if IS_USED(MODULE_POSIX_SELECT)
             _socket_pool[i].selecting_thread = NULL;
+#endif
+#if IS_USED(MODULE_SOCK_ASYNC_SET)
+            _socket_pool[i].set_entry = NULL;
 #endif
             return &_socket_pool[i];
         }
@@ -376,6 +385,11 @@ static void _async_cb(void *sock, sock_async_flags_t type,
         }
 #endif
     }
+#if IS_USED(MODULE_SOCK_ASYNC_SET)
+    if (socket->set_entry) {
+        sock_set_notify(socket->set_entry, type);
+    }
+#endif
 }
 
 static void _sock_set_cb(socket_t *socket)
@@ -1204,6 +1218,22 @@ int posix_socket_select(int fd)
     return -1;
 }
 
+#if IS_USED(MODULE_SOCK_ASYNC_SET)
+int posix_socket_set_entry(int fd, sock_set_entry_t *entry)
+{
+    socket_t *socket = _get_socket(fd);
+
+    if (socket == NULL) {
+        return -ENOTSOCK;
+    }
+    if ((entry != NULL) && (socket->set_entry != NULL)) {
+        return -EBUSY;
+    }
+    socket->set_entry = entry;
+    return 0;
+}
+#endif
+
 /**
  * @}
  */
@@ -0,0 +1,245 @@
+/*
+ * Copyright (C) 2023 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     sys_saul_sampler
+ * @{
+ *
+ * @file
+ * @brief       SAUL sampling scheduler implementation
+ *
+ * @}
+ */
+
+#include <assert.h>
+#include <errno.h>
+
+#include "msg.h"
+#include "mutex.h"
+#include "saul_sampler.h"
+#include "thread.h"
+#include "ztimer.h"
+
+#define ENABLE_DEBUG 0
+#include "debug.h"
+
+#define BUF_MASK        (CONFIG_SAUL_SAMPLER_BUF_NUMOF - 1)
+#define MSG_QUEUE_SIZE  (2)
+
+static_assert((CONFIG_SAUL_SAMPLER_BUF_NUMOF & BUF_MASK) == 0,
+              "CONFIG_SAUL_SAMPLER_BUF_NUMOF must be a power of two");
+
+static char _stack[SAUL_SAMPLER_STACK_SIZE];
+static kernel_pid_t _pid = KERNEL_PID_UNDEF;
+
+/* protects the schedule, held by the sampler thread while reading devices */
+static mutex_t _lock = MUTEX_INIT;
+static saul_sampler_entry_t *_entries;
+
+/* protects the ring buffer, never held while reading devices */
+static mutex_t _buf_lock = MUTEX_INIT;
+static saul_sample_t _buf[CONFIG_SAUL_SAMPLER_BUF_NUMOF];
+/* number of samples ever taken, the newest is at _buf[(_seq - 1) & BUF_MASK] */
+static uint32_t _seq;
+
+static bool _is_due(const saul_sampler_entry_t *entry, uint32_t now)
+{
+    return (int32_t)(entry->due - now) <= (int32_t)CONFIG_SAUL_SAMPLER_MERGE_MS;
+}
+
+/* finds the next due entry after @p entry, with bus key @p bus if not 0 */
+static saul_sampler_entry_t *_next_due(saul_sampler_entry_t *entry,
+                                       uint8_t bus, uint32_t now)
+{
+    for (; entry; entry = entry->next) {
+        if ((!bus || (entry->bus == bus)) && _is_due(entry, now)) {
+            break;
+        }
+    }
+    return entry;
+}
+
+static void _sample(saul_sampler_entry_t *entry)
+{
+    phydat_t data = { 0 };
+    int res = saul_reg_read(entry->dev, &data);
+    uint32_t now = ztimer_now(ZTIMER_MSEC);
+
+    DEBUG("saul_sampler: read %s: %d\n", entry->dev->name, res);
+
+    mutex_lock(&_buf_lock);
+    saul_sample_t *sample = &_buf[_seq & BUF_MASK];
+    sample->dev = entry->dev;
+    sample->time = now;
+    sample->data = data;
+    sample->res = res;
+    _seq++;
+    mutex_unlock(&_buf_lock);
+
+    entry->due += entry->period;
+    /* skip the reads that were missed instead of catching up */
+    if (_is_due(entry, now)) {
+        entry->due = now + entry->period;
+    }
+}
+
+/* reads all due devices, returns the time until the next one is due or -1 */
+static int32_t _run(void)
+{
+    saul_sampler_entry_t *entry;
+    uint32_t now = ztimer_now(ZTIMER_MSEC);
+    int32_t timeout = -1;
+
+    while ((entry = _next_due(_entries, 0, now))) {
+        uint8_t bus = entry->bus;
+
+        /* read the due devices on the same bus in a row */
+        do {
+            _sample(entry);
+        } while (bus && (entry = _next_due(entry->next, bus, now)));
+        now = ztimer_now(ZTIMER_MSEC);
+    }
+
+    for (entry = _entries; entry; entry = entry->next) {
+        int32_t left = entry->due - now;
+
+        if ((timeout < 0) || (left < timeout)) {
+            timeout = left;
+        }
+    }
+    return timeout;
+}
+
+static void *_thread(void *arg)
+{
+    (void)arg;
+    msg_t queue[MSG_QUEUE_SIZE];
+    msg_t msg;
+
+    msg_init_queue(queue, MSG_QUEUE_SIZE);
+
+    while (1) {
+        mutex_lock(&_lock);
+        int32_t timeout = _run();
+        mutex_unlock(&_lock);
+
+        if (timeout < 0) {
+            msg_receive(&msg);
+        }
+        else {
+            ztimer_msg_receive_timeout(ZTIMER_MSEC, &msg, timeout);
+        }
+    }
+
+    return NULL;
+}
+
+/* makes the sampler thread look at the schedule again */
+static void _wakeup(void)
+{
+    msg_t msg = { 0 };
+
+    if (_pid != KERNEL_PID_UNDEF) {
+        /* a full queue already wakes the thread */
+        msg_try_send(&msg, _pid);
+    }
+}
+
+void saul_sampler_init(void)
+{
+    if (_pid != KERNEL_PID_UNDEF) {
+        return;
+    }
+    _pid = thread_create(_stack, sizeof(_stack), SAUL_SAMPLER_PRIO,
+                         THREAD_CREATE_STACKTEST, _thread, NULL,
+                         "saul_sampler");
+}
+
+int saul_sampler_add(saul_sampler_entry_t *entry, saul_reg_t *dev,
+                     uint32_t period, uint8_t bus)
+{
+    if (!dev || (period <= CONFIG_SAUL_SAMPLER_MERGE_MS)) {
+        return -EINVAL;
+    }
+
+    entry->dev = dev;
+    entry->period = period;
+    entry->bus = bus;
+
+    mutex_lock(&_lock);
+    entry->due = ztimer_now(ZTIMER_MSEC);
+    entry->next = _entries;
+    _entries = entry;
+    mutex_unlock(&_lock);
+
+    _wakeup();
+    return 0;
+}
+
+void saul_sampler_remove(saul_sampler_entry_t *entry)
+{
+    mutex_lock(&_lock);
+    for (saul_sampler_entry_t **prev = &_entries; *prev; prev = &(*prev)->next) {
+        if (*prev == entry) {
+            *prev = entry->next;
+            break;
+        }
+    }
+    mutex_unlock(&_lock);
+
+    _wakeup();
+}
+
+void saul_sampler_cursor_init(saul_sampler_cursor_t *cursor)
+{
+    mutex_lock(&_buf_lock);
+    cursor->seq = _seq;
+    mutex_unlock(&_buf_lock);
+}
+
+int saul_sampler_read(saul_sampler_cursor_t *cursor, saul_sample_t *sample)
+{
+    int res = 0;
+
+    mutex_lock(&_buf_lock);
+    if (cursor->seq == _seq) {
+        res = -EAGAIN;
+    }
+    else if (_seq - cursor->seq > CONFIG_SAUL_SAMPLER_BUF_NUMOF) {
+        cursor->seq = _seq - CONFIG_SAUL_SAMPLER_BUF_NUMOF;
+        res = -EOVERFLOW;
+    }
+    else {
+        *sample = _buf[cursor->seq & BUF_MASK];
+        cursor->seq++;
+    }
+    mutex_unlock(&_buf_lock);
+
+    return res;
+}
+
+int saul_sampler_latest(const saul_reg_t *dev, saul_sample_t *sample)
+{
+    int res = -ENOENT;
+
+    mutex_lock(&_buf_lock);
+    uint32_t numof = (_seq < CONFIG_SAUL_SAMPLER_BUF_NUMOF)
+                   ? _seq : CONFIG_SAUL_SAMPLER_BUF_NUMOF;
+    for (uint32_t seq = _seq; numof--; ) {
+        const saul_sample_t *cur = &_buf[--seq & BUF_MASK];
+
+        if (cur->dev == dev) {
+            *sample = *cur;
+            res = 0;
+            break;
+        }
+    }
+    mutex_unlock(&_buf_lock);
+
+    return res;
+}
@@ -0,0 +1,258 @@
+/*
+ * Copyright (C) 2023 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include "base64.h"
+#include "fmt.h"
+#include "senml.h"
+#include "senml/json.h"
+
+/* largest float magnitude fmt_float() can format */
+#define FLOAT_MAX       (4294967295.0f)
+
+typedef struct {
+    char *buf;
+    size_t len;
+    size_t pos;
+    int res;
+} senml_json_t;
+
+static void _put(senml_json_t *j, const char *s, size_t n)
+{
+    if (j->pos + n <= j->len) {
+        memcpy(&j->buf[j->pos], s, n);
+    }
+    j->pos += n;
+}
+
+static void _put_str(senml_json_t *j, const char *s)
+{
+    _put(j, s, strlen(s));
+}
+
+static void _put_escaped(senml_json_t *j, const char *s, size_t n)
+{
+    static const char hex[] = "0123456789abcdef";
+
+    _put(j, "\"", 1);
+    for (const char *end = s + n; s < end; s++) {
+        uint8_t c = *s;
+
+        if ((c == '"') || (c == '\\')) {
+            char esc[2] = { '\\', c };
+            _put(j, esc, sizeof(esc));
+        }
+        else if (c < 0x20) {
+            char esc[6] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xf] };
+            _put(j, esc, sizeof(esc));
+        }
+        else {
+            _put(j, s, 1);
+        }
+    }
+    _put(j, "\"", 1);
+}
+
+/* starts a member, the first member of a record opens the object */
+static void _label(senml_json_t *j, const char *label)
+{
+    _put(j, j->pos ? ",\"" : "{\"", 2);
+    _put_str(j, label);
+    _put(j, "\":", 2);
+}
+
+static void _put_float(senml_json_t *j, float f)
+{
+    char tmp[24];
+
+    if (!((f > -FLOAT_MAX) && (f < FLOAT_MAX))) {
+        j->res = -ERANGE;
+        return;
+    }
+    _put(j, tmp, fmt_float(tmp, f, CONFIG_SENML_JSON_FLOAT_PRECISION));
+}
+
+static void _put_numeric(senml_json_t *j, const senml_numeric_t *v)
+{
+    char tmp[24];
+    size_t n = 0;
+
+    switch (v->type) {
+    case SENML_TYPE_NUMERIC_FLOAT:
+        _put_float(j, v->value.f);
+        return;
+    case SENML_TYPE_NUMERIC_DOUBLE:
+        _put_float(j, v->value.d);
+        return;
+    case SENML_TYPE_NUMERIC_INT:
+        n = fmt_s64_dec(tmp, v->value.i);
+        break;
+    case SENML_TYPE_NUMERIC_UINT:
+        n = fmt_u64_dec(tmp, v->value.u);
+        break;
+    case SENML_TYPE_NUMERIC_DECFRAC:
+        if ((v->value.df.e < 0) && (v->value.df.e > -10)) {
+            n = fmt_s32_dfp(tmp, v->value.df.m, v->value.df.e);
+        }
+        else {
+            n = fmt_s32_dec(tmp, v->value.df.m);
+            tmp[n++] = 'e';
+            n += fmt_s32_dec(&tmp[n], v->value.df.e);
+        }
+        break;
+    default:
+        break;
+    }
+    _put(j, tmp, n);
+}
+
+#if IS_ACTIVE(CONFIG_SENML_ATTR_VERSION)
+static void _put_uint(senml_json_t *j, uint64_t u)
+{
+    char tmp[20];
+
+    _put(j, tmp, fmt_u64_dec(tmp, u));
+}
+#endif
+
+static void _encode_start(senml_json_t *j, const senml_attr_t *attr,
+                          bool sum_value)
+{
+    (void)sum_value;
+
+    if (attr->base_name != NULL) {
+        _label(j, "bn");
+        _put_escaped(j, attr->base_name, strlen(attr->base_name));
+    }
+
+    if (attr->base_time.value.u != 0) {
+        _label(j, "bt");
+        _put_numeric(j, &attr->base_time);
+    }
+
+    if (attr->base_unit != SENML_UNIT_NONE) {
+        _label(j, "bu");
+        _put_escaped(j, senml_unit_to_str(attr->base_unit),
+                     strlen(senml_unit_to_str(attr->base_unit)));
+    }
+
+    if (attr->base_value.value.u != 0) {
+        _label(j, "bv");
+        _put_numeric(j, &attr->base_value);
+    }
+
+#if IS_ACTIVE(CONFIG_SENML_ATTR_SUM)
+    if (attr->base_sum.value.u != 0) {
+        _label(j, "bs");
+        _put_numeric(j, &attr->base_sum);
+    }
+#endif
+
+#if IS_ACTIVE(CONFIG_SENML_ATTR_VERSION)
+    if (attr->base_version != 0 && attr->base_version != 10) {
+        _label(j, "bver");
+        _put_uint(j, attr->base_version);
+    }
+#endif
+
+    if (attr->name != NULL) {
+        _label(j, "n");
+        _put_escaped(j, attr->name, strlen(attr->name));
+    }
+
+    if (attr->unit != SENML_UNIT_NONE) {
+        _label(j, "u");
+        _put_escaped(j, senml_unit_to_str(attr->unit),
+                     strlen(senml_unit_to_str(attr->unit)));
+    }
+
+#if IS_ACTIVE(CONFIG_SENML_ATTR_SUM)
+    if (sum_value || attr->sum.value.u != 0) {
+        _label(j, "s");
+        _put_numeric(j, &attr->sum);
+    }
+#endif
+
+    if (attr->time.value.u != 0) {
+        _label(j, "t");
+        _put_numeric(j, &attr->time);
+    }
+
+#if IS_ACTIVE(CONFIG_SENML_ATTR_UPDATE_TIME)
+    if (attr->update_time.value.u != 0) {
+        _label(j, "ut");
+        _put_numeric(j, &attr->update_time);
+    }
+#endif
+}
+
+static int _finish(senml_json_t *j)
+{
+    /* a record without any member is still an object */
+    _put_str(j, j->pos ? "}" : "{}");
+    return j->res ? j->res : (int)j->pos;
+}
+
+#if IS_ACTIVE(CONFIG_SENML_ATTR_SUM)
+int senml_encode_sum_json(char *buf, size_t len, const senml_attr_t *attr)
+{
+    senml_json_t j = { .buf = buf, .len = len };
+
+    _encode_start(&j, attr, true);
+    return _finish(&j);
+}
+#endif
+
+int senml_encode_bool_json(char *buf, size_t len, const senml_bool_value_t *val)
+{
+    senml_json_t j = { .buf = buf, .len = len };
+
+    _encode_start(&j, &val->attr, false);
+    _label(&j, "vb");
+    _put_str(&j, val->value ? "true" : "false");
+    return _finish(&j);
+}
+
+int senml_encode_value_json(char *buf, size_t len, const senml_value_t *val)
+{
+    senml_json_t j = { .buf = buf, .len = len };
+
+    _encode_start(&j, &val->attr, false);
+    _label(&j, "v");
+    _put_numeric(&j, &val->value);
+    return _finish(&j);
+}
+
+int senml_encode_string_json(char *buf, size_t len, const senml_string_value_t *val)
+{
+    senml_json_t j = { .buf = buf, .len = len };
+
+    _encode_start(&j, &val->attr, false);
+    _label(&j, "vs");
+    _put_escaped(&j, val->value, val->len);
+    return _finish(&j);
+}
+
+int senml_encode_data_json(char *buf, size_t len, const senml_data_value_t *val)
+{
+    senml_json_t j = { .buf = buf, .len = len };
+    size_t b64_len = base64_estimate_encode_size(val->len);
+
+    _encode_start(&j, &val->attr, false);
+    _label(&j, "vd");
+    _put(&j, "\"", 1);
+    /* base64url_encode() needs room for the padding, which is dropped */
+    if (j.pos + b64_len <= j.len) {
+        base64url_encode(val->value, val->len, &j.buf[j.pos], &b64_len);
+    }
+    j.pos += (4 * val->len + 2) / 3;
+    _put(&j, "\"", 1);
+    return _finish(&j);
+}
@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2023 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include <assert.h>
+#include <errno.h>
+
+#include "senml.h"
+#include "senml/stream.h"
+#if IS_USED(MODULE_SENML_CBOR)
+#include "senml/cbor.h"
+#endif
+#if IS_USED(MODULE_SENML_JSON)
+#include "senml/json.h"
+#endif
+
+/* CBOR array of indefinite length and its break code */
+#define CBOR_ARRAY_START    (0x9f)
+#define CBOR_BREAK          (0xff)
+
+static void _write(senml_stream_t *stream, const void *data, size_t len)
+{
+    if (stream->res) {
+        return;
+    }
+
+    ssize_t res = stream->write(stream->arg, data, len);
+
+    if (res < 0) {
+        stream->res = res;
+    }
+    else {
+        stream->len += len;
+    }
+}
+
+static void _write_byte(senml_stream_t *stream, uint8_t byte)
+{
+    _write(stream, &byte, 1);
+}
+
+void senml_stream_init(senml_stream_t *stream, senml_stream_format_t format,
+                       void *buf, size_t buf_len,
+                       senml_stream_write_t write, void *arg)
+{
+    assert(IS_USED(MODULE_SENML_CBOR) || (format != SENML_STREAM_CBOR));
+    assert(IS_USED(MODULE_SENML_JSON) || (format != SENML_STREAM_JSON));
+
+    stream->write = write;
+    stream->arg = arg;
+    stream->buf = buf;
+    stream->buf_len = buf_len;
+    stream->len = 0;
+    stream->res = 0;
+    stream->format = format;
+    stream->empty = true;
+
+    _write_byte(stream, (format == SENML_STREAM_CBOR) ? CBOR_ARRAY_START : '[');
+}
+
+/* writes a record that was encoded into the record buffer */
+static int _record(senml_stream_t *stream, int len)
+{
+    if (len < 0) {
+        stream->res = stream->res ? stream->res : len;
+    }
+    else if ((size_t)len > stream->buf_len) {
+        stream->res = stream->res ? stream->res : -ENOBUFS;
+    }
+    else {
+        if ((stream->format == SENML_STREAM_JSON) && !stream->empty) {
+            _write_byte(stream, ',');
+        }
+        _write(stream, stream->buf, len);
+        stream->empty = false;
+    }
+    return stream->res;
+}
+
+#if IS_USED(MODULE_SENML_CBOR)
+#define ENCODE_CBOR(stream, fn, val) \
+    ({ \
+        nanocbor_encoder_t enc; \
+        nanocbor_encoder_init(&enc, (stream)->buf, (stream)->buf_len); \
+        fn(&enc, val); \
+        (int)nanocbor_encoded_len(&enc); \
+    })
+#else
+#define ENCODE_CBOR(stream, fn, val)    (-ENOTSUP)
+#endif
+
+#if IS_USED(MODULE_SENML_JSON)
+#define ENCODE_JSON(stream, fn, val) \
+    fn((char *)(stream)->buf, (stream)->buf_len, val)
+#else
+#define ENCODE_JSON(stream, fn, val)    (-ENOTSUP)
+#endif
+
+/* encodes @p val with the encoder of the stream's format */
+#define ENCODE(stream, name, val) \
+    (((stream)->format == SENML_STREAM_CBOR) \
+     ? ENCODE_CBOR(stream, senml_encode_ ## name ## _cbor, val) \
+     : ENCODE_JSON(stream, senml_encode_ ## name ## _json, val))
+
+#if IS_ACTIVE(CONFIG_SENML_ATTR_SUM)
+int senml_stream_sum(senml_stream_t *stream, const senml_attr_t *attr)
+{
+    if (stream->res) {
+        return stream->res;
+    }
+    return _record(stream, ENCODE(stream, sum, attr));
+}
+#endif
+
+int senml_stream_bool(senml_stream_t *stream, const senml_bool_value_t *val)
+{
+    if (stream->res) {
+        return stream->res;
+    }
+    return _record(stream, ENCODE(stream, bool, val));
+}
+
+int senml_stream_value(senml_stream_t *stream, const senml_value_t *val)
+{
+    if (stream->res) {
+        return stream->res;
+    }
+    return _record(stream, ENCODE(stream, value, val));
+}
+
+int senml_stream_string(senml_stream_t *stream, const senml_string_value_t *val)
+{
+    if (stream->res) {
+        return stream->res;
+    }
+    return _record(stream, ENCODE(stream, string, val));
+}
+
+int senml_stream_data(senml_stream_t *stream, const senml_data_value_t *val)
+{
+    if (stream->res) {
+        return stream->res;
+    }
+    return _record(stream, ENCODE(stream, data, val));
+}
+
+ssize_t senml_stream_finish(senml_stream_t *stream)
+{
+    _write_byte(stream, (stream->format == SENML_STREAM_CBOR) ? CBOR_BREAK : ']');
+
+    return stream->res ? stream->res : (ssize_t)stream->len;
+}
+
+#if IS_USED(MODULE_NANOCOAP)
+ssize_t senml_stream_write_coap(void *arg, const void *data, size_t len)
+{
+    senml_stream_coap_t *sink = arg;
+
+    sink->pos += coap_blockwise_put_bytes(sink->slicer, sink->pos, data, len);
+    return len;
+}
+#endif
+
+#if IS_USED(MODULE_SOCK_TCP)
+ssize_t senml_stream_write_tcp(void *arg, const void *data, size_t len)
+{
+    const uint8_t *pos = data;
+    size_t left = len;
+
+    while (left) {
+        ssize_t res = sock_tcp_write(arg, pos, left);
+
+        if (res < 0) {
+            return res;
+        }
+        pos += res;
+        left -= res;
+    }
+    return len;
+}
+#endif
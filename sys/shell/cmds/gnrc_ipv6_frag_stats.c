@@ -15,6 +15,7 @@
 
 #include <stdio.h>
 
+#include "net/gnrc/ipv6/ext.h"
 #include "net/gnrc/ipv6/ext/frag.h"
 #include "shell.h"
 
@@ -29,6 +30,12 @@ static int _gnrc_ipv6_frag_stats(int argc, char **argv)
         printf("frag full: %u\n", stats->frag_full);
         printf("frags complete: %u\n", stats->fragments);
         printf("dgs complete: %u\n", stats->datagrams);
+        printf("budget drops: %u\n", stats->budget_drops);
+        printf("budget evicts: %u\n", stats->budget_evicts);
+        printf("quota evicts: %u\n", stats->quota_evicts);
+        printf("rbuf usage: %u/%u\n",
+               (unsigned)gnrc_ipv6_ext_frag_rbuf_usage(),
+               (unsigned)CONFIG_GNRC_IPV6_EXT_FRAG_RBUF_BUDGET);
     }
     return 0;
 }
@@ -0,0 +1,493 @@
+/*
+ * Copyright (C) 2023 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     sys_tslog
+ * @{
+ *
+ * @file
+ * @brief       Time-series log store implementation
+ *
+ * @}
+ */
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "checksum/crc16_ccitt.h"
+#include "macros/utils.h"
+#include "tslog.h"
+
+#define ENABLE_DEBUG 0
+#include "debug.h"
+
+#define TSLOG_MAGIC     (0x474f4c54UL)  /* "TLOG" */
+#define ERASED16        (0xffff)
+#define ERASED32        (0xffffffffUL)
+
+/* header at the start of every sector of the log */
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;
+    uint32_t ts_start;
+    uint16_t crc;           /* of the fields above */
+    uint16_t reserved;
+} _sector_hdr_t;
+
+/* header of a record, followed by the data padded to the write size */
+typedef struct {
+    uint32_t timestamp;
+    uint16_t len;
+    uint16_t crc;           /* of the fields above and the data */
+} _rec_hdr_t;
+
+static int _read(tslog_t *log, uint32_t sector, uint32_t pos,
+                 void *dest, size_t len)
+{
+    return mtd_read_page(log->mtd, dest, sector * log->mtd->pages_per_sector,
+                         pos, len);
+}
+
+static int _write(tslog_t *log, uint32_t sector, uint32_t pos,
+                  const void *src, size_t len)
+{
+    return mtd_write_page_raw(log->mtd, src, sector * log->mtd->pages_per_sector,
+                              pos, len);
+}
+
+static uint32_t _rec_size(const tslog_t *log, size_t len)
+{
+    return sizeof(_rec_hdr_t) + ((len + log->align - 1) & ~(log->align - 1UL));
+}
+
+static uint16_t _rec_crc(const _rec_hdr_t *hdr, const void *data)
+{
+    uint16_t crc = crc16_ccitt_false_calc((const uint8_t *)hdr,
+                                          offsetof(_rec_hdr_t, crc));
+    return crc16_ccitt_false_update(crc, data, hdr->len);
+}
+
+static bool _rec_erased(const _rec_hdr_t *hdr)
+{
+    return hdr->timestamp == ERASED32 && hdr->len == ERASED16
+        && hdr->crc == ERASED16;
+}
+
+/* checks the data of a record against its CRC, without a buffer for all of it */
+static int _rec_check(tslog_t *log, uint32_t sector, uint32_t pos,
+                      const _rec_hdr_t *hdr)
+{
+    uint8_t buf[32];
+    uint16_t crc = crc16_ccitt_false_calc((const uint8_t *)hdr,
+                                          offsetof(_rec_hdr_t, crc));
+
+    pos += sizeof(*hdr);
+    for (size_t done = 0; done < hdr->len;) {
+        size_t n = MIN(sizeof(buf), hdr->len - done);
+        int res = _read(log, sector, pos + done, buf, n);
+        if (res < 0) {
+            return res;
+        }
+        crc = crc16_ccitt_false_update(crc, buf, n);
+        done += n;
+    }
+    return crc == hdr->crc;
+}
+
+/* reads the header of the record at @p pos, returns 0 at the end of the
+ * records before @p end */
+static int _rec_read(tslog_t *log, uint32_t sector, uint32_t pos, uint32_t end,
+                     _rec_hdr_t *hdr)
+{
+    if (pos + sizeof(*hdr) > end) {
+        return 0;
+    }
+
+    int res = _read(log, sector, pos, hdr, sizeof(*hdr));
+    if (res < 0) {
+        return res;
+    }
+    if (hdr->len == ERASED16 || pos + _rec_size(log, hdr->len) > end) {
+        return 0;
+    }
+    return 1;
+}
+
+static uint16_t _sector_crc(const _sector_hdr_t *hdr)
+{
+    return crc16_ccitt_false_calc((const uint8_t *)hdr,
+                                  offsetof(_sector_hdr_t, crc));
+}
+
+/* erases the sector after the head and makes it the head */
+static int _open_sector(tslog_t *log, uint32_t timestamp)
+{
+    uint32_t next = (log->head + 1) % log->sectors_numof;
+
+    if (log->seq && next == log->tail) {
+        /* the log is full, drop its oldest records */
+        log->tail = (log->tail + 1) % log->sectors_numof;
+    }
+    log->sectors[next].seq = 0;
+
+    DEBUG("tslog: open sector %" PRIu32 "\n", next);
+    int res = mtd_erase_sector(log->mtd, next, 1);
+    if (res < 0) {
+        return res;
+    }
+
+    _sector_hdr_t hdr = {
+        .magic = TSLOG_MAGIC,
+        .seq = log->seq + 1,
+        .ts_start = timestamp,
+        .reserved = ERASED16,
+    };
+    hdr.crc = _sector_crc(&hdr);
+    res = _write(log, next, 0, &hdr, sizeof(hdr));
+    if (res < 0) {
+        return res;
+    }
+
+    if (log->seq == 0) {
+        log->tail = next;
+    }
+    log->sectors[next].seq = hdr.seq;
+    log->sectors[next].ts_start = timestamp;
+    log->seq = hdr.seq;
+    log->head = next;
+    log->head_pos = sizeof(hdr);
+    return 0;
+}
+
+/* finds the end of the records in the head sector */
+static int _restore_head(tslog_t *log)
+{
+    uint32_t pos = sizeof(_sector_hdr_t);
+
+    log->ts_last = log->sectors[log->head].ts_start;
+    while (pos + sizeof(_rec_hdr_t) <= log->sector_size) {
+        _rec_hdr_t hdr;
+        int res = _read(log, log->head, pos, &hdr, sizeof(hdr));
+        if (res < 0) {
+            return res;
+        }
+        if (_rec_erased(&hdr)) {
+            break;
+        }
+        if (pos + _rec_size(log, hdr.len) > log->sector_size) {
+            res = 0;
+        }
+        else {
+            res = _rec_check(log, log->head, pos, &hdr);
+            if (res < 0) {
+                return res;
+            }
+        }
+        if (res == 0) {
+            /* torn by a reset while writing, nothing can be appended after it */
+            DEBUG("tslog: torn record at %" PRIu32 "\n", pos);
+            pos = log->sector_size;
+            break;
+        }
+        log->ts_last = hdr.timestamp;
+        pos += _rec_size(log, hdr.len);
+    }
+    log->head_pos = pos;
+    return 0;
+}
+
+int tslog_init(tslog_t *log)
+{
+    mtd_dev_t *mtd = log->mtd;
+
+    int res = mtd_init(mtd);
+    if (res < 0) {
+        return res;
+    }
+
+    log->sectors_numof = MIN(log->sectors_numof, mtd->sector_count);
+    log->sector_size = mtd->page_size * mtd->pages_per_sector;
+    log->align = MAX(mtd->write_size, 1U);
+    if ((log->sectors_numof < 2) || (log->align > sizeof(_rec_hdr_t)) ||
+        (log->align & (log->align - 1))) {
+        return -EINVAL;
+    }
+
+    mutex_lock(&log->lock);
+
+    /* restore the state of the sectors from their headers */
+    uint32_t n = log->sectors_numof;
+    log->seq = 0;
+    log->head = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        _sector_hdr_t hdr;
+        res = _read(log, i, 0, &hdr, sizeof(hdr));
+        if (res < 0) {
+            goto out;
+        }
+        log->sectors[i].seq = 0;
+        if (hdr.magic != TSLOG_MAGIC || hdr.seq == 0 || hdr.crc != _sector_crc(&hdr)) {
+            continue;
+        }
+        log->sectors[i].seq = hdr.seq;
+        log->sectors[i].ts_start = hdr.ts_start;
+        if (hdr.seq > log->seq) {
+            log->seq = hdr.seq;
+            log->head = i;
+        }
+    }
+
+    log->tail = log->head;
+    if (log->seq == 0) {
+        DEBUG_PUTS("tslog: empty");
+        log->head_pos = log->sector_size;
+        goto out;
+    }
+
+    /* the log is the run of sectors numbered consecutively up to the head,
+     * others were left over from an interrupted erase */
+    while (1) {
+        uint32_t prev = (log->tail + n - 1) % n;
+        if (prev == log->head || log->sectors[prev].seq == 0 ||
+            log->sectors[prev].seq != log->sectors[log->tail].seq - 1) {
+            break;
+        }
+        log->tail = prev;
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        if (log->sectors[i].seq < log->sectors[log->tail].seq) {
+            log->sectors[i].seq = 0;
+        }
+    }
+
+    res = _restore_head(log);
+    DEBUG("tslog: sectors %" PRIu32 " to %" PRIu32 ", next record at %" PRIu32 "\n",
+          log->tail, log->head, log->head_pos);
+
+out:
+    mutex_unlock(&log->lock);
+    return res;
+}
+
+int tslog_append(tslog_t *log, uint32_t timestamp, const void *data, size_t len)
+{
+    if (len >= ERASED16 ||
+        _rec_size(log, len) > log->sector_size - sizeof(_sector_hdr_t)) {
+        return -EMSGSIZE;
+    }
+
+    int res = 0;
+    uint32_t size = _rec_size(log, len);
+
+    mutex_lock(&log->lock);
+
+    if (log->seq && timestamp < log->ts_last) {
+        res = -EINVAL;
+        goto out;
+    }
+    if (log->seq == 0 || log->head_pos + size > log->sector_size) {
+        res = _open_sector(log, timestamp);
+        if (res < 0) {
+            goto out;
+        }
+    }
+
+    _rec_hdr_t hdr = {
+        .timestamp = timestamp,
+        .len = len,
+    };
+    hdr.crc = _rec_crc(&hdr, data);
+
+    /* the data is written from the buffer of the caller, only a partial
+     * last write unit is copied to be padded */
+    uint32_t pos = log->head_pos;
+    size_t aligned = len & ~(log->align - 1UL);
+    res = _write(log, log->head, pos, &hdr, sizeof(hdr));
+    pos += sizeof(hdr);
+    if (res >= 0 && aligned) {
+        res = _write(log, log->head, pos, data, aligned);
+        pos += aligned;
+    }
+    if (res >= 0 && aligned < len) {
+        uint8_t pad[sizeof(_rec_hdr_t)];
+        memset(pad, 0xff, log->align);
+        memcpy(pad, (const uint8_t *)data + aligned, len - aligned);
+        res = _write(log, log->head, pos, pad, log->align);
+    }
+    if (res < 0) {
+        /* nothing can be appended after a partially written record */
+        log->head_pos = log->sector_size;
+        goto out;
+    }
+
+    log->head_pos += size;
+    log->ts_last = timestamp;
+
+out:
+    mutex_unlock(&log->lock);
+    return res < 0 ? res : 0;
+}
+
+int tslog_clear(tslog_t *log)
+{
+    int res = 0;
+
+    mutex_lock(&log->lock);
+
+    /* oldest first, so that an interrupted clear leaves the newest records */
+    if (log->seq) {
+        uint32_t i = log->tail;
+        while (1) {
+            log->sectors[i].seq = 0;
+            int err = mtd_erase_sector(log->mtd, i, 1);
+            if (err < 0) {
+                res = err;
+            }
+            if (i == log->head) {
+                break;
+            }
+            i = (i + 1) % log->sectors_numof;
+        }
+    }
+    log->seq = 0;
+    log->tail = log->head;
+    log->head_pos = log->sector_size;
+
+    mutex_unlock(&log->lock);
+    return res;
+}
+
+void tslog_query(tslog_t *log, tslog_iter_t *iter, uint32_t from, uint32_t to)
+{
+    mutex_lock(&log->lock);
+
+    iter->ts_from = from;
+    iter->ts_to = to;
+    iter->pos = sizeof(_sector_hdr_t);
+    iter->seq = 0;
+
+    if (log->seq) {
+        /* binary search for the last sector starting before @p from, as
+         * records at @p from may be at its end */
+        uint32_t n = log->sectors_numof;
+        uint32_t lo = 0;
+        uint32_t hi = log->seq - log->sectors[log->tail].seq;
+        while (lo < hi) {
+            uint32_t mid = lo + (hi - lo + 1) / 2;
+            if (log->sectors[(log->tail + mid) % n].ts_start < from) {
+                lo = mid;
+            }
+            else {
+                hi = mid - 1;
+            }
+        }
+        iter->sector = (log->tail + lo) % n;
+        iter->seq = log->sectors[iter->sector].seq;
+    }
+
+    mutex_unlock(&log->lock);
+}
+
+int tslog_next(tslog_t *log, tslog_iter_t *iter, tslog_rec_t *rec)
+{
+    int res = 0;
+
+    mutex_lock(&log->lock);
+
+    if (log->seq == 0) {
+        goto out;
+    }
+    if (iter->seq == 0) {
+        /* the log was empty when the iteration started */
+        iter->sector = log->tail;
+        iter->seq = log->sectors[log->tail].seq;
+        iter->pos = sizeof(_sector_hdr_t);
+    }
+
+    while (1) {
+        if (log->sectors[iter->sector].seq != iter->seq) {
+            res = -ESTALE;
+            break;
+        }
+
+        bool head = (iter->sector == log->head);
+        _rec_hdr_t hdr;
+        res = _rec_read(log, iter->sector, iter->pos,
+                        head ? log->head_pos : log->sector_size, &hdr);
+        if (res < 0) {
+            break;
+        }
+        if (res == 0) {
+            if (head) {
+                /* stay at the end to return records appended later */
+                break;
+            }
+            iter->sector = (iter->sector + 1) % log->sectors_numof;
+            iter->seq++;
+            iter->pos = sizeof(_sector_hdr_t);
+            continue;
+        }
+        if (hdr.timestamp > iter->ts_to) {
+            res = 0;
+            break;
+        }
+
+        uint32_t pos = iter->pos;
+        iter->pos += _rec_size(log, hdr.len);
+        if (hdr.timestamp < iter->ts_from) {
+            continue;
+        }
+
+        rec->timestamp = hdr.timestamp;
+        rec->seq = iter->seq;
+        rec->sector = iter->sector;
+        rec->offset = pos + sizeof(hdr);
+        rec->len = hdr.len;
+        rec->crc = hdr.crc;
+        break;
+    }
+
+out:
+    mutex_unlock(&log->lock);
+    return res;
+}
+
+int tslog_read(tslog_t *log, const tslog_rec_t *rec, void *dest,
+               size_t offset, size_t len)
+{
+    if (offset >= rec->len) {
+        return 0;
+    }
+    len = MIN(len, rec->len - offset);
+
+    int res;
+    mutex_lock(&log->lock);
+    if (log->sectors[rec->sector].seq != rec->seq) {
+        res = -ESTALE;
+    }
+    else {
+        res = _read(log, rec->sector, rec->offset + offset, dest, len);
+    }
+    mutex_unlock(&log->lock);
+
+    if (res < 0) {
+        return res;
+    }
+    if (offset == 0 && len == rec->len) {
+        _rec_hdr_t hdr = {
+            .timestamp = rec->timestamp,
+            .len = rec->len,
+        };
+        if (_rec_crc(&hdr, dest) != rec->crc) {
+            return -EBADMSG;
+        }
+    }
+    return len;
+}
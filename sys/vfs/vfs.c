@@ -23,7 +23,9 @@
 #include <fcntl.h> /* for O_ACCMODE, ..., fcntl */
 #include <unistd.h> /* for STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO */
 
+#include "bitfield.h"
 #include "container.h"
+#include "macros/utils.h"
 #include "modules.h"
 #include "vfs.h"
 #include "mutex.h"
@@ -72,6 +74,80 @@ static vfs_file_t _vfs_open_files[VFS_MAX_OPEN_FILES];
  */
 static clist_node_t _vfs_mounts_list;
 
+/**
+ * @internal
+ * @brief Mounts that are not below the mount point of another mount
+ *
+ * Mounts below a mount point are in the mount_child list of that mount, so
+ * that finding the mount of a path only compares the mount points along the
+ * path.
+ */
+static vfs_mount_t *_vfs_mount_tree;
+
+/**
+ * @internal
+ * @brief Entries of _vfs_open_files that _allocate_fd() may not hand out
+ *
+ * Bits are set for the fds in use, and always for the stdio fds
+ * (STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO).
+ */
+static BITFIELD(_vfs_fds_busy, VFS_MAX_OPEN_FILES) = { 0xe0 };
+
+#if IS_USED(MODULE_VFS_LOOKUP_CACHE)
+/**
+ * @internal
+ * @brief Cached result of looking up a path
+ */
+typedef struct {
+    vfs_mount_t *mp;        /**< mount of the path, NULL if unused */
+    int gen;                /**< gen of @p mp when looked up */
+    int data_gen;           /**< data_gen of @p mp when looked up */
+    int res;                /**< 0 if found, -ENOENT if not */
+    struct stat st;         /**< the file's status if found by vfs_stat() */
+    char path[CONFIG_VFS_LOOKUP_CACHE_PATH_LEN]; /**< absolute path */
+} _lookup_t;
+
+/**
+ * @internal
+ * @brief Lookup cache, guarded by _mount_mutex
+ */
+static _lookup_t _lookup_cache[CONFIG_VFS_LOOKUP_CACHE_NUMOF];
+
+/**
+ * @internal
+ * @brief Entry of _lookup_cache to replace next
+ */
+static uint8_t _lookup_next;
+#endif
+
+#if IS_USED(MODULE_VFS_READAHEAD)
+/**
+ * @internal
+ * @brief Data read ahead of the file position seen by the user
+ *
+ * The file position of the file system is at the end of the data.
+ */
+typedef struct {
+    vfs_file_t *filp;       /**< file the data was read from, NULL if unused */
+    int gen;                /**< data_gen of the file's mount when read */
+    uint16_t pos;           /**< bytes of @p buf already returned by vfs_read() */
+    uint16_t len;           /**< bytes in @p buf */
+    uint8_t buf[CONFIG_VFS_READAHEAD_SIZE]; /**< data read ahead */
+} _readahead_t;
+
+/**
+ * @internal
+ * @brief Readahead buffers, assigned under _open_mutex
+ */
+static _readahead_t _readahead[CONFIG_VFS_READAHEAD_NUMOF];
+
+/**
+ * @internal
+ * @brief Number of consecutive small reads of each fd
+ */
+static uint8_t _readahead_seq[VFS_MAX_OPEN_FILES];
+#endif
+
 /**
  * @internal
  * @brief Find an unused entry in the _vfs_open_files array and mark it as used
@@ -80,9 +156,8 @@ static clist_node_t _vfs_mounts_list;
  * corresponding slot in the open files table is already occupied, no iteration
  * is done to find another free number in this case.
  *
- * If the @p fd argument is negative, the algorithm will iterate through the
- * open files table until it find an unused slot and return the number of that
- * slot.
+ * If the @p fd argument is negative, the lowest unused slot is taken from the
+ * _vfs_fds_busy bitfield and its number is returned.
  *
  * @param[in]  fd  Desired fd number, use VFS_ANY_FD for any free fd
  *
@@ -142,9 +217,354 @@ static inline int _find_mount(vfs_mount_t **mountpp, const char *name, const cha
  */
 static inline int _fd_is_valid(int fd);
 
+/**
+ * @internal
+ * @brief Stop reading a file ahead, e.g. before seeking or writing it
+ *
+ * @param[in]  filp  open file
+ * @param[in]  seek  move the file position of the file system back to the one
+ *                   seen by the user, false if the file is about to be closed
+ *
+ * @return 0 on success
+ * @return <0 on error of the seek
+ */
+static int _readahead_reset(vfs_file_t *filp, bool seek);
+
 static mutex_t _mount_mutex = MUTEX_INIT;
 static mutex_t _open_mutex = MUTEX_INIT;
 
+/**
+ * @internal
+ * @brief Check whether the mount point of @p mountp is @p path or one of its
+ * parent directories
+ */
+static bool _is_below(const vfs_mount_t *mountp, const char *path, size_t path_len)
+{
+    size_t len = mountp->mount_point_len;
+    if (len > path_len) {
+        /* path name is shorter than the mount point name */
+        return false;
+    }
+    if ((len > 1) && (path[len] != '/') && (path[len] != '\0')) {
+        /* path does not have a directory separator where mount point name ends */
+        return false;
+    }
+    return strncmp(path, mountp->mount_point, len) == 0;
+}
+
+/**
+ * @internal
+ * @brief Find the mount with the longest mount point that @p name is below
+ *
+ * Must be called with _mount_mutex held.
+ */
+static vfs_mount_t *_tree_find(const char *name, size_t name_len)
+{
+    vfs_mount_t *found = NULL;
+    vfs_mount_t *it = _vfs_mount_tree;
+    while (it != NULL) {
+        if (_is_below(it, name, name_len)) {
+            /* continue with the mounts below this one */
+            found = it;
+            it = it->mount_child;
+        }
+        else {
+            it = it->mount_sibling;
+        }
+    }
+    return found;
+}
+
+/**
+ * @internal
+ * @brief Add a mount to the mount tree
+ *
+ * Must be called with _mount_mutex held.
+ */
+static void _tree_insert(vfs_mount_t *mountp)
+{
+    vfs_mount_t **list = &_vfs_mount_tree;
+    vfs_mount_t *it = *list;
+    while (it != NULL) {
+        if (_is_below(it, mountp->mount_point, mountp->mount_point_len)) {
+            list = &it->mount_child;
+            it = *list;
+        }
+        else {
+            it = it->mount_sibling;
+        }
+    }
+    /* mounts below the new mount point are moved below the new mount */
+    mountp->mount_child = NULL;
+    for (vfs_mount_t **pos = list; *pos != NULL;) {
+        it = *pos;
+        if (_is_below(mountp, it->mount_point, it->mount_point_len)) {
+            *pos = it->mount_sibling;
+            it->mount_sibling = mountp->mount_child;
+            mountp->mount_child = it;
+        }
+        else {
+            pos = &it->mount_sibling;
+        }
+    }
+    mountp->mount_sibling = *list;
+    *list = mountp;
+}
+
+/**
+ * @internal
+ * @brief Remove a mount from the mount tree
+ *
+ * Must be called with _mount_mutex held.
+ */
+static void _tree_remove(vfs_mount_t *mountp)
+{
+    vfs_mount_t **list = &_vfs_mount_tree;
+    while (*list != NULL) {
+        vfs_mount_t **pos = list;
+        while ((*pos != NULL) && (*pos != mountp)) {
+            pos = &(*pos)->mount_sibling;
+        }
+        if (*pos == mountp) {
+            *pos = mountp->mount_sibling;
+            /* mounts below the removed mount move up */
+            while (mountp->mount_child != NULL) {
+                vfs_mount_t *child = mountp->mount_child;
+                mountp->mount_child = child->mount_sibling;
+                child->mount_sibling = *list;
+                *list = child;
+            }
+            return;
+        }
+        /* descend to the mounts below the mount above mountp */
+        for (pos = list; *pos != NULL; pos = &(*pos)->mount_sibling) {
+            if (_is_below(*pos, mountp->mount_point, mountp->mount_point_len)) {
+                break;
+            }
+        }
+        if (*pos == NULL) {
+            return;
+        }
+        list = &(*pos)->mount_child;
+    }
+}
+
+/**
+ * @internal
+ * @brief Get the namespace modification count of a mount, to be passed to
+ * _lookup_put()
+ */
+static inline int _mount_gen(vfs_mount_t *mountp)
+{
+#if IS_USED(MODULE_VFS_LOOKUP_CACHE) || IS_USED(MODULE_VFS_READAHEAD)
+    return atomic_load(&mountp->gen);
+#else
+    (void)mountp;
+    return 0;
+#endif
+}
+
+/**
+ * @internal
+ * @brief Get the data modification count of a mount
+ */
+static inline int _mount_data_gen(vfs_mount_t *mountp)
+{
+#if IS_USED(MODULE_VFS_LOOKUP_CACHE) || IS_USED(MODULE_VFS_READAHEAD)
+    return atomic_load(&mountp->data_gen);
+#else
+    (void)mountp;
+    return 0;
+#endif
+}
+
+/**
+ * @internal
+ * @brief Invalidate the cached file status and read ahead data of a mount
+ * after writing to one of its files
+ *
+ * Must be called after the modification, so that no lookup that started
+ * before it is cached.
+ *
+ * @param[in]  mountp    modified mount, may be NULL
+ */
+static inline void _mount_written(vfs_mount_t *mountp)
+{
+#if IS_USED(MODULE_VFS_LOOKUP_CACHE) || IS_USED(MODULE_VFS_READAHEAD)
+    if (mountp != NULL) {
+        atomic_fetch_add(&mountp->data_gen, 1);
+    }
+#else
+    (void)mountp;
+#endif
+}
+
+/**
+ * @internal
+ * @brief Invalidate the cached lookups of a mount after creating or removing
+ * files on it
+ *
+ * Must be called after the modification, so that no lookup that started
+ * before it is cached.
+ *
+ * @param[in]  mountp    modified mount, may be NULL
+ */
+static inline void _mount_modified(vfs_mount_t *mountp)
+{
+#if IS_USED(MODULE_VFS_LOOKUP_CACHE) || IS_USED(MODULE_VFS_READAHEAD)
+    if (mountp != NULL) {
+        atomic_fetch_add(&mountp->gen, 1);
+    }
+#else
+    (void)mountp;
+#endif
+}
+
+/**
+ * @internal
+ * @brief Drop all cached lookups
+ *
+ * Must be called with _mount_mutex held.
+ */
+static inline void _lookup_flush(void)
+{
+#if IS_USED(MODULE_VFS_LOOKUP_CACHE)
+    for (unsigned i = 0; i < CONFIG_VFS_LOOKUP_CACHE_NUMOF; i++) {
+        _lookup_cache[i].mp = NULL;
+    }
+#endif
+}
+
+/**
+ * @internal
+ * @brief Drop the cached status of the files of a mount
+ *
+ * For file systems that only update the file status when syncing a file,
+ * without invalidating the read ahead data.
+ *
+ * @param[in]  mountp    synced mount
+ */
+static void _lookup_drop_status(vfs_mount_t *mountp)
+{
+#if IS_USED(MODULE_VFS_LOOKUP_CACHE)
+    mutex_lock(&_mount_mutex);
+    for (unsigned i = 0; i < CONFIG_VFS_LOOKUP_CACHE_NUMOF; i++) {
+        if ((_lookup_cache[i].mp == mountp) && (_lookup_cache[i].res == 0)) {
+            _lookup_cache[i].mp = NULL;
+        }
+    }
+    mutex_unlock(&_mount_mutex);
+#else
+    (void)mountp;
+#endif
+}
+
+/**
+ * @internal
+ * @brief Get the cached result of looking up @p path
+ *
+ * @param[in]  path  absolute path
+ * @param[out] buf   status of the file, if NULL, only a file not found is
+ *                   reported
+ *
+ * @return 0 if the file was found, @p buf is filled in
+ * @return -ENOENT if the file was not found
+ * @return -EAGAIN if there is no cached result
+ */
+static int _lookup_get(const char *path, struct stat *buf)
+{
+#if IS_USED(MODULE_VFS_LOOKUP_CACHE)
+    int res = -EAGAIN;
+    mutex_lock(&_mount_mutex);
+    for (unsigned i = 0; i < CONFIG_VFS_LOOKUP_CACHE_NUMOF; i++) {
+        _lookup_t *l = &_lookup_cache[i];
+        if ((l->mp == NULL) || (l->gen != atomic_load(&l->mp->gen)) ||
+            (strcmp(l->path, path) != 0)) {
+            continue;
+        }
+        if ((l->res == 0) && (l->data_gen != atomic_load(&l->mp->data_gen))) {
+            /* the file may have been written, its status is stale */
+            break;
+        }
+        if (l->res != 0) {
+            res = l->res;
+        }
+        else if (buf != NULL) {
+            *buf = l->st;
+            res = 0;
+        }
+        break;
+    }
+    mutex_unlock(&_mount_mutex);
+    return res;
+#else
+    (void)path;
+    (void)buf;
+    return -EAGAIN;
+#endif
+}
+
+/**
+ * @internal
+ * @brief Cache the result of looking up @p path on @p mountp
+ *
+ * Nothing is cached if the file system did not opt in, or if the mount was
+ * modified or the mounts changed since @p gen was taken. The status of a
+ * found file is also not cached if a file was written since @p data_gen was
+ * taken.
+ *
+ * @param[in]  mountp    mount the path was looked up on
+ * @param[in]  gen       result of _mount_gen() before the lookup
+ * @param[in]  data_gen  result of _mount_data_gen() before the lookup
+ * @param[in]  path      absolute path
+ * @param[in]  res       0 if found, -ENOENT if not
+ * @param[in]  buf       status of the file if found, may be NULL
+ */
+static void _lookup_put(vfs_mount_t *mountp, int gen, int data_gen,
+                        const char *path, int res, const struct stat *buf)
+{
+#if IS_USED(MODULE_VFS_LOOKUP_CACHE)
+    size_t len = strlen(path);
+    if (!(mountp->fs->flags & VFS_FS_FLAG_LOOKUP_CACHE) ||
+        (len >= CONFIG_VFS_LOOKUP_CACHE_PATH_LEN) || ((res == 0) && (buf == NULL))) {
+        return;
+    }
+    mutex_lock(&_mount_mutex);
+    if ((gen == atomic_load(&mountp->gen)) &&
+        ((res != 0) || (data_gen == atomic_load(&mountp->data_gen))) &&
+        (_tree_find(path, len) == mountp)) {
+        _lookup_t *l = NULL;
+        for (unsigned i = 0; i < CONFIG_VFS_LOOKUP_CACHE_NUMOF; i++) {
+            if ((_lookup_cache[i].mp != NULL) &&
+                (strcmp(_lookup_cache[i].path, path) == 0)) {
+                l = &_lookup_cache[i];
+                break;
+            }
+        }
+        if (l == NULL) {
+            l = &_lookup_cache[_lookup_next];
+            _lookup_next = (_lookup_next + 1) % CONFIG_VFS_LOOKUP_CACHE_NUMOF;
+        }
+        l->mp = mountp;
+        l->gen = gen;
+        l->data_gen = data_gen;
+        l->res = res;
+        if (buf != NULL) {
+            l->st = *buf;
+        }
+        memcpy(l->path, path, len + 1);
+    }
+    mutex_unlock(&_mount_mutex);
+#else
+    (void)mountp;
+    (void)gen;
+    (void)data_gen;
+    (void)path;
+    (void)res;
+    (void)buf;
+#endif
+}
+
 int vfs_close(int fd)
 {
     DEBUG("vfs_close: %d\n", fd);
@@ -153,11 +573,16 @@ int vfs_close(int fd)
         return res;
     }
     vfs_file_t *filp = &_vfs_open_files[fd];
+    _readahead_reset(filp, false);
     if (filp->f_op->close != NULL) {
         /* We will invalidate the fd regardless of the outcome of the file
          * system driver close() call below */
         res = filp->f_op->close(filp);
     }
+    if ((filp->flags & O_ACCMODE) != O_RDONLY) {
+        /* the file system may only update the file status on close */
+        _mount_written(filp->mp);
+    }
     _free_fd(fd);
     return res;
 }
@@ -239,14 +664,8 @@ int vfs_dstatvfs(vfs_DIR *dirp, struct statvfs *buf)
     return dirp->mp->fs->fs_op->statvfs(dirp->mp, "/", buf);
 }
 
-off_t vfs_lseek(int fd, off_t off, int whence)
+static off_t _lseek(vfs_file_t *filp, off_t off, int whence)
 {
-    DEBUG("vfs_lseek: %d, %ld, %d\n", fd, (long)off, whence);
-    int res = _fd_is_valid(fd);
-    if (res < 0) {
-        return res;
-    }
-    vfs_file_t *filp = &_vfs_open_files[fd];
     if (filp->f_op->lseek == NULL) {
         /* driver does not implement lseek() */
         /* default seek functionality is naive */
@@ -274,6 +693,149 @@ off_t vfs_lseek(int fd, off_t off, int whence)
     return filp->f_op->lseek(filp, off, whence);
 }
 
+#if IS_USED(MODULE_VFS_READAHEAD)
+static _readahead_t *_readahead_find(const vfs_file_t *filp)
+{
+    for (unsigned i = 0; i < CONFIG_VFS_READAHEAD_NUMOF; i++) {
+        if (_readahead[i].filp == filp) {
+            return &_readahead[i];
+        }
+    }
+    return NULL;
+}
+
+static _readahead_t *_readahead_alloc(vfs_file_t *filp)
+{
+    _readahead_t *ra = NULL;
+    mutex_lock(&_open_mutex);
+    for (unsigned i = 0; i < CONFIG_VFS_READAHEAD_NUMOF; i++) {
+        if (_readahead[i].filp == NULL) {
+            ra = &_readahead[i];
+            ra->filp = filp;
+            ra->pos = 0;
+            ra->len = 0;
+            break;
+        }
+    }
+    mutex_unlock(&_open_mutex);
+    return ra;
+}
+
+static int _readahead_free(_readahead_t *ra, bool seek)
+{
+    off_t res = 0;
+    if (seek && (ra->pos < ra->len)) {
+        res = _lseek(ra->filp, (off_t)ra->pos - ra->len, SEEK_CUR);
+    }
+    ra->filp = NULL;
+    return (res < 0) ? res : 0;
+}
+#endif
+
+static int _readahead_reset(vfs_file_t *filp, bool seek)
+{
+#if IS_USED(MODULE_VFS_READAHEAD)
+    _readahead_seq[filp - _vfs_open_files] = 0;
+    _readahead_t *ra = _readahead_find(filp);
+    if (ra != NULL) {
+        return _readahead_free(ra, seek);
+    }
+#else
+    (void)filp;
+    (void)seek;
+#endif
+    return 0;
+}
+
+/**
+ * @internal
+ * @brief Read from a file, through a readahead buffer if it is read
+ * sequentially
+ */
+static ssize_t _read(vfs_file_t *filp, void *dest, size_t count)
+{
+#if IS_USED(MODULE_VFS_READAHEAD)
+    if ((filp->mp == NULL) || !(filp->mp->fs->flags & VFS_FS_FLAG_READAHEAD)) {
+        return filp->f_op->read(filp, dest, count);
+    }
+    _readahead_t *ra = _readahead_find(filp);
+    if ((ra != NULL) && (ra->gen != _mount_data_gen(filp->mp))) {
+        /* the file may have been written since it was read ahead */
+        int res = _readahead_free(ra, true);
+        if (res < 0) {
+            return res;
+        }
+        ra = NULL;
+    }
+    if (ra == NULL) {
+        uint8_t *seq = &_readahead_seq[filp - _vfs_open_files];
+        if (count >= CONFIG_VFS_READAHEAD_SIZE) {
+            return filp->f_op->read(filp, dest, count);
+        }
+        if (*seq < CONFIG_VFS_READAHEAD_THRESHOLD) {
+            (*seq)++;
+            return filp->f_op->read(filp, dest, count);
+        }
+        ra = _readahead_alloc(filp);
+        if (ra == NULL) {
+            /* all buffers are in use */
+            return filp->f_op->read(filp, dest, count);
+        }
+        DEBUG("vfs_read: reading %p ahead\n", (void *)filp);
+    }
+    size_t done = 0;
+    while (done < count) {
+        if (ra->pos == ra->len) {
+            ssize_t res;
+            if (count - done >= CONFIG_VFS_READAHEAD_SIZE) {
+                /* no need to buffer the rest */
+                res = filp->f_op->read(filp, (uint8_t *)dest + done, count - done);
+                if (res > 0) {
+                    done += res;
+                }
+                else if ((res < 0) && (done == 0)) {
+                    return res;
+                }
+                break;
+            }
+            ra->gen = _mount_data_gen(filp->mp);
+            res = filp->f_op->read(filp, ra->buf, sizeof(ra->buf));
+            ra->pos = 0;
+            ra->len = (res > 0) ? res : 0;
+            if ((res < 0) && (done == 0)) {
+                return res;
+            }
+            if (res <= 0) {
+                /* end of file */
+                break;
+            }
+        }
+        size_t n = MIN(count - done, (size_t)(ra->len - ra->pos));
+        memcpy((uint8_t *)dest + done, &ra->buf[ra->pos], n);
+        ra->pos += n;
+        done += n;
+    }
+    return done;
+#else
+    return filp->f_op->read(filp, dest, count);
+#endif
+}
+
+off_t vfs_lseek(int fd, off_t off, int whence)
+{
+    DEBUG("vfs_lseek: %d, %ld, %d\n", fd, (long)off, whence);
+    int res = _fd_is_valid(fd);
+    if (res < 0) {
+        return res;
+    }
+    vfs_file_t *filp = &_vfs_open_files[fd];
+    res = _readahead_reset(filp, true);
+    if (res < 0) {
+        return res;
+    }
+    return _lseek(filp, off, whence);
+}
+
 int vfs_open(const char *name, int flags, mode_t mode)
 {
     DEBUG("vfs_open: \"%s\", 0x%x, 0%03lo\n", name, flags, (long unsigned int)mode);
@@ -282,6 +844,11 @@ int vfs_open(const char *name, int flags, mode_t mode)
     }
     const char *rel_path;
     vfs_mount_t *mountp;
+    bool modifies = ((flags & O_ACCMODE) != O_RDONLY) || (flags & (O_CREAT | O_TRUNC));
+    if (!modifies && (_lookup_get(name, NULL) == -ENOENT)) {
+        DEBUG("vfs_open: cached ENOENT\n");
+        return -ENOENT;
+    }
     int res = _find_mount(&mountp, name, &rel_path);
     /* _find_mount implicitly increments the open_files count on success */
     if (res < 0) {
@@ -289,6 +856,8 @@ int vfs_open(const char *name, int flags, mode_t mode)
         DEBUG("vfs_open: no matching mount\n");
         return res;
     }
+    int gen = _mount_gen(mountp);
+    int data_gen = _mount_data_gen(mountp);
     mutex_lock(&_open_mutex);
     int fd = _init_fd(VFS_ANY_FD, mountp->fs->f_op, mountp, flags, NULL);
     mutex_unlock(&_open_mutex);
@@ -304,11 +873,20 @@ int vfs_open(const char *name, int flags, mode_t mode)
         if (res < 0) {
             /* something went wrong during open */
             DEBUG("vfs_open: open: ERR %d!\n", res);
+            if (!modifies && (res == -ENOENT)) {
+                _lookup_put(mountp, gen, data_gen, name, res, NULL);
+            }
             /* clean up */
             _free_fd(fd);
             return res;
         }
     }
+    if (flags & O_CREAT) {
+        _mount_modified(mountp);
+    }
+    if (flags & O_TRUNC) {
+        _mount_written(mountp);
+    }
     DEBUG("vfs_open: opened %d\n", fd);
     return fd;
 }
@@ -332,7 +910,7 @@ ssize_t vfs_read(int fd, void *dest, size_t count)
         /* driver does not implement read() */
         return -EINVAL;
     }
-    return filp->f_op->read(filp, dest, count);
+    return _read(filp, dest, count);
 }
 
 ssize_t vfs_write(int fd, const void *src, size_t count)
@@ -354,7 +932,13 @@ ssize_t vfs_write(int fd, const void *src, size_t count)
         /* driver does not implement write() */
         return -EINVAL;
     }
-    return filp->f_op->write(filp, src, count);
+    res = _readahead_reset(filp, true);
+    if (res < 0) {
+        return res;
+    }
+    res = filp->f_op->write(filp, src, count);
+    _mount_written(filp->mp);
+    return res;
 }
 
 ssize_t vfs_write_iol(int fd, const iolist_t *snips)
@@ -373,6 +957,118 @@ ssize_t vfs_write_iol(int fd, const iolist_t *snips)
     return sum;
 }
 
+/* positional I/O of drivers without preadv() or pwritev(), the position is
+ * restored afterwards */
+static ssize_t _prw_fallback(vfs_file_t *filp, const iolist_t *iolist,
+                             off_t off, bool write)
+{
+    if ((write && filp->f_op->write == NULL) || (!write && filp->f_op->read == NULL)) {
+        /* driver does not implement read() or write() */
+        return -EINVAL;
+    }
+    off_t pos = _lseek(filp, 0, SEEK_CUR);
+    if (pos < 0) {
+        return pos;
+    }
+    ssize_t res = _lseek(filp, off, SEEK_SET);
+    if (res < 0) {
+        return res;
+    }
+    ssize_t sum = 0;
+    for (; iolist; iolist = iolist->iol_next) {
+        res = write ? filp->f_op->write(filp, iolist->iol_base, iolist->iol_len)
+                    : filp->f_op->read(filp, iolist->iol_base, iolist->iol_len);
+        if (res < 0) {
+            break;
+        }
+        sum += res;
+        if ((size_t)res < iolist->iol_len) {
+            /* end of file */
+            break;
+        }
+    }
+    off = _lseek(filp, pos, SEEK_SET);
+    if (res < 0) {
+        return res;
+    }
+    if (off < 0) {
+        return off;
+    }
+    return sum;
+}
+
+ssize_t vfs_preadv(int fd, const iolist_t *iolist, off_t off)
+{
+    DEBUG("vfs_preadv: %d, %p, %ld\n", fd, (void *)iolist, (long)off);
+    if (off < 0) {
+        return -EINVAL;
+    }
+    int res = _fd_is_valid(fd);
+    if (res < 0) {
+        return res;
+    }
+    vfs_file_t *filp = &_vfs_open_files[fd];
+    if (((filp->flags & O_ACCMODE) != O_RDONLY) & ((filp->flags & O_ACCMODE) != O_RDWR)) {
+        /* File not open for reading */
+        return -EBADF;
+    }
+    if (filp->f_op->preadv == NULL) {
+        return _prw_fallback(filp, iolist, off, false);
+    }
+    return filp->f_op->preadv(filp, iolist, off);
+}
+
+ssize_t vfs_pwritev(int fd, const iolist_t *iolist, off_t off)
+{
+    DEBUG("vfs_pwritev: %d, %p, %ld\n", fd, (void *)iolist, (long)off);
+    if (off < 0) {
+        return -EINVAL;
+    }
+    int res = _fd_is_valid(fd);
+    if (res < 0) {
+        return res;
+    }
+    vfs_file_t *filp = &_vfs_open_files[fd];
+    if (((filp->flags & O_ACCMODE) != O_WRONLY) & ((filp->flags & O_ACCMODE) != O_RDWR)) {
+        /* File not open for writing */
+        return -EBADF;
+    }
+    ssize_t ret;
+    if (filp->f_op->pwritev == NULL) {
+        ret = _prw_fallback(filp, iolist, off, true);
+    }
+    else {
+        ret = filp->f_op->pwritev(filp, iolist, off);
+    }
+    _mount_written(filp->mp);
+    return ret;
+}
+
+int vfs_mmap(int fd, off_t off, size_t len, const void **addr)
+{
+    DEBUG("vfs_mmap: %d, %ld, %lu\n", fd, (long)off, (unsigned long)len);
+    if (addr == NULL) {
+        return -EFAULT;
+    }
+    if (off < 0) {
+        return -EINVAL;
+    }
+    int res = _fd_is_valid(fd);
+    if (res < 0) {
+        return res;
+    }
+    vfs_file_t *filp = &_vfs_open_files[fd];
+    if (((filp->flags & O_ACCMODE) != O_RDONLY) & ((filp->flags & O_ACCMODE) != O_RDWR)) {
+        /* File not open for reading */
+        return -EACCES;
+    }
+    if (filp->f_op->mmap == NULL) {
+        /* driver does not implement mmap() */
+        return -ENODEV;
+    }
+    return filp->f_op->mmap(filp, off, len, addr);
+}
+
 int vfs_fsync(int fd)
 {
     DEBUG_NOT_STDOUT(fd, "vfs_fsync: %d\n", fd);
@@ -389,7 +1085,9 @@ int vfs_fsync(int fd)
         /* driver does not implement fsync() */
         return -EINVAL;
     }
-    return filp->f_op->fsync(filp);
+    res = filp->f_op->fsync(filp);
+    _lookup_drop_status(filp->mp);
+    return res;
 }
 
 int vfs_opendir(vfs_DIR *dirp, const char *dirname)
@@ -542,6 +1240,10 @@ int vfs_mount(vfs_mount_t *mountp)
     }
     /* Insert last in list. This property is relied on by vfs_iterate_mount_dirs. */
     clist_rpush(&_vfs_mounts_list, &mountp->list_entry);
+    _tree_insert(mountp);
+    /* paths below the new mount point are no longer looked up on the mount
+     * they were cached for */
+    _lookup_flush();
     mutex_unlock(&_mount_mutex);
     DEBUG("vfs_mount: mount done\n");
     return 0;
@@ -587,6 +1289,8 @@ int vfs_umount(vfs_mount_t *mountp, bool force)
         mutex_unlock(&_mount_mutex);
         return -EINVAL;
     }
+    _tree_remove(mountp);
+    _lookup_flush();
     mutex_unlock(&_mount_mutex);
     return 0;
 }
@@ -633,6 +1337,7 @@ int vfs_rename(const char *from_path, const char *to_path)
         return -EXDEV;
     }
     res = mountp->fs->fs_op->rename(mountp, rel_from, rel_to);
+    _mount_modified(mountp);
     DEBUG("vfs_rename: rename %p, \"%s\" -> \"%s\"", (void *)mountp, rel_from, rel_to);
     if (res < 0) {
         /* something went wrong during rename */
@@ -673,6 +1378,7 @@ int vfs_unlink(const char *name)
         return -EROFS;
     }
     res = mountp->fs->fs_op->unlink(mountp, rel_path);
+    _mount_modified(mountp);
     DEBUG("vfs_unlink: unlink %p, \"%s\"", (void *)mountp, rel_path);
     if (res < 0) {
         /* something went wrong during unlink */
@@ -710,6 +1416,7 @@ int vfs_mkdir(const char *name, mode_t mode)
         return -EROFS;
     }
     res = mountp->fs->fs_op->mkdir(mountp, rel_path, mode);
+    _mount_modified(mountp);
     DEBUG("vfs_mkdir: mkdir %p, \"%s\"", (void *)mountp, rel_path);
     if (res < 0) {
         /* something went wrong during mkdir */
@@ -747,6 +1454,7 @@ int vfs_rmdir(const char *name)
         return -EROFS;
     }
     res = mountp->fs->fs_op->rmdir(mountp, rel_path);
+    _mount_modified(mountp);
     DEBUG("vfs_rmdir: rmdir %p, \"%s\"", (void *)mountp, rel_path);
     if (res < 0) {
         /* something went wrong during rmdir */
@@ -769,6 +1477,11 @@ int vfs_stat(const char *restrict path, struct stat *restrict buf)
     const char *rel_path;
     vfs_mount_t *mountp;
     int res;
+    res = _lookup_get(path, buf);
+    if (res != -EAGAIN) {
+        DEBUG("vfs_stat: cached %d\n", res);
+        return res;
+    }
     res = _find_mount(&mountp, path, &rel_path);
     /* _find_mount implicitly increments the open_files count on success */
     if (res < 0) {
@@ -784,7 +1497,12 @@ int vfs_stat(const char *restrict path, struct stat *restrict buf)
         return -EPERM;
     }
     memset(buf, 0, sizeof(*buf));
+    int gen = _mount_gen(mountp);
+    int data_gen = _mount_data_gen(mountp);
     res = mountp->fs->fs_op->stat(mountp, rel_path, buf);
+    if ((res == 0) || (res == -ENOENT)) {
+        _lookup_put(mountp, gen, data_gen, path, res, buf);
+    }
     /* remember to decrement the open_files count */
     atomic_fetch_sub(&mountp->open_files, 1);
     return res;
@@ -983,20 +1701,17 @@ const vfs_file_t *vfs_file_get(int fd)
 static inline int _allocate_fd(int fd)
 {
     if (fd < 0) {
-        for (fd = 0; fd < VFS_MAX_OPEN_FILES; ++fd) {
-            if ((fd == STDIN_FILENO) || (fd == STDOUT_FILENO) || (fd == STDERR_FILENO)) {
-                /* Do not auto-allocate the stdio file descriptor numbers to
-                 * avoid conflicts between normal file system users and stdio
-                 * drivers such as stdio_uart, stdio_rtt which need to be able
-                 * to bind to these specific file descriptor numbers. */
-                continue;
-            }
-            if (_vfs_open_files[fd].pid == KERNEL_PID_UNDEF) {
-                break;
-            }
+        /* The stdio file descriptor numbers are never auto-allocated, to
+         * avoid conflicts between normal file system users and stdio drivers
+         * such as stdio_uart, stdio_rtt which need to be able to bind to
+         * these specific file descriptor numbers: their bits are always set. */
+        fd = bf_get_unset(_vfs_fds_busy, VFS_MAX_OPEN_FILES);
+        if (fd < 0) {
+            /* The _vfs_open_files array is full */
+            return -ENFILE;
         }
     }
-    if (fd >= VFS_MAX_OPEN_FILES) {
+    else if (fd >= VFS_MAX_OPEN_FILES) {
         /* The _vfs_open_files array is full */
         return -ENFILE;
     }
@@ -1004,6 +1719,9 @@ static inline int _allocate_fd(int fd)
         /* The desired fd is already in use */
         return -EEXIST;
     }
+    else {
+        bf_set_atomic(_vfs_fds_busy, fd);
+    }
     kernel_pid_t pid = thread_getpid();
     if (pid == KERNEL_PID_UNDEF) {
         /* This happens when calling vfs_bind during boot, before threads have
@@ -1021,6 +1739,9 @@ static inline void _free_fd(int fd)
         atomic_fetch_sub(&_vfs_open_files[fd].mp->open_files, 1);
     }
     _vfs_open_files[fd].pid = KERNEL_PID_UNDEF;
+    if ((fd != STDIN_FILENO) && (fd != STDOUT_FILENO) && (fd != STDERR_FILENO)) {
+        bf_unset_atomic(_vfs_fds_busy, fd);
+    }
 }
 
 static inline int _init_fd(int fd, const vfs_file_ops_t *f_op, vfs_mount_t *mountp, int flags, void *private_data)
@@ -1040,42 +1761,10 @@ static inline int _init_fd(int fd, const vfs_file_ops_t *f_op, vfs_mount_t *moun
 
 static inline int _find_mount(vfs_mount_t **mountpp, const char *name, const char **rel_path)
 {
-    size_t longest_match = 0;
     size_t name_len = strlen(name);
     mutex_lock(&_mount_mutex);
 
-    clist_node_t *node = _vfs_mounts_list.next;
-    if (node == NULL) {
-        /* list empty */
-        mutex_unlock(&_mount_mutex);
-        return -ENOENT;
-    }
-    vfs_mount_t *mountp = NULL;
-    do {
-        node = node->next;
-        vfs_mount_t *it = container_of(node, vfs_mount_t, list_entry);
-        size_t len = it->mount_point_len;
-        if (len < longest_match) {
-            /* Already found a longer prefix */
-            continue;
-        }
-        if (len > name_len) {
-            /* path name is shorter than the mount point name */
-            continue;
-        }
-        if ((len > 1) && (name[len] != '/') && (name[len] != '\0')) {
-            /* name does not have a directory separator where mount point name ends */
-            continue;
-        }
-        if (strncmp(name, it->mount_point, len) == 0) {
-            /* mount_point is a prefix of name */
-            /* special check for mount_point == "/" */
-            if (len > 1) {
-                longest_match = len;
-            }
-            mountp = it;
-        }
-    } while (node != _vfs_mounts_list.next);
+    vfs_mount_t *mountp = _tree_find(name, name_len);
     if (mountp == NULL) {
         /* not found */
         mutex_unlock(&_mount_mutex);
@@ -1089,8 +1778,11 @@ static inline int _find_mount(vfs_mount_t **mountpp, const char *name, const cha
     if (rel_path != NULL) {
         if (mountp->fs->flags & VFS_FS_FLAG_WANT_ABS_PATH) {
             *rel_path = name;
+        } else if (mountp->mount_point_len > 1) {
+            *rel_path = name + mountp->mount_point_len;
         } else {
-            *rel_path = name + longest_match;
+            /* special case for mount_point == "/" */
+            *rel_path = name;
         }
     }
     return 0;
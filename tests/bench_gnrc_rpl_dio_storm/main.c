@@ -0,0 +1,220 @@
+/*
+ * Copyright (C) 2023 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Measure the runtime of RPL DIO processing under parent churn
+ *
+ * @}
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "benchmark.h"
+#include "msg.h"
+#include "net/ethernet.h"
+#include "net/gnrc.h"
+#include "net/gnrc/netif/ethernet.h"
+#include "net/gnrc/netif/hdr.h"
+#include "net/gnrc/rpl.h"
+#include "net/gnrc/rpl/mrhof.h"
+#include "net/icmpv6.h"
+#include "net/ipv6/hdr.h"
+#include "net/netdev_test.h"
+#include "test_utils/expect.h"
+
+#ifndef BENCH_RUNS
+#define BENCH_RUNS          (10000UL)
+#endif
+
+#define OF0_INSTANCE_ID     (1U)
+#define MRHOF_INSTANCE_ID   (2U)
+#define MIN_HOP_RANK_INC    (256U)
+#define NEIGHBORS_NUMOF     (8U)
+
+/**
+ * @brief   A DIO of the trace
+ */
+typedef struct {
+    uint8_t neighbor;   /**< index of the sending neighbor */
+    uint16_t rank;      /**< rank advertised by the neighbor */
+} _dio_event_t;
+
+/* DIO trace of a node in a dense part of a mesh with eight neighbors two to
+ * four hops away from the root whose ranks fluctuate during churn */
+static const _dio_event_t _trace[] = {
+    { 0, 512 }, { 1, 768 }, { 2, 512 }, { 3, 1024 },
+    { 4, 768 }, { 5, 1280 }, { 6, 768 }, { 7, 1024 },
+    { 0, 768 }, { 2, 512 }, { 1, 512 }, { 3, 768 },
+    { 0, 512 }, { 4, 1024 }, { 6, 512 }, { 5, 1024 },
+    { 2, 768 }, { 7, 768 }, { 1, 768 }, { 0, 512 },
+    { 3, 1024 }, { 6, 768 }, { 2, 512 }, { 4, 768 },
+    { 5, 1280 }, { 0, 768 }, { 1, 512 }, { 7, 1024 },
+    { 6, 512 }, { 2, 768 }, { 3, 768 }, { 0, 512 },
+};
+
+static const ipv6_addr_t _dodag_id = {
+    .u8 = { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x01 }
+};
+static const ipv6_addr_t _own_addr = {
+    .u8 = { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x42 }
+};
+
+static gnrc_netif_t _netif;
+static netdev_test_t _mock_netdev;
+static char _mock_netif_stack[THREAD_STACKSIZE_DEFAULT];
+static unsigned _next_event;
+static unsigned _switches;
+static unsigned _rank_changes;
+
+static int _get_device_type(netdev_t *dev, void *value, size_t max_len)
+{
+    (void)dev;
+    expect(max_len == sizeof(uint16_t));
+    *((uint16_t *)value) = NETDEV_TYPE_ETHERNET;
+    return sizeof(uint16_t);
+}
+
+static int _get_max_packet_size(netdev_t *dev, void *value, size_t max_len)
+{
+    (void)dev;
+    expect(max_len == sizeof(uint16_t));
+    *((uint16_t *)value) = ETHERNET_DATA_LEN;
+    return sizeof(uint16_t);
+}
+
+static int _get_address(netdev_t *dev, void *value, size_t max_len)
+{
+    static const uint8_t addr[] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x42 };
+
+    (void)dev;
+    expect(max_len >= sizeof(addr));
+    memcpy(value, addr, sizeof(addr));
+    return sizeof(addr);
+}
+
+static void _init_netif(void)
+{
+    netdev_test_setup(&_mock_netdev, 0);
+    netdev_test_set_get_cb(&_mock_netdev, NETOPT_DEVICE_TYPE,
+                           _get_device_type);
+    netdev_test_set_get_cb(&_mock_netdev, NETOPT_MAX_PDU_SIZE,
+                           _get_max_packet_size);
+    netdev_test_set_get_cb(&_mock_netdev, NETOPT_ADDRESS, _get_address);
+    expect(gnrc_netif_ethernet_create(&_netif, _mock_netif_stack,
+                                      sizeof(_mock_netif_stack),
+                                      GNRC_NETIF_PRIO, "mockup_eth",
+                                      &_mock_netdev.netdev.netdev) == 0);
+    expect(gnrc_netif_ipv6_addr_add(&_netif, &_own_addr, 64,
+                                    GNRC_NETIF_IPV6_ADDRS_FLAGS_STATE_VALID) > 0);
+}
+
+static void _recv_dio(uint8_t instance_id, uint16_t ocp, const _dio_event_t *event)
+{
+    const size_t size = sizeof(icmpv6_hdr_t) + sizeof(gnrc_rpl_dio_t) +
+                        sizeof(gnrc_rpl_opt_dodag_conf_t);
+    gnrc_pktsnip_t *netif, *ipv6, *icmpv6;
+    gnrc_rpl_opt_dodag_conf_t *conf;
+    gnrc_rpl_dio_t *dio;
+    ipv6_hdr_t *ipv6_hdr;
+
+    netif = gnrc_netif_hdr_build(NULL, 0, NULL, 0);
+    expect(netif != NULL);
+    gnrc_netif_hdr_set_netif(netif->data, &_netif);
+    ipv6 = gnrc_pktbuf_add(netif, NULL, sizeof(ipv6_hdr_t), GNRC_NETTYPE_IPV6);
+    expect(ipv6 != NULL);
+    icmpv6 = gnrc_pktbuf_add(ipv6, NULL, size, GNRC_NETTYPE_ICMPV6);
+    expect(icmpv6 != NULL);
+
+    ipv6_hdr = ipv6->data;
+    memset(ipv6_hdr, 0, sizeof(*ipv6_hdr));
+    ipv6_hdr_set_version(ipv6_hdr);
+    ipv6_hdr->len = byteorder_htons(size);
+    ipv6_hdr->nh = PROTNUM_ICMPV6;
+    ipv6_hdr->hl = 255;
+    ipv6_addr_set_link_local_prefix(&ipv6_hdr->src);
+    ipv6_hdr->src.u8[15] = event->neighbor + 1;
+    ipv6_hdr->dst = ipv6_addr_all_rpl_nodes;
+
+    memset(icmpv6->data, 0, size);
+    ((icmpv6_hdr_t *)icmpv6->data)->type = ICMPV6_RPL_CTRL;
+    ((icmpv6_hdr_t *)icmpv6->data)->code = GNRC_RPL_ICMPV6_CODE_DIO;
+    dio = (gnrc_rpl_dio_t *)(((icmpv6_hdr_t *)icmpv6->data) + 1);
+    dio->instance_id = instance_id;
+    dio->rank = byteorder_htons(event->rank);
+    /* grounded, storing mode without multicast */
+    dio->g_mop_prf = (1U << 7) | (GNRC_RPL_MOP_STORING_MODE_NO_MC << 3);
+    dio->dodag_id = _dodag_id;
+    conf = (gnrc_rpl_opt_dodag_conf_t *)(dio + 1);
+    conf->type = GNRC_RPL_OPT_DODAG_CONF;
+    conf->length = GNRC_RPL_OPT_DODAG_CONF_LEN;
+    conf->dio_int_doubl = CONFIG_GNRC_RPL_DEFAULT_DIO_INTERVAL_DOUBLINGS;
+    conf->dio_int_min = CONFIG_GNRC_RPL_DEFAULT_DIO_INTERVAL_MIN;
+    conf->dio_redun = CONFIG_GNRC_RPL_DEFAULT_DIO_REDUNDANCY_CONSTANT;
+    conf->min_hop_rank_inc = byteorder_htons(MIN_HOP_RANK_INC);
+    conf->ocp = byteorder_htons(ocp);
+    conf->default_lifetime = CONFIG_GNRC_RPL_DEFAULT_LIFETIME;
+    conf->lifetime_unit = byteorder_htons(CONFIG_GNRC_RPL_LIFETIME_UNIT);
+
+    /* the RPL thread has a higher priority, so the DIO is processed before
+     * this returns */
+    expect(gnrc_netapi_receive(gnrc_rpl_pid, icmpv6) > 0);
+}
+
+static void _replay(uint8_t instance_id, uint16_t ocp)
+{
+    gnrc_rpl_instance_t *inst = gnrc_rpl_instance_get(instance_id);
+    gnrc_rpl_parent_t *preferred = inst->dodag.parents;
+    uint16_t rank = inst->dodag.my_rank;
+
+    _recv_dio(instance_id, ocp, &_trace[_next_event]);
+    _next_event = (_next_event + 1) % ARRAY_SIZE(_trace);
+    if (preferred != inst->dodag.parents) {
+        _switches++;
+    }
+    if (rank != inst->dodag.my_rank) {
+        _rank_changes++;
+    }
+}
+
+static void _bench(const char *name, uint8_t instance_id, uint16_t ocp)
+{
+    char label[16];
+
+    /* join the DODAG via all neighbors */
+    for (unsigned i = 0; i < NEIGHBORS_NUMOF; i++) {
+        _recv_dio(instance_id, ocp, &_trace[i]);
+    }
+    expect(gnrc_rpl_instance_get(instance_id) != NULL);
+    expect(gnrc_rpl_instance_get(instance_id)->of->ocp == ocp);
+    _next_event = 0;
+    _switches = 0;
+    _rank_changes = 0;
+    snprintf(label, sizeof(label), "%s DIO", name);
+    BENCHMARK_FUNC(label, BENCH_RUNS, _replay(instance_id, ocp));
+    printf("%s: parent switches: %u, rank changes: %u\n", name, _switches,
+           _rank_changes);
+}
+
+int main(void)
+{
+    puts("RPL DIO storm benchmark\n");
+
+    _init_netif();
+    expect(gnrc_rpl_init(_netif.pid) != KERNEL_PID_UNDEF);
+
+    _bench("OF0", OF0_INSTANCE_ID, 0);
+    _bench("MRHOF", MRHOF_INSTANCE_ID, GNRC_RPL_MRHOF_OCP);
+
+    puts("\n[SUCCESS]");
+    return 0;
+}
@@ -0,0 +1,25 @@
+#!/usr/bin/env python3
+
+# Copyright (C) 2023 Freie Universität Berlin
+#
+# This file is subject to the terms and conditions of the GNU Lesser
+# General Public License v2.1. See the file LICENSE in the top level
+# directory for more details.
+
+import sys
+from testrunner import run
+
+
+BENCHMARK_REGEXP = r"\s+{func}:\s+\d+us\s+---\s+\d*\.*\d+us per call\s+---\s+\d+ calls per sec"
+
+
+def testfunc(child):
+    child.expect_exact('RPL DIO storm benchmark')
+    for of in ("OF0", "MRHOF"):
+        child.expect(BENCHMARK_REGEXP.format(func=of + " DIO"), timeout=60)
+        child.expect(r"{}: parent switches: \d+, rank changes: \d+".format(of))
+    child.expect_exact('[SUCCESS]')
+
+
+if __name__ == "__main__":
+    sys.exit(run(testfunc))
@@ -0,0 +1,376 @@
+/*
+ * Copyright (C) 2023 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Tests the publish queue and topic ID cache of emCute
+ *
+ * A gateway thread on the loopback address answers the messages of emCute
+ * and drops, holds back or rejects PUBLISH messages as set up by each test.
+ *
+ * @}
+ */
+
+#include <limits.h>
+#include <string.h>
+
+#include "byteorder.h"
+#include "container.h"
+#include "embUnit.h"
+#include "net/emcute.h"
+#include "net/ipv6/addr.h"
+#include "net/mqttsn.h"
+#include "net/sock/udp.h"
+#include "thread.h"
+#include "ztimer.h"
+
+#define EMCUTE_ID           "emcute pubq test"
+#define CLIENT_PORT         (CONFIG_EMCUTE_DEFAULT_PORT)
+#define GATEWAY_PORT        (CONFIG_EMCUTE_DEFAULT_PORT + 1)
+#define PUBLISH_MAX         (8U)
+#define HOLD_DELAY_MS       (100U)
+
+static struct {
+    unsigned connects;                  /**< CONNECTs received */
+    unsigned registers;                 /**< REGISTERs received */
+    unsigned publishes;                 /**< PUBLISHes received */
+    unsigned dups;                      /**< PUBLISHes with the DUP flag */
+    unsigned acks;                      /**< PUBACKs sent */
+    unsigned drop;                      /**< PUBLISHes to ignore */
+    unsigned hold;                      /**< PUBACKs to hold back */
+    uint8_t rc;                         /**< return code of PUBACKs */
+    uint16_t ids[PUBLISH_MAX];          /**< message IDs of the PUBLISHes */
+    unsigned acked[PUBLISH_MAX];        /**< PUBACKs sent before each PUBLISH */
+    uint8_t held[PUBLISH_MAX][7];       /**< held back PUBACKs */
+    unsigned held_numof;                /**< number of held back PUBACKs */
+} _gw;
+
+static char _gw_stack[THREAD_STACKSIZE_DEFAULT];
+static char _emcute_stack[THREAD_STACKSIZE_DEFAULT];
+static sock_udp_ep_t _gw_ep = { .family = AF_INET6, .port = GATEWAY_PORT };
+static const char _data[] = "measurement";
+
+static void _on_publish(sock_udp_t *sock, sock_udp_ep_t *remote,
+                        const uint8_t *buf, size_t pos)
+{
+    unsigned num = _gw.publishes++;
+    uint8_t ack[7] = { 7, MQTTSN_PUBACK, 0, 0, 0, 0, _gw.rc };
+
+    /* copy topic ID and message ID */
+    memcpy(&ack[2], &buf[pos + 2], 4);
+    if (buf[pos + 1] & MQTTSN_DUP) {
+        _gw.dups++;
+    }
+    if (num < PUBLISH_MAX) {
+        _gw.ids[num] = byteorder_bebuftohs(&buf[pos + 4]);
+        _gw.acked[num] = _gw.acks;
+    }
+
+    if (_gw.drop) {
+        _gw.drop--;
+        return;
+    }
+    if (_gw.hold) {
+        memcpy(_gw.held[_gw.held_numof++], ack, sizeof(ack));
+        if (_gw.held_numof < _gw.hold) {
+            return;
+        }
+        /* give the client time to queue more messages */
+        ztimer_sleep(ZTIMER_MSEC, HOLD_DELAY_MS);
+        for (unsigned i = 0; i < _gw.held_numof; i++) {
+            _gw.acks++;
+            sock_udp_send(sock, _gw.held[i], sizeof(ack), remote);
+        }
+        _gw.hold = 0;
+        _gw.held_numof = 0;
+        return;
+    }
+    _gw.acks++;
+    sock_udp_send(sock, ack, sizeof(ack), remote);
+}
+
+static void _handle(sock_udp_t *sock, sock_udp_ep_t *remote,
+                    const uint8_t *buf, size_t len)
+{
+    size_t pos = (buf[0] == 0x01) ? 3 : 1;
+
+    if (len < pos + 1) {
+        return;
+    }
+
+    switch (buf[pos]) {
+    case MQTTSN_CONNECT: {
+        uint8_t ack[3] = { 3, MQTTSN_CONNACK, MQTTSN_ACCEPTED };
+        _gw.connects++;
+        sock_udp_send(sock, ack, sizeof(ack), remote);
+        break;
+    }
+    case MQTTSN_REGISTER: {
+        uint8_t ack[7] = { 7, MQTTSN_REGACK, 0, 0, 0, 0, MQTTSN_ACCEPTED };
+        /* topic IDs are handed out in order of registration */
+        byteorder_htobebufs(&ack[2], ++_gw.registers);
+        memcpy(&ack[4], &buf[pos + 3], 2);
+        sock_udp_send(sock, ack, sizeof(ack), remote);
+        break;
+    }
+    case MQTTSN_PUBLISH:
+        _on_publish(sock, remote, buf, pos);
+        break;
+    case MQTTSN_PINGREQ:
+    case MQTTSN_DISCONNECT: {
+        uint8_t ack[2] = { 2, (buf[pos] == MQTTSN_PINGREQ) ? MQTTSN_PINGRESP
+                                                           : MQTTSN_DISCONNECT };
+        sock_udp_send(sock, ack, sizeof(ack), remote);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+static void *_gw_thread(void *arg)
+{
+    (void)arg;
+    sock_udp_ep_t local = { .family = AF_INET6, .port = GATEWAY_PORT };
+    sock_udp_t sock;
+    uint8_t buf[CONFIG_EMCUTE_BUFSIZE];
+
+    sock_udp_create(&sock, &local, NULL, 0);
+    while (1) {
+        sock_udp_ep_t remote;
+        ssize_t res = sock_udp_recv(&sock, buf, sizeof(buf), SOCK_NO_TIMEOUT,
+                                    &remote);
+        if (res >= 2) {
+            _handle(&sock, &remote, buf, res);
+        }
+    }
+
+    return NULL;
+}
+
+static void *_emcute_thread(void *arg)
+{
+    (void)arg;
+    emcute_run(CLIENT_PORT, EMCUTE_ID);
+    return NULL;    /* should never be reached */
+}
+
+static void _reg(emcute_topic_t *topic, const char *name)
+{
+    topic->name = name;
+    topic->id = 0;
+    TEST_ASSERT_EQUAL_INT(EMCUTE_OK, emcute_reg(topic));
+}
+
+static void set_up(void)
+{
+    memset(&_gw, 0, sizeof(_gw));
+    TEST_ASSERT_EQUAL_INT(EMCUTE_OK, emcute_con(&_gw_ep, true, NULL, NULL, 0, 0));
+}
+
+static void tear_down(void)
+{
+    emcute_discon();
+}
+
+static void test_pubq_window(void)
+{
+    emcute_topic_t topic;
+
+    _reg(&topic, "sensor");
+
+    /* all PUBACKs are sent once the window is full */
+    _gw.hold = CONFIG_EMCUTE_PUBQ_WINDOW;
+    for (unsigned i = 0; i <= CONFIG_EMCUTE_PUBQ_WINDOW; i++) {
+        TEST_ASSERT_EQUAL_INT(EMCUTE_OK,
+                              emcute_pub_queue(&topic, _data, sizeof(_data),
+                                               EMCUTE_QOS_1));
+    }
+    TEST_ASSERT_EQUAL_INT(EMCUTE_OK, emcute_pub_flush());
+
+    TEST_ASSERT_EQUAL_INT(CONFIG_EMCUTE_PUBQ_WINDOW + 1, _gw.publishes);
+    TEST_ASSERT_EQUAL_INT(CONFIG_EMCUTE_PUBQ_WINDOW + 1, _gw.acks);
+    TEST_ASSERT_EQUAL_INT(0, _gw.dups);
+    for (unsigned i = 0; i < CONFIG_EMCUTE_PUBQ_WINDOW; i++) {
+        /* the first messages were in flight at the same time */
+        TEST_ASSERT_EQUAL_INT(0, _gw.acked[i]);
+        for (unsigned j = 0; j < i; j++) {
+            TEST_ASSERT(_gw.ids[i] != _gw.ids[j]);
+        }
+    }
+    /* the last one waited for a free slot */
+    TEST_ASSERT_EQUAL_INT(CONFIG_EMCUTE_PUBQ_WINDOW,
+                          _gw.acked[CONFIG_EMCUTE_PUBQ_WINDOW]);
+}
+
+static void test_pubq_retry(void)
+{
+    emcute_topic_t topic;
+
+    _reg(&topic, "sensor");
+
+    _gw.drop = 1;
+    TEST_ASSERT_EQUAL_INT(EMCUTE_OK,
+                          emcute_pub_queue(&topic, _data, sizeof(_data),
+                                           EMCUTE_QOS_1));
+    TEST_ASSERT_EQUAL_INT(EMCUTE_OK, emcute_pub_flush());
+
+    /* the retransmission is a duplicate of the lost message */
+    TEST_ASSERT_EQUAL_INT(2, _gw.publishes);
+    TEST_ASSERT_EQUAL_INT(1, _gw.dups);
+    TEST_ASSERT_EQUAL_INT(_gw.ids[0], _gw.ids[1]);
+}
+
+static void test_pubq_reject(void)
+{
+    emcute_topic_t topic;
+
+    _reg(&topic, "sensor");
+
+    _gw.rc = MQTTSN_REJ_CONGESTION;
+    for (unsigned i = 0; i < 2; i++) {
+        TEST_ASSERT_EQUAL_INT(EMCUTE_OK,
+                              emcute_pub_queue(&topic, _data, sizeof(_data),
+                                               EMCUTE_QOS_1));
+    }
+    TEST_ASSERT_EQUAL_INT(EMCUTE_REJECT, emcute_pub_flush());
+
+    /* the error is reported once */
+    _gw.rc = MQTTSN_ACCEPTED;
+    TEST_ASSERT_EQUAL_INT(EMCUTE_OK,
+                          emcute_pub_queue(&topic, _data, sizeof(_data),
+                                           EMCUTE_QOS_1));
+    TEST_ASSERT_EQUAL_INT(EMCUTE_OK, emcute_pub_flush());
+    TEST_ASSERT_EQUAL_INT(0, _gw.dups);
+}
+
+static void test_pubq_timeout(void)
+{
+    emcute_topic_t topic;
+
+    _reg(&topic, "sensor");
+
+    _gw.drop = UINT_MAX;
+    TEST_ASSERT_EQUAL_INT(EMCUTE_OK,
+                          emcute_pub_queue(&topic, _data, sizeof(_data),
+                                           EMCUTE_QOS_1));
+    TEST_ASSERT_EQUAL_INT(EMCUTE_TIMEOUT, emcute_pub_flush());
+    TEST_ASSERT_EQUAL_INT(1 + CONFIG_EMCUTE_N_RETRY, _gw.publishes);
+    TEST_ASSERT_EQUAL_INT(CONFIG_EMCUTE_N_RETRY, _gw.dups);
+}
+
+static void test_pubq_discon(void)
+{
+    emcute_topic_t topic;
+
+    _reg(&topic, "sensor");
+
+    _gw.drop = UINT_MAX;
+    TEST_ASSERT_EQUAL_INT(EMCUTE_OK,
+                          emcute_pub_queue(&topic, _data, sizeof(_data),
+                                           EMCUTE_QOS_1));
+    TEST_ASSERT_EQUAL_INT(EMCUTE_OK, emcute_discon());
+
+    /* messages in flight are dropped, no new ones are accepted */
+    TEST_ASSERT_EQUAL_INT(EMCUTE_NOGW, emcute_pub_flush());
+    TEST_ASSERT_EQUAL_INT(EMCUTE_NOGW,
+                          emcute_pub_queue(&topic, _data, sizeof(_data),
+                                           EMCUTE_QOS_1));
+}
+
+static void test_pubq_qos0(void)
+{
+    emcute_topic_t topic;
+
+    _reg(&topic, "sensor");
+
+    /* QoS 0 messages are sent right away and not acknowledged */
+    _gw.drop = UINT_MAX;
+    TEST_ASSERT_EQUAL_INT(EMCUTE_OK,
+                          emcute_pub_queue(&topic, _data, sizeof(_data),
+                                           EMCUTE_QOS_0));
+    TEST_ASSERT_EQUAL_INT(EMCUTE_OK, emcute_pub_flush());
+    TEST_ASSERT_EQUAL_INT(1, _gw.publishes);
+}
+
+static void test_topic_cache(void)
+{
+    static const char *names[] = { "a", "b", "c", "d", "e" };
+    static const char long_name[] = "a topic name too long to be cached...";
+    emcute_topic_t topic;
+    uint16_t id;
+
+    _reg(&topic, "a");
+    id = topic.id;
+    TEST_ASSERT_EQUAL_INT(1, _gw.registers);
+
+    /* a cache hit needs no REGISTER */
+    _reg(&topic, "a");
+    TEST_ASSERT_EQUAL_INT(1, _gw.registers);
+    TEST_ASSERT_EQUAL_INT(id, topic.id);
+
+    /* "a" is replaced by "e" */
+    for (unsigned i = 1; i < ARRAY_SIZE(names); i++) {
+        _reg(&topic, names[i]);
+    }
+    TEST_ASSERT_EQUAL_INT(ARRAY_SIZE(names), _gw.registers);
+    for (unsigned i = 1; i < ARRAY_SIZE(names); i++) {
+        _reg(&topic, names[i]);
+    }
+    TEST_ASSERT_EQUAL_INT(ARRAY_SIZE(names), _gw.registers);
+    _reg(&topic, "a");
+    TEST_ASSERT_EQUAL_INT(ARRAY_SIZE(names) + 1, _gw.registers);
+
+    /* long names are not cached */
+    TEST_ASSERT(strlen(long_name) > CONFIG_EMCUTE_TOPIC_CACHE_NAMELEN);
+    _reg(&topic, long_name);
+    _reg(&topic, long_name);
+    TEST_ASSERT_EQUAL_INT(ARRAY_SIZE(names) + 3, _gw.registers);
+
+    /* the cache is cleared on connect */
+    TEST_ASSERT_EQUAL_INT(EMCUTE_OK, emcute_discon());
+    TEST_ASSERT_EQUAL_INT(EMCUTE_OK, emcute_con(&_gw_ep, true, NULL, NULL, 0, 0));
+    _reg(&topic, "e");
+    TEST_ASSERT_EQUAL_INT(ARRAY_SIZE(names) + 4, _gw.registers);
+}
+
+static Test *tests_emcute_pubq(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_pubq_window),
+        new_TestFixture(test_pubq_retry),
+        new_TestFixture(test_pubq_reject),
+        new_TestFixture(test_pubq_timeout),
+        new_TestFixture(test_pubq_discon),
+        new_TestFixture(test_pubq_qos0),
+        new_TestFixture(test_topic_cache),
+    };
+
+    EMB_UNIT_TESTCALLER(emcute_pubq_tests, set_up, tear_down, fixtures);
+
+    return (Test *)&emcute_pubq_tests;
+}
+
+int main(void)
+{
+    memcpy(_gw_ep.addr.ipv6, &ipv6_addr_loopback, sizeof(_gw_ep.addr.ipv6));
+
+    thread_create(_gw_stack, sizeof(_gw_stack), THREAD_PRIORITY_MAIN - 2,
+                  THREAD_CREATE_STACKTEST, _gw_thread, NULL, "gateway");
+    thread_create(_emcute_stack, sizeof(_emcute_stack), THREAD_PRIORITY_MAIN - 1,
+                  THREAD_CREATE_STACKTEST, _emcute_thread, NULL, "emcute");
+
+    TESTS_START();
+    TESTS_RUN(tests_emcute_pubq());
+    TESTS_END();
+
+    return 0;
+}
@@ -0,0 +1,319 @@
+/*
+ * Copyright (C) 2023 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Tests the open file cache of the CoAP file server
+ *
+ * The file server is called directly with requests on a file system that
+ * counts the operations on its only file.
+ *
+ * @}
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+
+#include "embUnit.h"
+#include "net/gcoap.h"
+#include "net/gcoap/fileserver.h"
+#include "vfs.h"
+
+#define BLOCK_SZX       (0)
+#define BLOCK_SIZE      (16)
+
+static const char _content[] = "Join us now and share the software!";
+static const char _changed[] = "You'll be free, hackers, you'll be free.";
+
+static struct {
+    char data[64];
+    size_t size;
+    bool exists;
+    unsigned mtime;
+    unsigned opens;
+    unsigned closes;
+    unsigned seeks;
+} _file;
+
+static uint8_t _buf[128];
+
+static int _open(vfs_file_t *filp, const char *name, int flags, mode_t mode)
+{
+    (void)filp;
+    (void)flags;
+    (void)mode;
+    if (strcmp(name, "/file") || !_file.exists) {
+        return -ENOENT;
+    }
+    _file.opens++;
+    return 0;
+}
+
+static int _close(vfs_file_t *filp)
+{
+    (void)filp;
+    _file.closes++;
+    return 0;
+}
+
+static ssize_t _read(vfs_file_t *filp, void *dest, size_t nbytes)
+{
+    if ((size_t)filp->pos >= _file.size) {
+        return 0;
+    }
+    if (nbytes > _file.size - filp->pos) {
+        nbytes = _file.size - filp->pos;
+    }
+    memcpy(dest, &_file.data[filp->pos], nbytes);
+    filp->pos += nbytes;
+    return nbytes;
+}
+
+static ssize_t _write(vfs_file_t *filp, const void *src, size_t nbytes)
+{
+    if (filp->pos + nbytes > sizeof(_file.data)) {
+        return -ENOSPC;
+    }
+    memcpy(&_file.data[filp->pos], src, nbytes);
+    filp->pos += nbytes;
+    if ((size_t)filp->pos > _file.size) {
+        _file.size = filp->pos;
+    }
+    _file.mtime++;
+    return nbytes;
+}
+
+static off_t _lseek(vfs_file_t *filp, off_t off, int whence)
+{
+    _file.seeks++;
+    switch (whence) {
+        case SEEK_SET:
+            break;
+        case SEEK_CUR:
+            off += filp->pos;
+            break;
+        case SEEK_END:
+            off += _file.size;
+            break;
+        default:
+            return -EINVAL;
+    }
+    if (off < 0) {
+        return -EINVAL;
+    }
+    filp->pos = off;
+    return off;
+}
+
+static int _stat(vfs_mount_t *mountp, const char *restrict path,
+                 struct stat *restrict buf)
+{
+    (void)mountp;
+    if (strcmp(path, "/file") || !_file.exists) {
+        return -ENOENT;
+    }
+    buf->st_mode = S_IFREG;
+    buf->st_size = _file.size;
+    buf->st_mtime = _file.mtime;
+    return 0;
+}
+
+static int _unlink(vfs_mount_t *mountp, const char *name)
+{
+    (void)mountp;
+    if (strcmp(name, "/file") || !_file.exists) {
+        return -ENOENT;
+    }
+    _file.exists = false;
+    return 0;
+}
+
+static const vfs_file_ops_t _file_ops = {
+    .open = _open,
+    .close = _close,
+    .read = _read,
+    .write = _write,
+    .lseek = _lseek,
+};
+
+static const vfs_file_system_ops_t _fs_ops = {
+    .stat = _stat,
+    .unlink = _unlink,
+};
+
+static const vfs_file_system_t _fs = {
+    .f_op = &_file_ops,
+    .fs_op = &_fs_ops,
+};
+
+static vfs_mount_t _mount = {
+    .fs = &_fs,
+    .mount_point = "/fs",
+};
+
+static const coap_resource_t _resource = {
+    .path = "/files",
+    .methods = COAP_GET | COAP_PUT | COAP_DELETE | COAP_MATCH_SUBTREE,
+    .handler = gcoap_fileserver_handler,
+    .context = "/fs",
+};
+
+/* sends a request for /files/file and parses the response into pdu */
+static void _request(coap_pkt_t *pdu, unsigned code, int blknum,
+                     const char *payload)
+{
+    coap_request_ctx_t ctx = { .resource = &_resource };
+    ssize_t len;
+
+    len = coap_build_hdr((coap_hdr_t *)_buf, COAP_TYPE_CON, NULL, 0, code, 1);
+    TEST_ASSERT(len > 0);
+    coap_pkt_init(pdu, _buf, sizeof(_buf), len);
+    coap_opt_add_uri_path(pdu, "/files/file");
+    if (blknum >= 0) {
+        coap_block1_t block = { .blknum = blknum, .szx = BLOCK_SZX };
+        coap_opt_add_block2_control(pdu, &block);
+    }
+    if (payload) {
+        len = coap_opt_finish(pdu, COAP_OPT_FINISH_PAYLOAD);
+        memcpy(pdu->payload, payload, strlen(payload));
+        len += strlen(payload);
+    }
+    else {
+        len = coap_opt_finish(pdu, COAP_OPT_FINISH_NONE);
+    }
+    TEST_ASSERT(coap_parse(pdu, _buf, len) >= 0);
+
+    len = gcoap_fileserver_handler(pdu, _buf, sizeof(_buf), &ctx);
+    TEST_ASSERT(len > 0);
+    TEST_ASSERT(coap_parse(pdu, _buf, len) >= 0);
+}
+
+/* gets a block of the file and checks it against content */
+static void _get_block(unsigned blknum, const char *content)
+{
+    size_t size = strlen(content);
+    size_t start = blknum * BLOCK_SIZE;
+    size_t end = (start + BLOCK_SIZE < size) ? start + BLOCK_SIZE : size;
+    coap_block1_t block;
+    coap_pkt_t pdu;
+
+    _request(&pdu, COAP_METHOD_GET, blknum, NULL);
+    TEST_ASSERT_EQUAL_INT(COAP_CODE_CONTENT, coap_get_code_raw(&pdu));
+    TEST_ASSERT_EQUAL_INT(1, coap_get_block2(&pdu, &block));
+    TEST_ASSERT_EQUAL_INT(blknum, block.blknum);
+    TEST_ASSERT_EQUAL_INT(BLOCK_SZX, block.szx);
+    TEST_ASSERT_EQUAL_INT(end < size, block.more);
+    TEST_ASSERT_EQUAL_INT(end - start, pdu.payload_len);
+    TEST_ASSERT(!memcmp(pdu.payload, &content[start], end - start));
+}
+
+static void setup(void)
+{
+    memset(&_file, 0, sizeof(_file));
+    memcpy(_file.data, _content, strlen(_content));
+    _file.size = strlen(_content);
+    _file.exists = true;
+}
+
+static void teardown(void)
+{
+    coap_pkt_t pdu;
+
+    /* drops the file from the cache */
+    if (_file.exists) {
+        _request(&pdu, COAP_METHOD_DELETE, -1, NULL);
+    }
+}
+
+static void test_sequential_blocks(void)
+{
+    _get_block(0, _content);
+    _get_block(1, _content);
+    _get_block(2, _content);
+    /* the cached file was opened once, and read on without seeking */
+    TEST_ASSERT_EQUAL_INT(1, _file.opens);
+    TEST_ASSERT_EQUAL_INT(0, _file.closes);
+    TEST_ASSERT_EQUAL_INT(0, _file.seeks);
+
+    /* going back needs a seek */
+    _get_block(1, _content);
+    TEST_ASSERT_EQUAL_INT(1, _file.opens);
+    TEST_ASSERT_EQUAL_INT(1, _file.seeks);
+    _get_block(2, _content);
+    TEST_ASSERT_EQUAL_INT(1, _file.seeks);
+}
+
+static void test_put_invalidates(void)
+{
+    coap_pkt_t pdu;
+
+    _get_block(0, _content);
+    _get_block(1, _content);
+    TEST_ASSERT_EQUAL_INT(1, _file.opens);
+
+    _request(&pdu, COAP_METHOD_PUT, -1, _changed);
+    TEST_ASSERT_EQUAL_INT(COAP_CODE_CHANGED, coap_get_code_raw(&pdu));
+    /* one open for writing, the cached file was closed */
+    TEST_ASSERT_EQUAL_INT(2, _file.opens);
+    TEST_ASSERT_EQUAL_INT(2, _file.closes);
+
+    /* the file is opened again and read from its start */
+    _file.seeks = 0;
+    _get_block(2, _changed);
+    TEST_ASSERT_EQUAL_INT(3, _file.opens);
+    TEST_ASSERT_EQUAL_INT(1, _file.seeks);
+    _get_block(0, _changed);
+    _get_block(1, _changed);
+    TEST_ASSERT_EQUAL_INT(3, _file.opens);
+}
+
+static void test_delete_invalidates(void)
+{
+    coap_pkt_t pdu;
+
+    _get_block(0, _content);
+    TEST_ASSERT_EQUAL_INT(1, _file.opens);
+
+    _request(&pdu, COAP_METHOD_DELETE, -1, NULL);
+    TEST_ASSERT_EQUAL_INT(COAP_CODE_DELETED, coap_get_code_raw(&pdu));
+    TEST_ASSERT_EQUAL_INT(1, _file.closes);
+    TEST_ASSERT(!_file.exists);
+
+    _request(&pdu, COAP_METHOD_GET, 1, NULL);
+    TEST_ASSERT_EQUAL_INT(COAP_CODE_PATH_NOT_FOUND, coap_get_code_raw(&pdu));
+    TEST_ASSERT_EQUAL_INT(1, _file.opens);
+}
+
+Test *tests_gcoap_fileserver_file_cache_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_sequential_blocks),
+        new_TestFixture(test_put_invalidates),
+        new_TestFixture(test_delete_invalidates),
+    };
+
+    EMB_UNIT_TESTCALLER(gcoap_fileserver_file_cache_tests, setup, teardown,
+                        fixtures);
+
+    return (Test *)&gcoap_fileserver_file_cache_tests;
+}
+
+int main(void)
+{
+    vfs_mount(&_mount);
+
+    TESTS_START();
+    TESTS_RUN(tests_gcoap_fileserver_file_cache_tests());
+    TESTS_END();
+
+    return 0;
+}
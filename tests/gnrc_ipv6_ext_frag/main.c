@@ -315,6 +315,8 @@ static void test_ipv6_ext_frag_reass_out_of_order(void)
     TEST_ASSERT_NOT_NULL((rbuf = gnrc_ipv6_ext_frag_rbuf_get(ipv6, TEST_ID)));
     TEST_ASSERT_NOT_NULL(rbuf->pkt);
     TEST_ASSERT_EQUAL_INT(sizeof(_exp_payload), rbuf->pkt->size);
+    TEST_ASSERT_EQUAL_INT(sizeof(_exp_payload),
+                          gnrc_ipv6_ext_frag_rbuf_usage());
     TEST_ASSERT_EQUAL_INT(TEST_ID, rbuf->id);
     TEST_ASSERT(rbuf->last);
     ptr = (gnrc_ipv6_ext_frag_limits_t *)rbuf->limits.next;
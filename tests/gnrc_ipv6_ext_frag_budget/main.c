@@ -0,0 +1,224 @@
+/*
+ * Copyright (C) 2023 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Tests the reassembly buffer limits of the IPv6 fragmentation
+ *              header handling of gnrc stack
+ *
+ * The reassembly buffer has 3 entries, a budget of 128 bytes and a quota of
+ * 2 entries per source.
+ *
+ * @}
+ */
+
+#include <assert.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "byteorder.h"
+#include "embUnit.h"
+#include "net/ipv6/addr.h"
+#include "net/ipv6/ext/frag.h"
+#include "net/protnum.h"
+#include "net/gnrc/ipv6/ext.h"
+#include "net/gnrc/ipv6/ext/frag.h"
+#include "net/gnrc/ipv6/hdr.h"
+#include "net/gnrc/pktbuf.h"
+
+#define TEST_HL             (64U)
+#define TEST_ID1            (0x52dacb1)
+#define TEST_ID2            (0x52dacb2)
+#define TEST_ID3            (0x52dacb3)
+/* a last fragment announcing a datagram of 64 bytes, a quarter received */
+#define TEST_LAST_OFFSET    (48U)
+#define TEST_LAST_LEN       (16U)
+/* a fragment from the middle of a datagram of unknown length */
+#define TEST_MID_OFFSET     (8U)
+#define TEST_MID_LEN        (8U)
+
+#if (CONFIG_GNRC_IPV6_EXT_FRAG_RBUF_SIZE != 3) || \
+    (CONFIG_GNRC_IPV6_EXT_FRAG_RBUF_BUDGET != 128) || \
+    (CONFIG_GNRC_IPV6_EXT_FRAG_RBUF_SRC_QUOTA != 2)
+#error "Tests are written for the reassembly buffer limits set in the Makefile"
+#endif
+
+static const ipv6_addr_t _src1 = { .u8 = { 0x20, 0x01, 0x0d, 0xb8,
+                                           [15] = 0x01 } };
+static const ipv6_addr_t _src2 = { .u8 = { 0x20, 0x01, 0x0d, 0xb8,
+                                           [15] = 0x02 } };
+static const ipv6_addr_t _src3 = { .u8 = { 0x20, 0x01, 0x0d, 0xb8,
+                                           [15] = 0x03 } };
+static const ipv6_addr_t _dst = { .u8 = { 0x20, 0x01, 0x0d, 0xb8,
+                                          [15] = 0xff } };
+
+static gnrc_pktsnip_t *_recv_frag(const ipv6_addr_t *src, uint32_t id,
+                                  unsigned offset, size_t len, bool more)
+{
+    gnrc_pktsnip_t *ipv6_snip = gnrc_ipv6_hdr_build(NULL, src, &_dst);
+    gnrc_pktsnip_t *pkt;
+    ipv6_hdr_t *ipv6;
+    ipv6_ext_frag_t *frag;
+
+    assert(ipv6_snip != NULL);
+    pkt = gnrc_pktbuf_add(ipv6_snip, NULL, sizeof(ipv6_ext_frag_t) + len,
+                          GNRC_NETTYPE_UNDEF);
+    assert(pkt != NULL);
+    ipv6 = ipv6_snip->data;
+    frag = pkt->data;
+    memset(frag + 1, 0, len);
+
+    ipv6->nh = PROTNUM_IPV6_EXT_FRAG;
+    ipv6->hl = TEST_HL;
+    ipv6->len = byteorder_htons(pkt->size);
+    frag->nh = PROTNUM_UDP;
+    frag->resv = 0U;
+    ipv6_ext_frag_set_offset(frag, offset);
+    if (more) {
+        ipv6_ext_frag_set_more(frag);
+    }
+    frag->id = byteorder_htonl(id);
+    return gnrc_ipv6_ext_frag_reass(pkt);
+}
+
+static void _recv_last(const ipv6_addr_t *src, uint32_t id)
+{
+    TEST_ASSERT_NULL(_recv_frag(src, id, TEST_LAST_OFFSET, TEST_LAST_LEN,
+                                false));
+}
+
+static void _recv_mid(const ipv6_addr_t *src, uint32_t id)
+{
+    TEST_ASSERT_NULL(_recv_frag(src, id, TEST_MID_OFFSET, TEST_MID_LEN,
+                                true));
+}
+
+/* only use when the reassembly buffer has room for a new entry of @p src,
+ * otherwise the lookup itself evicts an entry */
+static gnrc_ipv6_ext_frag_rbuf_t *_find(const ipv6_addr_t *src, uint32_t id)
+{
+    static ipv6_hdr_t ipv6;
+    gnrc_ipv6_ext_frag_rbuf_t *rbuf;
+
+    ipv6.src = *src;
+    ipv6.dst = _dst;
+    rbuf = gnrc_ipv6_ext_frag_rbuf_get(&ipv6, id);
+    if ((rbuf != NULL) && (rbuf->pkt == NULL)) {
+        /* entry was newly created by the lookup */
+        gnrc_ipv6_ext_frag_rbuf_del(rbuf);
+        return NULL;
+    }
+    return rbuf;
+}
+
+static void set_up(void)
+{
+    gnrc_pktbuf_init();
+    gnrc_ipv6_ext_frag_init();
+    memset(gnrc_ipv6_ext_frag_stats(), 0, sizeof(gnrc_ipv6_ext_frag_stats_t));
+}
+
+static void test_ipv6_ext_frag_budget_evict(void)
+{
+    gnrc_ipv6_ext_frag_stats_t *stats = gnrc_ipv6_ext_frag_stats();
+
+    _recv_last(&_src1, TEST_ID1);
+    _recv_mid(&_src2, TEST_ID2);
+    TEST_ASSERT_EQUAL_INT(TEST_LAST_OFFSET + TEST_LAST_LEN +
+                          TEST_MID_OFFSET + TEST_MID_LEN,
+                          gnrc_ipv6_ext_frag_rbuf_usage());
+    /* exceeds the budget, but is as complete as the datagram from _src1, so
+     * the newer but less complete datagram from _src2 has to give way */
+    _recv_last(&_src3, TEST_ID3);
+    TEST_ASSERT_EQUAL_INT(0, stats->budget_drops);
+    TEST_ASSERT_EQUAL_INT(1, stats->budget_evicts);
+    TEST_ASSERT_EQUAL_INT(2 * (TEST_LAST_OFFSET + TEST_LAST_LEN),
+                          gnrc_ipv6_ext_frag_rbuf_usage());
+    TEST_ASSERT(gnrc_ipv6_ext_frag_rbuf_usage() <=
+                CONFIG_GNRC_IPV6_EXT_FRAG_RBUF_BUDGET);
+    TEST_ASSERT_NOT_NULL(_find(&_src1, TEST_ID1));
+    TEST_ASSERT_NOT_NULL(_find(&_src3, TEST_ID3));
+    TEST_ASSERT_NULL(_find(&_src2, TEST_ID2));
+    TEST_ASSERT(gnrc_pktbuf_is_sane());
+}
+
+static void test_ipv6_ext_frag_budget_drop(void)
+{
+    gnrc_ipv6_ext_frag_stats_t *stats = gnrc_ipv6_ext_frag_stats();
+
+    _recv_last(&_src1, TEST_ID1);
+    _recv_last(&_src2, TEST_ID2);
+    TEST_ASSERT_EQUAL_INT(CONFIG_GNRC_IPV6_EXT_FRAG_RBUF_BUDGET,
+                          gnrc_ipv6_ext_frag_rbuf_usage());
+    /* exceeds the budget and is the least complete datagram, so it is
+     * dropped rather than evicting the others */
+    _recv_mid(&_src3, TEST_ID3);
+    TEST_ASSERT_EQUAL_INT(1, stats->budget_drops);
+    TEST_ASSERT_EQUAL_INT(0, stats->budget_evicts);
+    TEST_ASSERT_EQUAL_INT(CONFIG_GNRC_IPV6_EXT_FRAG_RBUF_BUDGET,
+                          gnrc_ipv6_ext_frag_rbuf_usage());
+    TEST_ASSERT_NULL(_find(&_src3, TEST_ID3));
+    TEST_ASSERT_NOT_NULL(_find(&_src1, TEST_ID1));
+    TEST_ASSERT_NOT_NULL(_find(&_src2, TEST_ID2));
+    TEST_ASSERT(gnrc_pktbuf_is_sane());
+}
+
+static void test_ipv6_ext_frag_src_quota(void)
+{
+    gnrc_ipv6_ext_frag_stats_t *stats = gnrc_ipv6_ext_frag_stats();
+    gnrc_ipv6_ext_frag_rbuf_t *rbuf;
+
+    _recv_mid(&_src2, TEST_ID1);
+    /* make the datagram from _src2 the oldest of the least complete ones, so
+     * only the quota keeps it from being replaced */
+    TEST_ASSERT_NOT_NULL((rbuf = _find(&_src2, TEST_ID1)));
+    rbuf->arrival -= CONFIG_GNRC_IPV6_EXT_FRAG_RBUF_TIMEOUT_US / 2;
+    _recv_last(&_src1, TEST_ID1);
+    _recv_mid(&_src1, TEST_ID2);
+    TEST_ASSERT_EQUAL_INT(0, stats->quota_evicts);
+    /* third datagram of _src1 replaces its least complete one */
+    _recv_mid(&_src1, TEST_ID3);
+    TEST_ASSERT_EQUAL_INT(1, stats->quota_evicts);
+    TEST_ASSERT_EQUAL_INT(0, stats->rbuf_full);
+    TEST_ASSERT_EQUAL_INT(0, stats->budget_drops);
+    TEST_ASSERT_EQUAL_INT(0, stats->budget_evicts);
+    /* the reassembly buffer is full with these, so (_src1, TEST_ID2) is gone */
+    TEST_ASSERT_NOT_NULL(_find(&_src2, TEST_ID1));
+    TEST_ASSERT_NOT_NULL(_find(&_src1, TEST_ID1));
+    TEST_ASSERT_NOT_NULL(_find(&_src1, TEST_ID3));
+    TEST_ASSERT_EQUAL_INT(TEST_MID_OFFSET + TEST_MID_LEN +
+                          TEST_LAST_OFFSET + TEST_LAST_LEN +
+                          TEST_MID_OFFSET + TEST_MID_LEN,
+                          gnrc_ipv6_ext_frag_rbuf_usage());
+    TEST_ASSERT(gnrc_pktbuf_is_sane());
+}
+
+static Test *tests_gnrc_ipv6_ext_frag_budget(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_ipv6_ext_frag_budget_evict),
+        new_TestFixture(test_ipv6_ext_frag_budget_drop),
+        new_TestFixture(test_ipv6_ext_frag_src_quota),
+    };
+
+    EMB_UNIT_TESTCALLER(ipv6_ext_frag_budget_tests, set_up, NULL, fixtures);
+
+    return (Test *)&ipv6_ext_frag_budget_tests;
+}
+
+int main(void)
+{
+    TESTS_START();
+    TESTS_RUN(tests_gnrc_ipv6_ext_frag_budget());
+    TESTS_END();
+
+    return 0;
+}
@@ -0,0 +1,247 @@
+/*
+ * Copyright (C) 2023 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Tests the parent selection of gnrc_rpl with MRHOF
+ *
+ * All neighbors share the same initial link metric, so the path cost through
+ * a parent only differs by the rank it advertises.
+ *
+ * @}
+ */
+
+#include <string.h>
+
+#include "embUnit.h"
+#include "net/ethernet.h"
+#include "net/gnrc.h"
+#include "net/gnrc/netif/ethernet.h"
+#include "net/gnrc/netif/hdr.h"
+#include "net/gnrc/rpl.h"
+#include "net/gnrc/rpl/mrhof.h"
+#include "net/icmpv6.h"
+#include "net/ipv6/hdr.h"
+#include "net/netdev_test.h"
+#include "test_utils/expect.h"
+
+#define INSTANCE_ID         (1U)
+#define MIN_HOP_RANK_INC    (256U)
+
+#define NEIGHBOR_B          (1U)
+#define NEIGHBOR_C          (2U)
+#define NEIGHBOR_D          (3U)
+
+static const ipv6_addr_t _dodag_id = {
+    .u8 = { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x01 }
+};
+static const ipv6_addr_t _own_addr = {
+    .u8 = { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x42 }
+};
+
+static gnrc_netif_t _netif;
+static netdev_test_t _mock_netdev;
+static char _mock_netif_stack[THREAD_STACKSIZE_DEFAULT];
+
+static int _get_device_type(netdev_t *dev, void *value, size_t max_len)
+{
+    (void)dev;
+    expect(max_len == sizeof(uint16_t));
+    *((uint16_t *)value) = NETDEV_TYPE_ETHERNET;
+    return sizeof(uint16_t);
+}
+
+static int _get_max_packet_size(netdev_t *dev, void *value, size_t max_len)
+{
+    (void)dev;
+    expect(max_len == sizeof(uint16_t));
+    *((uint16_t *)value) = ETHERNET_DATA_LEN;
+    return sizeof(uint16_t);
+}
+
+static int _get_address(netdev_t *dev, void *value, size_t max_len)
+{
+    static const uint8_t addr[] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x42 };
+
+    (void)dev;
+    expect(max_len >= sizeof(addr));
+    memcpy(value, addr, sizeof(addr));
+    return sizeof(addr);
+}
+
+static void _init_netif(void)
+{
+    netdev_test_setup(&_mock_netdev, 0);
+    netdev_test_set_get_cb(&_mock_netdev, NETOPT_DEVICE_TYPE,
+                           _get_device_type);
+    netdev_test_set_get_cb(&_mock_netdev, NETOPT_MAX_PDU_SIZE,
+                           _get_max_packet_size);
+    netdev_test_set_get_cb(&_mock_netdev, NETOPT_ADDRESS, _get_address);
+    expect(gnrc_netif_ethernet_create(&_netif, _mock_netif_stack,
+                                      sizeof(_mock_netif_stack),
+                                      GNRC_NETIF_PRIO, "mockup_eth",
+                                      &_mock_netdev.netdev.netdev) == 0);
+    expect(gnrc_netif_ipv6_addr_add(&_netif, &_own_addr, 64,
+                                    GNRC_NETIF_IPV6_ADDRS_FLAGS_STATE_VALID) > 0);
+}
+
+static void _recv_dio(uint8_t neighbor, uint16_t rank)
+{
+    const size_t size = sizeof(icmpv6_hdr_t) + sizeof(gnrc_rpl_dio_t) +
+                        sizeof(gnrc_rpl_opt_dodag_conf_t);
+    gnrc_pktsnip_t *netif, *ipv6, *icmpv6;
+    gnrc_rpl_opt_dodag_conf_t *conf;
+    gnrc_rpl_dio_t *dio;
+    ipv6_hdr_t *ipv6_hdr;
+
+    netif = gnrc_netif_hdr_build(NULL, 0, NULL, 0);
+    expect(netif != NULL);
+    gnrc_netif_hdr_set_netif(netif->data, &_netif);
+    ipv6 = gnrc_pktbuf_add(netif, NULL, sizeof(ipv6_hdr_t), GNRC_NETTYPE_IPV6);
+    expect(ipv6 != NULL);
+    icmpv6 = gnrc_pktbuf_add(ipv6, NULL, size, GNRC_NETTYPE_ICMPV6);
+    expect(icmpv6 != NULL);
+
+    ipv6_hdr = ipv6->data;
+    memset(ipv6_hdr, 0, sizeof(*ipv6_hdr));
+    ipv6_hdr_set_version(ipv6_hdr);
+    ipv6_hdr->len = byteorder_htons(size);
+    ipv6_hdr->nh = PROTNUM_ICMPV6;
+    ipv6_hdr->hl = 255;
+    ipv6_addr_set_link_local_prefix(&ipv6_hdr->src);
+    ipv6_hdr->src.u8[15] = neighbor;
+    ipv6_hdr->dst = ipv6_addr_all_rpl_nodes;
+
+    memset(icmpv6->data, 0, size);
+    ((icmpv6_hdr_t *)icmpv6->data)->type = ICMPV6_RPL_CTRL;
+    ((icmpv6_hdr_t *)icmpv6->data)->code = GNRC_RPL_ICMPV6_CODE_DIO;
+    dio = (gnrc_rpl_dio_t *)(((icmpv6_hdr_t *)icmpv6->data) + 1);
+    dio->instance_id = INSTANCE_ID;
+    dio->rank = byteorder_htons(rank);
+    /* grounded, storing mode without multicast */
+    dio->g_mop_prf = (1U << 7) | (GNRC_RPL_MOP_STORING_MODE_NO_MC << 3);
+    dio->dodag_id = _dodag_id;
+    conf = (gnrc_rpl_opt_dodag_conf_t *)(dio + 1);
+    conf->type = GNRC_RPL_OPT_DODAG_CONF;
+    conf->length = GNRC_RPL_OPT_DODAG_CONF_LEN;
+    conf->dio_int_doubl = CONFIG_GNRC_RPL_DEFAULT_DIO_INTERVAL_DOUBLINGS;
+    conf->dio_int_min = CONFIG_GNRC_RPL_DEFAULT_DIO_INTERVAL_MIN;
+    conf->dio_redun = CONFIG_GNRC_RPL_DEFAULT_DIO_REDUNDANCY_CONSTANT;
+    conf->min_hop_rank_inc = byteorder_htons(MIN_HOP_RANK_INC);
+    conf->ocp = byteorder_htons(GNRC_RPL_MRHOF_OCP);
+    conf->default_lifetime = CONFIG_GNRC_RPL_DEFAULT_LIFETIME;
+    conf->lifetime_unit = byteorder_htons(CONFIG_GNRC_RPL_LIFETIME_UNIT);
+
+    /* the RPL thread has a higher priority, so the DIO is processed before
+     * this returns */
+    expect(gnrc_netapi_receive(gnrc_rpl_pid, icmpv6) > 0);
+}
+
+/* returns the neighbor that is the preferred parent, 0 if there is none */
+static uint8_t _preferred(void)
+{
+    gnrc_rpl_instance_t *inst = gnrc_rpl_instance_get(INSTANCE_ID);
+
+    if ((inst == NULL) || (inst->dodag.parents == NULL)) {
+        return 0;
+    }
+    return inst->dodag.parents->addr.u8[15];
+}
+
+/* same as the RPL thread does when the preferred parent times out */
+static void _timeout_preferred(void)
+{
+    gnrc_rpl_instance_t *inst = gnrc_rpl_instance_get(INSTANCE_ID);
+
+    TEST_ASSERT_NOT_NULL(inst);
+    TEST_ASSERT_NOT_NULL(inst->dodag.parents);
+    gnrc_rpl_parent_remove(inst->dodag.parents);
+    gnrc_rpl_parent_update(&inst->dodag, NULL);
+}
+
+static void tear_down(void)
+{
+    gnrc_rpl_instance_remove_by_id(INSTANCE_ID);
+}
+
+static void test_mrhof_select_cheapest(void)
+{
+    _recv_dio(NEIGHBOR_B, 256);
+    TEST_ASSERT_NOT_NULL(gnrc_rpl_instance_get(INSTANCE_ID));
+    TEST_ASSERT_EQUAL_INT(GNRC_RPL_MRHOF_OCP,
+                          gnrc_rpl_instance_get(INSTANCE_ID)->of->ocp);
+    /* both within the switch threshold of the preferred parent, but D is the
+     * cheaper one */
+    _recv_dio(NEIGHBOR_C, 400);
+    _recv_dio(NEIGHBOR_D, 310);
+    TEST_ASSERT_EQUAL_INT(NEIGHBOR_B, _preferred());
+    /* preferred parent goes away */
+    _recv_dio(NEIGHBOR_B, GNRC_RPL_INFINITE_RANK);
+    TEST_ASSERT_EQUAL_INT(NEIGHBOR_D, _preferred());
+}
+
+static void test_mrhof_hysteresis_candidate(void)
+{
+    _recv_dio(NEIGHBOR_B, 512);
+    /* cheaper than B, but not by the switch threshold */
+    _recv_dio(NEIGHBOR_C, 512 - CONFIG_GNRC_RPL_MRHOF_PARENT_SWITCH_THRESHOLD + 1);
+    TEST_ASSERT_EQUAL_INT(NEIGHBOR_B, _preferred());
+    _recv_dio(NEIGHBOR_C, 512 - CONFIG_GNRC_RPL_MRHOF_PARENT_SWITCH_THRESHOLD);
+    TEST_ASSERT_EQUAL_INT(NEIGHBOR_C, _preferred());
+}
+
+static void test_mrhof_hysteresis_preferred(void)
+{
+    _recv_dio(NEIGHBOR_B, 256);
+    _recv_dio(NEIGHBOR_C, 400);
+    TEST_ASSERT_EQUAL_INT(NEIGHBOR_B, _preferred());
+    /* B becomes more expensive than C, but not by the switch threshold */
+    _recv_dio(NEIGHBOR_B, 400 + CONFIG_GNRC_RPL_MRHOF_PARENT_SWITCH_THRESHOLD - 1);
+    TEST_ASSERT_EQUAL_INT(NEIGHBOR_B, _preferred());
+    _recv_dio(NEIGHBOR_B, 400 + CONFIG_GNRC_RPL_MRHOF_PARENT_SWITCH_THRESHOLD);
+    TEST_ASSERT_EQUAL_INT(NEIGHBOR_C, _preferred());
+}
+
+static void test_mrhof_select_cheapest_timeout(void)
+{
+    _recv_dio(NEIGHBOR_B, 256);
+    _recv_dio(NEIGHBOR_C, 400);
+    _recv_dio(NEIGHBOR_D, 310);
+    TEST_ASSERT_EQUAL_INT(NEIGHBOR_B, _preferred());
+    _timeout_preferred();
+    TEST_ASSERT_EQUAL_INT(NEIGHBOR_D, _preferred());
+}
+
+static Test *tests_gnrc_rpl_mrhof(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_mrhof_select_cheapest),
+        new_TestFixture(test_mrhof_select_cheapest_timeout),
+        new_TestFixture(test_mrhof_hysteresis_candidate),
+        new_TestFixture(test_mrhof_hysteresis_preferred),
+    };
+
+    EMB_UNIT_TESTCALLER(gnrc_rpl_mrhof_tests, NULL, tear_down, fixtures);
+
+    return (Test *)&gnrc_rpl_mrhof_tests;
+}
+
+int main(void)
+{
+    _init_netif();
+    expect(gnrc_rpl_init(_netif.pid) != KERNEL_PID_UNDEF);
+
+    TESTS_START();
+    TESTS_RUN(tests_gnrc_rpl_mrhof());
+    TESTS_END();
+
+    return 0;
+}
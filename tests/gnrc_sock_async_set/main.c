@@ -0,0 +1,236 @@
+/*
+ * Copyright (C) 2023 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Test application for readiness sets of asynchronous socks
+ *
+ * @}
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+
+#include "container.h"
+#include "net/ipv6/addr.h"
+#include "net/ipv6/hdr.h"
+#include "net/sock/ip.h"
+#include "net/sock/udp.h"
+#include "net/gnrc.h"
+#include "net/gnrc/ipv6/hdr.h"
+#include "net/gnrc/udp.h"
+#include "net/protnum.h"
+#include "test_utils/expect.h"
+#include "vfs.h"
+
+#include "net/sock/async/set.h"
+
+#define TEST_PORT               (38664U)
+#define TEST_LOCAL              { 0xfe, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+                                  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01 }
+#define TEST_REMOTE             { 0xfe, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, \
+                                  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02 }
+#define TEST_PAYLOAD            { 0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef }
+
+static const uint8_t _test_local[] = TEST_LOCAL;
+static const uint8_t _test_remote[] = TEST_REMOTE;
+static const uint8_t _test_payload[] = TEST_PAYLOAD;
+
+static uint8_t _buffer[128];
+static sock_ip_t _ip_sock;
+static sock_udp_t _udp_socks[2];
+static sock_set_t _set;
+static sock_set_entry_t _entries[ARRAY_SIZE(_udp_socks) + 1];
+
+/* module is not compiled in, so provide this function for the test */
+ipv6_hdr_t *gnrc_ipv6_get_header(gnrc_pktsnip_t *pkt)
+{
+    gnrc_pktsnip_t *tmp = gnrc_pktsnip_search_type(pkt, GNRC_NETTYPE_IPV6);
+    if (tmp == NULL) {
+        return NULL;
+    }
+
+    expect(tmp->data != NULL);
+    expect(tmp->size >= sizeof(ipv6_hdr_t));
+    expect(ipv6_hdr_is(tmp->data));
+
+    return ((ipv6_hdr_t*) tmp->data);
+}
+
+static int _file_fstat(vfs_file_t *filp, struct stat *buf)
+{
+    (void)filp;
+    buf->st_mode = S_IFREG;
+    return 0;
+}
+
+static const vfs_file_ops_t _file_ops = {
+    .fstat = _file_fstat,
+};
+
+static void _inject(uint16_t port)
+{
+    gnrc_pktsnip_t *pkt;
+
+    pkt = gnrc_netif_hdr_build(NULL, 0, NULL, 0);
+    expect(pkt != NULL);
+    memset(pkt->data, 0, pkt->size);
+    pkt = gnrc_ipv6_hdr_build(pkt, (ipv6_addr_t *)&_test_remote,
+                              (ipv6_addr_t *)&_test_local);
+    expect(pkt != NULL);
+    /* module is not compiled in, so set header type manually */
+    pkt->type = GNRC_NETTYPE_IPV6;
+    pkt = gnrc_udp_hdr_build(pkt, TEST_PORT - 1, port);
+    expect(pkt != NULL);
+    pkt = gnrc_pktbuf_add(pkt, _test_payload, sizeof(_test_payload),
+                          GNRC_NETTYPE_UNDEF);
+    expect(pkt != NULL);
+    /* we dispatch twice, so hold one time */
+    gnrc_pktbuf_hold(pkt, 1);
+    gnrc_netapi_dispatch_receive(GNRC_NETTYPE_UDP, port, pkt);
+    gnrc_netapi_dispatch_receive(GNRC_NETTYPE_IPV6, PROTNUM_UDP, pkt);
+}
+
+static void _handle(sock_set_entry_t *entry)
+{
+    unsigned received = 0;
+
+    /* notifications are edge-triggered, so drain the sock */
+    if (entry->type == SOCK_SET_TYPE_UDP) {
+        while (sock_udp_recv(entry->sock, _buffer, sizeof(_buffer), 0,
+                             NULL) >= 0) {
+            received++;
+        }
+    }
+    else {
+        while (sock_ip_recv(entry->sock, _buffer, sizeof(_buffer), 0,
+                            NULL) >= 0) {
+            received++;
+        }
+    }
+    printf("%s: %04X, received %u packets\n", (char *)entry->arg,
+           entry->flags, received);
+}
+
+static void _wait(void)
+{
+    sock_set_entry_t *ready[ARRAY_SIZE(_entries)];
+    int res = sock_set_wait(&_set, ready, ARRAY_SIZE(ready), 0);
+
+    if (res == -EAGAIN) {
+        puts("no sock ready");
+        return;
+    }
+    expect(res > 0);
+    printf("%d socks ready\n", res);
+    for (int i = 0; i < res; i++) {
+        _handle(ready[i]);
+    }
+}
+
+static void _test_fd(void)
+{
+    struct sockaddr_in6 local = { .sin6_family = AF_INET6,
+                                  .sin6_port = htons(TEST_PORT + 2) };
+    struct sockaddr_in6 remote = { .sin6_family = AF_INET6,
+                                   .sin6_port = htons(TEST_PORT - 1) };
+    sock_set_entry_t entries[3];
+    sock_set_entry_t *ready[ARRAY_SIZE(entries)];
+    int file, sock;
+
+    memcpy(&remote.sin6_addr, _test_remote, sizeof(_test_remote));
+    file = vfs_bind(VFS_ANY_FD, O_RDONLY, &_file_ops, NULL);
+    expect(file >= 0);
+    sock = socket(AF_INET6, SOCK_DGRAM, 0);
+    expect(sock >= 0);
+    /* connecting creates the sock, so it receives without calling recv() */
+    expect(bind(sock, (struct sockaddr *)&local, sizeof(local)) == 0);
+    expect(connect(sock, (struct sockaddr *)&remote, sizeof(remote)) == 0);
+
+    expect(sock_set_add_fd(&_set, &entries[0], VFS_MAX_OPEN_FILES, NULL) ==
+           -EBADF);
+    expect(sock_set_add_fd(&_set, &entries[0], file, "file") == 0);
+    expect(sock_set_add_fd(&_set, &entries[1], sock, "socket") == 0);
+    /* a socket can only be member of one set */
+    expect(sock_set_add_fd(&_set, &entries[2], sock, NULL) == -EBUSY);
+    expect(entries[2].type == SOCK_SET_TYPE_NONE);
+
+    /* files never block, so they are ready right away */
+    expect(sock_set_wait(&_set, ready, ARRAY_SIZE(ready), 0) == 1);
+    printf("%s: %04X\n", (char *)ready[0]->arg, ready[0]->flags);
+    expect(sock_set_wait(&_set, ready, ARRAY_SIZE(ready), 0) == -EAGAIN);
+
+    /* sockets are ready when posix_sockets receives a packet */
+    _inject(TEST_PORT + 2);
+    expect(sock_set_wait(&_set, ready, ARRAY_SIZE(ready), 0) == 1);
+    printf("%s: %04X\n", (char *)ready[0]->arg, ready[0]->flags);
+    expect(ready[0]->fd == sock);
+    expect(recv(sock, _buffer, sizeof(_buffer), 0) ==
+           (ssize_t)sizeof(_test_payload));
+
+    /* the socket does not notify the set anymore after it was removed */
+    sock_set_del(&entries[1]);
+    sock_set_del(&entries[0]);
+    _inject(TEST_PORT + 2);
+    expect(sock_set_wait(&_set, ready, ARRAY_SIZE(ready), 0) == -EAGAIN);
+    expect(recv(sock, _buffer, sizeof(_buffer), 0) ==
+           (ssize_t)sizeof(_test_payload));
+    /* and can be added to a set again */
+    expect(sock_set_add_fd(&_set, &entries[2], sock, NULL) == 0);
+    sock_set_del(&entries[2]);
+
+    close(sock);
+    vfs_close(file);
+}
+
+int main(void)
+{
+    static char *names[] = { "UDP 0", "UDP 1" };
+    sock_udp_ep_t local = SOCK_IPV6_EP_ANY;
+
+    sock_set_init(&_set);
+    for (unsigned i = 0; i < ARRAY_SIZE(_udp_socks); i++) {
+        local.port = TEST_PORT + i;
+        expect(sock_udp_create(&_udp_socks[i], &local, NULL, 0) == 0);
+        sock_set_add_udp(&_set, &_entries[i], &_udp_socks[i], names[i]);
+    }
+    expect(sock_ip_create(&_ip_sock, (sock_ip_ep_t *)&local, NULL,
+                          PROTNUM_UDP, 0) == 0);
+    sock_set_add_ip(&_set, &_entries[ARRAY_SIZE(_udp_socks)], &_ip_sock, "IP");
+
+    _inject(TEST_PORT);
+    _inject(TEST_PORT);
+    _inject(TEST_PORT + 1);
+    _wait();
+    _wait();
+
+    /* the UDP sock is reported again on the next packet */
+    sock_set_del(&_entries[ARRAY_SIZE(_udp_socks)]);
+    _inject(TEST_PORT + 1);
+    _wait();
+
+    _test_fd();
+
+    /* drop the packets received by the IP sock, it is no member anymore */
+    while (sock_ip_recv(&_ip_sock, _buffer, sizeof(_buffer), 0, NULL) >= 0) {}
+    expect(gnrc_pktbuf_is_empty());
+
+    puts("SUCCESS");
+    return 0;
+}
+
+/** @} */
@@ -0,0 +1,27 @@
+#!/usr/bin/env python3
+
+# Copyright (C) 2023 Freie Universität Berlin
+#
+# This file is subject to the terms and conditions of the GNU Lesser
+# General Public License v2.1. See the file LICENSE in the top level
+# directory for more details.
+
+import sys
+from testrunner import run
+
+
+def testfunc(child):
+    child.expect_exact("3 socks ready")
+    child.expect_exact("UDP 0: 0010, received 2 packets")
+    child.expect_exact("IP: 0010, received 3 packets")
+    child.expect_exact("UDP 1: 0010, received 1 packets")
+    child.expect_exact("no sock ready")
+    child.expect_exact("1 socks ready")
+    child.expect_exact("UDP 1: 0010, received 1 packets")
+    child.expect_exact("file: 0030")
+    child.expect_exact("socket: 0010")
+    child.expect_exact("SUCCESS")
+
+
+if __name__ == "__main__":
+    sys.exit(run(testfunc))
@@ -22,7 +22,8 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
-
+#include <string.h>
+#include "container.h"
 #include "net/sock/udp.h"
 #include "test_utils/expect.h"
 #include "xtimer.h"
@@ -512,6 +513,45 @@ static void test_sock_udp_recv_buf__success(void)
     expect(_check_net());
 }
 
+static void test_sock_udp_recv_many__success(void)
+{
+    static const ipv6_addr_t src_addr = { .u8 = _TEST_ADDR_REMOTE };
+    static const ipv6_addr_t dst_addr = { .u8 = _TEST_ADDR_LOCAL };
+    static const sock_udp_ep_t local = { .family = AF_INET6,
+                                         .port = _TEST_PORT_LOCAL };
+    static char *payloads[] = { "ABCD", "EFG", "HI" };
+    sock_udp_msg_t msgs[2];
+
+    memset(msgs, 0, sizeof(msgs));
+    expect(0 == sock_udp_create(&_sock, &local, NULL, SOCK_FLAGS_REUSE_EP));
+    for (unsigned i = 0; i < ARRAY_SIZE(payloads); i++) {
+        expect(_inject_packet(&src_addr, &dst_addr, _TEST_PORT_REMOTE,
+                              _TEST_PORT_LOCAL, payloads[i],
+                              strlen(payloads[i]) + 1, _TEST_NETIF));
+    }
+    /* first call is limited by the number of descriptors */
+    expect(2 == sock_udp_recv_many(&_sock, msgs, ARRAY_SIZE(msgs),
+                                   SOCK_NO_TIMEOUT));
+    for (unsigned i = 0; i < 2; i++) {
+        expect(msgs[i].len == strlen(payloads[i]) + 1);
+        expect(memcmp(msgs[i].data, payloads[i], msgs[i].len) == 0);
+        expect(msgs[i].remote.family == AF_INET6);
+        expect(msgs[i].remote.port == _TEST_PORT_REMOTE);
+        expect(memcmp(&msgs[i].remote.addr, &src_addr, sizeof(src_addr)) == 0);
+    }
+    sock_udp_recv_many_release(&_sock, msgs, 2);
+    expect(msgs[0].buf_ctx == NULL);
+    expect(msgs[1].buf_ctx == NULL);
+    /* second call returns what is left without blocking */
+    expect(1 == sock_udp_recv_many(&_sock, msgs, ARRAY_SIZE(msgs),
+                                   SOCK_NO_TIMEOUT));
+    expect(msgs[0].len == strlen(payloads[2]) + 1);
+    expect(memcmp(msgs[0].data, payloads[2], msgs[0].len) == 0);
+    sock_udp_recv_many_release(&_sock, msgs, 1);
+    expect(-EAGAIN == sock_udp_recv_many(&_sock, msgs, ARRAY_SIZE(msgs), 0));
+    expect(_check_net());
+}
+
 static void test_sock_udp_send__EAFNOSUPPORT(void)
 {
     static const sock_udp_ep_t remote = { .addr = { .ipv6 = _TEST_ADDR_REMOTE },
@@ -849,6 +889,7 @@ int main(void)
     CALL(test_sock_udp_recv__non_blocking());
     CALL(test_sock_udp_recv__aux());
     CALL(test_sock_udp_recv_buf__success());
+    CALL(test_sock_udp_recv_many__success());
     _prepare_send_checks();
     CALL(test_sock_udp_send__EAFNOSUPPORT());
     CALL(test_sock_udp_send__EINVAL_addr());
@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2023 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       mtd_async module test
+ *
+ * @}
+ */
+
+#include <stdint.h>
+#include <errno.h>
+#include <string.h>
+
+#include "container.h"
+#include "embUnit.h"
+#include "mtd.h"
+#include "mtd_async.h"
+#include "mtd_emulated.h"
+#include "thread.h"
+
+#define SECTOR_COUNT    8
+#define PAGE_PER_SECTOR 4
+#define PAGE_SIZE       64
+#define SECTOR_SIZE     (PAGE_PER_SECTOR * PAGE_SIZE)
+
+MTD_EMULATED_DEV(0, SECTOR_COUNT, PAGE_PER_SECTOR, PAGE_SIZE);
+MTD_EMULATED_DEV(1, SECTOR_COUNT, PAGE_PER_SECTOR, PAGE_SIZE);
+
+#define dev     (&mtd_emulated_dev0.base)
+
+/* device that erases one sector per step and is busy for two polls */
+#define dev_async   (&mtd_emulated_dev1.base)
+
+static unsigned steps, polls, busy;
+
+static int _async_step(mtd_dev_t *mtd, mtd_async_req_t *req)
+{
+    if (req->op != MTD_ASYNC_ERASE) {
+        return -ENOTSUP;
+    }
+    if (req->size == 0) {
+        return 0;
+    }
+    if (req->page + req->size > SECTOR_COUNT) {
+        return -EOVERFLOW;
+    }
+    _mtd_emulated_driver.erase_sector(mtd, req->page, 1);
+    req->page++;
+    req->size--;
+    steps++;
+    busy = 2;
+    return 1500;
+}
+
+static int _async_busy(mtd_dev_t *mtd)
+{
+    (void)mtd;
+    polls++;
+    return busy ? busy-- > 0 : 0;
+}
+
+static mtd_desc_t _async_driver;
+
+static event_queue_t _queue;
+static mtd_async_req_t _req;
+static unsigned _done;
+static kernel_pid_t _done_pid;
+
+static void _handler(event_t *event)
+{
+    mtd_async_req_t *req = container_of(event, mtd_async_req_t, event);
+
+    TEST_ASSERT(req == &_req);
+    _done++;
+    _done_pid = thread_getpid();
+}
+
+/* runs the event queue until the request completed */
+static int _wait(void)
+{
+    while (!_done) {
+        event_t *event = event_wait(&_queue);
+        event->handler(event);
+    }
+    return _req.res;
+}
+
+static void setup(void)
+{
+    _async_driver = _mtd_emulated_driver;
+    _async_driver.async_step = _async_step;
+    _async_driver.async_busy = _async_busy;
+    mtd_emulated_dev1.base.driver = &_async_driver;
+
+    TEST_ASSERT_EQUAL_INT(0, mtd_init(dev));
+    TEST_ASSERT_EQUAL_INT(0, mtd_init(dev_async));
+    memset(mtd_emulated_dev0.memory, 0, mtd_emulated_dev0.size);
+    memset(mtd_emulated_dev1.memory, 0, mtd_emulated_dev1.size);
+
+    event_queue_init(&_queue);
+    mtd_async_req_init(&_req, &_queue, _handler);
+    _done = 0;
+    steps = polls = busy = 0;
+}
+
+static void test_mtd_async_write_read(void)
+{
+    static const char data[] = "some data to write";
+    char buf[sizeof(data)];
+
+    mtd_async_erase_sector(&_req, dev, 1, 1);
+    TEST_ASSERT_EQUAL_INT(0, _wait());
+    TEST_ASSERT_EQUAL_INT(0xff, mtd_emulated_dev0.memory[SECTOR_SIZE]);
+
+    _done = 0;
+    mtd_async_write_page_raw(&_req, dev, data, PAGE_PER_SECTOR, 10, sizeof(data));
+    TEST_ASSERT_EQUAL_INT(0, _wait());
+
+    _done = 0;
+    mtd_async_read_page(&_req, dev, buf, PAGE_PER_SECTOR, 10, sizeof(buf));
+    TEST_ASSERT_EQUAL_INT(0, _wait());
+    TEST_ASSERT_EQUAL_STRING(data, buf);
+
+    /* the completion event is handled by the thread running the queue */
+    TEST_ASSERT_EQUAL_INT(thread_getpid(), _done_pid);
+}
+
+static void test_mtd_async_error(void)
+{
+    mtd_async_erase_sector(&_req, dev, SECTOR_COUNT - 1, 2);
+    TEST_ASSERT_EQUAL_INT(-EOVERFLOW, _wait());
+}
+
+static void test_mtd_async_native(void)
+{
+    mtd_async_erase_sector(&_req, dev_async, 2, 3);
+    /* the first step is started right away */
+    TEST_ASSERT_EQUAL_INT(1, steps);
+    TEST_ASSERT_EQUAL_INT(0, _done);
+
+    TEST_ASSERT_EQUAL_INT(0, _wait());
+    TEST_ASSERT_EQUAL_INT(3, steps);
+    TEST_ASSERT_EQUAL_INT(9, polls);
+    TEST_ASSERT_EQUAL_INT(0, mtd_emulated_dev1.memory[2 * SECTOR_SIZE - 1]);
+    TEST_ASSERT_EQUAL_INT(0xff, mtd_emulated_dev1.memory[2 * SECTOR_SIZE]);
+    TEST_ASSERT_EQUAL_INT(0xff, mtd_emulated_dev1.memory[5 * SECTOR_SIZE - 1]);
+    TEST_ASSERT_EQUAL_INT(0, mtd_emulated_dev1.memory[5 * SECTOR_SIZE]);
+
+    /* other requests go to the worker thread */
+    _done = 0;
+    mtd_async_write_page_raw(&_req, dev_async, "x", 0, 0, 1);
+    TEST_ASSERT_EQUAL_INT(0, _wait());
+    TEST_ASSERT_EQUAL_INT('x', mtd_emulated_dev1.memory[0]);
+    TEST_ASSERT_EQUAL_INT(3, steps);
+}
+
+Test *tests_mtd_async_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_mtd_async_write_read),
+        new_TestFixture(test_mtd_async_error),
+        new_TestFixture(test_mtd_async_native),
+    };
+
+    EMB_UNIT_TESTCALLER(mtd_async_tests, setup, NULL, fixtures);
+
+    return (Test *)&mtd_async_tests;
+}
+
+int main(void)
+{
+    TESTS_START();
+    TESTS_RUN(tests_mtd_async_tests());
+    TESTS_END();
+    return 0;
+}
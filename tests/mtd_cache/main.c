@@ -0,0 +1,217 @@
+/*
+ * Copyright (C) 2023 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       mtd_cache module test
+ *
+ * @}
+ */
+
+#include <stdint.h>
+#include <errno.h>
+#include <string.h>
+
+#include "embUnit.h"
+#include "mtd.h"
+#include "mtd_cache.h"
+#include "mtd_emulated.h"
+
+#define SECTOR_COUNT    8
+#define PAGE_PER_SECTOR 4
+#define PAGE_SIZE       64
+#define LINES_NUMOF     2
+
+MTD_EMULATED_DEV(0, SECTOR_COUNT, PAGE_PER_SECTOR, PAGE_SIZE);
+
+/* accesses of the backing device */
+static unsigned reads, writes, rewrites;
+
+static int _read_page(mtd_dev_t *dev, void *dest, uint32_t page,
+                      uint32_t offset, uint32_t size)
+{
+    reads++;
+    return _mtd_emulated_driver.read_page(dev, dest, page, offset, size);
+}
+
+static int _write_page(mtd_dev_t *dev, const void *src, uint32_t page,
+                       uint32_t offset, uint32_t size)
+{
+    const uint8_t *mem = &mtd_emulated_dev0.memory[page * PAGE_SIZE + offset];
+
+    /* like on flash, every byte may be written once after erasing it */
+    for (unsigned i = 0; i < size; i++) {
+        if (mem[i] != 0xff) {
+            rewrites++;
+        }
+    }
+    writes++;
+    return _mtd_emulated_driver.write_page(dev, src, page, offset, size);
+}
+
+static int _erase_sector(mtd_dev_t *dev, uint32_t sector, uint32_t count)
+{
+    return _mtd_emulated_driver.erase_sector(dev, sector, count);
+}
+
+static int _init(mtd_dev_t *dev)
+{
+    return _mtd_emulated_driver.init(dev);
+}
+
+static const mtd_desc_t _counting_driver = {
+    .init = _init,
+    .read_page = _read_page,
+    .write_page = _write_page,
+    .erase_sector = _erase_sector,
+};
+
+static mtd_cache_line_t _lines[LINES_NUMOF];
+static uint8_t _buf[LINES_NUMOF * PAGE_SIZE];
+static mtd_cache_t _cache = MTD_CACHE_INIT(&mtd_emulated_dev0.base, _lines, _buf);
+
+#define dev (&_cache.mtd)
+
+static uint8_t _buffer[PAGE_SIZE];
+
+static void setup(void)
+{
+    mtd_emulated_dev0.base.driver = &_counting_driver;
+    TEST_ASSERT_EQUAL_INT(0, mtd_init(dev));
+    TEST_ASSERT_EQUAL_INT(0, mtd_erase_sector(dev, 0, SECTOR_COUNT));
+    reads = writes = rewrites = 0;
+    memset(&_cache.stats, 0, sizeof(_cache.stats));
+}
+
+static void teardown(void)
+{
+    TEST_ASSERT_EQUAL_INT(0, rewrites);
+}
+
+static void test_mtd_cache_init(void)
+{
+    TEST_ASSERT_EQUAL_INT(SECTOR_COUNT, dev->sector_count);
+    TEST_ASSERT_EQUAL_INT(PAGE_PER_SECTOR, dev->pages_per_sector);
+    TEST_ASSERT_EQUAL_INT(PAGE_SIZE, dev->page_size);
+}
+
+static void test_mtd_cache_read_hit(void)
+{
+    for (unsigned i = 0; i < 10; i++) {
+        TEST_ASSERT_EQUAL_INT(0, mtd_read_page(dev, _buffer, 3, 8, 16));
+    }
+    TEST_ASSERT_EQUAL_INT(1, reads);
+    TEST_ASSERT_EQUAL_INT(9, _cache.stats.hits);
+    TEST_ASSERT_EQUAL_INT(1, _cache.stats.misses);
+
+    /* whole pages are not cached */
+    TEST_ASSERT_EQUAL_INT(0, mtd_read_page(dev, _buffer, 5, 0, PAGE_SIZE));
+    TEST_ASSERT_EQUAL_INT(0, mtd_read_page(dev, _buffer, 5, 0, PAGE_SIZE));
+    TEST_ASSERT_EQUAL_INT(3, reads);
+    TEST_ASSERT_EQUAL_INT(0, mtd_read_page(dev, _buffer, 3, 0, 4));
+    TEST_ASSERT_EQUAL_INT(3, reads);
+}
+
+static void test_mtd_cache_write_merge(void)
+{
+    static const uint8_t data[] = "0123456789abcdef";
+
+    /* consecutive small writes are written back at once */
+    for (unsigned i = 0; i < sizeof(data) - 1; i += 4) {
+        TEST_ASSERT_EQUAL_INT(0, mtd_write_page_raw(dev, &data[i], 2, 16 + i, 4));
+    }
+    TEST_ASSERT_EQUAL_INT(0, writes);
+    TEST_ASSERT_EQUAL_INT(0, mtd_read_page(dev, _buffer, 2, 16, 16));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(data, _buffer, 16));
+
+    TEST_ASSERT_EQUAL_INT(0, mtd_cache_flush(&_cache));
+    TEST_ASSERT_EQUAL_INT(1, writes);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(data, &mtd_emulated_dev0.memory[2 * PAGE_SIZE + 16], 16));
+    TEST_ASSERT_EQUAL_INT(0, mtd_cache_flush(&_cache));
+    TEST_ASSERT_EQUAL_INT(1, writes);
+
+    /* a write apart from the pending range writes it back first */
+    TEST_ASSERT_EQUAL_INT(0, mtd_write_page_raw(dev, data, 2, 0, 4));
+    TEST_ASSERT_EQUAL_INT(0, mtd_write_page_raw(dev, data, 2, 48, 4));
+    TEST_ASSERT_EQUAL_INT(2, writes);
+    TEST_ASSERT_EQUAL_INT(0, mtd_cache_flush(&_cache));
+    TEST_ASSERT_EQUAL_INT(3, writes);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(data, &mtd_emulated_dev0.memory[2 * PAGE_SIZE + 48], 4));
+}
+
+static void test_mtd_cache_evict(void)
+{
+    static const uint8_t data[] = "RIOT";
+
+    TEST_ASSERT_EQUAL_INT(0, mtd_write_page_raw(dev, data, 0, 0, 4));
+    TEST_ASSERT_EQUAL_INT(0, mtd_read_page(dev, _buffer, 1, 0, 4));
+    /* page 0 is used more recently than page 1 */
+    TEST_ASSERT_EQUAL_INT(0, mtd_read_page(dev, _buffer, 0, 0, 4));
+    TEST_ASSERT_EQUAL_INT(0, writes);
+    TEST_ASSERT_EQUAL_INT(0, mtd_read_page(dev, _buffer, 4, 0, 4));
+    TEST_ASSERT_EQUAL_INT(0, writes);
+    TEST_ASSERT_EQUAL_INT(0, mtd_read_page(dev, _buffer, 5, 0, 4));
+    TEST_ASSERT_EQUAL_INT(1, writes);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(data, mtd_emulated_dev0.memory, 4));
+}
+
+static void test_mtd_cache_erase(void)
+{
+    static const uint8_t data[] = "RIOT";
+
+    TEST_ASSERT_EQUAL_INT(0, mtd_write_page_raw(dev, data, 1, 0, 4));
+    TEST_ASSERT_EQUAL_INT(0, mtd_erase_sector(dev, 0, 1));
+    TEST_ASSERT_EQUAL_INT(0, mtd_cache_flush(&_cache));
+    TEST_ASSERT_EQUAL_INT(0, writes);
+
+    TEST_ASSERT_EQUAL_INT(0, mtd_read_page(dev, _buffer, 1, 0, 4));
+    TEST_ASSERT_EQUAL_INT(0xff, _buffer[0]);
+
+    /* writing to the erased page works */
+    TEST_ASSERT_EQUAL_INT(0, mtd_write_page_raw(dev, data, 1, 0, 4));
+    TEST_ASSERT_EQUAL_INT(0, mtd_cache_flush(&_cache));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(data, &mtd_emulated_dev0.memory[PAGE_SIZE], 4));
+}
+
+static void test_mtd_cache_across_pages(void)
+{
+    static uint8_t data[PAGE_SIZE + 8];
+
+    memset(data, 0x5a, sizeof(data));
+    TEST_ASSERT_EQUAL_INT(0, mtd_write_page_raw(dev, data, 6, 60, sizeof(data)));
+    TEST_ASSERT_EQUAL_INT(0, mtd_cache_flush(&_cache));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(data, &mtd_emulated_dev0.memory[6 * PAGE_SIZE + 60],
+                                    sizeof(data)));
+}
+
+Test *tests_mtd_cache_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_mtd_cache_init),
+        new_TestFixture(test_mtd_cache_read_hit),
+        new_TestFixture(test_mtd_cache_write_merge),
+        new_TestFixture(test_mtd_cache_evict),
+        new_TestFixture(test_mtd_cache_erase),
+        new_TestFixture(test_mtd_cache_across_pages),
+    };
+
+    EMB_UNIT_TESTCALLER(mtd_cache_tests, setup, teardown, fixtures);
+
+    return (Test *)&mtd_cache_tests;
+}
+
+int main(void)
+{
+    TESTS_START();
+    TESTS_RUN(tests_mtd_cache_tests());
+    TESTS_END();
+    return 0;
+}
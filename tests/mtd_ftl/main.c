@@ -0,0 +1,277 @@
+/*
+ * Copyright (C) 2023 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       mtd_ftl module test
+ *
+ * @}
+ */
+
+#include <stdint.h>
+#include <errno.h>
+#include <string.h>
+
+#include "embUnit.h"
+#include "mtd.h"
+#include "mtd_emulated.h"
+#include "mtd_ftl.h"
+
+#define SECTOR_COUNT    16
+#define PAGE_PER_SECTOR 8
+#define PAGE_SIZE       128
+#define FTL_PAGE_SIZE   128
+/* less than the (16 - 2) * 7 slots, so that garbage collection has room */
+#define FTL_PAGES       64
+
+MTD_EMULATED_DEV(0, SECTOR_COUNT, PAGE_PER_SECTOR, PAGE_SIZE);
+
+/* accesses of the backing device */
+static unsigned rewrites, erases;
+
+static int _read_page(mtd_dev_t *dev, void *dest, uint32_t page,
+                      uint32_t offset, uint32_t size)
+{
+    return _mtd_emulated_driver.read_page(dev, dest, page, offset, size);
+}
+
+static int _write_page(mtd_dev_t *dev, const void *src, uint32_t page,
+                       uint32_t offset, uint32_t size)
+{
+    const uint8_t *mem = &mtd_emulated_dev0.memory[page * PAGE_SIZE + offset];
+
+    /* like on flash, every byte may be written once after erasing it */
+    for (unsigned i = 0; i < size; i++) {
+        if (mem[i] != 0xff) {
+            rewrites++;
+        }
+    }
+    return _mtd_emulated_driver.write_page(dev, src, page, offset, size);
+}
+
+static int _erase_sector(mtd_dev_t *dev, uint32_t sector, uint32_t count)
+{
+    erases += count;
+    return _mtd_emulated_driver.erase_sector(dev, sector, count);
+}
+
+static int _init(mtd_dev_t *dev)
+{
+    return _mtd_emulated_driver.init(dev);
+}
+
+static const mtd_desc_t _counting_driver = {
+    .init = _init,
+    .read_page = _read_page,
+    .write_page = _write_page,
+    .erase_sector = _erase_sector,
+};
+
+static uint16_t _map[FTL_PAGES];
+static mtd_ftl_block_t _blocks[SECTOR_COUNT];
+static uint8_t _buf[FTL_PAGE_SIZE];
+static mtd_ftl_t _ftl = MTD_FTL_INIT(&mtd_emulated_dev0.base, FTL_PAGE_SIZE,
+                                     _map, _blocks, _buf);
+
+#define dev (&_ftl.mtd)
+
+static uint8_t _buffer[FTL_PAGE_SIZE];
+static uint8_t _versions[FTL_PAGES];
+
+static uint32_t _rand(void)
+{
+    static uint32_t state = 1;
+
+    state = state * 1103515245 + 12345;
+    return state >> 16;
+}
+
+/* fills the buffer with a pattern that identifies page and version */
+static void _pattern(uint32_t page, uint8_t version)
+{
+    for (unsigned i = 0; i < sizeof(_buffer); i++) {
+        _buffer[i] = page + version + i;
+    }
+}
+
+static void _write(uint32_t page)
+{
+    _pattern(page, ++_versions[page]);
+    TEST_ASSERT_EQUAL_INT(0, mtd_write_page_raw(dev, _buffer, page, 0, FTL_PAGE_SIZE));
+}
+
+static void _check_all(void)
+{
+    static uint8_t expected[FTL_PAGE_SIZE];
+
+    for (unsigned page = 0; page < FTL_PAGES; page++) {
+        /* pages that were never written read as erased */
+        if (_versions[page]) {
+            _pattern(page, _versions[page]);
+            memcpy(expected, _buffer, sizeof(expected));
+        }
+        else {
+            memset(expected, 0xff, sizeof(expected));
+        }
+        TEST_ASSERT_EQUAL_INT(0, mtd_read_page(dev, _buffer, page, 0, FTL_PAGE_SIZE));
+        TEST_ASSERT_EQUAL_INT(0, memcmp(expected, _buffer, sizeof(expected)));
+    }
+}
+
+static void setup(void)
+{
+    memset(mtd_emulated_dev0.memory, 0xff, mtd_emulated_dev0.size);
+    mtd_emulated_dev0.base.driver = &_counting_driver;
+    _ftl.blocks_numof = ARRAY_SIZE(_blocks);
+    TEST_ASSERT_EQUAL_INT(0, mtd_init(dev));
+    memset(&_ftl.stats, 0, sizeof(_ftl.stats));
+    memset(_versions, 0, sizeof(_versions));
+    rewrites = erases = 0;
+}
+
+static void teardown(void)
+{
+    TEST_ASSERT_EQUAL_INT(0, rewrites);
+}
+
+static void test_mtd_ftl_init(void)
+{
+    TEST_ASSERT_EQUAL_INT(FTL_PAGES, dev->sector_count);
+    TEST_ASSERT_EQUAL_INT(1, dev->pages_per_sector);
+    TEST_ASSERT_EQUAL_INT(FTL_PAGE_SIZE, dev->page_size);
+    TEST_ASSERT(dev->driver->flags & MTD_DRIVER_FLAG_DIRECT_WRITE);
+
+    /* pages that were never written read as erased */
+    TEST_ASSERT_EQUAL_INT(0, mtd_read_page(dev, _buffer, 5, 0, FTL_PAGE_SIZE));
+    TEST_ASSERT_EQUAL_INT(0xff, _buffer[0]);
+    TEST_ASSERT_EQUAL_INT(0xff, _buffer[FTL_PAGE_SIZE - 1]);
+}
+
+static void test_mtd_ftl_overwrite(void)
+{
+    static const uint8_t data[] = "RIOT";
+
+    /* a page is overwritten without erasing a sector for every write */
+    for (unsigned i = 0; i < 10; i++) {
+        _write(7);
+    }
+    TEST_ASSERT_EQUAL_INT(2, erases);
+    _check_all();
+
+    /* partial writes keep the rest of the page */
+    TEST_ASSERT_EQUAL_INT(0, mtd_write_page_raw(dev, data, 7, 10, sizeof(data)));
+    TEST_ASSERT_EQUAL_INT(0, mtd_read_page(dev, _buffer, 7, 0, FTL_PAGE_SIZE));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(data, &_buffer[10], sizeof(data)));
+    TEST_ASSERT_EQUAL_INT(7 + 10 + 9, _buffer[9]);
+
+    /* writes across pages are split */
+    memset(_buffer, 0x5a, sizeof(_buffer));
+    TEST_ASSERT_EQUAL_INT(0, mtd_write_page_raw(dev, _buffer, 1, 100, 60));
+    TEST_ASSERT_EQUAL_INT(0, mtd_read_page(dev, _buffer, 2, 0, FTL_PAGE_SIZE));
+    TEST_ASSERT_EQUAL_INT(0x5a, _buffer[31]);
+    TEST_ASSERT_EQUAL_INT(0xff, _buffer[32]);
+}
+
+static void test_mtd_ftl_random_writes(void)
+{
+    for (unsigned page = 0; page < FTL_PAGES; page++) {
+        _write(page);
+    }
+    for (unsigned i = 0; i < 1000; i++) {
+        _write(_rand() % FTL_PAGES);
+    }
+    _check_all();
+
+    /* garbage collection copied pages, but far less than a sector per write */
+    TEST_ASSERT(_ftl.stats.copies > 0);
+    TEST_ASSERT(erases < _ftl.stats.writes / 2);
+    TEST_ASSERT_EQUAL_INT(_ftl.stats.erases, erases);
+
+    /* the mapping is rebuilt from the backing device */
+    memset(_map, 0, sizeof(_map));
+    TEST_ASSERT_EQUAL_INT(0, mtd_init(dev));
+    _check_all();
+    for (unsigned i = 0; i < 200; i++) {
+        _write(_rand() % FTL_PAGES);
+    }
+    _check_all();
+}
+
+static void test_mtd_ftl_erase(void)
+{
+    for (unsigned page = 0; page < FTL_PAGES; page++) {
+        _write(page);
+    }
+    TEST_ASSERT_EQUAL_INT(0, mtd_erase_sector(dev, 0, FTL_PAGES - 3));
+    TEST_ASSERT_EQUAL_INT(0, mtd_read_page(dev, _buffer, 0, 0, FTL_PAGE_SIZE));
+    TEST_ASSERT_EQUAL_INT(0xff, _buffer[0]);
+
+    /* erased pages are not copied by garbage collection */
+    for (unsigned i = 0; i < 100; i++) {
+        _write(FTL_PAGES - 1 - i % 3);
+    }
+    TEST_ASSERT_EQUAL_INT(0, _ftl.stats.copies);
+}
+
+static void test_mtd_ftl_wear_levelling(void)
+{
+    /* all pages but two are written once, the others over and over */
+    for (unsigned page = 0; page < FTL_PAGES; page++) {
+        _write(page);
+    }
+    for (unsigned i = 0; i < 2000; i++) {
+        _write(i % 2);
+        while (mtd_ftl_collect(&_ftl) > 0) {}
+    }
+    _check_all();
+
+    uint32_t least = UINT32_MAX, most = 0;
+    for (unsigned i = 0; i < SECTOR_COUNT; i++) {
+        least = MIN(least, _blocks[i].erase_count);
+        most = MAX(most, _blocks[i].erase_count);
+    }
+    TEST_ASSERT(most - least <= CONFIG_MTD_FTL_WEAR_DELTA + 1);
+}
+
+static void test_mtd_ftl_full(void)
+{
+    /* the backing device does not have room for more than the logical pages */
+    _ftl.blocks_numof = CONFIG_MTD_FTL_SPARE_BLOCKS;
+    TEST_ASSERT_EQUAL_INT(-EINVAL, mtd_init(dev));
+    _ftl.blocks_numof = ARRAY_SIZE(_blocks);
+    TEST_ASSERT_EQUAL_INT(0, mtd_init(dev));
+
+    TEST_ASSERT_EQUAL_INT(-EOVERFLOW, mtd_write_page_raw(dev, _buffer, FTL_PAGES, 0, 1));
+}
+
+Test *tests_mtd_ftl_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_mtd_ftl_init),
+        new_TestFixture(test_mtd_ftl_overwrite),
+        new_TestFixture(test_mtd_ftl_random_writes),
+        new_TestFixture(test_mtd_ftl_erase),
+        new_TestFixture(test_mtd_ftl_wear_levelling),
+        new_TestFixture(test_mtd_ftl_full),
+    };
+
+    EMB_UNIT_TESTCALLER(mtd_ftl_tests, setup, teardown, fixtures);
+
+    return (Test *)&mtd_ftl_tests;
+}
+
+int main(void)
+{
+    TESTS_START();
+    TESTS_RUN(tests_mtd_ftl_tests());
+    TESTS_END();
+    return 0;
+}
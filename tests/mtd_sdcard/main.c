@@ -0,0 +1,376 @@
+/*
+ * Copyright (C) 2023 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       mtd_sdcard test against an SD card simulated on the SPI bus
+ *
+ * @}
+ */
+
+#include <stdint.h>
+#include <errno.h>
+#include <string.h>
+
+#include "checksum/crc16_ccitt.h"
+#include "embUnit.h"
+#include "mtd.h"
+#include "mtd_sdcard.h"
+#include "sdcard_spi_internal.h"
+#include "spi_mock.h"
+
+/* the smallest SDHC card, its CSD has a C_SIZE of 0 */
+#define BLOCKS          (1024)
+
+/* an SD card in SPI mode that only knows the commands to access data */
+typedef enum {
+    SD_IDLE,
+    SD_READ_MULTI,
+    SD_WRITE_SINGLE,
+    SD_WRITE_MULTI,
+} _sd_state_t;
+
+static struct {
+    _sd_state_t state;
+    uint32_t block;                                 /**< next block to transfer */
+    bool app_cmd;                                   /**< CMD55 was received */
+    uint8_t cmd[6];
+    unsigned cmd_len;
+    uint8_t resp[SD_HC_BLOCK_SIZE + 8];             /**< bytes to send next */
+    unsigned resp_len;
+    unsigned resp_pos;
+    bool receiving;                                 /**< receiving a data packet */
+    uint8_t data[SD_HC_BLOCK_SIZE + 2];
+    unsigned data_len;
+} _sd;
+
+static uint8_t _sd_mem[BLOCKS * SD_HC_BLOCK_SIZE];
+/* commands and application specific commands received */
+static unsigned _cmds[64], _acmds[64];
+/* argument of the last ACMD23 */
+static uint32_t _pre_erase;
+
+static void _push(uint8_t byte)
+{
+    _sd.resp[_sd.resp_len++] = byte;
+}
+
+static void _queue_block(uint32_t block)
+{
+    if (block >= BLOCKS) {
+        return;
+    }
+
+    const uint8_t *data = &_sd_mem[block * SD_HC_BLOCK_SIZE];
+    uint16_t crc = crc16_ccitt_false_update(0, data, SD_HC_BLOCK_SIZE);
+
+    _push(SD_CARD_DUMMY_BYTE);
+    _push(SD_DATA_TOKEN_CMD_17_18_24);
+    memcpy(&_sd.resp[_sd.resp_len], data, SD_HC_BLOCK_SIZE);
+    _sd.resp_len += SD_HC_BLOCK_SIZE;
+    _push(crc >> 8);
+    _push(crc & 0xff);
+}
+
+static void _command(void)
+{
+    uint8_t idx = _sd.cmd[0] & ~SD_CMD_PREFIX_MASK;
+    uint32_t arg = ((uint32_t)_sd.cmd[1] << 24) | ((uint32_t)_sd.cmd[2] << 16)
+                 | ((uint32_t)_sd.cmd[3] << 8) | _sd.cmd[4];
+
+    _sd.resp_len = _sd.resp_pos = 0;
+    _push(SD_CARD_DUMMY_BYTE);
+
+    if (_sd.app_cmd) {
+        _sd.app_cmd = false;
+        _acmds[idx]++;
+        if (idx == SD_CMD_23) {
+            _pre_erase = arg;
+        }
+        _push(0);
+        return;
+    }
+
+    _cmds[idx]++;
+    switch (idx) {
+    case SD_CMD_55:
+        _sd.app_cmd = true;
+        _push(0);
+        break;
+    case SD_CMD_12:
+        _sd.state = SD_IDLE;
+        _push(0);
+        break;
+    case SD_CMD_17:
+    case SD_CMD_18:
+    case SD_CMD_24:
+    case SD_CMD_25:
+        if (arg >= BLOCKS) {
+            _push(SD_R1_RESPONSE_ADDR_ERROR);
+            break;
+        }
+        _push(0);
+        _sd.block = arg;
+        if (idx == SD_CMD_17) {
+            _queue_block(arg);
+        }
+        else if (idx == SD_CMD_18) {
+            _sd.state = SD_READ_MULTI;
+        }
+        else {
+            _sd.state = (idx == SD_CMD_24) ? SD_WRITE_SINGLE : SD_WRITE_MULTI;
+        }
+        break;
+    default:
+        _push(SD_R1_RESPONSE_ILLEGAL_CMD_ERROR);
+    }
+}
+
+static void _receive(uint8_t byte)
+{
+    if (!_sd.receiving) {
+        if ((_sd.state == SD_WRITE_SINGLE && byte == SD_DATA_TOKEN_CMD_17_18_24) ||
+            (_sd.state == SD_WRITE_MULTI && byte == SD_DATA_TOKEN_CMD_25)) {
+            _sd.receiving = true;
+            _sd.data_len = 0;
+        }
+        else if (_sd.state == SD_WRITE_MULTI && byte == SD_DATA_TOKEN_CMD_25_STOP) {
+            /* busy after one byte */
+            _sd.state = SD_IDLE;
+            _sd.resp_len = _sd.resp_pos = 0;
+            _push(SD_CARD_DUMMY_BYTE);
+            _push(0);
+            _push(0);
+        }
+        return;
+    }
+
+    _sd.data[_sd.data_len++] = byte;
+    if (_sd.data_len < sizeof(_sd.data)) {
+        return;
+    }
+
+    uint16_t crc = (_sd.data[SD_HC_BLOCK_SIZE] << 8) | _sd.data[SD_HC_BLOCK_SIZE + 1];
+    bool valid = crc16_ccitt_false_update(0, _sd.data, SD_HC_BLOCK_SIZE) == crc;
+
+    _sd.receiving = false;
+    _sd.resp_len = _sd.resp_pos = 0;
+    if (valid && _sd.block < BLOCKS) {
+        memcpy(&_sd_mem[_sd.block++ * SD_HC_BLOCK_SIZE], _sd.data, SD_HC_BLOCK_SIZE);
+        /* data accepted, then busy while programming */
+        _push(0x05);
+        _push(0);
+        _push(0);
+    }
+    else {
+        /* data rejected due to a CRC error */
+        _push(0x0b);
+    }
+    if (_sd.state == SD_WRITE_SINGLE) {
+        _sd.state = SD_IDLE;
+    }
+}
+
+static uint8_t _sd_transfer(void *arg, uint8_t out)
+{
+    (void)arg;
+    uint8_t in = SD_CARD_DUMMY_BYTE;
+
+    /* blocks are sent until the host sends a command */
+    if (_sd.state == SD_READ_MULTI && _sd.resp_pos == _sd.resp_len &&
+        _sd.cmd_len == 0) {
+        _sd.resp_len = _sd.resp_pos = 0;
+        _queue_block(_sd.block++);
+    }
+    if (_sd.resp_pos < _sd.resp_len) {
+        in = _sd.resp[_sd.resp_pos++];
+    }
+
+    if (_sd.state == SD_WRITE_SINGLE || _sd.state == SD_WRITE_MULTI) {
+        _receive(out);
+    }
+    else if (_sd.cmd_len || (out & 0xc0) == SD_CMD_PREFIX_MASK) {
+        _sd.cmd[_sd.cmd_len++] = out;
+        if (_sd.cmd_len == sizeof(_sd.cmd)) {
+            _sd.cmd_len = 0;
+            _command();
+        }
+    }
+    return in;
+}
+
+static void _sd_select(void *arg, bool selected)
+{
+    (void)arg;
+
+    if (!selected) {
+        _sd.cmd_len = 0;
+        _sd.receiving = false;
+    }
+}
+
+static const spi_mock_dev_t _sd_model = {
+    .select = _sd_select,
+    .transfer = _sd_transfer,
+};
+
+/* the card is simulated from its SPI mode on, so it was initialized before */
+static sdcard_spi_t _card = {
+    .params = {
+        .spi_dev = SPI_DEV(0),
+        .cs = GPIO_PIN(0, 0),
+        .clk = GPIO_PIN(0, 1),
+        .mosi = GPIO_PIN(0, 2),
+        .miso = GPIO_PIN(0, 3),
+        .power = GPIO_UNDEF,
+    },
+    .spi_clk = SD_CARD_SPI_SPEED_POSTINIT,
+    .use_block_addr = true,
+    .init_done = true,
+    .card_type = SD_V2,
+    .csd_structure = SD_CSD_V2,
+};
+
+static mtd_sdcard_t _mtd_sdcard = {
+    .base = {
+        .driver = &mtd_sdcard_driver,
+    },
+    .sd_card = &_card,
+    .params = &_card.params,
+};
+
+#define dev (&_mtd_sdcard.base)
+
+static uint8_t _buffer[20 * SD_HC_BLOCK_SIZE];
+
+static void _pattern(uint8_t *buf, size_t len, uint8_t seed)
+{
+    for (unsigned i = 0; i < len; i++) {
+        buf[i] = seed + i * 3 + (i >> 9);
+    }
+}
+
+static void setup(void)
+{
+    _pattern(_sd_mem, sizeof(_sd_mem), 0);
+    memset(&_sd, 0, sizeof(_sd));
+    memset(_cmds, 0, sizeof(_cmds));
+    memset(_acmds, 0, sizeof(_acmds));
+    _pre_erase = 0;
+    spi_mock_attach(SPI_DEV(0), &_sd_model, NULL);
+    TEST_ASSERT_EQUAL_INT(0, mtd_init(dev));
+}
+
+static void teardown(void)
+{
+    spi_mock_attach(SPI_DEV(0), NULL, NULL);
+}
+
+static void test_mtd_sdcard_init(void)
+{
+    TEST_ASSERT_EQUAL_INT(BLOCKS, dev->sector_count);
+    TEST_ASSERT_EQUAL_INT(1, dev->pages_per_sector);
+    TEST_ASSERT_EQUAL_INT(SD_HC_BLOCK_SIZE, dev->page_size);
+    /* FAT does not erase sectors before writing them */
+    TEST_ASSERT(dev->driver->flags & MTD_DRIVER_FLAG_DIRECT_WRITE);
+}
+
+static void test_mtd_sdcard_single_block(void)
+{
+    _pattern(_buffer, SD_HC_BLOCK_SIZE, 0x42);
+    TEST_ASSERT_EQUAL_INT(0, mtd_write_page_raw(dev, _buffer, 7, 0, SD_HC_BLOCK_SIZE));
+    TEST_ASSERT_EQUAL_INT(1, _cmds[SD_CMD_24]);
+    TEST_ASSERT_EQUAL_INT(0, _acmds[SD_CMD_23]);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(_buffer, &_sd_mem[7 * SD_HC_BLOCK_SIZE],
+                                    SD_HC_BLOCK_SIZE));
+
+    memset(_buffer, 0, SD_HC_BLOCK_SIZE);
+    TEST_ASSERT_EQUAL_INT(0, mtd_read_page(dev, _buffer, 7, 0, SD_HC_BLOCK_SIZE));
+    TEST_ASSERT_EQUAL_INT(1, _cmds[SD_CMD_17]);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(_buffer, &_sd_mem[7 * SD_HC_BLOCK_SIZE],
+                                    SD_HC_BLOCK_SIZE));
+}
+
+static void test_mtd_sdcard_multi_block(void)
+{
+    /* a contiguous range is written with a single command */
+    _pattern(_buffer, sizeof(_buffer), 0x17);
+    TEST_ASSERT_EQUAL_INT(0, mtd_write_page_raw(dev, _buffer, 100, 0, sizeof(_buffer)));
+    TEST_ASSERT_EQUAL_INT(1, _cmds[SD_CMD_25]);
+    TEST_ASSERT_EQUAL_INT(0, _cmds[SD_CMD_24]);
+    TEST_ASSERT_EQUAL_INT(1, _acmds[SD_CMD_23]);
+    TEST_ASSERT_EQUAL_INT(sizeof(_buffer) / SD_HC_BLOCK_SIZE, _pre_erase);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(_buffer, &_sd_mem[100 * SD_HC_BLOCK_SIZE],
+                                    sizeof(_buffer)));
+
+    /* and read with a single command */
+    memset(_buffer, 0, sizeof(_buffer));
+    TEST_ASSERT_EQUAL_INT(0, mtd_read_page(dev, _buffer, 100, 0, sizeof(_buffer)));
+    TEST_ASSERT_EQUAL_INT(1, _cmds[SD_CMD_18]);
+    TEST_ASSERT_EQUAL_INT(1, _cmds[SD_CMD_12]);
+    TEST_ASSERT_EQUAL_INT(0, _cmds[SD_CMD_17]);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(_buffer, &_sd_mem[100 * SD_HC_BLOCK_SIZE],
+                                    sizeof(_buffer)));
+}
+
+static void test_mtd_sdcard_unaligned(void)
+{
+    static uint8_t expected[4 * SD_HC_BLOCK_SIZE];
+    const uint32_t addr = 3 * SD_HC_BLOCK_SIZE - 100;
+    const uint32_t len = 3 * SD_HC_BLOCK_SIZE + 50;
+
+    /* the partial blocks at both ends are read separately, the blocks in
+       between with a single command */
+    TEST_ASSERT_EQUAL_INT(0, mtd_read(dev, _buffer, addr, len));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(_buffer, &_sd_mem[addr], len));
+    TEST_ASSERT_EQUAL_INT(2, _cmds[SD_CMD_17]);
+    TEST_ASSERT_EQUAL_INT(1, _cmds[SD_CMD_18]);
+
+    memcpy(expected, &_sd_mem[2 * SD_HC_BLOCK_SIZE], sizeof(expected));
+    _pattern(_buffer, len, 0x99);
+    memcpy(&expected[SD_HC_BLOCK_SIZE - 100], _buffer, len);
+    TEST_ASSERT_EQUAL_INT(0, mtd_write(dev, _buffer, addr, len));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(expected, &_sd_mem[2 * SD_HC_BLOCK_SIZE],
+                                    sizeof(expected)));
+    TEST_ASSERT_EQUAL_INT(2, _cmds[SD_CMD_24]);
+    TEST_ASSERT_EQUAL_INT(1, _cmds[SD_CMD_25]);
+}
+
+static void test_mtd_sdcard_out_of_range(void)
+{
+    TEST_ASSERT_EQUAL_INT(-EOVERFLOW, mtd_read_page(dev, _buffer, BLOCKS - 1, 0,
+                                                    2 * SD_HC_BLOCK_SIZE));
+    TEST_ASSERT_EQUAL_INT(-EIO, mtd_sdcard_driver.read_page(dev, _buffer, BLOCKS,
+                                                            0, SD_HC_BLOCK_SIZE));
+}
+
+Test *tests_mtd_sdcard_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_mtd_sdcard_init),
+        new_TestFixture(test_mtd_sdcard_single_block),
+        new_TestFixture(test_mtd_sdcard_multi_block),
+        new_TestFixture(test_mtd_sdcard_unaligned),
+        new_TestFixture(test_mtd_sdcard_out_of_range),
+    };
+
+    EMB_UNIT_TESTCALLER(mtd_sdcard_tests, setup, teardown, fixtures);
+
+    return (Test *)&mtd_sdcard_tests;
+}
+
+int main(void)
+{
+    TESTS_START();
+    TESTS_RUN(tests_mtd_sdcard_tests());
+    TESTS_END();
+    return 0;
+}
@@ -0,0 +1,490 @@
+/*
+ * Copyright (C) 2023 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       mtd_spi_nor test against a flash simulated on the SPI bus
+ *
+ * @}
+ */
+
+#include <stdint.h>
+#include <errno.h>
+#include <string.h>
+
+#include "container.h"
+#include "embUnit.h"
+#include "mtd.h"
+#include "mtd_async.h"
+#include "mtd_spi_nor.h"
+#include "spi_mock.h"
+#include "ztimer.h"
+
+#define PAGE_SIZE       (256)
+#define PAGE_PER_SECTOR (16)
+#define SECTOR_SIZE     (PAGE_SIZE * PAGE_PER_SECTOR)
+#define FLASH_SIZE      (256 * 1024)
+
+/* status register polls an operation keeps the flash busy */
+#define PROGRAM_POLLS   (1)
+#define ERASE_POLLS     (3)
+
+#define OP_PP           (0x02)
+#define OP_READ         (0x03)
+#define OP_RDSR         (0x05)
+#define OP_WREN         (0x06)
+#define OP_FAST_READ    (0x0b)
+#define OP_SE_4K        (0x20)
+#define OP_BE_32K       (0x52)
+#define OP_SUSPEND      (0x75)
+#define OP_RESUME       (0x7a)
+#define OP_RDID         (0x9f)
+#define OP_CE           (0xc7)
+#define OP_BE_64K       (0xd8)
+
+/* a flash that only knows the commands of the default opcode table */
+static struct {
+    uint8_t cmd;
+    unsigned pos;                   /**< bytes received in this command */
+    uint32_t addr;
+    bool ignored;                   /**< command is not executed */
+    bool wel;                       /**< write enable latch */
+    bool suspended;                 /**< erase is suspended */
+    unsigned busy;                  /**< status polls until ready */
+    uint32_t erase_addr;            /**< block being erased */
+    uint32_t erase_size;
+    uint32_t resumed;               /**< time the erase started or resumed */
+    uint8_t page[PAGE_SIZE];        /**< data to program */
+    unsigned page_len;
+} _nor;
+
+static uint8_t _nor_mem[FLASH_SIZE];
+/* Winbond W25X20: 256 KiB */
+static const uint8_t _nor_id[] = { 0xef, 0x40, 0x12 };
+/* commands received per opcode */
+static unsigned _cmds[256];
+/* commands received while the flash was busy */
+static unsigned _violations;
+
+static bool _nor_busy(void)
+{
+    return _nor.busy && !_nor.suspended;
+}
+
+static void _nor_erase(uint32_t addr, uint32_t size)
+{
+    addr &= ~(size - 1);
+    memset(&_nor_mem[addr % FLASH_SIZE], 0xff, size);
+    _nor.busy = ERASE_POLLS;
+    _nor.erase_addr = addr % FLASH_SIZE;
+    _nor.erase_size = size;
+    _nor.resumed = ztimer_now(ZTIMER_MSEC);
+}
+
+/* writes need the write enable latch set, which they reset */
+static bool _nor_write_start(void)
+{
+    bool enabled = _nor.wel && (_nor.pos >= ((_nor.cmd == OP_CE) ? 1 : 4));
+
+    _nor.wel = false;
+    return enabled;
+}
+
+static void _nor_execute(void)
+{
+    switch (_nor.cmd) {
+    case OP_WREN:
+        _nor.wel = true;
+        break;
+    case OP_RDSR:
+        if (_nor_busy()) {
+            _nor.busy--;
+        }
+        break;
+    case OP_SUSPEND:
+        /* an erase must progress between suspends */
+        if (_nor_busy() && (ztimer_now(ZTIMER_MSEC) - _nor.resumed <
+                            CONFIG_MTD_SPI_NOR_SUSPEND_INTERVAL_MS)) {
+            _violations++;
+        }
+        _nor.suspended = _nor.busy > 0;
+        break;
+    case OP_RESUME:
+        _nor.suspended = false;
+        _nor.resumed = ztimer_now(ZTIMER_MSEC);
+        break;
+    case OP_PP:
+        if (_nor_write_start()) {
+            for (unsigned i = 0; i < _nor.page_len; i++) {
+                uint32_t addr = (_nor.addr & ~(PAGE_SIZE - 1))
+                              | ((_nor.addr + i) & (PAGE_SIZE - 1));
+                _nor_mem[addr % FLASH_SIZE] &= _nor.page[i];
+            }
+            _nor.busy = PROGRAM_POLLS;
+        }
+        break;
+    case OP_SE_4K:
+        if (_nor_write_start()) {
+            _nor_erase(_nor.addr, 4 * 1024);
+        }
+        break;
+    case OP_BE_32K:
+        if (_nor_write_start()) {
+            _nor_erase(_nor.addr, 32 * 1024);
+        }
+        break;
+    case OP_BE_64K:
+        if (_nor_write_start()) {
+            _nor_erase(_nor.addr, 64 * 1024);
+        }
+        break;
+    case OP_CE:
+        if (_nor_write_start()) {
+            _nor_erase(0, FLASH_SIZE);
+        }
+        break;
+    }
+}
+
+static void _nor_select(void *arg, bool selected)
+{
+    (void)arg;
+
+    if (!selected && _nor.pos > 0 && !_nor.ignored) {
+        _nor_execute();
+    }
+    _nor.pos = 0;
+    _nor.page_len = 0;
+}
+
+static uint8_t _nor_transfer(void *arg, uint8_t out)
+{
+    (void)arg;
+    uint8_t in = 0xff;
+    unsigned pos = _nor.pos++;
+
+    if (pos == 0) {
+        _nor.cmd = out;
+        _nor.addr = 0;
+        _cmds[out]++;
+        /* only the status can be read while an operation is in progress */
+        _nor.ignored = _nor_busy() && (out != OP_RDSR) && (out != OP_SUSPEND);
+        if (_nor.ignored) {
+            _violations++;
+        }
+        return in;
+    }
+    if (_nor.ignored) {
+        return in;
+    }
+
+    switch (_nor.cmd) {
+    case OP_RDID:
+        in = (pos <= sizeof(_nor_id)) ? _nor_id[pos - 1] : 0;
+        break;
+    case OP_RDSR:
+        in = (_nor_busy() ? 0x01 : 0) | (_nor.wel ? 0x02 : 0);
+        break;
+    case OP_READ:
+    case OP_FAST_READ:
+    case OP_PP:
+        if (pos <= 3) {
+            _nor.addr = (_nor.addr << 8) | out;
+            break;
+        }
+        if (_nor.cmd == OP_FAST_READ && pos == 4) {
+            /* dummy byte */
+            break;
+        }
+        if (_nor.cmd == OP_PP) {
+            if (_nor.page_len < PAGE_SIZE) {
+                _nor.page[_nor.page_len++] = out;
+            }
+            break;
+        }
+        /* the block of a suspended erase has no defined content */
+        if (_nor.suspended && (_nor.addr % FLASH_SIZE >= _nor.erase_addr) &&
+            (_nor.addr % FLASH_SIZE < _nor.erase_addr + _nor.erase_size)) {
+            _violations++;
+        }
+        in = _nor_mem[_nor.addr++ % FLASH_SIZE];
+        break;
+    default:
+        if (pos <= 3) {
+            _nor.addr = (_nor.addr << 8) | out;
+        }
+        break;
+    }
+    return in;
+}
+
+static const spi_mock_dev_t _nor_model = {
+    .select = _nor_select,
+    .transfer = _nor_transfer,
+};
+
+static mtd_spi_nor_params_t _params = {
+    .opcode = &mtd_spi_nor_opcode_default,
+    .wait_chip_erase = 1000,
+    .wait_64k_erase = 1000,
+    .wait_32k_erase = 1000,
+    .wait_sector_erase = 1000,
+    .wait_chip_wake_up = 1,
+    .clk = SPI_CLK_10MHZ,
+    .spi = SPI_DEV(0),
+    .mode = SPI_MODE_0,
+    .cs = GPIO_PIN(0, 0),
+    .wp = GPIO_UNDEF,
+    .hold = GPIO_UNDEF,
+};
+
+static mtd_spi_nor_t _mtd_nor = {
+    .base = {
+        .driver = &mtd_spi_nor_driver,
+        .page_size = PAGE_SIZE,
+        .pages_per_sector = PAGE_PER_SECTOR,
+    },
+    .params = &_params,
+};
+
+#define dev (&_mtd_nor.base)
+
+static event_queue_t _queue;
+static mtd_async_req_t _req;
+static unsigned _done;
+
+static void _handler(event_t *event)
+{
+    mtd_async_req_t *req = container_of(event, mtd_async_req_t, event);
+
+    TEST_ASSERT(req == &_req);
+    _done++;
+}
+
+/* runs the event queue until the request completed */
+static int _wait(void)
+{
+    while (!_done) {
+        event_t *event = event_wait(&_queue);
+        event->handler(event);
+    }
+    return _req.res;
+}
+
+static void setup(void)
+{
+    memset(&_nor, 0, sizeof(_nor));
+    memset(_nor_mem, 0, sizeof(_nor_mem));
+    spi_mock_attach(SPI_DEV(0), &_nor_model, NULL);
+
+    _params.flag = SPI_NOR_F_SECT_4K | SPI_NOR_F_SECT_32K | SPI_NOR_F_SECT_64K
+                 | SPI_NOR_F_FAST_READ | SPI_NOR_F_SUSPEND;
+    dev->sector_count = 0;
+    TEST_ASSERT_EQUAL_INT(0, mtd_init(dev));
+
+    event_queue_init(&_queue);
+    mtd_async_req_init(&_req, &_queue, _handler);
+    _done = 0;
+    memset(_cmds, 0, sizeof(_cmds));
+    _violations = 0;
+}
+
+static void teardown(void)
+{
+    spi_mock_attach(SPI_DEV(0), NULL, NULL);
+}
+
+static void test_mtd_spi_nor_init(void)
+{
+    TEST_ASSERT_EQUAL_INT(FLASH_SIZE / SECTOR_SIZE, dev->sector_count);
+    TEST_ASSERT_EQUAL_INT(0xef, _mtd_nor.jedec_id.manuf);
+}
+
+static void test_mtd_spi_nor_write_read(void)
+{
+    static uint8_t data[3 * PAGE_SIZE];
+    uint8_t buf[sizeof(data)];
+
+    for (unsigned i = 0; i < sizeof(data); i++) {
+        data[i] = ~i;
+    }
+    memset(_nor_mem, 0xff, sizeof(_nor_mem));
+
+    /* one page program per page */
+    TEST_ASSERT_EQUAL_INT(0, mtd_write_page_raw(dev, data, 1, 10, sizeof(data)));
+    TEST_ASSERT_EQUAL_INT(4, _cmds[OP_PP]);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(&_nor_mem[PAGE_SIZE + 10], data, sizeof(data)));
+
+    /* one fast read of the whole range */
+    TEST_ASSERT_EQUAL_INT(0, mtd_read(dev, buf, PAGE_SIZE + 10, sizeof(buf)));
+    TEST_ASSERT_EQUAL_INT(1, _cmds[OP_FAST_READ]);
+    TEST_ASSERT_EQUAL_INT(0, _cmds[OP_READ]);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(buf, data, sizeof(buf)));
+
+    /* or a plain read */
+    _params.flag &= ~SPI_NOR_F_FAST_READ;
+    memset(buf, 0, sizeof(buf));
+    TEST_ASSERT_EQUAL_INT(0, mtd_read(dev, buf, PAGE_SIZE + 10, sizeof(buf)));
+    TEST_ASSERT_EQUAL_INT(1, _cmds[OP_READ]);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(buf, data, sizeof(buf)));
+
+    TEST_ASSERT_EQUAL_INT(0, _violations);
+}
+
+static void test_mtd_spi_nor_erase(void)
+{
+    /* 28 KiB to 128 KiB is erased with the largest blocks that fit */
+    TEST_ASSERT_EQUAL_INT(0, mtd_erase(dev, 28 * 1024, 100 * 1024));
+    TEST_ASSERT_EQUAL_INT(1, _cmds[OP_SE_4K]);
+    TEST_ASSERT_EQUAL_INT(1, _cmds[OP_BE_32K]);
+    TEST_ASSERT_EQUAL_INT(1, _cmds[OP_BE_64K]);
+    TEST_ASSERT_EQUAL_INT(0, _nor_mem[28 * 1024 - 1]);
+    TEST_ASSERT_EQUAL_INT(0xff, _nor_mem[28 * 1024]);
+    TEST_ASSERT_EQUAL_INT(0xff, _nor_mem[128 * 1024 - 1]);
+    TEST_ASSERT_EQUAL_INT(0, _nor_mem[128 * 1024]);
+
+    /* the whole flash with one command */
+    TEST_ASSERT_EQUAL_INT(0, mtd_erase(dev, 0, FLASH_SIZE));
+    TEST_ASSERT_EQUAL_INT(1, _cmds[OP_CE]);
+    TEST_ASSERT_EQUAL_INT(0xff, _nor_mem[0]);
+    TEST_ASSERT_EQUAL_INT(0xff, _nor_mem[FLASH_SIZE - 1]);
+
+    TEST_ASSERT_EQUAL_INT(0, _violations);
+}
+
+static void test_mtd_spi_nor_async_erase(void)
+{
+    /* 28 KiB to 128 KiB is erased with one erase block per step */
+    mtd_async_erase_sector(&_req, dev, 7, 25);
+    TEST_ASSERT_EQUAL_INT(1, _cmds[OP_SE_4K]);
+    TEST_ASSERT_EQUAL_INT(0, _cmds[OP_BE_32K]);
+    TEST_ASSERT_EQUAL_INT(0, _cmds[OP_BE_64K]);
+    TEST_ASSERT_EQUAL_INT(0, _done);
+    /* a long erase, the device is polled until it is done */
+    _nor.busy = 4 * ERASE_POLLS;
+
+    TEST_ASSERT_EQUAL_INT(0, _wait());
+    TEST_ASSERT_EQUAL_INT(1, _done);
+    TEST_ASSERT_EQUAL_INT(1, _cmds[OP_SE_4K]);
+    TEST_ASSERT_EQUAL_INT(1, _cmds[OP_BE_32K]);
+    TEST_ASSERT_EQUAL_INT(1, _cmds[OP_BE_64K]);
+    TEST_ASSERT(_cmds[OP_RDSR] >= 4 * ERASE_POLLS + 2 * ERASE_POLLS);
+    TEST_ASSERT_EQUAL_INT(0, _nor.busy);
+    TEST_ASSERT_EQUAL_INT(0, _nor_mem[28 * 1024 - 1]);
+    TEST_ASSERT_EQUAL_INT(0xff, _nor_mem[28 * 1024]);
+    TEST_ASSERT_EQUAL_INT(0xff, _nor_mem[128 * 1024 - 1]);
+    TEST_ASSERT_EQUAL_INT(0, _nor_mem[128 * 1024]);
+
+    /* a step that fails completes the request */
+    _done = 0;
+    mtd_async_erase_sector(&_req, dev, dev->sector_count - 1, 2);
+    TEST_ASSERT_EQUAL_INT(-EOVERFLOW, _wait());
+
+    TEST_ASSERT_EQUAL_INT(0, _violations);
+}
+
+static void test_mtd_spi_nor_suspend(void)
+{
+    uint8_t buf[16];
+
+    memset(_nor_mem, 0x5a, SECTOR_SIZE);
+
+    mtd_async_erase_sector(&_req, dev, 16, 16);
+    TEST_ASSERT_EQUAL_INT(1, _cmds[OP_BE_64K]);
+    TEST_ASSERT_EQUAL_INT(0, _done);
+
+    /* reading suspends the erase */
+    TEST_ASSERT_EQUAL_INT(0, mtd_read(dev, buf, 0, sizeof(buf)));
+    TEST_ASSERT_EQUAL_INT(1, _cmds[OP_SUSPEND]);
+    TEST_ASSERT_EQUAL_INT(1, _cmds[OP_RESUME]);
+    TEST_ASSERT_EQUAL_INT(0x5a, buf[0]);
+    TEST_ASSERT_EQUAL_INT(0x5a, buf[sizeof(buf) - 1]);
+    TEST_ASSERT(_nor.busy > 0);
+
+    TEST_ASSERT_EQUAL_INT(0, _wait());
+    TEST_ASSERT_EQUAL_INT(0, _nor.busy);
+    TEST_ASSERT_EQUAL_INT(0xff, _nor_mem[16 * SECTOR_SIZE]);
+    TEST_ASSERT_EQUAL_INT(0, _violations);
+
+    /* without suspend, reading waits for the erase to complete */
+    _params.flag &= ~SPI_NOR_F_SUSPEND;
+    _done = 0;
+    mtd_async_erase_sector(&_req, dev, 0, 1);
+    TEST_ASSERT_EQUAL_INT(0, mtd_read(dev, buf, 0, sizeof(buf)));
+    TEST_ASSERT_EQUAL_INT(1, _cmds[OP_SUSPEND]);
+    TEST_ASSERT_EQUAL_INT(0xff, buf[0]);
+    TEST_ASSERT_EQUAL_INT(0, _nor.busy);
+    TEST_ASSERT_EQUAL_INT(0, _wait());
+    TEST_ASSERT_EQUAL_INT(0, _violations);
+}
+
+static void test_mtd_spi_nor_suspend_range(void)
+{
+    uint8_t buf[16];
+
+    memset(_nor_mem, 0x5a, sizeof(_nor_mem));
+
+    /* a read overlapping the block being erased waits for the erase */
+    mtd_async_erase_sector(&_req, dev, 16, 16);
+    TEST_ASSERT(_nor.busy > 0);
+    TEST_ASSERT_EQUAL_INT(0, mtd_read(dev, buf, 16 * SECTOR_SIZE - 8,
+                                      sizeof(buf)));
+    TEST_ASSERT_EQUAL_INT(0, _cmds[OP_SUSPEND]);
+    TEST_ASSERT_EQUAL_INT(0, _nor.busy);
+    TEST_ASSERT_EQUAL_INT(0x5a, buf[7]);
+    TEST_ASSERT_EQUAL_INT(0xff, buf[8]);
+    TEST_ASSERT_EQUAL_INT(0, _wait());
+    TEST_ASSERT_EQUAL_INT(0, _violations);
+
+    /* reads right after each other let the erase progress in between */
+    _done = 0;
+    uint32_t start = ztimer_now(ZTIMER_MSEC);
+    mtd_async_erase_sector(&_req, dev, 0, 1);
+    /* a long erase that is not completed by the polls of the reads */
+    _nor.busy = 10 * ERASE_POLLS;
+    for (unsigned i = 1; i <= 3; i++) {
+        TEST_ASSERT_EQUAL_INT(0, mtd_read(dev, buf, 32 * SECTOR_SIZE,
+                                          sizeof(buf)));
+        TEST_ASSERT_EQUAL_INT(0x5a, buf[0]);
+        TEST_ASSERT_EQUAL_INT(i, _cmds[OP_SUSPEND]);
+        TEST_ASSERT_EQUAL_INT(i, _cmds[OP_RESUME]);
+    }
+    TEST_ASSERT(ztimer_now(ZTIMER_MSEC) - start >=
+                3 * CONFIG_MTD_SPI_NOR_SUSPEND_INTERVAL_MS);
+    TEST_ASSERT(_nor.busy > 0);
+    TEST_ASSERT_EQUAL_INT(0, _wait());
+    TEST_ASSERT_EQUAL_INT(0xff, _nor_mem[0]);
+    TEST_ASSERT_EQUAL_INT(0, _violations);
+}
+
+Test *tests_mtd_spi_nor_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_mtd_spi_nor_init),
+        new_TestFixture(test_mtd_spi_nor_write_read),
+        new_TestFixture(test_mtd_spi_nor_erase),
+        new_TestFixture(test_mtd_spi_nor_async_erase),
+        new_TestFixture(test_mtd_spi_nor_suspend),
+        new_TestFixture(test_mtd_spi_nor_suspend_range),
+    };
+
+    EMB_UNIT_TESTCALLER(mtd_spi_nor_tests, setup, teardown, fixtures);
+
+    return (Test *)&mtd_spi_nor_tests;
+}
+
+int main(void)
+{
+    TESTS_START();
+    TESTS_RUN(tests_mtd_spi_nor_tests());
+    TESTS_END();
+    return 0;
+}
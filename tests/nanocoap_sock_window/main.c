@@ -0,0 +1,326 @@
+/*
+ * Copyright (C) 2023 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Tests nanocoap_sock_get_blockwise_window()
+ *
+ * A server thread on the loopback address answers the block requests and
+ * drops, holds back or rejects some of them as set up by each test.
+ *
+ * @}
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include "embUnit.h"
+#include "net/ipv6/addr.h"
+#include "net/nanocoap_sock.h"
+#include "net/sock/udp.h"
+#include "thread.h"
+
+#define SERVER_PORT     (5683)
+#define BLOCK_SZX       (COAP_BLOCKSIZE_16)
+#define BLOCK_SIZE      (16)
+#define LAST_SIZE       (5)
+#define BLOCKS_MAX      (16)
+#define WINDOW_BUF_SIZE (3 * BLOCK_SIZE)
+
+enum {
+    FAIL_ERROR,         /**< answer failing requests with 4.02 */
+    FAIL_RST,           /**< answer failing requests with RST */
+};
+
+static struct {
+    unsigned blocks;                /**< number of blocks of the resource */
+    uint8_t fail_with;              /**< answer to failing requests */
+    uint32_t fail;                  /**< fail these blocks, as those past the end */
+    uint32_t drop;                  /**< drop first request of these blocks */
+    uint32_t hold;                  /**< hold back responses of these blocks */
+    unsigned release;               /**< send held responses after this one */
+    unsigned requests[BLOCKS_MAX];  /**< requests received per block */
+    uint8_t held[BLOCKS_MAX][64];   /**< held back responses */
+    size_t held_len[BLOCKS_MAX];    /**< lengths of the held responses */
+} _server;
+
+static struct {
+    size_t received;
+    int more;
+} _client;
+
+static char _server_stack[THREAD_STACKSIZE_DEFAULT];
+static uint8_t _window_buf[WINDOW_BUF_SIZE];
+
+static size_t _resource_size(void)
+{
+    return (_server.blocks - 1) * BLOCK_SIZE + LAST_SIZE;
+}
+
+static ssize_t _build_response(uint8_t *buf, coap_pkt_t *req, unsigned num)
+{
+    coap_hdr_t *hdr = (void *)buf;
+    uint8_t *pos = buf;
+
+    if ((num >= _server.blocks) || (_server.fail & (1UL << num))) {
+        if (_server.fail_with == FAIL_RST) {
+            return coap_build_hdr(hdr, COAP_TYPE_RST, NULL, 0,
+                                  COAP_CODE_EMPTY, coap_get_id(req));
+        }
+        return coap_build_hdr(hdr, COAP_TYPE_ACK, coap_get_token(req),
+                              coap_get_token_len(req), COAP_CODE_BAD_OPTION,
+                              coap_get_id(req));
+    }
+
+    bool more = (num + 1) < _server.blocks;
+    size_t len = more ? BLOCK_SIZE : LAST_SIZE;
+
+    pos += coap_build_hdr(hdr, COAP_TYPE_ACK, coap_get_token(req),
+                          coap_get_token_len(req), COAP_CODE_205,
+                          coap_get_id(req));
+    pos += coap_opt_put_uint(pos, 0, COAP_OPT_BLOCK2,
+                             (num << 4) | (more ? 0x8 : 0) | BLOCK_SZX);
+    *pos++ = 0xff;
+    for (unsigned i = 0; i < len; i++) {
+        *pos++ = num * BLOCK_SIZE + i;
+    }
+    return pos - buf;
+}
+
+static void _serve(sock_udp_t *sock, sock_udp_ep_t *remote,
+                   uint8_t *buf, size_t len)
+{
+    coap_pkt_t pkt;
+    coap_block1_t block2;
+    uint8_t resp[64];
+
+    if ((coap_parse(&pkt, buf, len) < 0) ||
+        (coap_get_type(&pkt) != COAP_TYPE_CON)) {
+        return;
+    }
+    if (!coap_get_block2(&pkt, &block2)) {
+        block2.blknum = 0;
+    }
+
+    unsigned num = block2.blknum;
+    if (num >= BLOCKS_MAX) {
+        return;
+    }
+    if ((_server.requests[num]++ == 0) && (_server.drop & (1UL << num))) {
+        return;
+    }
+
+    ssize_t res = _build_response(resp, &pkt, num);
+    if (_server.hold & (1UL << num)) {
+        memcpy(_server.held[num], resp, res);
+        _server.held_len[num] = res;
+        return;
+    }
+    sock_udp_send(sock, resp, res, remote);
+
+    if (num == _server.release) {
+        /* send the held responses in reverse order */
+        for (unsigned i = BLOCKS_MAX; i-- > 0;) {
+            if (_server.held_len[i]) {
+                sock_udp_send(sock, _server.held[i], _server.held_len[i], remote);
+                _server.held_len[i] = 0;
+            }
+        }
+    }
+}
+
+static void *_server_thread(void *arg)
+{
+    (void)arg;
+    sock_udp_ep_t local = { .family = AF_INET6, .port = SERVER_PORT };
+    sock_udp_t sock;
+    uint8_t buf[64];
+
+    sock_udp_create(&sock, &local, NULL, 0);
+    while (1) {
+        sock_udp_ep_t remote;
+        ssize_t res = sock_udp_recv(&sock, buf, sizeof(buf), SOCK_NO_TIMEOUT,
+                                    &remote);
+        if (res > 0) {
+            _serve(&sock, &remote, buf, res);
+        }
+    }
+
+    return NULL;
+}
+
+static int _block_cb(void *arg, size_t offset, uint8_t *buf, size_t len, int more)
+{
+    (void)arg;
+
+    /* blocks must be passed in order */
+    if (offset != _client.received) {
+        return -EINVAL;
+    }
+    for (size_t i = 0; i < len; i++) {
+        if (buf[i] != (uint8_t)(offset + i)) {
+            return -EBADMSG;
+        }
+    }
+    _client.received += len;
+    _client.more = more;
+    return 0;
+}
+
+static int _get(void)
+{
+    nanocoap_sock_t sock;
+    sock_udp_ep_t remote = {
+        .family = AF_INET6,
+        .port = SERVER_PORT,
+    };
+    memcpy(remote.addr.ipv6, &ipv6_addr_loopback, sizeof(remote.addr.ipv6));
+
+    int res = nanocoap_sock_connect(&sock, NULL, &remote);
+    if (res < 0) {
+        return res;
+    }
+    res = nanocoap_sock_get_blockwise_window(&sock, "/file", BLOCK_SZX,
+                                             _window_buf, sizeof(_window_buf),
+                                             _block_cb, NULL);
+    nanocoap_sock_close(&sock);
+    return res;
+}
+
+static void set_up(void)
+{
+    memset(&_server, 0, sizeof(_server));
+    memset(&_client, 0, sizeof(_client));
+    _server.blocks = 6;
+    _server.release = BLOCKS_MAX;
+}
+
+static void test_window_in_order(void)
+{
+    TEST_ASSERT_EQUAL_INT(0, _get());
+    TEST_ASSERT_EQUAL_INT(_resource_size(), _client.received);
+    TEST_ASSERT_EQUAL_INT(0, _client.more);
+    for (unsigned i = 0; i < _server.blocks; i++) {
+        TEST_ASSERT_EQUAL_INT(1, _server.requests[i]);
+    }
+}
+
+static void test_window_reorder(void)
+{
+    /* block 2 arrives before block 1 */
+    _server.hold = 1UL << 1;
+    _server.release = 2;
+
+    TEST_ASSERT_EQUAL_INT(0, _get());
+    TEST_ASSERT_EQUAL_INT(_resource_size(), _client.received);
+    TEST_ASSERT_EQUAL_INT(0, _client.more);
+    for (unsigned i = 0; i < _server.blocks; i++) {
+        TEST_ASSERT_EQUAL_INT(1, _server.requests[i]);
+    }
+}
+
+static void test_window_out_of_order(void)
+{
+    /* blocks 4, 3, 2 and 1 arrive in that order, the window is full */
+    _server.hold = (1UL << 1) | (1UL << 2) | (1UL << 3);
+    _server.release = 4;
+
+    TEST_ASSERT_EQUAL_INT(0, _get());
+    TEST_ASSERT_EQUAL_INT(_resource_size(), _client.received);
+    TEST_ASSERT_EQUAL_INT(0, _client.more);
+    for (unsigned i = 0; i < _server.blocks; i++) {
+        TEST_ASSERT_EQUAL_INT(1, _server.requests[i]);
+    }
+}
+
+static void test_window_retransmit(void)
+{
+    /* the first requests of blocks 2 and 5 get lost */
+    _server.drop = (1UL << 2) | (1UL << 5);
+
+    TEST_ASSERT_EQUAL_INT(0, _get());
+    TEST_ASSERT_EQUAL_INT(_resource_size(), _client.received);
+    TEST_ASSERT_EQUAL_INT(0, _client.more);
+    TEST_ASSERT_EQUAL_INT(1, _server.requests[1]);
+    TEST_ASSERT_EQUAL_INT(2, _server.requests[2]);
+    TEST_ASSERT_EQUAL_INT(1, _server.requests[3]);
+    TEST_ASSERT_EQUAL_INT(2, _server.requests[5]);
+}
+
+static void test_window_past_end_rst(void)
+{
+    /* blocks 3 and 4 are past the end, their RSTs arrive before block 2 */
+    _server.blocks = 3;
+    _server.fail_with = FAIL_RST;
+    _server.hold = 1UL << 2;
+    _server.release = 4;
+
+    TEST_ASSERT_EQUAL_INT(0, _get());
+    TEST_ASSERT_EQUAL_INT(_resource_size(), _client.received);
+    TEST_ASSERT_EQUAL_INT(0, _client.more);
+    TEST_ASSERT_EQUAL_INT(1, _server.requests[3]);
+    TEST_ASSERT_EQUAL_INT(1, _server.requests[4]);
+}
+
+static void test_window_past_end_error(void)
+{
+    /* blocks 3 and 4 are past the end, their errors arrive before block 2 */
+    _server.blocks = 3;
+    _server.fail_with = FAIL_ERROR;
+    _server.hold = 1UL << 2;
+    _server.release = 4;
+
+    TEST_ASSERT_EQUAL_INT(0, _get());
+    TEST_ASSERT_EQUAL_INT(_resource_size(), _client.received);
+    TEST_ASSERT_EQUAL_INT(0, _client.more);
+}
+
+static void test_window_error(void)
+{
+    /* an RST for block 2 arrives before block 1, it fails the transfer */
+    _server.fail = 1UL << 2;
+    _server.fail_with = FAIL_RST;
+    _server.hold = 1UL << 1;
+    _server.release = 3;
+
+    TEST_ASSERT_EQUAL_INT(-EBADMSG, _get());
+    TEST_ASSERT_EQUAL_INT(2 * BLOCK_SIZE, _client.received);
+}
+
+static Test *tests_nanocoap_sock_window(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_window_in_order),
+        new_TestFixture(test_window_reorder),
+        new_TestFixture(test_window_out_of_order),
+        new_TestFixture(test_window_retransmit),
+        new_TestFixture(test_window_past_end_rst),
+        new_TestFixture(test_window_past_end_error),
+        new_TestFixture(test_window_error),
+    };
+
+    EMB_UNIT_TESTCALLER(nanocoap_sock_window_tests, set_up, NULL, fixtures);
+
+    return (Test *)&nanocoap_sock_window_tests;
+}
+
+int main(void)
+{
+    thread_create(_server_stack, sizeof(_server_stack),
+                  THREAD_PRIORITY_MAIN - 1, THREAD_CREATE_STACKTEST,
+                  _server_thread, NULL, "coap server");
+
+    TESTS_START();
+    TESTS_RUN(tests_nanocoap_sock_window());
+    TESTS_END();
+
+    return 0;
+}
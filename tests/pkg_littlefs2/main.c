@@ -153,6 +153,41 @@ static void tests_littlefs_write(void)
     TEST_ASSERT_EQUAL_INT(0, res);
 }
 
+static void tests_littlefs_preadv_pwritev(void)
+{
+    char r_buf[8] = { 0 };
+
+    int res;
+    int fd = vfs_open("/test-littlefs/test.txt", O_CREAT | O_RDWR, 0);
+    TEST_ASSERT(fd >= 0);
+
+    iolist_t iol_b = { .iol_base = "-BBB", .iol_len = 4 };
+    iolist_t iol_a = { .iol_next = &iol_b, .iol_base = "AAAA", .iol_len = 4 };
+    res = vfs_pwritev(fd, &iol_a, 2);
+    TEST_ASSERT_EQUAL_INT(8, res);
+
+    /* the file position is kept */
+    res = vfs_write(fd, "01", 2);
+    TEST_ASSERT_EQUAL_INT(2, res);
+
+    res = vfs_pread(fd, r_buf, 4, 4);
+    TEST_ASSERT_EQUAL_INT(4, res);
+    TEST_ASSERT_EQUAL_STRING("AA-B", r_buf);
+
+    memset(r_buf, 0, sizeof(r_buf));
+    iolist_t iol_d = { .iol_base = &r_buf[3], .iol_len = 4 };
+    iolist_t iol_c = { .iol_next = &iol_d, .iol_base = r_buf, .iol_len = 3 };
+    res = vfs_preadv(fd, &iol_c, 3);
+    TEST_ASSERT_EQUAL_INT(7, res);
+    TEST_ASSERT_EQUAL_STRING("AAAA-BB", r_buf);
+
+    res = vfs_lseek(fd, 0, SEEK_CUR);
+    TEST_ASSERT_EQUAL_INT(2, res);
+
+    res = vfs_close(fd);
+    TEST_ASSERT_EQUAL_INT(0, res);
+}
+
 static void tests_littlefs_unlink(void)
 {
     const char buf[] = "TESTSTRING";
@@ -351,6 +386,7 @@ Test *tests_littlefs(void)
         new_TestFixture(tests_littlefs_mount_umount),
         new_TestFixture(tests_littlefs_open_close),
         new_TestFixture(tests_littlefs_write),
+        new_TestFixture(tests_littlefs_preadv_pwritev),
         new_TestFixture(tests_littlefs_unlink),
         new_TestFixture(tests_littlefs_readdir),
         new_TestFixture(tests_littlefs_rename),
@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2023 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       SAUL sampling scheduler test
+ *
+ * @}
+ */
+
+#include <errno.h>
+#include <stdio.h>
+
+#include "container.h"
+#include "embUnit.h"
+#include "saul_sampler.h"
+#include "ztimer.h"
+
+#define PERIOD_MS   (100U)
+
+/* number of reads of each device */
+static unsigned reads[3];
+
+static int _read(const void *dev, phydat_t *res)
+{
+    unsigned *count = (unsigned *)dev;
+
+    res->val[0] = ++*count;
+    res->unit = UNIT_NONE;
+    res->scale = 0;
+    return 1;
+}
+
+static const saul_driver_t _driver = {
+    .read = _read,
+    .write = saul_write_notsup,
+    .type = SAUL_SENSE_COUNT,
+};
+
+static saul_reg_t _devs[] = {
+    { .dev = &reads[0], .name = "a", .driver = &_driver },
+    { .dev = &reads[1], .name = "b", .driver = &_driver },
+    { .dev = &reads[2], .name = "c", .driver = &_driver },
+};
+
+static saul_sampler_entry_t _entries[ARRAY_SIZE(_devs)];
+
+static void set_up(void)
+{
+    for (unsigned i = 0; i < ARRAY_SIZE(reads); i++) {
+        reads[i] = 0;
+    }
+}
+
+static void tear_down(void)
+{
+    for (unsigned i = 0; i < ARRAY_SIZE(_entries); i++) {
+        saul_sampler_remove(&_entries[i]);
+    }
+}
+
+static void test_saul_sampler_add_invalid(void)
+{
+    TEST_ASSERT_EQUAL_INT(-EINVAL, saul_sampler_add(&_entries[0], NULL,
+                                                    PERIOD_MS, 0));
+    TEST_ASSERT_EQUAL_INT(-EINVAL, saul_sampler_add(&_entries[0], &_devs[0],
+                                                    CONFIG_SAUL_SAMPLER_MERGE_MS, 0));
+}
+
+static void test_saul_sampler_bus_grouping(void)
+{
+    saul_sampler_cursor_t cursor;
+    saul_sample_t sample[6];
+
+    saul_sampler_cursor_init(&cursor);
+    saul_sampler_add(&_entries[0], &_devs[0], PERIOD_MS, 1);
+    saul_sampler_add(&_entries[1], &_devs[1], PERIOD_MS, 2);
+    saul_sampler_add(&_entries[2], &_devs[2], PERIOD_MS, 1);
+    ztimer_sleep(ZTIMER_MSEC, PERIOD_MS + PERIOD_MS / 2);
+
+    for (unsigned i = 0; i < ARRAY_SIZE(sample); i++) {
+        TEST_ASSERT_EQUAL_INT(0, saul_sampler_read(&cursor, &sample[i]));
+        TEST_ASSERT_EQUAL_INT(1, sample[i].res);
+        TEST_ASSERT_EQUAL_INT(i / 3 + 1, sample[i].data.val[0]);
+    }
+    TEST_ASSERT_EQUAL_INT(-EAGAIN, saul_sampler_read(&cursor, &sample[0]));
+    /* the second round reads the devices on bus 1 one after the other */
+    TEST_ASSERT(sample[5].dev == &_devs[1]);
+}
+
+static void test_saul_sampler_periodic(void)
+{
+    saul_sampler_cursor_t cursor;
+    saul_sample_t sample;
+    unsigned count = 0;
+
+    saul_sampler_cursor_init(&cursor);
+    saul_sampler_add(&_entries[0], &_devs[0], PERIOD_MS, 0);
+    saul_sampler_add(&_entries[1], &_devs[1], 2 * PERIOD_MS, 0);
+    ztimer_sleep(ZTIMER_MSEC, 3 * PERIOD_MS + PERIOD_MS / 2);
+
+    while (saul_sampler_read(&cursor, &sample) == 0) {
+        count++;
+    }
+    TEST_ASSERT_EQUAL_INT(4, reads[0]);
+    TEST_ASSERT_EQUAL_INT(2, reads[1]);
+    TEST_ASSERT_EQUAL_INT(6, count);
+
+    /* consumers get the latest sample without reading the device */
+    TEST_ASSERT_EQUAL_INT(0, saul_sampler_latest(&_devs[0], &sample));
+    TEST_ASSERT_EQUAL_INT(4, sample.data.val[0]);
+    TEST_ASSERT_EQUAL_INT(0, saul_sampler_latest(&_devs[1], &sample));
+    TEST_ASSERT_EQUAL_INT(2, sample.data.val[0]);
+    TEST_ASSERT_EQUAL_INT(4, reads[0]);
+}
+
+static void test_saul_sampler_remove(void)
+{
+    saul_sampler_add(&_entries[0], &_devs[0], PERIOD_MS, 0);
+    ztimer_sleep(ZTIMER_MSEC, PERIOD_MS / 2);
+    saul_sampler_remove(&_entries[0]);
+    ztimer_sleep(ZTIMER_MSEC, 2 * PERIOD_MS);
+    TEST_ASSERT_EQUAL_INT(1, reads[0]);
+}
+
+static void test_saul_sampler_overflow(void)
+{
+    saul_sampler_cursor_t cursor;
+    saul_sample_t sample;
+    unsigned count = 0;
+
+    saul_sampler_cursor_init(&cursor);
+    saul_sampler_add(&_entries[0], &_devs[0], CONFIG_SAUL_SAMPLER_MERGE_MS + 1, 0);
+    while (reads[0] <= CONFIG_SAUL_SAMPLER_BUF_NUMOF) {
+        ztimer_sleep(ZTIMER_MSEC, CONFIG_SAUL_SAMPLER_MERGE_MS);
+    }
+    saul_sampler_remove(&_entries[0]);
+
+    TEST_ASSERT_EQUAL_INT(-EOVERFLOW, saul_sampler_read(&cursor, &sample));
+    while (saul_sampler_read(&cursor, &sample) == 0) {
+        count++;
+    }
+    TEST_ASSERT_EQUAL_INT(CONFIG_SAUL_SAMPLER_BUF_NUMOF, count);
+    TEST_ASSERT_EQUAL_INT(reads[0], sample.data.val[0]);
+}
+
+Test *tests_saul_sampler(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_saul_sampler_add_invalid),
+        new_TestFixture(test_saul_sampler_bus_grouping),
+        new_TestFixture(test_saul_sampler_periodic),
+        new_TestFixture(test_saul_sampler_remove),
+        new_TestFixture(test_saul_sampler_overflow),
+    };
+    EMB_UNIT_TESTCALLER(saul_sampler_tests, set_up, tear_down, fixtures);
+    return (Test *)&saul_sampler_tests;
+}
+
+int main(void)
+{
+    TESTS_START();
+    TESTS_RUN(tests_saul_sampler());
+    TESTS_END();
+    return 0;
+}
@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2023 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       SenML streaming encoder test
+ *
+ * @}
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "embUnit.h"
+#include "fmt.h"
+#include "senml/stream.h"
+
+#define OUT_SIZE (128)
+
+static uint8_t out[OUT_SIZE];
+static size_t out_len;
+static unsigned writes;
+static char hex[2 * OUT_SIZE + 1];
+
+static const senml_value_t val_uint = { .attr = { .name = "a" },
+                                        .value = { .type = SENML_TYPE_NUMERIC_UINT,
+                                                   .value.u = 1 } };
+static const senml_bool_value_t val_bool = { .attr = { .time = { .value.u = 5 } },
+                                             .value = true };
+
+/* collects the stream, failing once the output buffer is full */
+static ssize_t _write(void *arg, const void *data, size_t len)
+{
+    (void)arg;
+
+    if (out_len + len > sizeof(out)) {
+        return -ENOSPC;
+    }
+    memcpy(&out[out_len], data, len);
+    out_len += len;
+    writes++;
+    return len;
+}
+
+static void set_up(void)
+{
+    out_len = 0;
+    writes = 0;
+}
+
+static void test_senml_stream_cbor(void)
+{
+    static const char expect[] = "9FA20061610201A2060504F5FF";
+    uint8_t record[16];
+    senml_stream_t stream;
+
+    senml_stream_init(&stream, SENML_STREAM_CBOR, record, sizeof(record),
+                      _write, NULL);
+    TEST_ASSERT_EQUAL_INT(0, senml_stream_value(&stream, &val_uint));
+    TEST_ASSERT_EQUAL_INT(0, senml_stream_bool(&stream, &val_bool));
+    TEST_ASSERT_EQUAL_INT(sizeof(expect) / 2, senml_stream_finish(&stream));
+
+    hex[fmt_bytes_hex(hex, out, out_len)] = '\0';
+    TEST_ASSERT_EQUAL_STRING(expect, hex);
+    /* array start, two records, break */
+    TEST_ASSERT_EQUAL_INT(4, writes);
+}
+
+static void test_senml_stream_json(void)
+{
+    static const char expect[] =
+        "[{\"n\":\"a\",\"v\":1},{\"t\":5,\"vb\":true},"
+        "{\"n\":\"t\",\"u\":\"Cel\",\"v\":21.5},{\"v\":61.500},"
+        "{\"vs\":\"a\\\"b\"},{\"vd\":\"AAECAw\"}]";
+    static const uint8_t data[] = { 0x00, 0x01, 0x02, 0x03 };
+    senml_value_t val_decfrac = { .attr = { .name = "t", .unit = SENML_UNIT_CELSIUS },
+                                  .value = senml_decfrac(215, -1) };
+    senml_value_t val_float = { .value = senml_float(61.5) };
+    senml_string_value_t val_string = { .value = "a\"b", .len = 3 };
+    senml_data_value_t val_data = { .value = data, .len = sizeof(data) };
+    char record[40];
+    senml_stream_t stream;
+
+    senml_stream_init(&stream, SENML_STREAM_JSON, record, sizeof(record),
+                      _write, NULL);
+    senml_stream_value(&stream, &val_uint);
+    senml_stream_bool(&stream, &val_bool);
+    senml_stream_value(&stream, &val_decfrac);
+    senml_stream_value(&stream, &val_float);
+    senml_stream_string(&stream, &val_string);
+    senml_stream_data(&stream, &val_data);
+    TEST_ASSERT_EQUAL_INT(sizeof(expect) - 1, senml_stream_finish(&stream));
+
+    out[out_len] = '\0';
+    TEST_ASSERT_EQUAL_STRING(expect, (char *)out);
+}
+
+static void test_senml_stream_record_too_large(void)
+{
+    senml_string_value_t val_string = { .value = "a long string value", .len = 19 };
+    char record[16];
+    senml_stream_t stream;
+
+    senml_stream_init(&stream, SENML_STREAM_JSON, record, sizeof(record),
+                      _write, NULL);
+    TEST_ASSERT_EQUAL_INT(0, senml_stream_value(&stream, &val_uint));
+    TEST_ASSERT_EQUAL_INT(-ENOBUFS, senml_stream_string(&stream, &val_string));
+    /* later records are dropped */
+    TEST_ASSERT_EQUAL_INT(-ENOBUFS, senml_stream_value(&stream, &val_uint));
+    TEST_ASSERT_EQUAL_INT(-ENOBUFS, senml_stream_finish(&stream));
+    TEST_ASSERT_EQUAL_INT(2, writes);
+}
+
+static void test_senml_stream_write_error(void)
+{
+    char record[16];
+    senml_stream_t stream;
+    int res = 0;
+
+    senml_stream_init(&stream, SENML_STREAM_JSON, record, sizeof(record),
+                      _write, NULL);
+    /* the output holds far fewer records than written */
+    for (unsigned i = 0; i < 100; i++) {
+        res = senml_stream_value(&stream, &val_uint);
+    }
+    TEST_ASSERT_EQUAL_INT(-ENOSPC, res);
+    TEST_ASSERT_EQUAL_INT(-ENOSPC, senml_stream_finish(&stream));
+    /* "[" and the first record, then seven records with separator */
+    TEST_ASSERT_EQUAL_INT(OUT_SIZE, out_len);
+}
+
+Test *tests_senml_stream(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_senml_stream_cbor),
+        new_TestFixture(test_senml_stream_json),
+        new_TestFixture(test_senml_stream_record_too_large),
+        new_TestFixture(test_senml_stream_write_error),
+    };
+    EMB_UNIT_TESTCALLER(senml_stream_tests, set_up, NULL, fixtures);
+    return (Test *)&senml_stream_tests;
+}
+
+int main(void)
+{
+    TESTS_START();
+    TESTS_RUN(tests_senml_stream());
+    TESTS_END();
+    return 0;
+}
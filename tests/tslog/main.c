@@ -0,0 +1,335 @@
+/*
+ * Copyright (C) 2023 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       tslog module test
+ *
+ * @}
+ */
+
+#include <stdint.h>
+#include <errno.h>
+#include <string.h>
+
+#include "embUnit.h"
+#include "mtd.h"
+#include "mtd_emulated.h"
+#include "tslog.h"
+
+#define SECTOR_COUNT    8
+#define PAGE_PER_SECTOR 2
+#define PAGE_SIZE       64
+#define SECTOR_SIZE     (PAGE_PER_SECTOR * PAGE_SIZE)
+
+/* records of 8 bytes: 7 per sector after the 16 byte sector header */
+#define DATA_SIZE       8
+#define RECS_PER_SECTOR 7
+
+MTD_EMULATED_DEV(0, SECTOR_COUNT, PAGE_PER_SECTOR, PAGE_SIZE);
+
+/* accesses of the backing device */
+static unsigned reads, rewrites, erases;
+
+static int _read_page(mtd_dev_t *dev, void *dest, uint32_t page,
+                      uint32_t offset, uint32_t size)
+{
+    reads++;
+    return _mtd_emulated_driver.read_page(dev, dest, page, offset, size);
+}
+
+static int _write_page(mtd_dev_t *dev, const void *src, uint32_t page,
+                       uint32_t offset, uint32_t size)
+{
+    const uint8_t *mem = &mtd_emulated_dev0.memory[page * PAGE_SIZE + offset];
+
+    /* like on flash, every byte may be written once after erasing it */
+    for (unsigned i = 0; i < size; i++) {
+        if (mem[i] != 0xff) {
+            rewrites++;
+        }
+    }
+    return _mtd_emulated_driver.write_page(dev, src, page, offset, size);
+}
+
+static int _erase_sector(mtd_dev_t *dev, uint32_t sector, uint32_t count)
+{
+    erases += count;
+    return _mtd_emulated_driver.erase_sector(dev, sector, count);
+}
+
+static int _init(mtd_dev_t *dev)
+{
+    return _mtd_emulated_driver.init(dev);
+}
+
+static const mtd_desc_t _counting_driver = {
+    .init = _init,
+    .read_page = _read_page,
+    .write_page = _write_page,
+    .erase_sector = _erase_sector,
+};
+
+static tslog_sector_t _sectors[SECTOR_COUNT];
+static tslog_t _log = TSLOG_INIT(&mtd_emulated_dev0.base, _sectors);
+
+/* fills the data of the record with time stamp @p ts */
+static void _pattern(uint8_t *data, uint32_t ts)
+{
+    for (unsigned i = 0; i < DATA_SIZE; i++) {
+        data[i] = ts + i;
+    }
+}
+
+static void _append(uint32_t ts)
+{
+    uint8_t data[DATA_SIZE];
+
+    _pattern(data, ts);
+    TEST_ASSERT_EQUAL_INT(0, tslog_append(&_log, ts, data, sizeof(data)));
+}
+
+/* checks that the next record has time stamp @p ts and the matching data */
+static void _expect(tslog_iter_t *iter, uint32_t ts)
+{
+    tslog_rec_t rec;
+    uint8_t data[DATA_SIZE], expected[DATA_SIZE];
+
+    TEST_ASSERT_EQUAL_INT(1, tslog_next(&_log, iter, &rec));
+    TEST_ASSERT_EQUAL_INT(ts, rec.timestamp);
+    TEST_ASSERT_EQUAL_INT(DATA_SIZE, rec.len);
+    TEST_ASSERT_EQUAL_INT(DATA_SIZE, tslog_read(&_log, &rec, data, 0, sizeof(data)));
+    _pattern(expected, ts);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(data, expected, sizeof(data)));
+}
+
+static void _reinit(void)
+{
+    memset(_sectors, 0, sizeof(_sectors));
+    _log.sectors_numof = ARRAY_SIZE(_sectors);
+    TEST_ASSERT_EQUAL_INT(0, tslog_init(&_log));
+}
+
+static void setup(void)
+{
+    memset(mtd_emulated_dev0.memory, 0xff, mtd_emulated_dev0.size);
+    mtd_emulated_dev0.base.driver = &_counting_driver;
+    mtd_emulated_dev0.base.write_size = 1;
+    _reinit();
+    reads = rewrites = erases = 0;
+}
+
+static void teardown(void)
+{
+    TEST_ASSERT_EQUAL_INT(0, rewrites);
+}
+
+static void test_tslog_append_query(void)
+{
+    tslog_iter_t iter;
+
+    for (uint32_t ts = 0; ts < 30; ts++) {
+        _append(ts * 10);
+    }
+    TEST_ASSERT_EQUAL_INT(5, erases);
+
+    tslog_query(&_log, &iter, 95, 200);
+    for (uint32_t ts = 100; ts <= 200; ts += 10) {
+        _expect(&iter, ts);
+    }
+    TEST_ASSERT_EQUAL_INT(0, tslog_next(&_log, &iter, &(tslog_rec_t){ 0 }));
+
+    /* the whole log */
+    tslog_query(&_log, &iter, 0, UINT32_MAX);
+    for (uint32_t ts = 0; ts < 300; ts += 10) {
+        _expect(&iter, ts);
+    }
+    TEST_ASSERT_EQUAL_INT(0, tslog_next(&_log, &iter, &(tslog_rec_t){ 0 }));
+
+    /* records appended later are found by an open ended query */
+    _append(300);
+    _expect(&iter, 300);
+}
+
+static void test_tslog_binary_search(void)
+{
+    tslog_iter_t iter;
+
+    for (uint32_t ts = 0; ts < 7 * RECS_PER_SECTOR; ts++) {
+        _append(ts);
+    }
+
+    /* only the headers of the records in the sector of the first match are
+     * read, plus the one of the match */
+    reads = 0;
+    tslog_query(&_log, &iter, 6 * RECS_PER_SECTOR - 2, UINT32_MAX);
+    TEST_ASSERT_EQUAL_INT(0, reads);
+    _expect(&iter, 6 * RECS_PER_SECTOR - 2);
+    TEST_ASSERT(reads <= RECS_PER_SECTOR + 1);
+
+    /* equal time stamps across sectors */
+    for (unsigned i = 0; i < RECS_PER_SECTOR + 2; i++) {
+        _append(100);
+    }
+    tslog_query(&_log, &iter, 100, 100);
+    for (unsigned i = 0; i < RECS_PER_SECTOR + 2; i++) {
+        _expect(&iter, 100);
+    }
+    TEST_ASSERT_EQUAL_INT(0, tslog_next(&_log, &iter, &(tslog_rec_t){ 0 }));
+}
+
+static void test_tslog_wrap(void)
+{
+    tslog_iter_t iter;
+    tslog_rec_t rec;
+    const uint32_t count = 3 * SECTOR_COUNT * RECS_PER_SECTOR + 3;
+
+    _append(0);
+    tslog_query(&_log, &iter, 0, UINT32_MAX);
+    for (uint32_t ts = 1; ts < count; ts++) {
+        _append(ts);
+    }
+
+    /* the iterator was overtaken by erasing the oldest sectors */
+    TEST_ASSERT_EQUAL_INT(-ESTALE, tslog_next(&_log, &iter, &rec));
+
+    /* the oldest records left are those of the sector after the head */
+    uint32_t first = count - 3 - (SECTOR_COUNT - 1) * RECS_PER_SECTOR;
+    tslog_query(&_log, &iter, 0, UINT32_MAX);
+    for (uint32_t ts = first; ts < count; ts++) {
+        _expect(&iter, ts);
+    }
+    TEST_ASSERT_EQUAL_INT(0, tslog_next(&_log, &iter, &rec));
+
+    /* the log is restored from the device */
+    _reinit();
+    tslog_query(&_log, &iter, count - 5, UINT32_MAX);
+    for (uint32_t ts = count - 5; ts < count; ts++) {
+        _expect(&iter, ts);
+    }
+    TEST_ASSERT_EQUAL_INT(-EINVAL, tslog_append(&_log, count - 2, "x", 1));
+    _append(count);
+    _expect(&iter, count);
+
+    /* records found before their sector is erased can't be read after */
+    tslog_query(&_log, &iter, 0, UINT32_MAX);
+    TEST_ASSERT_EQUAL_INT(1, tslog_next(&_log, &iter, &rec));
+    for (uint32_t ts = count + 1; ts < count + RECS_PER_SECTOR; ts++) {
+        _append(ts);
+    }
+    uint8_t data[DATA_SIZE];
+    TEST_ASSERT_EQUAL_INT(-ESTALE, tslog_read(&_log, &rec, data, 0, sizeof(data)));
+}
+
+static void test_tslog_torn(void)
+{
+    tslog_iter_t iter;
+    tslog_rec_t rec;
+
+    for (uint32_t ts = 0; ts < 3; ts++) {
+        _append(ts);
+    }
+
+    /* a reset while writing the last record left some bits set */
+    uint32_t last = SECTOR_SIZE + 16 + 2 * (8 + DATA_SIZE);
+    mtd_emulated_dev0.memory[last + 8 + DATA_SIZE - 1] = 0xff;
+
+    _reinit();
+    tslog_query(&_log, &iter, 0, UINT32_MAX);
+    _expect(&iter, 0);
+    _expect(&iter, 1);
+    TEST_ASSERT_EQUAL_INT(1, tslog_next(&_log, &iter, &rec));
+    uint8_t data[DATA_SIZE];
+    TEST_ASSERT_EQUAL_INT(-EBADMSG, tslog_read(&_log, &rec, data, 0, sizeof(data)));
+    /* parts of it are not checked */
+    TEST_ASSERT_EQUAL_INT(2, tslog_read(&_log, &rec, data, 2, 2));
+
+    /* nothing is written after it */
+    _append(3);
+    _expect(&iter, 3);
+    TEST_ASSERT_EQUAL_INT(3, mtd_emulated_dev0.memory[2 * SECTOR_SIZE + 16 + 8]);
+}
+
+static void test_tslog_write_size(void)
+{
+    tslog_iter_t iter;
+    tslog_rec_t rec;
+    char data[8];
+
+    /* records are padded to the write size */
+    mtd_emulated_dev0.base.write_size = 4;
+    _reinit();
+
+    TEST_ASSERT_EQUAL_INT(0, tslog_append(&_log, 1, "abcde", 5));
+    TEST_ASSERT_EQUAL_INT(0, tslog_append(&_log, 2, "", 0));
+    TEST_ASSERT_EQUAL_INT(0, tslog_append(&_log, 3, "fgh", 3));
+    TEST_ASSERT_EQUAL_INT(0xff, mtd_emulated_dev0.memory[SECTOR_SIZE + 16 + 8 + 5]);
+
+    tslog_query(&_log, &iter, 0, UINT32_MAX);
+    TEST_ASSERT_EQUAL_INT(1, tslog_next(&_log, &iter, &rec));
+    TEST_ASSERT_EQUAL_INT(5, tslog_read(&_log, &rec, data, 0, sizeof(data)));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(data, "abcde", 5));
+    TEST_ASSERT_EQUAL_INT(1, tslog_next(&_log, &iter, &rec));
+    TEST_ASSERT_EQUAL_INT(0, rec.len);
+    TEST_ASSERT_EQUAL_INT(1, tslog_next(&_log, &iter, &rec));
+    TEST_ASSERT_EQUAL_INT(3, tslog_read(&_log, &rec, data, 0, sizeof(data)));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(data, "fgh", 3));
+    TEST_ASSERT_EQUAL_INT(0, tslog_next(&_log, &iter, &rec));
+}
+
+static void test_tslog_errors(void)
+{
+    static uint8_t data[SECTOR_SIZE];
+    tslog_iter_t iter;
+    tslog_rec_t rec;
+
+    /* nothing to find in an empty log */
+    tslog_query(&_log, &iter, 0, UINT32_MAX);
+    TEST_ASSERT_EQUAL_INT(0, tslog_next(&_log, &iter, &rec));
+
+    TEST_ASSERT_EQUAL_INT(-EMSGSIZE, tslog_append(&_log, 0, data, SECTOR_SIZE - 16 - 7));
+    TEST_ASSERT_EQUAL_INT(0, tslog_append(&_log, 5, data, SECTOR_SIZE - 16 - 8));
+    TEST_ASSERT_EQUAL_INT(-EINVAL, tslog_append(&_log, 4, data, 1));
+
+    /* the iteration started on the empty log finds the record */
+    TEST_ASSERT_EQUAL_INT(1, tslog_next(&_log, &iter, &rec));
+    TEST_ASSERT_EQUAL_INT(5, rec.timestamp);
+
+    TEST_ASSERT_EQUAL_INT(0, tslog_clear(&_log));
+    _reinit();
+    tslog_query(&_log, &iter, 0, UINT32_MAX);
+    TEST_ASSERT_EQUAL_INT(0, tslog_next(&_log, &iter, &rec));
+    TEST_ASSERT_EQUAL_INT(0, tslog_append(&_log, 4, data, 1));
+}
+
+Test *tests_tslog_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_tslog_append_query),
+        new_TestFixture(test_tslog_binary_search),
+        new_TestFixture(test_tslog_wrap),
+        new_TestFixture(test_tslog_torn),
+        new_TestFixture(test_tslog_write_size),
+        new_TestFixture(test_tslog_errors),
+    };
+
+    EMB_UNIT_TESTCALLER(tslog_tests, setup, teardown, fixtures);
+
+    return (Test *)&tslog_tests;
+}
+
+int main(void)
+{
+    TESTS_START();
+    TESTS_RUN(tests_tslog_tests());
+    TESTS_END();
+    return 0;
+}
@@ -6,7 +6,9 @@
  * directory for more details.
  */
 
+#include <errno.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <string.h>
 #include "net/af.h"
 #include "net/ipv6.h"
@@ -51,11 +53,97 @@ static void test_dns_cache_add_ttl0(void)
     TEST_ASSERT_EQUAL_INT(0, dns_cache_query("example.com", &addr_out, AF_INET6));
 }
 
+static void test_dns_cache_add_negative(void)
+{
+    ipv6_addr_t addr_in = IPV6_ADDR_ALL_NODES_IF_LOCAL;
+    ipv6_addr_t addr_out;
+
+    dns_cache_add("example.com", &addr_in, sizeof(addr_in), 1);
+    /* a negative entry replaces the address */
+    dns_cache_add_negative("example.com", 1);
+    TEST_ASSERT_EQUAL_INT(-ENOENT, dns_cache_query("example.com", &addr_out, AF_INET6));
+    TEST_ASSERT_EQUAL_INT(-ENOENT, dns_cache_query("example.com", &addr_out, AF_INET));
+    TEST_ASSERT_EQUAL_INT(-ENOENT, dns_cache_query("example.com", &addr_out, AF_UNSPEC));
+    TEST_ASSERT_EQUAL_INT(0, dns_cache_query("example.org", &addr_out, AF_INET6));
+
+    /* an address replaces the negative entry */
+    dns_cache_add("example.com", &addr_in, sizeof(addr_in), 1);
+    TEST_ASSERT_EQUAL_INT(sizeof(addr_out), dns_cache_query("example.com", &addr_out, AF_INET6));
+
+    dns_cache_add_negative("example.com", 1);
+    ztimer_sleep(ZTIMER_USEC, 2000000);
+    TEST_ASSERT_EQUAL_INT(0, dns_cache_query("example.com", &addr_out, AF_INET6));
+}
+
+static void test_dns_cache_evict(void)
+{
+    ipv6_addr_t addr_in = IPV6_ADDR_ALL_NODES_IF_LOCAL;
+    ipv6_addr_t addr_out;
+    dns_cache_stats_t before, after;
+    char name[16];
+
+    dns_cache_get_stats(&before);
+    /* fill the cache with entries that expire in order of addition */
+    for (unsigned i = 0; i < CONFIG_DNS_CACHE_SIZE; i++) {
+        snprintf(name, sizeof(name), "host%u.example", i);
+        dns_cache_add(name, &addr_in, sizeof(addr_in), 10 + i);
+    }
+    /* an entry living shorter than all others is not added */
+    dns_cache_add("short.example", &addr_in, sizeof(addr_in), 1);
+    TEST_ASSERT_EQUAL_INT(0, dns_cache_query("short.example", &addr_out, AF_INET6));
+    /* otherwise the first entry to expire is evicted */
+    dns_cache_add("long.example", &addr_in, sizeof(addr_in), 100);
+    TEST_ASSERT_EQUAL_INT(sizeof(addr_out), dns_cache_query("long.example", &addr_out, AF_INET6));
+    TEST_ASSERT_EQUAL_INT(0, dns_cache_query("host0.example", &addr_out, AF_INET6));
+    for (unsigned i = 1; i < CONFIG_DNS_CACHE_SIZE; i++) {
+        snprintf(name, sizeof(name), "host%u.example", i);
+        TEST_ASSERT_EQUAL_INT(sizeof(addr_out), dns_cache_query(name, &addr_out, AF_INET6));
+        dns_cache_add(name, &addr_in, sizeof(addr_in), 0);
+    }
+    dns_cache_add("long.example", &addr_in, sizeof(addr_in), 0);
+
+    dns_cache_get_stats(&after);
+    TEST_ASSERT_EQUAL_INT(1, after.evictions - before.evictions);
+    TEST_ASSERT_EQUAL_INT(CONFIG_DNS_CACHE_SIZE, after.hits - before.hits);
+    TEST_ASSERT_EQUAL_INT(2, after.misses - before.misses);
+}
+
+static void test_dns_cache_query_claim(void)
+{
+    ipv6_addr_t addr_in = IPV6_ADDR_ALL_NODES_IF_LOCAL;
+    ipv6_addr_t addr_out;
+    dns_cache_stats_t before, after;
+
+    dns_cache_get_stats(&before);
+    TEST_ASSERT_EQUAL_INT(0, dns_cache_query_claim("example.com", &addr_out, AF_INET6));
+    /* a query of another family is not coalesced with the claimed one */
+    TEST_ASSERT_EQUAL_INT(0, dns_cache_query_claim("example.com", &addr_out, AF_INET));
+    dns_cache_release("example.com", AF_INET);
+    dns_cache_add("example.com", &addr_in, sizeof(addr_in), 1);
+    dns_cache_release("example.com", AF_INET6);
+    TEST_ASSERT_EQUAL_INT(sizeof(addr_out), dns_cache_query_claim("example.com", &addr_out, AF_INET6));
+    dns_cache_add("example.com", &addr_in, sizeof(addr_in), 0);
+
+    /* claimed queries that failed can be claimed again */
+    TEST_ASSERT_EQUAL_INT(0, dns_cache_query_claim("example.com", &addr_out, AF_INET6));
+    dns_cache_release("example.com", AF_INET6);
+    TEST_ASSERT_EQUAL_INT(0, dns_cache_query_claim("example.com", &addr_out, AF_INET6));
+    dns_cache_release("example.com", AF_INET6);
+
+    dns_cache_get_stats(&after);
+    TEST_ASSERT_EQUAL_INT(1, after.hits - before.hits);
+    TEST_ASSERT_EQUAL_INT(4, after.misses - before.misses);
+    TEST_ASSERT_EQUAL_INT(0, after.coalesced - before.coalesced);
+}
+
 Test *tests_dns_cache_tests(void)
 {
     EMB_UNIT_TESTFIXTURES(fixtures) {
         new_TestFixture(test_dns_cache_add),
         new_TestFixture(test_dns_cache_add_ttl0),
+        new_TestFixture(test_dns_cache_add_negative),
+        new_TestFixture(test_dns_cache_evict),
+        new_TestFixture(test_dns_cache_query_claim),
     };
 
     EMB_UNIT_TESTCALLER(dns_cache_tests, NULL, NULL, fixtures);
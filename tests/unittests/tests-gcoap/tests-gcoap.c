@@ -17,11 +17,17 @@
 
 #include "embUnit.h"
 
+#include "byteorder.h"
 #include "net/gcoap.h"
+#include "net/gnrc.h"
+#include "net/gnrc/ipv6/hdr.h"
+#include "net/udp.h"
 
 #include "unittests-constants.h"
 #include "tests-gcoap.h"
 
+#include "_gcoap-index.h"
+
 #if IS_USED(MODULE_NANOCOAP_CACHE)
 #define ETAG_SLACK 9    /* account for ETag slack implicitly added by gcoap_req_init() */
 #else
@@ -367,6 +373,191 @@ static void test_gcoap__server_con_resp(void)
     TEST_ASSERT_EQUAL_INT(sizeof(resp_data), res + 1);
 }
 
+/*
+ * Observable resource for the notification template test
+ */
+static ssize_t _obs_handler(coap_pkt_t *pdu, uint8_t *buf, size_t len,
+                            coap_request_ctx_t *ctx)
+{
+    (void)ctx;
+    gcoap_resp_init(pdu, buf, len, COAP_CODE_CONTENT);
+    coap_opt_add_format(pdu, COAP_FORMAT_TEXT);
+    return coap_opt_finish(pdu, COAP_OPT_FINISH_NONE);
+}
+
+/* keeps the resource out of the resource list */
+static ssize_t _obs_encode_link(const coap_resource_t *resource, char *buf,
+                                size_t maxlen, coap_link_encoder_ctx_t *context)
+{
+    (void)resource;
+    (void)buf;
+    (void)maxlen;
+    (void)context;
+    return 0;
+}
+
+static const coap_resource_t resources_obs[] = {
+    { .path = "/obs/value", .methods = COAP_GET, .handler = _obs_handler },
+};
+
+static gcoap_listener_t listener_obs = {
+    .resources     = &resources_obs[0],
+    .resources_len = ARRAY_SIZE(resources_obs),
+    .link_encoder  = _obs_encode_link,
+    .next          = NULL
+};
+
+static const ipv6_addr_t _observer_addr = {
+    .u8 = { 0x20, 0x01, 0x0d, 0xb8, [15] = 0x01 }
+};
+static const ipv6_addr_t _server_addr = {
+    .u8 = { 0x20, 0x01, 0x0d, 0xb8, [15] = 0x02 }
+};
+#define OBSERVER_PORT   (61616U)
+
+/* last CoAP message sent by gcoap */
+static uint8_t _sent[CONFIG_GCOAP_PDU_BUF_SIZE];
+static size_t _sent_len;
+static unsigned _sent_numof;
+
+static void _capture_sent(uint16_t cmd, gnrc_pktsnip_t *pkt, void *ctx)
+{
+    (void)ctx;
+    gnrc_pktsnip_t *udp = gnrc_pktsnip_search_type(pkt, GNRC_NETTYPE_UDP);
+
+    if ((cmd == GNRC_NETAPI_MSG_TYPE_SND) && (udp != NULL)) {
+        _sent_len = 0;
+        for (gnrc_pktsnip_t *snip = udp->next; snip != NULL; snip = snip->next) {
+            if ((_sent_len + snip->size) > sizeof(_sent)) {
+                break;
+            }
+            memcpy(&_sent[_sent_len], snip->data, snip->size);
+            _sent_len += snip->size;
+        }
+        _sent_numof++;
+    }
+    gnrc_pktbuf_release(pkt);
+}
+
+/* passes a request from the observer to the gcoap server, which runs with a
+ * higher priority, so it is handled when this returns */
+static int _recv_request(const uint8_t *data, size_t len)
+{
+    gnrc_pktsnip_t *ipv6 = gnrc_ipv6_hdr_build(NULL, &_observer_addr,
+                                               &_server_addr);
+    gnrc_pktsnip_t *udp = gnrc_pktbuf_add(ipv6, NULL, sizeof(udp_hdr_t),
+                                          GNRC_NETTYPE_UDP);
+    gnrc_pktsnip_t *payload = gnrc_pktbuf_add(udp, data, len,
+                                              GNRC_NETTYPE_UNDEF);
+    udp_hdr_t *hdr;
+
+    if (payload == NULL) {
+        return -ENOMEM;
+    }
+    hdr = udp->data;
+    hdr->src_port = byteorder_htons(OBSERVER_PORT);
+    hdr->dst_port = byteorder_htons(CONFIG_GCOAP_PORT);
+    hdr->length = byteorder_htons(sizeof(udp_hdr_t) + len);
+    hdr->checksum = byteorder_htons(0);
+    if (!gnrc_netapi_dispatch_receive(GNRC_NETTYPE_UDP, CONFIG_GCOAP_PORT,
+                                      payload)) {
+        gnrc_pktbuf_release(payload);
+        return -ENOTCONN;
+    }
+    return 0;
+}
+
+/*
+ * Observe notification template. Tests the encoded options, which are
+ * preceded by room for header and token, and the notification sent to a
+ * registered observer.
+ */
+static void test_gcoap__server_obs_template(void)
+{
+    uint8_t buf[CONFIG_GCOAP_PDU_BUF_SIZE];
+    gcoap_obs_template_t tmpl;
+    coap_pkt_t pdu;
+
+    TEST_ASSERT_EQUAL_INT(-ENOBUFS, gcoap_obs_template_init(&tmpl, &pdu, buf, 8,
+                                                            &resources[1]));
+    TEST_ASSERT_EQUAL_INT(0, gcoap_obs_template_init(&tmpl, &pdu, buf, sizeof(buf),
+                                                     &resources[1]));
+    coap_opt_add_format(&pdu, COAP_FORMAT_TEXT);
+    size_t max = gcoap_obs_template_finish(&tmpl, &pdu);
+
+    /* Observe with fixed width, Content-Format text, payload marker */
+    uint8_t opts[] = {
+        0x60 | CONFIG_GCOAP_OBS_VALUE_WIDTH, 0x00, 0x00, 0x00, 0x60, 0xff
+    };
+    uint8_t *start = &buf[GCOAP_HEADER_MAXLEN];
+    size_t opts_len = sizeof(opts) - (3 - CONFIG_GCOAP_OBS_VALUE_WIDTH);
+
+    TEST_ASSERT(tmpl.observe == start + 1);
+    TEST_ASSERT(tmpl.payload == start + opts_len);
+    TEST_ASSERT_EQUAL_INT(sizeof(buf) - GCOAP_HEADER_MAXLEN - opts_len, max);
+    TEST_ASSERT_EQUAL_INT(0x60 | CONFIG_GCOAP_OBS_VALUE_WIDTH, start[0]);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(&opts[4], start + opts_len - 2, 2));
+
+    /* no observer registered for the resource */
+    memcpy(tmpl.payload, "22", 2);
+    TEST_ASSERT_EQUAL_INT(0, gcoap_obs_template_send(&tmpl, 2));
+
+    /* register an observer for the resource with the gcoap server */
+    static gnrc_netreg_entry_cbd_t capture_cbd = { .cb = _capture_sent };
+    static gnrc_netreg_entry_t capture = GNRC_NETREG_ENTRY_INIT_CB(
+            GNRC_NETREG_DEMUX_CTX_ALL, &capture_cbd);
+    uint8_t req_buf[CONFIG_GCOAP_PDU_BUF_SIZE];
+    coap_pkt_t req;
+
+    gnrc_pktbuf_init();
+    gcoap_init();
+    gcoap_register_listener(&listener_obs);
+    gnrc_netreg_register(GNRC_NETTYPE_UDP, &capture);
+
+    gcoap_req_init(&req, req_buf, sizeof(req_buf), COAP_METHOD_GET, NULL);
+    coap_hdr_set_type(req.hdr, COAP_TYPE_NON);
+    coap_opt_add_uint(&req, COAP_OPT_OBSERVE, COAP_OBS_REGISTER);
+    coap_opt_add_string(&req, COAP_OPT_URI_PATH, resources_obs[0].path, '/');
+    ssize_t req_len = coap_opt_finish(&req, COAP_OPT_FINISH_NONE);
+    size_t token_len = coap_get_token_len(&req);
+
+    TEST_ASSERT_EQUAL_INT(0, _recv_request(req_buf, req_len));
+    /* response confirms the registration */
+    coap_pkt_t resp;
+    TEST_ASSERT_EQUAL_INT(1, _sent_numof);
+    TEST_ASSERT_EQUAL_INT(0, coap_parse(&resp, _sent, _sent_len));
+    TEST_ASSERT_EQUAL_INT(COAP_CODE_CONTENT, coap_get_code_raw(&resp));
+    TEST_ASSERT(coap_has_observe(&resp));
+
+    /* notification carries the header and token of the observer in front of
+     * the template */
+    TEST_ASSERT_EQUAL_INT(0, gcoap_obs_template_init(&tmpl, &pdu, buf, sizeof(buf),
+                                                     &resources_obs[0]));
+    coap_opt_add_format(&pdu, COAP_FORMAT_TEXT);
+    gcoap_obs_template_finish(&tmpl, &pdu);
+    memcpy(tmpl.payload, "22", 2);
+    TEST_ASSERT_EQUAL_INT(1, gcoap_obs_template_send(&tmpl, 2));
+    TEST_ASSERT_EQUAL_INT(2, _sent_numof);
+
+    coap_pkt_t notif;
+    size_t hdr_len = sizeof(coap_hdr_t) + token_len;
+
+    TEST_ASSERT_EQUAL_INT(hdr_len + opts_len + 2, _sent_len);
+    TEST_ASSERT_EQUAL_INT(0, coap_parse(&notif, _sent, _sent_len));
+    TEST_ASSERT_EQUAL_INT(COAP_TYPE_NON, coap_get_type(&notif));
+    TEST_ASSERT_EQUAL_INT(COAP_CODE_CONTENT, coap_get_code_raw(&notif));
+    TEST_ASSERT_EQUAL_INT(token_len, coap_get_token_len(&notif));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(coap_get_token(&req), coap_get_token(&notif),
+                                    token_len));
+    TEST_ASSERT(coap_get_id(&notif) != coap_get_id(&resp));
+    TEST_ASSERT(coap_has_observe(&notif));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(start, &_sent[hdr_len], opts_len));
+    TEST_ASSERT_EQUAL_INT(2, notif.payload_len);
+    TEST_ASSERT_EQUAL_INT(0, memcmp("22", notif.payload, 2));
+
+    gnrc_netreg_unregister(GNRC_NETTYPE_UDP, &capture);
+}
+
 /*
  * Test the export of configured resources as CoRE link format string
  */
@@ -392,6 +583,98 @@ static void test_gcoap__server_get_resource_list(void)
     TEST_ASSERT_EQUAL_STRING(resource_list_str, (char *)res);
 }
 
+/*
+ * Hash index of gcoap, with four buckets, so hashes 1, 5 and 9 collide
+ */
+#define INDEX_NUMOF     (4U)
+
+static uint16_t _index_mem[3][INDEX_NUMOF];
+static const _index_t _index = {
+    _index_mem[0], _index_mem[1], _index_mem[2], INDEX_NUMOF
+};
+
+/* returns the entries in the bucket of hash as bit field */
+static unsigned _index_lookup(uint32_t hash)
+{
+    unsigned entries = 0;
+    unsigned n = 0;
+
+    for (unsigned i = _index_first(&_index, hash); i != INDEX_NONE;
+         i = _index_next(&_index, i)) {
+        if ((i >= INDEX_NUMOF) || (++n > INDEX_NUMOF)) {
+            /* corrupted chain */
+            return UINT_MAX;
+        }
+        entries |= 1U << i;
+    }
+    return entries;
+}
+
+static void test_gcoap__index_collisions(void)
+{
+    _index_reset(&_index);
+    _index_add(&_index, 0, 1);
+    _index_add(&_index, 1, 5);
+    _index_add(&_index, 2, 9);
+    _index_add(&_index, 3, 2);
+
+    TEST_ASSERT_EQUAL_INT(0x7, _index_lookup(1));
+    TEST_ASSERT_EQUAL_INT(0x7, _index_lookup(5));
+    TEST_ASSERT_EQUAL_INT(0x8, _index_lookup(2));
+    TEST_ASSERT_EQUAL_INT(0x0, _index_lookup(3));
+    TEST_ASSERT_EQUAL_INT(0x0, _index_lookup(4));
+
+    /* from the middle of the chain */
+    _index_del(&_index, 1);
+    TEST_ASSERT_EQUAL_INT(0x5, _index_lookup(1));
+    /* from the head of the chain */
+    _index_del(&_index, 2);
+    TEST_ASSERT_EQUAL_INT(0x1, _index_lookup(1));
+    /* unlinked entries are ignored */
+    _index_del(&_index, 2);
+    TEST_ASSERT_EQUAL_INT(0x1, _index_lookup(1));
+    TEST_ASSERT_EQUAL_INT(0x8, _index_lookup(2));
+
+    /* adding a linked entry moves it to its new bucket */
+    _index_add(&_index, 0, 6);
+    TEST_ASSERT_EQUAL_INT(0x0, _index_lookup(1));
+    TEST_ASSERT_EQUAL_INT(0x9, _index_lookup(2));
+    _index_add(&_index, 1, 10);
+    TEST_ASSERT_EQUAL_INT(0xb, _index_lookup(2));
+    /* from the tail of the chain */
+    _index_del(&_index, 3);
+    TEST_ASSERT_EQUAL_INT(0x3, _index_lookup(2));
+}
+
+static void test_gcoap__index_remove_last(void)
+{
+    _index_reset(&_index);
+    _index_add(&_index, 3, 7);
+    TEST_ASSERT_EQUAL_INT(0x8, _index_lookup(3));
+
+    _index_del(&_index, 3);
+    TEST_ASSERT_EQUAL_INT(INDEX_NONE, _index_first(&_index, 3));
+    TEST_ASSERT_EQUAL_INT(0x0, _index_lookup(7));
+
+    /* the emptied bucket can be used again */
+    _index_add(&_index, 0, 3);
+    _index_add(&_index, 3, 7);
+    TEST_ASSERT_EQUAL_INT(0x9, _index_lookup(3));
+    _index_del(&_index, 3);
+    _index_del(&_index, 0);
+    TEST_ASSERT_EQUAL_INT(INDEX_NONE, _index_first(&_index, 3));
+
+    /* reset unlinks all entries */
+    _index_add(&_index, 0, 0);
+    _index_add(&_index, 1, 1);
+    _index_reset(&_index);
+    for (unsigned hash = 0; hash < INDEX_NUMOF; hash++) {
+        TEST_ASSERT_EQUAL_INT(INDEX_NONE, _index_first(&_index, hash));
+    }
+    _index_add(&_index, 1, 1);
+    TEST_ASSERT_EQUAL_INT(0x2, _index_lookup(1));
+}
+
 Test *tests_gcoap_tests(void)
 {
     EMB_UNIT_TESTFIXTURES(fixtures) {
@@ -405,7 +688,10 @@ Test *tests_gcoap_tests(void)
         new_TestFixture(test_gcoap__server_get_resp),
         new_TestFixture(test_gcoap__server_con_req),
         new_TestFixture(test_gcoap__server_con_resp),
-        new_TestFixture(test_gcoap__server_get_resource_list)
+        new_TestFixture(test_gcoap__server_obs_template),
+        new_TestFixture(test_gcoap__server_get_resource_list),
+        new_TestFixture(test_gcoap__index_collisions),
+        new_TestFixture(test_gcoap__index_remove_last),
     };
 
     EMB_UNIT_TESTCALLER(gcoap_tests, NULL, NULL, fixtures);
@@ -0,0 +1,198 @@
+/*
+ * Copyright (C) 2023 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @{
+ *
+ * @file
+ */
+#include <errno.h>
+
+#include "container.h"
+#include "embUnit.h"
+
+#include "net/gnrc/rpl/sr_table.h"
+
+#include "tests-gnrc_rpl_sr_table.h"
+
+#define LIFETIME        (60U)
+
+static ipv6_addr_t _addrs[CONFIG_GNRC_RPL_SR_TABLE_NUMOF + 1];
+
+static void set_up(void)
+{
+    for (unsigned i = 0; i < ARRAY_SIZE(_addrs); i++) {
+        ipv6_addr_from_str(&_addrs[i], "2001:db8::");
+        _addrs[i].u8[15] = i + 2;
+    }
+    gnrc_rpl_sr_table_reset();
+}
+
+/* builds root <- 0 <- 1 <- ... <- (numof - 1) */
+static void _add_chain(unsigned numof)
+{
+    for (unsigned i = 0; i < numof; i++) {
+        TEST_ASSERT_EQUAL_INT(0, gnrc_rpl_sr_table_add(&_addrs[i],
+                                                       i ? &_addrs[i - 1] : NULL,
+                                                       LIFETIME));
+    }
+}
+
+static void test_sr_table_get_route__unknown(void)
+{
+    ipv6_addr_t hops[CONFIG_GNRC_RPL_SR_TABLE_MAX_DEPTH];
+
+    TEST_ASSERT_EQUAL_INT(-ENOENT, gnrc_rpl_sr_table_get_route(&_addrs[0], hops,
+                                                               ARRAY_SIZE(hops)));
+}
+
+static void test_sr_table_add__invalid(void)
+{
+    TEST_ASSERT_EQUAL_INT(-EINVAL, gnrc_rpl_sr_table_add(&_addrs[0], NULL, 0));
+    TEST_ASSERT_EQUAL_INT(-EINVAL, gnrc_rpl_sr_table_add(&_addrs[0], &_addrs[0],
+                                                         LIFETIME));
+    TEST_ASSERT_EQUAL_INT(0, gnrc_rpl_sr_table_numof());
+}
+
+static void test_sr_table_get_route__chain(void)
+{
+    ipv6_addr_t hops[CONFIG_GNRC_RPL_SR_TABLE_MAX_DEPTH];
+    gnrc_rpl_sr_table_stats_t stats;
+
+    _add_chain(3);
+    TEST_ASSERT_EQUAL_INT(3, gnrc_rpl_sr_table_numof());
+    for (unsigned run = 0; run < 2; run++) {
+        TEST_ASSERT_EQUAL_INT(3, gnrc_rpl_sr_table_get_route(&_addrs[2], hops,
+                                                             ARRAY_SIZE(hops)));
+        for (unsigned i = 0; i < 3; i++) {
+            TEST_ASSERT(ipv6_addr_equal(&_addrs[i], &hops[i]));
+        }
+    }
+    gnrc_rpl_sr_table_get_stats(&stats);
+    TEST_ASSERT_EQUAL_INT(2, stats.lookups);
+    TEST_ASSERT_EQUAL_INT(1, stats.cache_hits);
+    TEST_ASSERT_EQUAL_INT(-ENOBUFS, gnrc_rpl_sr_table_get_route(&_addrs[2], hops, 2));
+}
+
+static void test_sr_table_get_route__parent_change(void)
+{
+    ipv6_addr_t hops[CONFIG_GNRC_RPL_SR_TABLE_MAX_DEPTH];
+
+    _add_chain(3);
+    TEST_ASSERT_EQUAL_INT(3, gnrc_rpl_sr_table_get_route(&_addrs[2], hops,
+                                                         ARRAY_SIZE(hops)));
+    /* move 2 directly below the root */
+    TEST_ASSERT_EQUAL_INT(0, gnrc_rpl_sr_table_add(&_addrs[2], NULL, LIFETIME));
+    TEST_ASSERT_EQUAL_INT(1, gnrc_rpl_sr_table_get_route(&_addrs[2], hops,
+                                                         ARRAY_SIZE(hops)));
+    TEST_ASSERT(ipv6_addr_equal(&_addrs[2], &hops[0]));
+}
+
+static void test_sr_table_get_route__unknown_parent(void)
+{
+    ipv6_addr_t hops[CONFIG_GNRC_RPL_SR_TABLE_MAX_DEPTH];
+
+    /* DAO of 1 arrives before the one of its parent 0 */
+    TEST_ASSERT_EQUAL_INT(0, gnrc_rpl_sr_table_add(&_addrs[1], &_addrs[0],
+                                                   LIFETIME));
+    TEST_ASSERT_EQUAL_INT(2, gnrc_rpl_sr_table_numof());
+    TEST_ASSERT_EQUAL_INT(-EHOSTUNREACH,
+                          gnrc_rpl_sr_table_get_route(&_addrs[0], hops,
+                                                      ARRAY_SIZE(hops)));
+    TEST_ASSERT_EQUAL_INT(-EHOSTUNREACH,
+                          gnrc_rpl_sr_table_get_route(&_addrs[1], hops,
+                                                      ARRAY_SIZE(hops)));
+    TEST_ASSERT_EQUAL_INT(0, gnrc_rpl_sr_table_add(&_addrs[0], NULL, LIFETIME));
+    TEST_ASSERT_EQUAL_INT(2, gnrc_rpl_sr_table_numof());
+    TEST_ASSERT_EQUAL_INT(2, gnrc_rpl_sr_table_get_route(&_addrs[1], hops,
+                                                         ARRAY_SIZE(hops)));
+}
+
+static void test_sr_table_add__loop(void)
+{
+    _add_chain(3);
+    TEST_ASSERT_EQUAL_INT(-ELOOP, gnrc_rpl_sr_table_add(&_addrs[0], &_addrs[2],
+                                                        LIFETIME));
+}
+
+static void test_sr_table_get_route__too_deep(void)
+{
+    ipv6_addr_t hops[CONFIG_GNRC_RPL_SR_TABLE_MAX_DEPTH + 1];
+
+    _add_chain(CONFIG_GNRC_RPL_SR_TABLE_MAX_DEPTH + 1);
+    TEST_ASSERT_EQUAL_INT(-ELOOP,
+                          gnrc_rpl_sr_table_get_route(
+                              &_addrs[CONFIG_GNRC_RPL_SR_TABLE_MAX_DEPTH], hops,
+                              ARRAY_SIZE(hops)));
+}
+
+static void test_sr_table_add__full(void)
+{
+    for (unsigned i = 0; i < CONFIG_GNRC_RPL_SR_TABLE_NUMOF; i++) {
+        TEST_ASSERT_EQUAL_INT(0, gnrc_rpl_sr_table_add(&_addrs[i], NULL,
+                                                       LIFETIME));
+    }
+    TEST_ASSERT_EQUAL_INT(-ENOMEM,
+                          gnrc_rpl_sr_table_add(
+                              &_addrs[CONFIG_GNRC_RPL_SR_TABLE_NUMOF], NULL,
+                              LIFETIME));
+}
+
+static void test_sr_table_del(void)
+{
+    ipv6_addr_t hops[CONFIG_GNRC_RPL_SR_TABLE_MAX_DEPTH];
+
+    _add_chain(3);
+    /* 1 is kept as placeholder for 2 */
+    gnrc_rpl_sr_table_del(&_addrs[1]);
+    TEST_ASSERT_EQUAL_INT(3, gnrc_rpl_sr_table_numof());
+    TEST_ASSERT_EQUAL_INT(-EHOSTUNREACH,
+                          gnrc_rpl_sr_table_get_route(&_addrs[2], hops,
+                                                      ARRAY_SIZE(hops)));
+    gnrc_rpl_sr_table_del(&_addrs[2]);
+    TEST_ASSERT_EQUAL_INT(1, gnrc_rpl_sr_table_numof());
+    TEST_ASSERT_EQUAL_INT(1, gnrc_rpl_sr_table_get_route(&_addrs[0], hops,
+                                                         ARRAY_SIZE(hops)));
+}
+
+static void test_sr_table_timeout(void)
+{
+    _add_chain(2);
+    TEST_ASSERT_EQUAL_INT(0, gnrc_rpl_sr_table_add(&_addrs[1], &_addrs[0],
+                                                   LIFETIME / 2));
+    gnrc_rpl_sr_table_timeout(LIFETIME / 2);
+    TEST_ASSERT_EQUAL_INT(1, gnrc_rpl_sr_table_numof());
+    gnrc_rpl_sr_table_timeout(LIFETIME / 2);
+    TEST_ASSERT_EQUAL_INT(0, gnrc_rpl_sr_table_numof());
+}
+
+static Test *tests_gnrc_rpl_sr_table_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_sr_table_get_route__unknown),
+        new_TestFixture(test_sr_table_add__invalid),
+        new_TestFixture(test_sr_table_get_route__chain),
+        new_TestFixture(test_sr_table_get_route__parent_change),
+        new_TestFixture(test_sr_table_get_route__unknown_parent),
+        new_TestFixture(test_sr_table_add__loop),
+        new_TestFixture(test_sr_table_get_route__too_deep),
+        new_TestFixture(test_sr_table_add__full),
+        new_TestFixture(test_sr_table_del),
+        new_TestFixture(test_sr_table_timeout),
+    };
+
+    EMB_UNIT_TESTCALLER(gnrc_rpl_sr_table_tests, set_up, NULL, fixtures);
+
+    return (Test *)&gnrc_rpl_sr_table_tests;
+}
+
+void tests_gnrc_rpl_sr_table(void)
+{
+    TESTS_RUN(tests_gnrc_rpl_sr_table_tests());
+}
+/** @} */
@@ -257,6 +257,72 @@ static void test_nanocoap_cache__max_age(void)
     TEST_ASSERT(nanocoap_cache_entry_is_stale(c, 20));
 }
 
+static nanocoap_cache_entry_t *_add_fake(uint8_t id, size_t len)
+{
+    static uint8_t data[CONFIG_NANOCOAP_CACHE_RESPONSE_SIZE];
+    uint8_t cache_key[CONFIG_NANOCOAP_CACHE_KEY_LENGTH];
+    coap_pkt_t resp = { .hdr = (coap_hdr_t *)data, .payload = data };
+
+    memset(cache_key, id, sizeof(cache_key));
+    memset(data, id, sizeof(data));
+    return nanocoap_cache_add_by_key(cache_key, COAP_METHOD_GET, &resp, len);
+}
+
+static nanocoap_cache_entry_t *_lookup_fake(uint8_t id)
+{
+    uint8_t cache_key[CONFIG_NANOCOAP_CACHE_KEY_LENGTH];
+
+    memset(cache_key, id, sizeof(cache_key));
+    return nanocoap_cache_key_lookup(cache_key);
+}
+
+static void test_nanocoap_cache__bytes(void)
+{
+    const size_t len = CONFIG_NANOCOAP_CACHE_RESPONSE_SIZE / 2;
+    nanocoap_cache_stats_t stats;
+    nanocoap_cache_entry_t *c;
+
+    nanocoap_cache_init();
+
+    for (unsigned i = 0; i < CONFIG_NANOCOAP_CACHE_ENTRIES; i++) {
+        TEST_ASSERT_NOT_NULL(_add_fake(i, len));
+    }
+    /* remove an entry in the middle, the others keep their response */
+    c = _lookup_fake(1);
+    TEST_ASSERT_NOT_NULL(c);
+    TEST_ASSERT_EQUAL_INT(0, nanocoap_cache_del(c));
+    TEST_ASSERT_EQUAL_INT(-1, nanocoap_cache_del(c));
+    TEST_ASSERT_NULL(_lookup_fake(1));
+    for (unsigned i = 2; i < CONFIG_NANOCOAP_CACHE_ENTRIES; i++) {
+        c = _lookup_fake(i);
+        TEST_ASSERT_NOT_NULL(c);
+        TEST_ASSERT_EQUAL_INT(len, c->response_len);
+        TEST_ASSERT_EQUAL_INT(i, c->response_buf[0]);
+        TEST_ASSERT_EQUAL_INT(i, c->response_buf[len - 1]);
+    }
+    nanocoap_cache_get_stats(&stats);
+    TEST_ASSERT_EQUAL_INT(CONFIG_NANOCOAP_CACHE_ENTRIES - 1, stats.hits);
+    TEST_ASSERT_EQUAL_INT(1, stats.misses);
+    TEST_ASSERT_EQUAL_INT(0, stats.evictions);
+    TEST_ASSERT_EQUAL_INT((CONFIG_NANOCOAP_CACHE_ENTRIES - 1) * len, stats.bytes);
+
+    /* the first takes the free entry, the second evicts the least
+     * recently used entry 0 */
+    TEST_ASSERT_NOT_NULL(_add_fake(0xfe, 2 * len));
+    TEST_ASSERT_NOT_NULL(_add_fake(0xff, 2 * len));
+    TEST_ASSERT_NULL(_lookup_fake(0));
+    c = _lookup_fake(2);
+    TEST_ASSERT_NOT_NULL(c);
+    TEST_ASSERT_EQUAL_INT(2, c->response_buf[len - 1]);
+    c = _lookup_fake(0xfe);
+    TEST_ASSERT_NOT_NULL(c);
+    TEST_ASSERT_EQUAL_INT(0xfe, c->response_buf[2 * len - 1]);
+    nanocoap_cache_get_stats(&stats);
+    TEST_ASSERT_EQUAL_INT(1, stats.evictions);
+    TEST_ASSERT_EQUAL_INT((CONFIG_NANOCOAP_CACHE_ENTRIES - 2) * len + 4 * len,
+                          stats.bytes);
+}
+
 Test *tests_nanocoap_cache_tests(void)
 {
     EMB_UNIT_TESTFIXTURES(fixtures) {
@@ -264,6 +330,7 @@ Test *tests_nanocoap_cache_tests(void)
         new_TestFixture(test_nanocoap_cache__del),
         new_TestFixture(test_nanocoap_cache__cachekey),
         new_TestFixture(test_nanocoap_cache__max_age),
+        new_TestFixture(test_nanocoap_cache__bytes),
     };
 
     EMB_UNIT_TESTCALLER(nanocoap_cache_entry_tests, NULL, NULL, fixtures);
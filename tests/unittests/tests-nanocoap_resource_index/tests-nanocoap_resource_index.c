@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2023 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @{
+ *
+ * @file
+ */
+#include <errno.h>
+
+#include "container.h"
+#include "embUnit.h"
+
+#include "net/nanocoap/resource_index.h"
+
+#include "tests-nanocoap_resource_index.h"
+
+static const coap_resource_t _resources[] = {
+    { "/sensor/temp", COAP_GET, NULL, NULL },
+    { "/sensor/temp", COAP_PUT, NULL, NULL },
+    { "/sensor", COAP_GET | COAP_MATCH_SUBTREE, NULL, NULL },
+    { "/sensor/hum", COAP_GET, NULL, NULL },
+    { "/fw/", COAP_POST | COAP_MATCH_SUBTREE, NULL, NULL },
+    { "/riot/board", COAP_GET, NULL, NULL },
+};
+
+static coap_resource_index_t _index;
+static uint16_t _slots[16];
+
+static void set_up(void)
+{
+    TEST_ASSERT_EQUAL_INT(0, coap_resource_index_init(&_index, _resources,
+                                                      ARRAY_SIZE(_resources),
+                                                      _slots,
+                                                      ARRAY_SIZE(_slots)));
+}
+
+static int _find(const char *uri, coap_method_flags_t method)
+{
+    const coap_resource_t *resource;
+    int res = coap_resource_index_find(&_index, uri, method, &resource);
+
+    return (res == 0) ? (int)index_of(_resources, resource) : res;
+}
+
+static void test_resource_index_init__too_small(void)
+{
+    TEST_ASSERT_EQUAL_INT(-ENOSPC, coap_resource_index_init(&_index, _resources,
+                                                            ARRAY_SIZE(_resources),
+                                                            _slots, 8));
+}
+
+static void test_resource_index_find__exact(void)
+{
+    TEST_ASSERT_EQUAL_INT(0, _find("/sensor/temp", COAP_GET));
+    TEST_ASSERT_EQUAL_INT(1, _find("/sensor/temp", COAP_PUT));
+    TEST_ASSERT_EQUAL_INT(5, _find("/riot/board", COAP_GET));
+}
+
+static void test_resource_index_find__subtree(void)
+{
+    TEST_ASSERT_EQUAL_INT(2, _find("/sensor", COAP_GET));
+    TEST_ASSERT_EQUAL_INT(2, _find("/sensor/light", COAP_GET));
+    /* matches the earlier subtree resource first */
+    TEST_ASSERT_EQUAL_INT(2, _find("/sensor/hum", COAP_GET));
+    TEST_ASSERT_EQUAL_INT(4, _find("/fw/slot0", COAP_POST));
+}
+
+static void test_resource_index_find__wrong_method(void)
+{
+    TEST_ASSERT_EQUAL_INT(-EPERM, _find("/sensor/temp", COAP_DELETE));
+    TEST_ASSERT_EQUAL_INT(-EPERM, _find("/fw/slot0", COAP_GET));
+    TEST_ASSERT_EQUAL_INT(-EPERM, _find("/riot/board", COAP_POST));
+}
+
+static void test_resource_index_find__no_path(void)
+{
+    TEST_ASSERT_EQUAL_INT(-ENOENT, _find("/", COAP_GET));
+    TEST_ASSERT_EQUAL_INT(-ENOENT, _find("/fw", COAP_POST));
+    TEST_ASSERT_EQUAL_INT(-ENOENT, _find("/riot/board/x", COAP_GET));
+    TEST_ASSERT_EQUAL_INT(-ENOENT, _find("/sens", COAP_GET));
+}
+
+static Test *tests_nanocoap_resource_index_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_resource_index_init__too_small),
+        new_TestFixture(test_resource_index_find__exact),
+        new_TestFixture(test_resource_index_find__subtree),
+        new_TestFixture(test_resource_index_find__wrong_method),
+        new_TestFixture(test_resource_index_find__no_path),
+    };
+
+    EMB_UNIT_TESTCALLER(nanocoap_resource_index_tests, set_up, NULL, fixtures);
+
+    return (Test *)&nanocoap_resource_index_tests;
+}
+
+void tests_nanocoap_resource_index(void)
+{
+    TESTS_RUN(tests_nanocoap_resource_index_tests());
+}
+/** @} */
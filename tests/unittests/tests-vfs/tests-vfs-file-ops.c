@@ -150,6 +150,16 @@ static void test_vfs_null_file_ops_write(void)
     TEST_ASSERT_EQUAL_INT(-EFAULT, res);
 }
 
+static void test_vfs_null_file_ops_mmap(void)
+{
+    TEST_ASSERT(_test_vfs_file_op_my_fd >= 0);
+    const void *addr;
+    int res = vfs_mmap(_test_vfs_file_op_my_fd, 0, 1, &addr);
+    TEST_ASSERT_EQUAL_INT(-ENODEV, res);
+    res = vfs_mmap(_test_vfs_file_op_my_fd, 0, 1, NULL);
+    TEST_ASSERT_EQUAL_INT(-EFAULT, res);
+}
+
 Test *tests_vfs_null_file_ops_tests(void)
 {
     EMB_UNIT_TESTFIXTURES(fixtures) {
@@ -159,6 +169,7 @@ Test *tests_vfs_null_file_ops_tests(void)
         new_TestFixture(test_vfs_null_file_ops_fstat),
         new_TestFixture(test_vfs_null_file_ops_read),
         new_TestFixture(test_vfs_null_file_ops_write),
+        new_TestFixture(test_vfs_null_file_ops_mmap),
     };
 
     EMB_UNIT_TESTCALLER(vfs_file_op_tests, setup, teardown, fixtures);
@@ -173,6 +173,77 @@ static void test_vfs_constfs_read_lseek(void)
     TEST_ASSERT_EQUAL_INT(0, res);
 }
 
+static void test_vfs_constfs_preadv(void)
+{
+    int res;
+    res = vfs_mount(&_test_vfs_mount);
+    TEST_ASSERT_EQUAL_INT(0, res);
+
+    int fd = vfs_open("/test/test.txt", O_RDONLY, 0);
+    TEST_ASSERT(fd >= 0);
+
+    off_t pos = vfs_lseek(fd, 3, SEEK_SET);
+    TEST_ASSERT_EQUAL_INT(3, pos);
+
+    /* "This is a test file" */
+    char head[5] = { 0 }, tail[16] = { 0 };
+    iolist_t iol_tail = { .iol_base = tail, .iol_len = sizeof(tail) };
+    iolist_t iol = { .iol_next = &iol_tail, .iol_base = head, .iol_len = 4 };
+    ssize_t nbytes = vfs_preadv(fd, &iol, 5);
+    TEST_ASSERT_EQUAL_INT(sizeof(str_data) - 5, nbytes);
+    TEST_ASSERT_EQUAL_STRING("is a", head);
+    TEST_ASSERT_EQUAL_STRING(" test file", tail);
+
+    /* the file position is kept */
+    memset(head, 0, sizeof(head));
+    nbytes = vfs_read(fd, head, 4);
+    TEST_ASSERT_EQUAL_INT(4, nbytes);
+    TEST_ASSERT_EQUAL_STRING("s is", head);
+
+    nbytes = vfs_pread(fd, head, 4, sizeof(str_data));
+    TEST_ASSERT_EQUAL_INT(0, nbytes);
+    nbytes = vfs_pread(fd, head, 4, -1);
+    TEST_ASSERT_EQUAL_INT(-EINVAL, nbytes);
+    nbytes = vfs_pwrite(fd, head, 4, 0);
+    TEST_ASSERT_EQUAL_INT(-EBADF, nbytes);
+
+    res = vfs_close(fd);
+    TEST_ASSERT_EQUAL_INT(0, res);
+
+    res = vfs_umount(&_test_vfs_mount, false);
+    TEST_ASSERT_EQUAL_INT(0, res);
+}
+
+static void test_vfs_constfs_mmap(void)
+{
+    int res;
+    res = vfs_mount(&_test_vfs_mount);
+    TEST_ASSERT_EQUAL_INT(0, res);
+
+    int fd = vfs_open("/test/test.txt", O_RDONLY, 0);
+    TEST_ASSERT(fd >= 0);
+
+    /* the file is used in place */
+    const void *addr;
+    res = vfs_mmap(fd, 0, sizeof(str_data), &addr);
+    TEST_ASSERT_EQUAL_INT(0, res);
+    TEST_ASSERT(addr == str_data);
+    res = vfs_mmap(fd, 5, sizeof(str_data) - 5, &addr);
+    TEST_ASSERT_EQUAL_INT(0, res);
+    TEST_ASSERT(addr == &str_data[5]);
+
+    res = vfs_mmap(fd, 5, sizeof(str_data) - 4, &addr);
+    TEST_ASSERT_EQUAL_INT(-ENXIO, res);
+    res = vfs_mmap(fd, sizeof(str_data) + 1, 0, &addr);
+    TEST_ASSERT_EQUAL_INT(-ENXIO, res);
+
+    res = vfs_close(fd);
+    TEST_ASSERT_EQUAL_INT(0, res);
+
+    res = vfs_umount(&_test_vfs_mount, false);
+    TEST_ASSERT_EQUAL_INT(0, res);
+}
+
 #if MODULE_NEWLIB || MODULE_PICOLIBC || defined(BOARD_NATIVE)
 static void test_vfs_constfs__posix(void)
 {
@@ -212,6 +283,8 @@ Test *tests_vfs_mount_constfs_tests(void)
         new_TestFixture(test_vfs_umount__invalid_mount),
         new_TestFixture(test_vfs_constfs_open),
         new_TestFixture(test_vfs_constfs_read_lseek),
+        new_TestFixture(test_vfs_constfs_preadv),
+        new_TestFixture(test_vfs_constfs_mmap),
 #if MODULE_NEWLIB || MODULE_PICOLIBC || defined(BOARD_NATIVE)
         new_TestFixture(test_vfs_constfs__posix),
 #endif
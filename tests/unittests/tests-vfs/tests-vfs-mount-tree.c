@@ -0,0 +1,251 @@
+/*
+ * Copyright (C) 2023 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @{
+ *
+ * @file
+ * @brief Unit tests of finding the mount of a path with nested mount points,
+ * and of the lookup cache
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "embUnit/embUnit.h"
+
+#include "vfs.h"
+
+#include "tests-vfs.h"
+
+/* records the lookups done on a mount */
+typedef struct {
+    unsigned lookups;
+    char path[16];
+} _probe_t;
+
+static _probe_t _probes[5];
+
+/* only "/file" exists, its size is the number of lookups */
+static int _probe_stat(vfs_mount_t *mountp, const char *restrict path,
+                       struct stat *restrict buf)
+{
+    _probe_t *probe = mountp->private_data;
+
+    probe->lookups++;
+    strncpy(probe->path, path, sizeof(probe->path) - 1);
+    if (strcmp(path, "/file") != 0) {
+        return -ENOENT;
+    }
+    buf->st_size = probe->lookups;
+    return 0;
+}
+
+static int _probe_mkdir(vfs_mount_t *mountp, const char *name, mode_t mode)
+{
+    (void)mountp;
+    (void)name;
+    (void)mode;
+    return 0;
+}
+
+static int _probe_open(vfs_file_t *filp, const char *name, int flags, mode_t mode)
+{
+    (void)flags;
+    (void)mode;
+    return _probe_stat(filp->mp, name, &(struct stat){ 0 });
+}
+
+static ssize_t _probe_write(vfs_file_t *filp, const void *src, size_t nbytes)
+{
+    (void)filp;
+    (void)src;
+    return nbytes;
+}
+
+static int _probe_fsync(vfs_file_t *filp)
+{
+    (void)filp;
+    return 0;
+}
+
+static const vfs_file_system_ops_t _probe_fs_ops = {
+    .stat = _probe_stat,
+    .mkdir = _probe_mkdir,
+};
+
+static const vfs_file_ops_t _probe_file_ops = {
+    .open = _probe_open,
+    .write = _probe_write,
+    .fsync = _probe_fsync,
+};
+
+static const vfs_file_system_t _probe_file_system = {
+    .f_op = &_probe_file_ops,
+    .fs_op = &_probe_fs_ops,
+    .flags = VFS_FS_FLAG_LOOKUP_CACHE,
+};
+
+static vfs_mount_t _mounts[] = {
+    { .mount_point = "/a/b", .fs = &_probe_file_system, .private_data = &_probes[0] },
+    { .mount_point = "/ab", .fs = &_probe_file_system, .private_data = &_probes[1] },
+    { .mount_point = "/", .fs = &_probe_file_system, .private_data = &_probes[2] },
+    { .mount_point = "/a", .fs = &_probe_file_system, .private_data = &_probes[3] },
+    { .mount_point = "/a/b/c", .fs = &_probe_file_system, .private_data = &_probes[4] },
+};
+
+#define MOUNT_A_B   (0)
+#define MOUNT_AB    (1)
+#define MOUNT_ROOT  (2)
+#define MOUNT_A     (3)
+#define MOUNT_A_B_C (4)
+
+static void setup(void)
+{
+    memset(_probes, 0, sizeof(_probes));
+    for (unsigned i = 0; i < ARRAY_SIZE(_mounts); i++) {
+        vfs_mount(&_mounts[i]);
+    }
+}
+
+static void teardown(void)
+{
+    for (unsigned i = 0; i < ARRAY_SIZE(_mounts); i++) {
+        vfs_umount(&_mounts[i], true);
+        atomic_store(&_mounts[i].open_files, 0);
+    }
+}
+
+/* checks that @p path is looked up as @p rel_path on @p mount */
+static void _check_lookup(const char *path, unsigned mount, const char *rel_path)
+{
+    struct stat st;
+
+    /* callers use a distinct path per call, so no cached result is used */
+    _probes[mount].lookups = 0;
+    vfs_stat(path, &st);
+    TEST_ASSERT_EQUAL_INT(1, _probes[mount].lookups);
+    TEST_ASSERT_EQUAL_STRING(rel_path, _probes[mount].path);
+}
+
+static void test_vfs_mount_tree_longest_match(void)
+{
+    _check_lookup("/x", MOUNT_ROOT, "/x");
+    _check_lookup("/a", MOUNT_A, "");
+    _check_lookup("/a/x", MOUNT_A, "/x");
+    _check_lookup("/a/bx", MOUNT_A, "/bx");
+    _check_lookup("/a/b/x", MOUNT_A_B, "/x");
+    _check_lookup("/a/b/c/x", MOUNT_A_B_C, "/x");
+    _check_lookup("/ab/x", MOUNT_AB, "/x");
+    _check_lookup("/abc", MOUNT_ROOT, "/abc");
+}
+
+static void test_vfs_mount_tree_umount(void)
+{
+    TEST_ASSERT_EQUAL_INT(0, vfs_umount(&_mounts[MOUNT_A_B], false));
+    _check_lookup("/a/b/y", MOUNT_A, "/b/y");
+    _check_lookup("/a/b/c/y", MOUNT_A_B_C, "/y");
+
+    TEST_ASSERT_EQUAL_INT(0, vfs_umount(&_mounts[MOUNT_ROOT], false));
+    struct stat st;
+    TEST_ASSERT_EQUAL_INT(-ENOENT, vfs_stat("/y", &st));
+    _check_lookup("/a/b/c/z", MOUNT_A_B_C, "/z");
+
+    /* mounting again puts the mount above the ones below its mount point */
+    TEST_ASSERT_EQUAL_INT(0, vfs_mount(&_mounts[MOUNT_A_B]));
+    _check_lookup("/a/b/z", MOUNT_A_B, "/z");
+    _check_lookup("/a/b/c/w", MOUNT_A_B_C, "/w");
+}
+
+static void test_vfs_lookup_cache(void)
+{
+    if (!IS_USED(MODULE_VFS_LOOKUP_CACHE)) {
+        return;
+    }
+
+    _probe_t *probe = &_probes[MOUNT_AB];
+    struct stat st;
+
+    /* not found */
+    TEST_ASSERT_EQUAL_INT(-ENOENT, vfs_stat("/ab/none", &st));
+    TEST_ASSERT_EQUAL_INT(-ENOENT, vfs_stat("/ab/none", &st));
+    TEST_ASSERT_EQUAL_INT(-ENOENT, vfs_open("/ab/none", O_RDONLY, 0));
+    TEST_ASSERT_EQUAL_INT(1, probe->lookups);
+
+    /* found */
+    TEST_ASSERT_EQUAL_INT(0, vfs_stat("/ab/file", &st));
+    TEST_ASSERT_EQUAL_INT(2, st.st_size);
+    TEST_ASSERT_EQUAL_INT(0, vfs_stat("/ab/file", &st));
+    TEST_ASSERT_EQUAL_INT(2, st.st_size);
+    TEST_ASSERT_EQUAL_INT(2, probe->lookups);
+
+    /* modifications of the mount invalidate the cache */
+    TEST_ASSERT_EQUAL_INT(0, vfs_mkdir("/ab/none", 0));
+    TEST_ASSERT_EQUAL_INT(-ENOENT, vfs_stat("/ab/none", &st));
+    TEST_ASSERT_EQUAL_INT(3, probe->lookups);
+
+    int fd = vfs_open("/ab/file", O_WRONLY, 0);
+    TEST_ASSERT(fd >= 0);
+    TEST_ASSERT_EQUAL_INT(4, probe->lookups);
+    /* opening a file for writing does not modify it */
+    TEST_ASSERT_EQUAL_INT(0, vfs_stat("/ab/file", &st));
+    TEST_ASSERT_EQUAL_INT(5, st.st_size);
+    TEST_ASSERT_EQUAL_INT(0, vfs_stat("/ab/file", &st));
+    TEST_ASSERT_EQUAL_INT(5, st.st_size);
+    /* writing invalidates the status of files, but not files not found */
+    TEST_ASSERT_EQUAL_INT(1, vfs_write(fd, "x", 1));
+    TEST_ASSERT_EQUAL_INT(0, vfs_stat("/ab/file", &st));
+    TEST_ASSERT_EQUAL_INT(6, st.st_size);
+    TEST_ASSERT_EQUAL_INT(-ENOENT, vfs_stat("/ab/none", &st));
+    TEST_ASSERT_EQUAL_INT(6, probe->lookups);
+    /* the file system may only update the status when syncing */
+    TEST_ASSERT_EQUAL_INT(0, vfs_fsync(fd));
+    TEST_ASSERT_EQUAL_INT(0, vfs_stat("/ab/file", &st));
+    TEST_ASSERT_EQUAL_INT(7, st.st_size);
+    TEST_ASSERT_EQUAL_INT(0, vfs_close(fd));
+
+    /* modifications of other mounts do not */
+    TEST_ASSERT_EQUAL_INT(0, vfs_stat("/ab/file", &st));
+    TEST_ASSERT_EQUAL_INT(8, probe->lookups);
+    TEST_ASSERT_EQUAL_INT(0, vfs_mkdir("/a/none", 0));
+    TEST_ASSERT_EQUAL_INT(0, vfs_stat("/ab/file", &st));
+    TEST_ASSERT_EQUAL_INT(8, probe->lookups);
+
+    /* neither do lookups in between */
+    TEST_ASSERT_EQUAL_INT(-ENOENT, vfs_stat("/a/none", &st));
+    TEST_ASSERT_EQUAL_INT(0, vfs_stat("/ab/file", &st));
+    TEST_ASSERT_EQUAL_INT(8, probe->lookups);
+
+    /* a new mount point shadows cached paths */
+    static vfs_mount_t shadow = {
+        .mount_point = "/ab/file",
+        .fs = &_probe_file_system,
+        .private_data = &_probes[MOUNT_AB],
+    };
+    TEST_ASSERT_EQUAL_INT(0, vfs_mount(&shadow));
+    TEST_ASSERT_EQUAL_INT(-ENOENT, vfs_stat("/ab/file", &st));
+    TEST_ASSERT_EQUAL_INT(9, probe->lookups);
+    TEST_ASSERT_EQUAL_STRING("", probe->path);
+    TEST_ASSERT_EQUAL_INT(0, vfs_umount(&shadow, false));
+}
+
+Test *tests_vfs_mount_tree_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_vfs_mount_tree_longest_match),
+        new_TestFixture(test_vfs_mount_tree_umount),
+        new_TestFixture(test_vfs_lookup_cache),
+    };
+
+    EMB_UNIT_TESTCALLER(vfs_mount_tree_tests, setup, teardown, fixtures);
+
+    return (Test *)&vfs_mount_tree_tests;
+}
+
+/** @} */
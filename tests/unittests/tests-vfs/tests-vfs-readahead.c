@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2023 Freie Universität Berlin
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @{
+ *
+ * @file
+ * @brief Unit tests of reading files ahead
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "embUnit/embUnit.h"
+
+#include "macros/utils.h"
+#include "vfs.h"
+
+#include "tests-vfs.h"
+
+#define FILE_SIZE   (3 * CONFIG_VFS_READAHEAD_SIZE + 100)
+
+/* a file system of one file in RAM, which counts the reads */
+static uint8_t _data[FILE_SIZE];
+static unsigned _reads;
+
+static int _ram_open(vfs_file_t *filp, const char *name, int flags, mode_t mode)
+{
+    (void)filp;
+    (void)flags;
+    (void)mode;
+    return (strcmp(name, "/file") == 0) ? 0 : -ENOENT;
+}
+
+static ssize_t _ram_read(vfs_file_t *filp, void *dest, size_t nbytes)
+{
+    _reads++;
+    if ((size_t)filp->pos >= sizeof(_data)) {
+        return 0;
+    }
+    nbytes = MIN(nbytes, sizeof(_data) - filp->pos);
+    memcpy(dest, &_data[filp->pos], nbytes);
+    filp->pos += nbytes;
+    return nbytes;
+}
+
+static ssize_t _ram_write(vfs_file_t *filp, const void *src, size_t nbytes)
+{
+    if ((size_t)filp->pos >= sizeof(_data)) {
+        return -ENOSPC;
+    }
+    nbytes = MIN(nbytes, sizeof(_data) - filp->pos);
+    memcpy(&_data[filp->pos], src, nbytes);
+    filp->pos += nbytes;
+    return nbytes;
+}
+
+static int _ram_fsync(vfs_file_t *filp)
+{
+    (void)filp;
+    return 0;
+}
+
+static const vfs_file_ops_t _ram_file_ops = {
+    .open = _ram_open,
+    .read = _ram_read,
+    .write = _ram_write,
+    .fsync = _ram_fsync,
+};
+
+static const vfs_file_system_ops_t _ram_fs_ops = { 0 };
+
+static const vfs_file_system_t _ram_file_system = {
+    .f_op = &_ram_file_ops,
+    .fs_op = &_ram_fs_ops,
+    .flags = VFS_FS_FLAG_READAHEAD,
+};
+
+static vfs_mount_t _test_vfs_mount_ram = {
+    .mount_point = "/ram",
+    .fs = &_ram_file_system,
+};
+
+static void setup(void)
+{
+    for (unsigned i = 0; i < sizeof(_data); i++) {
+        _data[i] = i * 7;
+    }
+    _reads = 0;
+    vfs_mount(&_test_vfs_mount_ram);
+}
+
+static void teardown(void)
+{
+    vfs_umount(&_test_vfs_mount_ram, true);
+    atomic_store(&_test_vfs_mount_ram.open_files, 0);
+}
+
+static void _check(const uint8_t *buf, off_t pos, size_t len)
+{
+    TEST_ASSERT_EQUAL_INT(0, memcmp(buf, &_data[pos], len));
+}
+
+static void test_vfs_readahead_sequential(void)
+{
+    if (!IS_USED(MODULE_VFS_READAHEAD)) {
+        return;
+    }
+
+    uint8_t buf[2 * CONFIG_VFS_READAHEAD_SIZE];
+    off_t pos = 0;
+    int fd = vfs_open("/ram/file", O_RDONLY, 0);
+    TEST_ASSERT(fd >= 0);
+
+    /* the first reads are passed on */
+    for (unsigned i = 0; i < CONFIG_VFS_READAHEAD_THRESHOLD; i++) {
+        TEST_ASSERT_EQUAL_INT(10, vfs_read(fd, buf, 10));
+        _check(buf, pos, 10);
+        pos += 10;
+    }
+    TEST_ASSERT_EQUAL_INT(CONFIG_VFS_READAHEAD_THRESHOLD, _reads);
+
+    /* then the file is read a buffer at a time */
+    _reads = 0;
+    for (unsigned i = 0; i < CONFIG_VFS_READAHEAD_SIZE / 10 + 1; i++) {
+        TEST_ASSERT_EQUAL_INT(10, vfs_read(fd, buf, 10));
+        _check(buf, pos, 10);
+        pos += 10;
+    }
+    TEST_ASSERT_EQUAL_INT(2, _reads);
+
+    /* seeking returns the position seen by the user */
+    TEST_ASSERT_EQUAL_INT(pos, vfs_lseek(fd, 0, SEEK_CUR));
+    TEST_ASSERT_EQUAL_INT(10, vfs_read(fd, buf, 10));
+    _check(buf, pos, 10);
+    pos += 10;
+
+    /* large reads are not buffered */
+    _reads = 0;
+    TEST_ASSERT_EQUAL_INT(sizeof(buf), vfs_read(fd, buf, sizeof(buf)));
+    _check(buf, pos, sizeof(buf));
+    pos += sizeof(buf);
+    TEST_ASSERT_EQUAL_INT(1, _reads);
+
+    /* up to the end of the file */
+    ssize_t res;
+    while ((res = vfs_read(fd, buf, 30)) > 0) {
+        _check(buf, pos, res);
+        pos += res;
+    }
+    TEST_ASSERT_EQUAL_INT(0, res);
+    TEST_ASSERT_EQUAL_INT(FILE_SIZE, pos);
+
+    TEST_ASSERT_EQUAL_INT(0, vfs_close(fd));
+}
+
+static void test_vfs_readahead_write(void)
+{
+    if (!IS_USED(MODULE_VFS_READAHEAD)) {
+        return;
+    }
+
+    uint8_t buf[16];
+    int fd = vfs_open("/ram/file", O_RDWR, 0);
+    TEST_ASSERT(fd >= 0);
+    int fd2 = vfs_open("/ram/file", O_WRONLY, 0);
+    TEST_ASSERT(fd2 >= 0);
+
+    for (unsigned i = 0; i <= CONFIG_VFS_READAHEAD_THRESHOLD; i++) {
+        TEST_ASSERT_EQUAL_INT(10, vfs_read(fd, buf, 10));
+    }
+    TEST_ASSERT_EQUAL_INT(CONFIG_VFS_READAHEAD_THRESHOLD + 1, _reads);
+
+    /* syncing does not change the data read ahead */
+    TEST_ASSERT_EQUAL_INT(0, vfs_fsync(fd2));
+    TEST_ASSERT_EQUAL_INT(10, vfs_read(fd, buf, 10));
+    TEST_ASSERT_EQUAL_INT(CONFIG_VFS_READAHEAD_THRESHOLD + 1, _reads);
+
+    /* data read ahead is not used after the file was written */
+    off_t pos = vfs_lseek(fd, 0, SEEK_CUR);
+    TEST_ASSERT_EQUAL_INT(pos, vfs_lseek(fd2, pos, SEEK_SET));
+    TEST_ASSERT_EQUAL_INT(4, vfs_write(fd2, "RIOT", 4));
+    TEST_ASSERT_EQUAL_INT(4, vfs_read(fd, buf, 4));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(buf, "RIOT", 4));
+
+    /* writing continues at the position seen by the user */
+    TEST_ASSERT_EQUAL_INT(4, vfs_read(fd, buf, 4));
+    TEST_ASSERT_EQUAL_INT(3, vfs_write(fd, "VFS", 3));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(&_data[pos + 8], "VFS", 3));
+
+    TEST_ASSERT_EQUAL_INT(0, vfs_close(fd2));
+    TEST_ASSERT_EQUAL_INT(0, vfs_close(fd));
+}
+
+Test *tests_vfs_readahead_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_vfs_readahead_sequential),
+        new_TestFixture(test_vfs_readahead_write),
+    };
+
+    EMB_UNIT_TESTCALLER(vfs_readahead_tests, setup, teardown, fixtures);
+
+    return (Test *)&vfs_readahead_tests;
+}
+
+/** @} */
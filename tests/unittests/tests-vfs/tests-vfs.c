@@ -21,8 +21,10 @@
 
 Test *tests_vfs_bind_tests(void);
 Test *tests_vfs_mount_constfs_tests(void);
+Test *tests_vfs_mount_tree_tests(void);
 Test *tests_vfs_open_close_tests(void);
 Test *tests_vfs_normalize_path_tests(void);
+Test *tests_vfs_readahead_tests(void);
 Test *tests_vfs_null_file_ops_tests(void);
 Test *tests_vfs_null_file_system_ops_tests(void);
 Test *tests_vfs_null_dir_ops_tests(void);
@@ -32,7 +34,9 @@ void tests_vfs(void)
     TESTS_RUN(tests_vfs_open_close_tests());
     TESTS_RUN(tests_vfs_bind_tests());
     TESTS_RUN(tests_vfs_mount_constfs_tests());
+    TESTS_RUN(tests_vfs_mount_tree_tests());
     TESTS_RUN(tests_vfs_normalize_path_tests());
+    TESTS_RUN(tests_vfs_readahead_tests());
     TESTS_RUN(tests_vfs_null_file_ops_tests());
     TESTS_RUN(tests_vfs_null_file_system_ops_tests());
     TESTS_RUN(tests_vfs_null_dir_ops_tests());